@@ -1,16 +1,28 @@
 AC_DEFUN([CHECK_CUSTOM_NEW], [
 
 # custom new off by default, contributing to problems with sst-core thread parallel simulation
+# the slab pools have not yet been measured against the system allocator on large runs
 AC_ARG_ENABLE([custom-new],
   [AS_HELP_STRING([--(dis|en)able-custom-new],
-    [enable custom new on certain classes for efficient, thread-safe mem pools [default=disable]])],
+    [enable custom new on certain classes for efficient, thread-safe slab pools [default=disable]])],
   [with_custom_new=$enableval],
   [with_custom_new=no]
 )
 
 if test "X$with_custom_new" = "Xyes"; then
-  AC_DEFINE_UNQUOTED([CUSTOM_NEW], 1, [Track communcation synchronization stats])
+  AC_DEFINE_UNQUOTED([CUSTOM_NEW], 1, [Pool small, frequently allocated objects in slabs])
 fi
 
-])
+# counting every pooled allocation costs shared atomics on the allocation fast path
+AC_ARG_ENABLE([alloc-stats],
+  [AS_HELP_STRING([--(dis|en)able-alloc-stats],
+    [count live and peak pooled objects for the allocator debug slot [default=disable]])],
+  [with_alloc_stats=$enableval],
+  [with_alloc_stats=no]
+)
 
+if test "X$with_alloc_stats" = "Xyes"; then
+  AC_DEFINE_UNQUOTED([ALLOC_STATS], 1, [Count live and peak pooled objects of each type])
+fi
+
+])
@@ -11,6 +11,7 @@ if test "X$with_multithread" = "Xyes"; then
 else
  AC_SUBST([mt_cmdline_args],[""])
 fi
+AM_CONDITIONAL([USE_MULTITHREAD], [test "X$with_multithread" = "Xyes"])
 
 AC_ARG_ENABLE([spinlock],
   [AS_HELP_STRING([--(dis|en)able-spinlock],
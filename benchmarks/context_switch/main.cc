@@ -42,76 +42,283 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 Questions? Contact sst-macro-help@sandia.gov
 */
 #include <sstmac/main/sstmac.h>
-#include <vector>
 #include <sstmac/software/threading/threading_interface.h>
-#include <sprockit/sim_parameters.h>
 #include <sstmac/software/threading/stack_alloc.h>
+#include <sstmac/software/process/tls.h>
+#include <sprockit/sim_parameters.h>
 #include <sprockit/keyword_registration.h>
+#include <sprockit/errors.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <alloca.h>
+#include <sys/resource.h>
 
 RegisterKeywords(
-{ "context", "the name of the context switch library to profile" },
-{ "nthread", "the number of distinct threads to context switch amongst" },
-{ "niter", "the number of context switch iterations to run" },
+{ "contexts", "the list of context switch libraries to profile" },
+{ "nthread", "the list of thread counts to context switch amongst" },
+{ "niter", "the number of times each thread is resumed" },
+{ "orders", "the list of wake orders to run: round_robin or random" },
+{ "touch_bytes", "the list of stack bytes each thread writes every time it is resumed" },
+{ "tls_lookups", "the number of thread-local storage lookups each thread does every time it is resumed" },
+{ "output", "the csv file results are appended to" },
+{ "label", "a tag, e.g. the release, written into every result" },
 );
 
-struct subthread_args {
-  sstmac::sw::ThreadContext* subthread;
+struct Subthread {
+  sstmac::sw::ThreadContext* context;
   sstmac::sw::ThreadContext* main_thread;
+  void* stack;
+  int touch_bytes;
+  int tls_lookups;
+  bool done;
+  /** Folds in the stack and TLS reads so they cannot be optimized away */
+  uint64_t sum;
 };
 
-class context_switch_benchmark : public sstmac::Benchmark
+/**
+ * Write touch_bytes on the stack of the running thread,
+ * as a deeper call stack in the skeleton would.
+ */
+static __attribute__((noinline)) void touchStack(Subthread* thr)
+{
+  volatile char* buf = (volatile char*) alloca(thr->touch_bytes);
+  memset((char*) buf, 1, thr->touch_bytes);
+  thr->sum += buf[thr->touch_bytes - 1];
+}
+
+/**
+ * Read the thread id the way skeleton code finds its thread-local storage.
+ * Kept out of line so the lookup is not hoisted out of the loop,
+ * which means the cost includes a function call.
+ */
+static __attribute__((noinline)) int tlsThreadId()
+{
+  return *(int*)(get_sstmac_tls() + SSTMAC_TLS_THREAD_ID);
+}
+
+static void runSubthread(void* args)
+{
+  Subthread* thr = (Subthread*) args;
+  while (!thr->done){
+    if (thr->touch_bytes){
+      touchStack(thr);
+    }
+    for (int i=0; i < thr->tls_lookups; ++i){
+      thr->sum += tlsThreadId();
+    }
+    thr->context->pauseContext(thr->main_thread);
+  }
+  thr->context->completeContext(thr->main_thread);
+}
+
+/**
+ * Measures the context switch libraries the way the operating system uses them:
+ * a main (DES) thread resumes each of a large number of user-space threads,
+ * which immediately pause back. Thread counts in the 10^3-10^5 range expose cache
+ * and TLB misses on the stacks, the random wake order mimics threads being unblocked
+ * by message arrivals, and the threads can optionally touch their stacks
+ * and look up their thread-local storage on every resume.
+ * Results are appended to a csv file so they can be tracked across releases.
+ */
+class ContextSwitchBenchmark : public sstmac::Benchmark
 {
  public:
-  FactoryRegister("context_switch", sstmac::benchmark, context_switch_benchmark);
+  SST_ELI_REGISTER_DERIVED(
+    Benchmark,
+    ContextSwitchBenchmark,
+    "macro",
+    "context_switch",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "measures user-space thread context switch costs")
 
-  context_switch_benchmark(SST::Params& params){
-    main_thread_ = sstmac::sw::ThreadContext::factory
-                    ::get_param("context", params);
-    nthread_ = params.find<int>("nthread");
-    niter_ = params.find<int>("niter");
+  ContextSwitchBenchmark(SST::Params& params){
+    if (params.contains("contexts")){
+      params.find_array("contexts", contexts_);
+    } else {
+      contexts_.push_back(sstmac::sw::ThreadContext::defaultThreading());
+    }
+    if (params.contains("nthread")){
+      params.find_array("nthread", nthreads_);
+    } else {
+      nthreads_ = {1000, 10000, 100000};
+    }
+    if (params.contains("orders")){
+      params.find_array("orders", orders_);
+    } else {
+      orders_ = {"round_robin", "random"};
+    }
+    if (params.contains("touch_bytes")){
+      params.find_array("touch_bytes", touch_bytes_);
+    } else {
+      touch_bytes_ = {0};
+    }
+    for (auto& order : orders_){
+      if (order != "round_robin" && order != "random"){
+        spkt_abort_printf("invalid context switch order %s: must be round_robin or random",
+                          order.c_str());
+      }
+    }
+    niter_ = params.find<int>("niter", 100);
+    tls_lookups_ = params.find<int>("tls_lookups", 16);
+    output_ = params.find<std::string>("output", "context_switch.csv");
+    label_ = params.find<std::string>("label", "");
     sstmac::sw::StackAlloc::init(params);
   }
 
   void run() override;
 
  private:
-  std::vector<subthread_args> subthreads_;
-  sstmac::sw::ThreadContext* main_thread_;
-  int nthread_;
+  struct Result {
+    double seconds;
+    long minor_faults;
+    uint64_t sum;
+  };
+
+  Result runThreads(const std::string& context, int nthread, bool random,
+                    int touch_bytes, int tls_lookups);
+
+  void report(FILE* f, const std::string& context, const char* test, int nthread,
+              const std::string& order, int touch_bytes, int tls_lookups,
+              const Result& res, double ns_per_lookup);
+
+  std::vector<std::string> contexts_;
+  std::vector<int> nthreads_;
+  std::vector<std::string> orders_;
+  std::vector<int> touch_bytes_;
   int niter_;
+  int tls_lookups_;
+  std::string output_;
+  std::string label_;
 };
 
-static void run_subthread(void* args){
-  subthread_args* sargs = (subthread_args*) args;
-  auto subthread = sargs->subthread;
-  auto main_thread = sargs->main_thread;
-  while (1){
-    subthread->pauseContext(main_thread);
+ContextSwitchBenchmark::Result
+ContextSwitchBenchmark::runThreads(const std::string& context, int nthread, bool random,
+                                   int touch_bytes, int tls_lookups)
+{
+  auto* main_thread = sprockit::create<sstmac::sw::ThreadContext>("macro", context);
+  main_thread->initContext();
+
+  std::vector<Subthread> subthreads(nthread);
+  for (int i=0; i < nthread; ++i){
+    Subthread& thr = subthreads[i];
+    thr.context = main_thread->copy();
+    thr.main_thread = main_thread;
+    thr.stack = sstmac::sw::StackAlloc::alloc();
+    thr.touch_bytes = touch_bytes;
+    thr.tls_lookups = tls_lookups;
+    thr.done = false;
+    thr.sum = 0;
+    //the thread-local storage sits at the bottom of the aligned stack
+    *(int*)((char*) thr.stack + SSTMAC_TLS_THREAD_ID) = i;
+    thr.context->startContext(thr.stack, sstmac::sw::StackAlloc::stacksize(),
+                              runSubthread, &thr, main_thread);
   }
+
+  std::vector<int> order(nthread);
+  for (int i=0; i < nthread; ++i){
+    order[i] = i;
+  }
+  std::mt19937 gen(42);
+
+  //one pass to fault in the stacks before timing
+  for (int i=0; i < nthread; ++i){
+    subthreads[i].context->resumeContext(main_thread);
+  }
+
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  long faults_start = usage.ru_minflt;
+  std::chrono::steady_clock::duration elapsed(0);
+  for (int it=0; it < niter_; ++it){
+    if (random){
+      std::shuffle(order.begin(), order.end(), gen);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i : order){
+      subthreads[i].context->resumeContext(main_thread);
+    }
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+  getrusage(RUSAGE_SELF, &usage);
+
+  Result res;
+  res.seconds = std::chrono::duration<double>(elapsed).count();
+  res.minor_faults = usage.ru_minflt - faults_start;
+  res.sum = 0;
+  for (Subthread& thr : subthreads){
+    thr.done = true;
+    thr.context->resumeContext(main_thread);
+    res.sum += thr.sum;
+    thr.context->destroyContext();
+    delete thr.context;
+    sstmac::sw::StackAlloc::free(thr.stack);
+  }
+  main_thread->destroyContext();
+  delete main_thread;
+  return res;
 }
 
-void context_switch_benchmark::run()
+void
+ContextSwitchBenchmark::report(FILE* f, const std::string& context, const char* test, int nthread,
+                               const std::string& order, int touch_bytes, int tls_lookups,
+                               const Result& res, double ns_per_lookup)
 {
-  main_thread_->initContext();
-  subthreads_.resize(nthread_);
-  for (int i=0; i < nthread_; ++i){
-    auto& args = subthreads_[i];
-    auto thr = main_thread_->copy();
-    args.subthread = thr;
-    args.main_thread = main_thread_;
-    thr->startContext(0, sstmac::sw::StackAlloc::alloc(),
-             sstmac::sw::StackAlloc::stacksize(),
-             run_subthread, &args, nullptr, nullptr, main_thread_);
+  //every resume is a switch into the thread and a switch back out
+  uint64_t switches = 2 * uint64_t(niter_) * nthread;
+  double ns_per_switch = res.seconds * 1e9 / switches;
+  printf("%-10s %-6s nthread=%-7d order=%-11s touch=%-7d %8.2f ns/switch",
+         context.c_str(), test, nthread, order.c_str(), touch_bytes, ns_per_switch);
+  if (tls_lookups){
+    printf(" %8.2f ns/lookup", ns_per_lookup);
   }
+  printf(" %ld faults\n", res.minor_faults);
+  fprintf(f, "%s,%s,%s,%d,%s,%d,%d,%d,%llu,%.9f,%.4f,%.4f,%ld\n",
+          label_.c_str(), context.c_str(), test, nthread, order.c_str(),
+          touch_bytes, tls_lookups, niter_, (unsigned long long) switches,
+          res.seconds, ns_per_switch, ns_per_lookup, res.minor_faults);
+}
 
-  double start = now();
-  for (int i=0; i < niter_; ++i){
-    for (int j=0; j < nthread_; ++j){
-      sstmac::sw::ThreadContext* subthread = subthreads_[j].subthread;
-      subthread->resumeContext(main_thread_);
+void
+ContextSwitchBenchmark::run()
+{
+  FILE* f = fopen(output_.c_str(), "a");
+  if (!f){
+    spkt_abort_printf("could not open context switch output %s", output_.c_str());
+  }
+  if (ftell(f) == 0){
+    fprintf(f, "label,context,test,nthread,order,touch_bytes,tls_lookups,niter,"
+               "switches,seconds,ns_per_switch,ns_per_lookup,minor_faults\n");
+  }
+
+  for (auto& context : contexts_){
+    for (int nthread : nthreads_){
+      for (auto& order : orders_){
+        for (int touch : touch_bytes_){
+          Result res = runThreads(context, nthread, order == "random", touch, 0);
+          report(f, context, "switch", nthread, order, touch, 0, res, 0);
+        }
+      }
+
+      if (tls_lookups_ > 0){
+        //the lookup cost is whatever the lookups add to a plain round-robin switch
+        //each thread also does its lookups when started and in the untimed pass
+        Result base = runThreads(context, nthread, false, 0, 0);
+        Result res = runThreads(context, nthread, false, 0, tls_lookups_);
+        uint64_t expected = uint64_t(niter_ + 2) * tls_lookups_ * (uint64_t(nthread) * (nthread - 1) / 2);
+        if (res.sum != expected){
+          spkt_abort_printf("context %s found the wrong thread-local storage: sum %llu != %llu",
+                            context.c_str(), (unsigned long long) res.sum,
+                            (unsigned long long) expected);
+        }
+        uint64_t lookups = uint64_t(niter_) * nthread * tls_lookups_;
+        double ns_per_lookup = std::max(0., res.seconds - base.seconds) * 1e9 / lookups;
+        report(f, context, "tls", nthread, "round_robin", 0, tls_lookups_, res, ns_per_lookup);
+      }
     }
   }
-  double stop = now();
-  printf("Benchmark ran for %12.8fs\n", stop - start);
+  fclose(f);
 }
-
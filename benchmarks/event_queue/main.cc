@@ -0,0 +1,237 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+#include <sstmac/main/sstmac.h>
+#include <sstmac/common/event_queue.h>
+#include <sprockit/sim_parameters.h>
+#include <sprockit/keyword_registration.h>
+#include <sprockit/errors.h>
+#include <vector>
+#include <random>
+#include <cstdio>
+
+RegisterKeywords(
+{ "queues", "the list of event queue types to compare" },
+{ "record_file", "an event stream recorded with event_queue=record to replay" },
+{ "num_pending", "the number of pending events for the synthetic hold model" },
+{ "num_ops", "the number of pop/push pairs for the synthetic hold model" },
+{ "num_links", "the number of links events are spread across for the synthetic hold model" },
+{ "link_latency", "the fixed link latency for the synthetic hold model" },
+{ "max_jitter", "the maximum random delay added to each event for the synthetic hold model" },
+{ "niter", "the number of times each stream is replayed against each queue" },
+);
+
+using Record = sstmac::RecordingEventQueue::Record;
+
+class BenchEvent : public sstmac::ExecutionEvent
+{
+ public:
+  void execute() override {}
+};
+
+/**
+ * Replays a stream of pushes, pops, and erases against each requested event queue.
+ * The stream is either recorded from a real simulation with
+ * event_queue = record or generated from a synthetic hold model
+ * resembling packet traversal of fixed-latency links.
+ */
+class EventQueueBenchmark : public sstmac::Benchmark
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    Benchmark,
+    EventQueueBenchmark,
+    "macro",
+    "event_queue",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "compares event queue implementations on a recorded or synthetic event stream")
+
+  EventQueueBenchmark(SST::Params& params) :
+    params_(params)
+  {
+    if (params.contains("queues")){
+      params.find_array("queues", queues_);
+    } else {
+      queues_ = {"set", "calendar"};
+    }
+    niter_ = params.find<int>("niter", 1);
+    auto fname = params.find<std::string>("record_file", "");
+    if (fname.empty()){
+      generateHoldModel(params);
+    } else {
+      readRecords(fname);
+    }
+  }
+
+  void run() override;
+
+ private:
+  void readRecords(const std::string& fname);
+
+  void generateHoldModel(SST::Params& params);
+
+  double replay(sstmac::EventQueue* queue, std::vector<uint64_t>& order);
+
+  SST::Params params_;
+  std::vector<std::string> queues_;
+  std::vector<Record> records_;
+  std::vector<BenchEvent> events_;
+  int niter_;
+};
+
+void
+EventQueueBenchmark::readRecords(const std::string& fname)
+{
+  FILE* f = fopen(fname.c_str(), "rb");
+  if (!f){
+    spkt_abort_printf("could not open event queue record file %s", fname.c_str());
+  }
+  Record rec;
+  size_t npush = 0;
+  while (fread(&rec, sizeof(Record), 1, f) == 1){
+    records_.push_back(rec);
+    if (rec.op == Record::push) ++npush;
+  }
+  fclose(f);
+  events_.resize(npush);
+  printf("Read %zu operations with %zu pushes from %s\n",
+         records_.size(), npush, fname.c_str());
+}
+
+void
+EventQueueBenchmark::generateHoldModel(SST::Params& params)
+{
+  int num_pending = params.find<int>("num_pending", 10000);
+  int num_ops = params.find<int>("num_ops", 1000000);
+  int num_links = params.find<int>("num_links", 1024);
+  sstmac::TimeDelta latency(params.find<SST::UnitAlgebra>("link_latency", "100ns").getValue().toDouble());
+  sstmac::TimeDelta jitter(params.find<SST::UnitAlgebra>("max_jitter", "10ns").getValue().toDouble());
+
+  //the hold model needs the time of each pop, which only depends on the ordering
+  //run it once through the reference queue to produce the stream
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<uint64_t> jitter_dist(0, jitter.ticks());
+  std::vector<uint32_t> seqnums(num_links, 0);
+  events_.resize(num_pending + num_ops);
+
+  sstmac::SetEventQueue queue(params);
+  size_t next_event = 0;
+  auto push = [&](uint64_t t){
+    BenchEvent* ev = &events_[next_event++];
+    uint32_t link = gen() % num_links;
+    ev->setTime(sstmac::Timestamp(0, t));
+    ev->setLink(link);
+    ev->setSeqnum(seqnums[link]++);
+    queue.push(ev);
+    records_.push_back(Record{t, link, ev->seqnum(), Record::push, 0});
+  };
+
+  for (int i=0; i < num_pending; ++i){
+    push(jitter_dist(gen));
+  }
+  for (int i=0; i < num_ops; ++i){
+    sstmac::ExecutionEvent* ev = queue.top();
+    uint64_t t = ev->time().time.ticks();
+    queue.pop();
+    records_.push_back(Record{t, ev->linkId(), ev->seqnum(), Record::pop, 0});
+    push(t + latency.ticks() + jitter_dist(gen));
+  }
+  while (!queue.empty()){
+    sstmac::ExecutionEvent* ev = queue.top();
+    queue.pop();
+    records_.push_back(Record{ev->time().time.ticks(), ev->linkId(), ev->seqnum(), Record::pop, 0});
+  }
+  printf("Generated hold model with %d pending events and %d operations\n",
+         num_pending, num_ops);
+}
+
+double
+EventQueueBenchmark::replay(sstmac::EventQueue* queue, std::vector<uint64_t>& order)
+{
+  order.clear();
+  size_t next_event = 0;
+  double start = now();
+  for (const Record& rec : records_){
+    if (rec.op == Record::push){
+      BenchEvent* ev = &events_[next_event++];
+      ev->setTime(sstmac::Timestamp(0, rec.ticks));
+      ev->setLink(rec.linkId);
+      ev->setSeqnum(rec.seqnum);
+      queue->push(ev);
+    } else if (rec.op == Record::erase){
+      //queues erase by key, so any event with the same key will do
+      BenchEvent key;
+      key.setTime(sstmac::Timestamp(0, rec.ticks));
+      key.setLink(rec.linkId);
+      key.setSeqnum(rec.seqnum);
+      queue->erase(&key);
+    } else {
+      sstmac::ExecutionEvent* ev = queue->top();
+      order.push_back((uint64_t(ev->linkId()) << 32) | ev->seqnum());
+      queue->pop();
+    }
+  }
+  double stop = now();
+  return stop - start;
+}
+
+void
+EventQueueBenchmark::run()
+{
+  std::vector<uint64_t> ref_order;
+  std::vector<uint64_t> order;
+  for (size_t q=0; q < queues_.size(); ++q){
+    auto& name = queues_[q];
+    double total = 0;
+    for (int i=0; i < niter_; ++i){
+      auto* queue = sprockit::create<sstmac::EventQueue>("macro", name, params_);
+      total += replay(queue, q == 0 ? ref_order : order);
+      delete queue;
+    }
+    bool match = q == 0 || order == ref_order;
+    double ns_per_op = total * 1e9 / niter_ / records_.size();
+    printf("Queue %-12s ran %zu operations in %12.8fs: %8.2f ns/op%s\n",
+           name.c_str(), records_.size(), total / niter_, ns_per_op,
+           match ? "" : " - ORDER MISMATCH");
+  }
+}
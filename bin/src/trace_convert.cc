@@ -0,0 +1,128 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/common/sstmac_config.h>
+#include <sstmac/skeletons/sstreplay/replay_convert.h>
+#include <sprockit/statics.h>
+
+#include <getopt.h>
+#include <iostream>
+#include <string>
+
+static void
+print_usage(const char* exe)
+{
+  std::cerr << "usage: " << exe << " [--quiet] (--dumpi trace.meta | --otf2 traces.otf2) output\n"
+            << "  converts a DUMPI or OTF2 trace into a replay file for the sstreplay app\n";
+}
+
+int
+try_trace_convert_main(int argc, char **argv)
+{
+  std::string dumpi;
+  std::string otf2;
+  bool print_progress = true;
+
+  static struct option long_options[] = {
+    {"dumpi", required_argument, 0, 'd'},
+    {"otf2", required_argument, 0, 'o'},
+    {"quiet", no_argument, 0, 'q'},
+    {"help", no_argument, 0, 'h'},
+    {0, 0, 0, 0}
+  };
+
+  int ch;
+  while ((ch = getopt_long(argc, argv, "d:o:qh", long_options, nullptr)) != -1){
+    switch (ch){
+      case 'd': dumpi = optarg; break;
+      case 'o': otf2 = optarg; break;
+      case 'q': print_progress = false; break;
+      case 'h': print_usage(argv[0]); return 0;
+      default: print_usage(argv[0]); return 1;
+    }
+  }
+
+  if (optind != argc - 1 || dumpi.empty() == otf2.empty()){
+    print_usage(argv[0]);
+    return 1;
+  }
+  std::string output = argv[optind];
+
+  if (!dumpi.empty()){
+    sumi::convertDumpi(dumpi, output, print_progress);
+  } else {
+#ifdef SSTMAC_OTF2_ENABLED
+    sumi::convertOtf2(otf2, output, print_progress);
+#else
+    std::cerr << argv[0] << ": not configured with OTF2 support\n";
+    return 1;
+#endif
+  }
+
+  sprockit::Statics::finish();
+  return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+  int rc;
+  try {
+    rc = try_trace_convert_main(argc, argv);
+  }
+  catch (const std::exception &e) {
+    std::cout.flush();
+    std::cerr.flush();
+    std::cerr << argv[0] << ": caught exception while converting trace:\n"
+              << e.what() << "\n";
+    return 1;
+  }
+  catch (...) {
+    std::cerr << argv[0]
+              << ": caught unknown exception while converting trace\n";
+    return 1;
+  }
+
+  return rc;
+}
@@ -0,0 +1,153 @@
+#! /usr/bin/env python
+__license__ = """
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+"""
+
+"""
+Reads the binary files written by streaming FTQ calendars (stream = true).
+Several files, e.g. the <group>.<rank>.ftq files of a parallel run, are merged
+by summing the ticks of each epoch and tag.
+
+  read_ftq.py ftq.*.ftq                  print the merged epochs as csv
+  read_ftq.py ftq.*.ftq -o ftq.csv       write them to a csv file
+  read_ftq.py ftq.*.ftq -t               print the aggregate time of each tag
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"SSTFTQ\0\0"
+VERSION = 2
+MEAN_FLAG = 1
+
+class Calendar:
+  def __init__(self):
+    self.mean = None
+    self.ticksPerEpoch = None
+    self.ticksPerSecond = None
+    self.numCalendars = 0
+    self.tags = {}
+    # (epoch, tag) -> ticks
+    self.ticks = {}
+
+  def merge(self, fname):
+    data = open(fname, "rb").read()
+    if data[:8] != MAGIC:
+      sys.exit("%s is not an FTQ stream file" % fname)
+    pos = 8
+    version, flags, perEpoch, perSecond, ncal, nrec = struct.unpack_from("=IIQQQQ", data, pos)
+    pos += struct.calcsize("=IIQQQQ")
+    if version != VERSION:
+      sys.exit("%s has unsupported version %d" % (fname, version))
+    mean = bool(flags & MEAN_FLAG)
+    if self.ticksPerEpoch is None:
+      self.mean, self.ticksPerEpoch, self.ticksPerSecond = mean, perEpoch, perSecond
+    elif (mean, perEpoch, perSecond) != (self.mean, self.ticksPerEpoch, self.ticksPerSecond):
+      sys.exit("%s does not have the same epochs as the other files" % fname)
+    self.numCalendars += ncal
+
+    for i in range(nrec):
+      epoch, tag, unused, ticks = struct.unpack_from("=QIIQ", data, pos)
+      pos += 24
+      key = epoch, tag
+      self.ticks[key] = self.ticks.get(key, 0) + ticks
+
+    ntags, = struct.unpack_from("=I", data, pos)
+    pos += 4
+    for i in range(ntags):
+      tag, length = struct.unpack_from("=II", data, pos)
+      pos += 8
+      self.tags[tag] = data[pos:pos+length].decode()
+      pos += length
+
+  def columns(self):
+    return sorted(set(tag for epoch, tag in self.ticks))
+
+  def tagName(self, tag):
+    return self.tags.get(tag, str(tag))
+
+
+def writeCSV(cal, out):
+  cols = cal.columns()
+  if cal.mean:
+    out.write("Epoch,Time,Mean\n")
+  else:
+    out.write(",".join(["Epoch", "Time"] + [cal.tagName(t) for t in cols]) + "\n")
+  numEpochs = max(epoch for epoch, tag in cal.ticks) + 1 if cal.ticks else 0
+  ticksPerMs = cal.ticksPerSecond / 1e3
+  for ep in range(numEpochs):
+    row = [str(ep), "%12.4f" % (ep * cal.ticksPerEpoch / ticksPerMs)]
+    if cal.mean:
+      total = sum(cal.ticks.get((ep, t), 0) for t in cols)
+      row.append(str(total / float(cal.numCalendars * cal.ticksPerEpoch)))
+    else:
+      row.extend([str(cal.ticks.get((ep, t), 0)) for t in cols])
+    out.write(",".join(row) + "\n")
+
+
+def writeTotals(cal, out):
+  for tag in cal.columns():
+    total = sum(ticks for (epoch, t), ticks in cal.ticks.items() if t == tag)
+    out.write("%16s: %16.5f s\n" % (cal.tagName(tag), total / float(cal.ticksPerSecond)))
+
+
+def main():
+  parser = argparse.ArgumentParser(description="read streaming FTQ files")
+  parser.add_argument("files", nargs="+", help="ftq files to merge")
+  parser.add_argument("-o", "--output", help="write csv to this file instead of stdout")
+  parser.add_argument("-t", "--totals", action="store_true", help="print the aggregate time of each tag")
+  args = parser.parse_args()
+
+  cal = Calendar()
+  for fname in args.files:
+    cal.merge(fname)
+
+  out = open(args.output, "w") if args.output else sys.stdout
+  if args.totals:
+    writeTotals(cal, out)
+  else:
+    writeCSV(cal, out)
+
+if __name__ == "__main__":
+  main()
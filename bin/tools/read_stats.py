@@ -0,0 +1,214 @@
+#! /usr/bin/env python
+__license__ = """
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+"""
+
+"""
+Reads the binary columnar statistics written by output = columnar.
+Several files, e.g. the <group>.<rank>.stats files of a parallel run, are merged
+by concatenating their rows and matching columns by name.
+
+  read_stats.py nic.*.stats                  print the merged rows as csv
+  read_stats.py nic.*.stats -o nic.csv       write them to a csv file
+  read_stats.py nic.*.stats -m nic.stats     write them to a single columnar file
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"SSTCOLS\0"
+VERSION = 1
+
+# type code -> (struct format, size)
+TYPES = {
+  0 : (None, 0),
+  1 : ("i", 4),
+  2 : ("I", 4),
+  3 : ("q", 8),
+  4 : ("Q", 8),
+  5 : ("f", 4),
+  6 : ("d", 8),
+}
+FLOAT64 = 6
+
+class Table:
+  def __init__(self):
+    self.names = []
+    self.components = []
+    # column name -> [type, list of values or None]
+    self.columns = {}
+    self.order = []
+
+  def numRows(self):
+    return len(self.names)
+
+  def append(self, other):
+    first = self.numRows()
+    self.names.extend(other.names)
+    self.components.extend(other.components)
+    for name in self.order:
+      self.columns[name][1].extend([None] * other.numRows())
+    for name in other.order:
+      otype, ovals = other.columns[name]
+      if name not in self.columns:
+        self.columns[name] = [otype, [None] * self.numRows()]
+        self.order.append(name)
+      col = self.columns[name]
+      if col[0] == 0:
+        col[0] = otype
+      elif otype != 0 and otype != col[0]:
+        col[0] = FLOAT64
+      col[1][first:] = ovals
+
+
+class Reader:
+  def __init__(self, data):
+    self.data = data
+    self.pos = 0
+
+  def read(self, fmt):
+    vals = struct.unpack_from("=" + fmt, self.data, self.pos)
+    self.pos += struct.calcsize("=" + fmt)
+    return vals
+
+  def bytes(self, n):
+    b = self.data[self.pos:self.pos+n]
+    self.pos += n
+    return b
+
+  def strings(self, nrows):
+    total, = self.read("Q")
+    lengths = self.read("%dI" % nrows) if nrows else ()
+    strs = []
+    for length in lengths:
+      strs.append(self.bytes(length).decode())
+    return strs
+
+
+def readTable(fname):
+  data = open(fname, "rb").read()
+  r = Reader(data)
+  if r.bytes(8) != MAGIC:
+    sys.exit("%s is not a columnar stats file" % fname)
+  version, rank, nproc, ncols = r.read("4I")
+  if version != VERSION:
+    sys.exit("%s has unsupported version %d" % (fname, version))
+  nrows, = r.read("Q")
+  t = Table()
+  t.names = r.strings(nrows)
+  t.components = r.strings(nrows)
+  for c in range(ncols):
+    name_length, = r.read("I")
+    name = r.bytes(name_length).decode()
+    typ, = r.read("I")
+    bitmap = r.bytes((nrows + 7) // 8)
+    fmt, size = TYPES[typ]
+    values = r.read("%d%s" % (nrows, fmt)) if fmt and nrows else [0] * nrows
+    vals = []
+    for i in range(nrows):
+      present = bitmap[i // 8] & (1 << (i % 8))
+      vals.append(values[i] if present else None)
+    t.columns[name] = [typ, vals]
+    t.order.append(name)
+  return t
+
+
+def writeCSV(t, out):
+  out.write(",".join(["name", "component"] + t.order) + "\n")
+  for i in range(t.numRows()):
+    row = [t.names[i], t.components[i]]
+    for name in t.order:
+      v = t.columns[name][1][i]
+      row.append("" if v is None else str(v))
+    out.write(",".join(row) + "\n")
+
+
+def writeColumnar(t, fname):
+  nrows = t.numRows()
+  out = open(fname, "wb")
+  out.write(MAGIC)
+  out.write(struct.pack("=4IQ", VERSION, 0, 1, len(t.order), nrows))
+  for strs in t.names, t.components:
+    encoded = [s.encode() for s in strs]
+    out.write(struct.pack("=Q", sum(len(s) for s in encoded)))
+    out.write(struct.pack("=%dI" % nrows, *[len(s) for s in encoded]))
+    for s in encoded:
+      out.write(s)
+  for name in t.order:
+    typ, vals = t.columns[name]
+    encoded = name.encode()
+    out.write(struct.pack("=I", len(encoded)))
+    out.write(encoded)
+    out.write(struct.pack("=I", typ))
+    bitmap = bytearray((nrows + 7) // 8)
+    for i, v in enumerate(vals):
+      if v is not None:
+        bitmap[i // 8] |= 1 << (i % 8)
+    out.write(bytes(bitmap))
+    fmt, size = TYPES[typ]
+    if fmt:
+      out.write(struct.pack("=%d%s" % (nrows, fmt), *[0 if v is None else v for v in vals]))
+  out.close()
+
+
+def main():
+  parser = argparse.ArgumentParser(description="read binary columnar statistics")
+  parser.add_argument("files", nargs="+", help="columnar stats files to merge")
+  parser.add_argument("-o", "--output", help="write csv to this file instead of stdout")
+  parser.add_argument("-m", "--merge", help="write the merged rows to this columnar file")
+  args = parser.parse_args()
+
+  merged = Table()
+  for fname in args.files:
+    merged.append(readTable(fname))
+
+  if args.merge:
+    writeColumnar(merged, args.merge)
+  elif args.output:
+    writeCSV(merged, open(args.output, "w"))
+  else:
+    writeCSV(merged, sys.stdout)
+
+if __name__ == "__main__":
+  main()
@@ -164,7 +164,7 @@ class threadSafeAllocator
       std::cerr << "thread safe allocator cannot allocate more than 1 item at a time" << std::endl;
       ::abort();
     } 
-    thread_safe_new<T>::operator delete(p);
+    thread_safe_new<T>::operator delete(p, sizeof(T));
   }
 
 };
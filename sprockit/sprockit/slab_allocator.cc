@@ -0,0 +1,338 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sprockit/slab_allocator.h>
+#include <sstmac/common/sstmac_config.h>
+
+#include <sys/mman.h>
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+RegisterDebugSlot(allocator,
+  "print the memory held in slabs at the end of the run, and live and peak object counts"
+  " for pooled types when configured with --enable-alloc-stats");
+
+namespace sprockit {
+
+thread_local SlabAllocator::ThreadHeap* SlabAllocator::heap_ = nullptr;
+std::atomic<AllocStats*> SlabAllocator::stats_{nullptr};
+std::atomic<int64_t> SlabAllocator::slabs_mapped_{0};
+std::atomic<int64_t> SlabAllocator::peak_slabs_mapped_{0};
+
+void
+AllocStats::registerStats(const char* type_name)
+{
+  if (registered.exchange(true)) return;
+
+  name = type_name;
+  AllocStats* head = SlabAllocator::stats_.load();
+  do {
+    next = head;
+  } while (!SlabAllocator::stats_.compare_exchange_weak(head, this));
+}
+
+void*
+SlabAllocator::allocateSlow(ThreadHeap* heap, int cls)
+{
+  if (!heap){
+    heap = new ThreadHeap();
+    heap_ = heap;
+  }
+
+  if (heap->remote_slabs.load(std::memory_order_relaxed)){
+    collectRemote(heap);
+  }
+
+  Slab* slab = heap->available[cls];
+  //only the head of the list can run out of objects
+  while (slab && !slab->local_free && slab->bump + slab->obj_size > slab->end){
+    removeAvailable(heap, slab);
+    slab = heap->available[cls];
+  }
+
+  if (!slab){
+    slab = newSlab(heap, cls);
+    addAvailable(heap, slab);
+  }
+
+  void* ret;
+  if (slab->local_free){
+    ret = slab->local_free;
+    slab->local_free = slab->local_free->next;
+  } else {
+    //carve lazily so pages are only touched as they are needed
+    ret = slab->bump;
+    slab->bump += slab->obj_size;
+  }
+  ++slab->used;
+  return ret;
+}
+
+void
+SlabAllocator::freeLocalSlow(Slab* slab)
+{
+  ThreadHeap* heap = slab->owner;
+  //keep the slab being allocated from to avoid churning through empty slabs
+  if (slab->used == 0 && heap->available[slab->cls] != slab){
+    releaseSlab(heap, slab);
+  } else if (!slab->available){
+    addAvailable(heap, slab);
+  }
+}
+
+void
+SlabAllocator::freeRemote(Slab* slab, void* ptr)
+{
+  FreeObject* obj = (FreeObject*) ptr;
+  uintptr_t old = slab->remote_free.load(std::memory_order_relaxed);
+  do {
+    obj->next = (FreeObject*) (old & ~uintptr_t(1));
+  } while (!slab->remote_free.compare_exchange_weak(old, uintptr_t(obj) | 1,
+                         std::memory_order_acq_rel, std::memory_order_relaxed));
+
+  if ((old & 1) == 0){
+    //first remote free since the owner last looked - queue the slab for the owner.
+    //the owner only collects queued slabs, so the slab stays mapped until this push is done
+    ThreadHeap* owner = slab->owner;
+    Slab* head = owner->remote_slabs.load(std::memory_order_relaxed);
+    do {
+      slab->pending_next = head;
+    } while (!owner->remote_slabs.compare_exchange_weak(head, slab,
+                         std::memory_order_release, std::memory_order_relaxed));
+  }
+}
+
+void
+SlabAllocator::collectRemote(ThreadHeap* heap)
+{
+  Slab* slab = heap->remote_slabs.exchange(nullptr, std::memory_order_acquire);
+  while (slab){
+    //read before clearing the flag, another thread may queue the slab again right after
+    Slab* next = slab->pending_next;
+    uintptr_t list = slab->remote_free.exchange(0, std::memory_order_acq_rel);
+    FreeObject* obj = (FreeObject*) (list & ~uintptr_t(1));
+    while (obj){
+      FreeObject* next_obj = obj->next;
+      obj->next = slab->local_free;
+      slab->local_free = obj;
+      --slab->used;
+      obj = next_obj;
+    }
+    freeLocalSlow(slab);
+    slab = next;
+  }
+}
+
+SlabAllocator::Slab*
+SlabAllocator::newSlab(ThreadHeap* heap, int cls)
+{
+  static_assert(offsetof(Slab, remote_free) == 64,
+                "remote fields of a slab must start on their own cache line");
+  static_assert(sizeof(Slab) <= header_size, "slab header does not fit");
+
+  Slab* slab = heap->empty;
+  if (slab){
+    heap->empty = slab->next;
+    --heap->num_empty;
+  } else {
+    //over-allocate and trim to get a slab_size-aligned region
+    size_t length = 2*slab_size;
+    void* mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED){
+      throw std::bad_alloc();
+    }
+    char* raw = (char*) mapped;
+    char* aligned = (char*) ((uintptr_t(raw) + slab_size - 1) & ~uintptr_t(slab_size-1));
+    size_t front = aligned - raw;
+    size_t back = length - front - slab_size;
+    if (front) munmap(raw, front);
+    if (back) munmap(aligned + slab_size, back);
+
+    slab = new (aligned) Slab;
+    slab->remote_free.store(0, std::memory_order_relaxed);
+    int64_t num_mapped = slabs_mapped_.fetch_add(1, std::memory_order_relaxed) + 1;
+    int64_t peak = peak_slabs_mapped_.load(std::memory_order_relaxed);
+    while (num_mapped > peak && !peak_slabs_mapped_.compare_exchange_weak(peak, num_mapped,
+                                                   std::memory_order_relaxed));
+  }
+
+  slab->local_free = nullptr;
+  slab->bump = (char*) slab + header_size;
+  slab->end = (char*) slab + slab_size;
+  slab->owner = heap;
+  slab->next = nullptr;
+  slab->prev = nullptr;
+  slab->used = 0;
+  slab->obj_size = classSize(cls);
+  slab->cls = cls;
+  slab->available = false;
+  slab->pending_next = nullptr;
+  return slab;
+}
+
+void
+SlabAllocator::addAvailable(ThreadHeap* heap, Slab* slab)
+{
+  Slab*& head = heap->available[slab->cls];
+  if (head && head->used == 0){
+    //the old head was kept around empty, it is no longer needed
+    releaseSlab(heap, head);
+  }
+  slab->prev = nullptr;
+  slab->next = head;
+  if (head) head->prev = slab;
+  head = slab;
+  slab->available = true;
+}
+
+void
+SlabAllocator::removeAvailable(ThreadHeap* heap, Slab* slab)
+{
+  if (slab->prev){
+    slab->prev->next = slab->next;
+  } else {
+    heap->available[slab->cls] = slab->next;
+  }
+  if (slab->next){
+    slab->next->prev = slab->prev;
+  }
+  slab->next = slab->prev = nullptr;
+  slab->available = false;
+}
+
+void
+SlabAllocator::releaseSlab(ThreadHeap* heap, Slab* slab)
+{
+  if (slab->available){
+    removeAvailable(heap, slab);
+  }
+  if (heap->num_empty < max_cached_slabs){
+    slab->next = heap->empty;
+    heap->empty = slab;
+    ++heap->num_empty;
+  } else {
+    unmapSlab(slab);
+  }
+}
+
+void
+SlabAllocator::unmapSlab(Slab* slab)
+{
+  slab->~Slab();
+  munmap(slab, slab_size);
+  slabs_mapped_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void
+SlabAllocator::trim()
+{
+  ThreadHeap* heap = heap_;
+  if (!heap) return;
+
+  collectRemote(heap);
+  for (int cls=0; cls < num_classes; ++cls){
+    Slab* head = heap->available[cls];
+    if (head && head->used == 0){
+      removeAvailable(heap, head);
+      unmapSlab(head);
+    }
+  }
+  while (heap->empty){
+    Slab* slab = heap->empty;
+    heap->empty = slab->next;
+    unmapSlab(slab);
+  }
+  heap->num_empty = 0;
+}
+
+static std::string
+demangledName(const char* name)
+{
+#if defined(__GNUC__)
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status == 0 && demangled){
+    std::string ret(demangled);
+    ::free(demangled);
+    return ret;
+  }
+#endif
+  return name;
+}
+
+void
+SlabAllocator::printStats(std::ostream& os)
+{
+#if SSTMAC_ALLOC_STATS
+  std::vector<AllocStats*> all;
+  for (AllocStats* stats = stats_.load(); stats; stats = stats->next){
+    all.push_back(stats);
+  }
+  std::sort(all.begin(), all.end(), [](AllocStats* a, AllocStats* b){
+    return a->peak_bytes.load() > b->peak_bytes.load();
+  });
+
+  //derived types are counted with their pooled base type
+  os << "Pooled allocations (including derived types):\n";
+  for (AllocStats* stats : all){
+    os << std::setw(12) << stats->live.load() << " live "
+       << std::setw(12) << stats->peak.load() << " peak "
+       << std::setw(10) << stats->peak_bytes.load() / 1024 << " KB peak  "
+       << demangledName(stats->name) << "\n";
+  }
+#else
+  os << "Pooled allocations: not counted, configure with --enable-alloc-stats\n";
+#endif
+  os << "Slab memory: " << (slabs_mapped_.load() * slab_size) / 1024 << " KB mapped, "
+     << (peak_slabs_mapped_.load() * slab_size) / 1024 << " KB peak\n";
+}
+
+}
@@ -0,0 +1,258 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SPROCKIT_SLAB_ALLOCATOR_H
+#define SPROCKIT_SLAB_ALLOCATOR_H
+
+#include <sprockit/debug.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+DeclareDebugSlot(allocator);
+
+namespace sprockit {
+
+/**
+ * Live and peak object counts and bytes for one pooled type and the types derived from it.
+ * Derived types can be larger than the base, so bytes are counted with the allocated size.
+ * Only counted when configured with --enable-alloc-stats.
+ */
+struct AllocStats {
+  std::atomic<int64_t> live{0};
+  std::atomic<int64_t> peak{0};
+  std::atomic<int64_t> live_bytes{0};
+  std::atomic<int64_t> peak_bytes{0};
+  std::atomic<bool> registered{false};
+  const char* name = nullptr;
+  AllocStats* next = nullptr;
+
+  void allocated(const char* type_name, size_t sz){
+    int64_t now = live.fetch_add(1, std::memory_order_relaxed) + 1;
+    int64_t now_bytes = live_bytes.fetch_add(sz, std::memory_order_relaxed) + sz;
+    updatePeak(peak, now);
+    updatePeak(peak_bytes, now_bytes);
+    if (!registered.load(std::memory_order_relaxed)){
+      registerStats(type_name);
+    }
+  }
+
+  void freed(size_t sz){
+    live.fetch_sub(1, std::memory_order_relaxed);
+    live_bytes.fetch_sub(sz, std::memory_order_relaxed);
+  }
+
+ private:
+  static void updatePeak(std::atomic<int64_t>& peak, int64_t now){
+    int64_t old_peak = peak.load(std::memory_order_relaxed);
+    //only happens while the population is growing
+    while (now > old_peak && !peak.compare_exchange_weak(old_peak, now, std::memory_order_relaxed));
+  }
+
+  void registerStats(const char* type_name);
+};
+
+/**
+ * Thread-caching slab allocator for small, frequently created objects like packets and events.
+ * Each thread allocates from its own 64 KB slabs, one list of slabs per size class.
+ * Objects freed by the owning thread go straight back on the slab's free list.
+ * Objects freed by another thread are pushed onto the slab's atomic remote-free list
+ * and the slab is queued for its owner, so memory always returns to the thread that can reuse it.
+ * Empty slabs are cached briefly and returned to the OS by trim().
+ * Thread heaps are never destroyed, so the allocator is meant for a fixed pool of worker threads.
+ */
+class SlabAllocator {
+ public:
+  static constexpr size_t slab_size = 64*1024;
+
+  /** Larger requests go to the global operator new */
+  static constexpr size_t max_size = 1024;
+
+  /** 16-byte classes up to 64 bytes, then 64-byte classes up to max_size */
+  static constexpr int num_classes = 19;
+
+  /** Empty slabs each thread keeps before returning them to the OS */
+  static constexpr int max_cached_slabs = 4;
+
+  static void* allocate(size_t size){
+    if (size > max_size){
+      return ::operator new(size);
+    }
+    int cls = sizeClass(size);
+    ThreadHeap* heap = heap_;
+    if (heap){
+      Slab* slab = heap->available[cls];
+      if (slab && slab->local_free){
+        FreeObject* obj = slab->local_free;
+        slab->local_free = obj->next;
+        ++slab->used;
+        return obj;
+      }
+    }
+    return allocateSlow(heap, cls);
+  }
+
+  /**
+   * @param size The size passed to allocate, which decides whether the object lives in a slab
+   */
+  static void deallocate(void* ptr, size_t size){
+    if (size > max_size){
+      ::operator delete(ptr);
+      return;
+    }
+    Slab* slab = (Slab*) (uintptr_t(ptr) & ~uintptr_t(slab_size-1));
+    if (slab->owner == heap_){
+      FreeObject* obj = (FreeObject*) ptr;
+      obj->next = slab->local_free;
+      slab->local_free = obj;
+      if (--slab->used == 0 || !slab->available){
+        freeLocalSlow(slab);
+      }
+    } else {
+      freeRemote(slab, ptr);
+    }
+  }
+
+  /**
+   * @brief trim Collect objects other threads freed back to this thread
+   *        and return this thread's cached empty slabs to the OS
+   */
+  static void trim();
+
+  static void printStats(std::ostream& os);
+
+  /**
+   * @return The number of slabs currently mapped by all threads
+   */
+  static int64_t slabsMapped() {
+    return slabs_mapped_.load();
+  }
+
+  static int sizeClass(size_t size){
+    if (size <= 64){
+      return size == 0 ? 0 : (size + 15)/16 - 1;
+    } else {
+      return (size + 63)/64 + 2;
+    }
+  }
+
+  static size_t classSize(int cls){
+    return cls < 4 ? 16*(cls+1) : 64*(cls-2);
+  }
+
+ private:
+  friend struct AllocStats;
+
+  struct FreeObject {
+    FreeObject* next;
+  };
+
+  struct ThreadHeap;
+
+  /**
+   * Header at the start of each slab_size-aligned slab, so an object finds its slab by masking
+   */
+  struct Slab {
+    /** Fields only the owning thread touches */
+    FreeObject* local_free;
+    char* bump;
+    char* end;
+    ThreadHeap* owner;
+    Slab* next;
+    Slab* prev;
+    uint32_t used;
+    uint32_t obj_size;
+    int cls;
+    bool available;
+    char pad_[3];
+
+    /** Fields other threads write, on their own cache line.
+     *  The low bit of remote_free is set once the slab has been queued for its owner */
+    std::atomic<uintptr_t> remote_free;
+    Slab* pending_next;
+  };
+
+  static constexpr size_t header_size = 128;
+
+  struct ThreadHeap {
+    /** Slabs with free objects, the head is allocated from */
+    Slab* available[num_classes];
+    Slab* empty;
+    int num_empty;
+    char pad_[64];
+    /** Slabs other threads freed objects into */
+    std::atomic<Slab*> remote_slabs;
+  };
+
+  static void* allocateSlow(ThreadHeap* heap, int cls);
+
+  static void freeLocalSlow(Slab* slab);
+
+  static void freeRemote(Slab* slab, void* ptr);
+
+  static void collectRemote(ThreadHeap* heap);
+
+  static Slab* newSlab(ThreadHeap* heap, int cls);
+
+  static void releaseSlab(ThreadHeap* heap, Slab* slab);
+
+  static void addAvailable(ThreadHeap* heap, Slab* slab);
+
+  static void removeAvailable(ThreadHeap* heap, Slab* slab);
+
+  static void unmapSlab(Slab* slab);
+
+  static thread_local ThreadHeap* heap_;
+
+  static std::atomic<AllocStats*> stats_;
+  static std::atomic<int64_t> slabs_mapped_;
+  static std::atomic<int64_t> peak_slabs_mapped_;
+
+};
+
+}
+
+#endif
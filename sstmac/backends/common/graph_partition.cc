@@ -0,0 +1,645 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+
+#include <sstmac/backends/common/sim_partition.h>
+#include <sstmac/backends/common/parallel_runtime.h>
+#include <sstmac/hardware/topology/topology.h>
+#include <sstmac/software/launch/launch_request.h>
+
+#include <sprockit/keyword_registration.h>
+#include <sprockit/sim_parameters.h>
+#include <sprockit/errors.h>
+#include <sprockit/util.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <map>
+#include <queue>
+
+#define part_debug(...) \
+  debug_printf(sprockit::dbg::partition, "Rank %d: %s", me_, sprockit::sprintf(__VA_ARGS__).c_str())
+
+RegisterKeywords(
+  { "partition_switch_weight", "base weight given to every switch by the graph partition" },
+  { "partition_node_weight", "weight added to a switch for each node attached to it" },
+  { "partition_occupied_weight", "weight added to a switch for each node allocated to a job" },
+  { "partition_imbalance", "largest allowed ratio of a part's weight to the average part weight" },
+  { "partition_weights_file", "file of 'switch weight' lines overriding the estimated switch weights" },
+  { "partition_profile", "event profile from a previous run used to weight switches and links" },
+  { "partition_summary", "whether to print the weight of each part and the links cut by the graph partition" },
+);
+
+namespace sstmac {
+
+/** Stop coarsening once the graph has this many vertices per part */
+static const int coarsen_vertices_per_part = 20;
+/** Number of random starts for the initial partition */
+static const int initial_partition_tries = 4;
+/** Maximum number of refinement passes at each level */
+static const int refine_passes = 8;
+
+GraphPartition::GraphPartition(SST::Params& params, ParallelRuntime* rt) :
+  BlockPartition(params, rt)
+{
+  switch_weight_ = params.find<int64_t>("partition_switch_weight", 1);
+  node_weight_ = params.find<int64_t>("partition_node_weight", 1);
+  occupied_weight_ = params.find<int64_t>("partition_occupied_weight", 4);
+  imbalance_ = params.find<double>("partition_imbalance", 1.05);
+  weights_file_ = params.find<std::string>("partition_weights_file", "");
+  print_summary_ = params.find<bool>("partition_summary", false);
+  if (imbalance_ < 1.0){
+    spkt_abort_printf("partition_imbalance=%f must be at least 1.0", imbalance_);
+  }
+  computeOccupiedNodes(params);
+}
+
+GraphPartition::~GraphPartition()
+{
+}
+
+void
+GraphPartition::computeOccupiedNodes(SST::Params& params)
+{
+  occupied_nodes_.resize(num_switches_total_, 0);
+  SST::Params node_params = params.get_scoped_params("node");
+  int num_nodes = fake_top_->numNodes();
+  //jobs with the default allocation fill nodes in order,
+  //other allocations cannot be predicted before the run
+  int next_node = 0;
+  bool found_app = true;
+  for (int appnum=1; found_app || appnum < 10; ++appnum){
+    std::string app_ns = sprockit::sprintf("app%d", appnum);
+    SST::Params app_params = node_params.get_scoped_params(app_ns);
+    found_app = app_params.contains("name");
+    if (!found_app) continue;
+
+    std::string alloc = app_params.find<std::string>("allocation", "first_available");
+    if (alloc != "first_available") continue;
+    if (!app_params.contains("launch_cmd") && !app_params.contains("size")) continue;
+
+    int nproc = 0, ppn = 1;
+    std::vector<int> ignore;
+    sw::SoftwareLaunchRequest::parseLaunchCmd(app_params, nproc, ppn, ignore);
+    if (nproc <= 0 || ppn <= 0) continue;
+
+    int nnodes = (nproc + ppn - 1) / ppn;
+    for (int i=0; i < nnodes && next_node < num_nodes; ++i, ++next_node){
+      SwitchId sid = fake_top_->endpointToSwitch(next_node);
+      occupied_nodes_[sid]++;
+    }
+  }
+}
+
+void
+GraphPartition::switchWeights(std::vector<int64_t>& weights)
+{
+  weights.resize(num_switches_total_);
+  std::vector<hw::Topology::InjectionPort> nodes;
+  for (int i=0; i < num_switches_total_; ++i){
+    nodes.clear();
+    fake_top_->endpointsConnectedToInjectionSwitch(i, nodes);
+    weights[i] = switch_weight_ + node_weight_ * nodes.size()
+                 + occupied_weight_ * occupied_nodes_[i];
+  }
+
+  if (weights_file_.empty()) return;
+
+  std::ifstream in(weights_file_);
+  if (!in.is_open()){
+    spkt_abort_printf("could not open partition_weights_file %s", weights_file_.c_str());
+  }
+  std::string line;
+  while (std::getline(in, line)){
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) line = line.substr(0, comment);
+    std::stringstream sstr(line);
+    int sid;
+    int64_t weight;
+    if (!(sstr >> sid)) continue;
+    if (!(sstr >> weight) || sid < 0 || sid >= num_switches_total_ || weight < 0){
+      spkt_abort_printf("invalid line '%s' in partition_weights_file %s",
+                        line.c_str(), weights_file_.c_str());
+    }
+    weights[sid] = weight;
+  }
+}
+
+void
+GraphPartition::buildGraph(Graph& g)
+{
+  switchWeights(g.vwgt);
+
+  //count links in both directions, a link shows up as an outport on each end
+  std::vector<std::map<int,int>> links(num_switches_total_);
+  std::vector<hw::Topology::Connection> conns;
+  for (int i=0; i < num_switches_total_; ++i){
+    conns.clear();
+    fake_top_->connectedOutports(i, conns);
+    for (auto& conn : conns){
+      if (conn.dst == SwitchId(i)) continue;
+      links[i][conn.dst]++;
+      links[conn.dst][i]++;
+    }
+  }
+
+  g.xadj.resize(num_switches_total_ + 1);
+  g.xadj[0] = 0;
+  for (int i=0; i < num_switches_total_; ++i){
+    g.xadj[i+1] = g.xadj[i] + links[i].size();
+  }
+  g.adjncy.resize(g.xadj.back());
+  g.adjwgt.resize(g.xadj.back());
+  for (int i=0; i < num_switches_total_; ++i){
+    int idx = g.xadj[i];
+    for (auto& pair : links[i]){
+      int lo = std::min(i, pair.first);
+      int hi = std::max(i, pair.first);
+      g.adjncy[idx] = pair.first;
+      g.adjwgt[idx] = std::max<int64_t>(1, linkWeight(lo, hi, pair.second));
+      ++idx;
+    }
+  }
+}
+
+int64_t
+GraphPartition::edgeCut(const Graph& g, const std::vector<int>& part)
+{
+  int64_t cut = 0;
+  for (int v=0; v < g.size(); ++v){
+    for (int e=g.xadj[v]; e < g.xadj[v+1]; ++e){
+      if (part[v] != part[g.adjncy[e]]) cut += g.adjwgt[e];
+    }
+  }
+  return cut / 2;
+}
+
+void
+GraphPartition::subgraph(const Graph& g, const std::vector<int>& vertices, Graph& sub)
+{
+  std::vector<int> local(g.size(), -1);
+  for (int i=0; i < int(vertices.size()); ++i){
+    local[vertices[i]] = i;
+  }
+  sub.xadj.assign(1, 0);
+  sub.adjncy.clear();
+  sub.adjwgt.clear();
+  sub.vwgt.resize(vertices.size());
+  for (int i=0; i < int(vertices.size()); ++i){
+    int v = vertices[i];
+    sub.vwgt[i] = g.vwgt[v];
+    for (int e=g.xadj[v]; e < g.xadj[v+1]; ++e){
+      int u = local[g.adjncy[e]];
+      if (u >= 0){
+        sub.adjncy.push_back(u);
+        sub.adjwgt.push_back(g.adjwgt[e]);
+      }
+    }
+    sub.xadj.push_back(sub.adjncy.size());
+  }
+}
+
+void
+GraphPartition::coarsen(const Graph& fine, Graph& coarse, std::vector<int>& cmap,
+                        int64_t max_vwgt, std::mt19937& rng) const
+{
+  int n = fine.size();
+  std::vector<int> order(n);
+  for (int i=0; i < n; ++i) order[i] = i;
+  std::shuffle(order.begin(), order.end(), rng);
+
+  //heavy-edge matching
+  std::vector<int> match(n, -1);
+  for (int v : order){
+    if (match[v] >= 0) continue;
+    int best = v;
+    int64_t best_wgt = -1;
+    for (int e=fine.xadj[v]; e < fine.xadj[v+1]; ++e){
+      int u = fine.adjncy[e];
+      if (match[u] < 0 && u != v && fine.adjwgt[e] > best_wgt
+          && fine.vwgt[v] + fine.vwgt[u] <= max_vwgt){
+        best = u;
+        best_wgt = fine.adjwgt[e];
+      }
+    }
+    match[v] = best;
+    match[best] = v;
+  }
+
+  cmap.resize(n);
+  int ncoarse = 0;
+  for (int v=0; v < n; ++v){
+    if (v <= match[v]){
+      cmap[v] = cmap[match[v]] = ncoarse++;
+    }
+  }
+
+  //merge the adjacency lists of matched vertices
+  coarse.vwgt.assign(ncoarse, 0);
+  coarse.xadj.assign(1, 0);
+  coarse.adjncy.clear();
+  coarse.adjwgt.clear();
+  std::vector<int> slot(ncoarse, -1);
+  for (int v=0; v < n; ++v){
+    if (v > match[v]) continue;
+    int cv = cmap[v];
+    int start = coarse.adjncy.size();
+    int pair[] = {v, match[v]};
+    int npair = match[v] == v ? 1 : 2;
+    for (int i=0; i < npair; ++i){
+      int w = pair[i];
+      coarse.vwgt[cv] += fine.vwgt[w];
+      for (int e=fine.xadj[w]; e < fine.xadj[w+1]; ++e){
+        int cu = cmap[fine.adjncy[e]];
+        if (cu == cv) continue;
+        if (slot[cu] < start){
+          slot[cu] = coarse.adjncy.size();
+          coarse.adjncy.push_back(cu);
+          coarse.adjwgt.push_back(fine.adjwgt[e]);
+        } else {
+          coarse.adjwgt[slot[cu]] += fine.adjwgt[e];
+        }
+      }
+    }
+    coarse.xadj.push_back(coarse.adjncy.size());
+  }
+}
+
+int64_t
+GraphPartition::initialPartition(const Graph& g, int nparts, int64_t max_pwgt,
+                                 std::vector<int>& part, std::mt19937& rng) const
+{
+  int n = g.size();
+  int64_t total = 0;
+  for (int64_t w : g.vwgt) total += w;
+
+  std::vector<int> best_part;
+  int64_t best_cut = -1;
+  std::vector<int> trial(n);
+  std::vector<int64_t> conn(n);
+  for (int t=0; t < initial_partition_tries; ++t){
+    std::fill(trial.begin(), trial.end(), -1);
+    std::vector<int> unassigned(n);
+    for (int i=0; i < n; ++i) unassigned[i] = i;
+    std::shuffle(unassigned.begin(), unassigned.end(), rng);
+    int next_seed = 0;
+    int64_t remaining = total;
+    //grow each part from a seed vertex, always adding
+    //the vertex most strongly connected to the part
+    for (int p=0; p < nparts - 1; ++p){
+      int64_t target = remaining / (nparts - p);
+      int64_t pwgt = 0;
+      std::fill(conn.begin(), conn.end(), 0);
+      std::priority_queue<std::pair<int64_t,int>> frontier;
+      while (pwgt < target){
+        int v = -1;
+        while (!frontier.empty()){
+          auto top = frontier.top();
+          frontier.pop();
+          if (trial[top.second] < 0 && top.first == conn[top.second]){
+            v = top.second;
+            break;
+          }
+        }
+        if (v < 0){
+          while (next_seed < n && trial[unassigned[next_seed]] >= 0) ++next_seed;
+          if (next_seed == n) break;
+          v = unassigned[next_seed];
+        }
+        //stop if this vertex takes us further from the target
+        if (pwgt > 0 && pwgt + g.vwgt[v] - target > target - pwgt) break;
+        trial[v] = p;
+        pwgt += g.vwgt[v];
+        for (int e=g.xadj[v]; e < g.xadj[v+1]; ++e){
+          int u = g.adjncy[e];
+          if (trial[u] < 0){
+            conn[u] += g.adjwgt[e];
+            frontier.emplace(conn[u], u);
+          }
+        }
+      }
+      remaining -= pwgt;
+    }
+    for (int v=0; v < n; ++v){
+      if (trial[v] < 0) trial[v] = nparts - 1;
+    }
+    refine(g, nparts, max_pwgt, trial, rng);
+    int64_t cut = edgeCut(g, trial);
+    if (best_cut < 0 || cut < best_cut){
+      best_cut = cut;
+      best_part = trial;
+    }
+  }
+  part = std::move(best_part);
+  return best_cut;
+}
+
+void
+GraphPartition::refine(const Graph& g, int nparts, int64_t max_pwgt,
+                       std::vector<int>& part, std::mt19937& rng) const
+{
+  int n = g.size();
+  std::vector<int64_t> pwgt(nparts, 0);
+  for (int v=0; v < n; ++v) pwgt[part[v]] += g.vwgt[v];
+
+  std::vector<int> order(n);
+  for (int i=0; i < n; ++i) order[i] = i;
+  std::vector<int64_t> conn(nparts, 0);
+  std::vector<int> touched;
+  for (int pass=0; pass < refine_passes; ++pass){
+    std::shuffle(order.begin(), order.end(), rng);
+    int nmoves = 0;
+    for (int v : order){
+      int from = part[v];
+      touched.clear();
+      for (int e=g.xadj[v]; e < g.xadj[v+1]; ++e){
+        int p = part[g.adjncy[e]];
+        if (conn[p] == 0) touched.push_back(p);
+        conn[p] += g.adjwgt[e];
+      }
+      bool overweight = pwgt[from] > max_pwgt;
+      int64_t internal = conn[from];
+      int to = -1;
+      int64_t best_gain = 0;
+      for (int p : touched){
+        if (p == from || pwgt[p] + g.vwgt[v] > max_pwgt) continue;
+        int64_t gain = conn[p] - internal;
+        bool better_balance = pwgt[p] + g.vwgt[v] < pwgt[from];
+        bool accept = gain > 0 || (gain == 0 && better_balance) || overweight;
+        if (accept && (to < 0 || gain > best_gain ||
+                       (gain == best_gain && pwgt[p] < pwgt[to]))){
+          to = p;
+          best_gain = gain;
+        }
+      }
+      if (to < 0 && overweight){
+        //no neighboring part has room, move to the lightest part
+        int lightest = std::min_element(pwgt.begin(), pwgt.end()) - pwgt.begin();
+        if (lightest != from && pwgt[lightest] + g.vwgt[v] < pwgt[from]) to = lightest;
+      }
+      for (int p : touched) conn[p] = 0;
+      if (to >= 0){
+        part[v] = to;
+        pwgt[from] -= g.vwgt[v];
+        pwgt[to] += g.vwgt[v];
+        ++nmoves;
+      }
+    }
+    if (nmoves == 0) break;
+  }
+}
+
+int64_t
+GraphPartition::partition(const Graph& g, int nparts, std::vector<int>& part) const
+{
+  part.assign(g.size(), 0);
+  if (nparts == 1) return 0;
+
+  int64_t total = 0;
+  int64_t max_vwgt = 0;
+  for (int64_t w : g.vwgt){
+    total += w;
+    max_vwgt = std::max(max_vwgt, w);
+  }
+  int64_t avg = (total + nparts - 1) / nparts;
+  int64_t max_pwgt = std::max<int64_t>(imbalance_ * avg, avg + max_vwgt);
+
+  //fixed seed so that every rank computes the same partition
+  std::mt19937 rng(42);
+
+  std::vector<Graph> levels(1, g);
+  std::vector<std::vector<int>> cmaps;
+  int coarsest_size = coarsen_vertices_per_part * nparts;
+  int64_t max_coarse_vwgt = std::max<int64_t>(max_vwgt, 3*total/(2*coarsest_size));
+  while (levels.back().size() > coarsest_size){
+    Graph coarse;
+    std::vector<int> cmap;
+    coarsen(levels.back(), coarse, cmap, max_coarse_vwgt, rng);
+    bool stalled = coarse.size() > 0.95 * levels.back().size();
+    levels.push_back(std::move(coarse));
+    cmaps.push_back(std::move(cmap));
+    if (stalled) break;
+  }
+
+  std::vector<int> coarse_part;
+  initialPartition(levels.back(), nparts, max_pwgt, coarse_part, rng);
+  for (int level=cmaps.size() - 1; level >= 0; --level){
+    const std::vector<int>& cmap = cmaps[level];
+    std::vector<int> fine_part(cmap.size());
+    for (size_t v=0; v < cmap.size(); ++v){
+      fine_part[v] = coarse_part[cmap[v]];
+    }
+    refine(levels[level], nparts, max_pwgt, fine_part, rng);
+    coarse_part = std::move(fine_part);
+  }
+  part = std::move(coarse_part);
+  return edgeCut(g, part);
+}
+
+void
+GraphPartition::ensureThreadsPerRank(const Graph& g, std::vector<int>& rank_part) const
+{
+  std::vector<int> nswitches(nproc_, 0);
+  for (int p : rank_part) nswitches[p]++;
+  for (int rank=0; rank < nproc_; ++rank){
+    while (nswitches[rank] < nthread_){
+      //take the switch most connected to this rank from a rank that can spare one
+      int best = -1;
+      int64_t best_conn = -1;
+      for (int v=0; v < g.size(); ++v){
+        if (nswitches[rank_part[v]] <= nthread_) continue;
+        int64_t conn = 0;
+        for (int e=g.xadj[v]; e < g.xadj[v+1]; ++e){
+          if (rank_part[g.adjncy[e]] == rank) conn += g.adjwgt[e];
+        }
+        if (conn > best_conn){
+          best = v;
+          best_conn = conn;
+        }
+      }
+      nswitches[rank_part[best]]--;
+      nswitches[rank]++;
+      rank_part[best] = rank;
+    }
+  }
+}
+
+void
+GraphPartition::partitionSwitches()
+{
+  int nworkers = nproc_ * nthread_;
+  if (num_switches_total_ < nworkers){
+    spkt_abort_printf("graph partition cannot split %d switches across %d ranks x %d threads",
+                      num_switches_total_, nproc_, nthread_);
+  }
+
+  Graph g;
+  buildGraph(g);
+
+  std::vector<int> rank_part;
+  int64_t rank_cut = partition(g, nproc_, rank_part);
+  part_debug("graph partition of %d switches across %d ranks cuts %ld",
+             num_switches_total_, nproc_, rank_cut);
+  ensureThreadsPerRank(g, rank_part);
+
+  for (int rank=0; rank < nproc_; ++rank){
+    std::vector<int> vertices;
+    int64_t rank_wgt = 0;
+    for (int v=0; v < g.size(); ++v){
+      if (rank_part[v] == rank){
+        vertices.push_back(v);
+        rank_wgt += g.vwgt[v];
+      }
+    }
+    Graph sub;
+    subgraph(g, vertices, sub);
+    std::vector<int> thread_part;
+    int64_t thread_cut = partition(sub, nthread_, thread_part);
+    part_debug("rank %d has %d switches with weight %ld, thread partition cuts %ld",
+               rank, int(vertices.size()), rank_wgt, thread_cut);
+    for (size_t i=0; i < vertices.size(); ++i){
+      switch_to_lpid_[vertices[i]] = rank;
+      switch_to_thread_[vertices[i]] = thread_part[i];
+    }
+  }
+
+  if (print_summary_ && me_ == 0){
+    printSummary(g);
+  }
+}
+
+void
+GraphPartition::printSummary(const Graph& g) const
+{
+  int nworkers = nproc_ * nthread_;
+  std::vector<int> worker(g.size());
+  std::vector<int> nswitches(nworkers, 0);
+  std::vector<int64_t> wgt(nworkers, 0);
+  int64_t total = 0;
+  for (int v=0; v < g.size(); ++v){
+    worker[v] = switch_to_lpid_[v] * nthread_ + switch_to_thread_[v];
+    nswitches[worker[v]]++;
+    wgt[worker[v]] += g.vwgt[v];
+    total += g.vwgt[v];
+  }
+  int64_t max_wgt = *std::max_element(wgt.begin(), wgt.end());
+  std::cout << sprockit::sprintf("Graph partition of %d switches into %d parts cuts %ld links, "
+                                 "imbalance %4.2f\n",
+                                 g.size(), nworkers, edgeCut(g, worker),
+                                 double(max_wgt) * nworkers / total);
+  for (int w=0; w < nworkers; ++w){
+    std::cout << sprockit::sprintf("  rank %d thread %d: %d switches, weight %ld\n",
+                                   w / nthread_, w % nthread_, nswitches[w], wgt[w]);
+  }
+}
+
+ProfilePartition::ProfilePartition(SST::Params& params, ParallelRuntime* rt) :
+  GraphPartition(params, rt)
+{
+  auto filename = params.find<std::string>("partition_profile");
+  std::ifstream in(filename);
+  if (!in.is_open()){
+    spkt_abort_printf("could not open partition_profile %s", filename.c_str());
+  }
+
+  switch_events_.resize(num_switches_total_, 0);
+  std::string line;
+  while (std::getline(in, line)){
+    if (line.empty() || line[0] == '#') continue;
+    std::stringstream sstr(line);
+    std::string type;
+    sstr >> type;
+    if (type == "switches"){
+      int nswitches = -1;
+      sstr >> nswitches;
+      if (nswitches != num_switches_total_){
+        spkt_abort_printf("partition_profile %s is for %d switches, but topology has %d",
+                          filename.c_str(), nswitches, num_switches_total_);
+      }
+    } else if (type == "switch"){
+      int sid = -1;
+      int64_t count = -1;
+      sstr >> sid >> count;
+      if (sid < 0 || sid >= num_switches_total_ || count < 0){
+        spkt_abort_printf("invalid line '%s' in partition_profile %s", line.c_str(), filename.c_str());
+      }
+      switch_events_[sid] = count;
+    } else if (type == "link"){
+      int src = -1, dst = -1;
+      int64_t count = -1;
+      sstr >> src >> dst >> count;
+      if (src < 0 || dst < 0 || src >= num_switches_total_ || dst >= num_switches_total_ || count < 0){
+        spkt_abort_printf("invalid line '%s' in partition_profile %s", line.c_str(), filename.c_str());
+      }
+      link_events_[std::make_pair(std::min(src,dst), std::max(src,dst))] += count;
+    } else {
+      spkt_abort_printf("invalid line '%s' in partition_profile %s", line.c_str(), filename.c_str());
+    }
+  }
+}
+
+ProfilePartition::~ProfilePartition()
+{
+}
+
+void
+ProfilePartition::switchWeights(std::vector<int64_t>& weights)
+{
+  //keep the estimate so that switches idle in the profile still carry some weight
+  GraphPartition::switchWeights(weights);
+  for (int i=0; i < num_switches_total_; ++i){
+    weights[i] += switch_events_[i];
+  }
+}
+
+int64_t
+ProfilePartition::linkWeight(int src, int dst, int num_links)
+{
+  auto iter = link_events_.find(std::make_pair(src, dst));
+  return iter == link_events_.end() ? num_links : num_links + iter->second;
+}
+
+}
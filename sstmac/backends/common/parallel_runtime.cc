@@ -237,6 +237,7 @@ ParallelRuntime::initPartitionParams(SSTMAC_MAYBE_UNUSED SST::Params&  params)
   }
   auto type = params.find<std::string>("partition", deflt);
   part_ = sprockit::create<Partition>("macro", type, params, this);
+  part_->finalizeInit(params);
 #endif
 }
 
@@ -323,7 +324,8 @@ ParallelRuntime::runSerialize(serializer& ser, IpcEvent* iev)
   ser & iev->ev;
 }
 
-void ParallelRuntime::sendEvent(IpcEvent* iev)
+void
+ParallelRuntime::sizeEvent(IpcEvent* iev)
 {
   //somehow this doesn't return the sum of sizes
   //uint32_t overhead = sizeof(ipc_event_base);
@@ -341,8 +343,12 @@ void ParallelRuntime::sendEvent(IpcEvent* iev)
   ser & iev->ev;
   iev->ser_size = overhead + ser.size();
   align64(iev->ser_size);
-  CommBuffer& buff = send_buffers_[iev->rank];
-  char* ptr = buff.allocateSpace(iev->ser_size, iev);
+}
+
+void
+ParallelRuntime::packEvent(IpcEvent* iev, char* ptr)
+{
+  sprockit::serializer ser;
   ser.start_packing(ptr, iev->ser_size);
   debug_printf(sprockit::dbg::parallel,
      "sending event of size %lu to LP %d at t=%10.6e on link=%" PRIu64 " on epoch %d: %s",
@@ -357,7 +363,15 @@ void ParallelRuntime::sendEvent(IpcEvent* iev)
   runSerialize(test_ser, &test_ev);
   iev->ev->validate_serialization(test_ev.ev);
 #endif
+}
 
+void
+ParallelRuntime::sendEvent(IpcEvent* iev)
+{
+  sizeEvent(iev);
+  CommBuffer& buff = send_buffers_[iev->rank];
+  char* ptr = buff.allocateSpace(iev->ser_size, iev);
+  packEvent(iev, ptr);
 }
 #endif
 
@@ -165,9 +165,20 @@ class ParallelRuntime :
   };
 
 #if !SSTMAC_INTEGRATED_SST_CORE
-  void sendEvent(IpcEvent* iev);
+  virtual void sendEvent(IpcEvent* iev);
 
   static void runSerialize(serializer& ser, IpcEvent* iev);
+
+  /**
+   * @brief sizeEvent Compute and set the serialized size of an event, including its header
+   */
+  static void sizeEvent(IpcEvent* iev);
+
+  /**
+   * @brief packEvent Serialize an event whose size has already been set by sizeEvent
+   * @param ptr Buffer with at least iev->ser_size bytes
+   */
+  void packEvent(IpcEvent* iev, char* ptr);
 #endif
 
   static const int global_root;
@@ -232,7 +243,17 @@ class ParallelRuntime :
     return vote;
   }
 
-  void resetSendRecv();
+  /**
+   * @brief sendRecvMessages Exchange pending events with a separate time bound for each LP
+   * @param votes For each LP, the earliest time at which this LP could send it an event
+   * @param global_vote In: the earliest time on this LP. Out: the earliest time across all LPs
+   * @return The minimum across all LPs of their votes for this LP
+   */
+  virtual Timestamp sendRecvMessages(const std::vector<Timestamp>& votes, Timestamp& global_vote){
+    return votes[me_];
+  }
+
+  virtual void resetSendRecv();
 
   int me() const {
     return me_;
@@ -254,11 +275,11 @@ class ParallelRuntime :
     return part_;
   }
 
-  int numRecvsDone() const {
+  virtual int numRecvsDone() const {
     return numRecvsDone_;
   }
 
-  const CommBuffer& recvBuffer(int idx) const {
+  virtual const CommBuffer& recvBuffer(int idx) const {
     return recv_buffers_[idx];
   }
 
@@ -56,6 +56,10 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/sst_core/integrated_component.h>
 
 #include <vector>
+#include <string>
+#include <map>
+#include <random>
+#include <cstdint>
 
 DeclareDebugSlot(partition);
 
@@ -212,6 +216,140 @@ class OccupiedBlockPartition :
 
 };
 
+/**
+ * Multilevel k-way partition of the switch graph.
+ * Switches are weighted by an estimate of the events they generate
+ * (attached nodes, nodes occupied by the jobs, optional per-switch weights)
+ * and links between switches are the edges. The graph is coarsened by heavy-edge
+ * matching, partitioned greedily, and refined while it is projected back so
+ * that parts are balanced and the fewest links cross between parts.
+ * Switches are first split across MPI ranks, then each rank's switches across its threads.
+ */
+class GraphPartition :
+  public BlockPartition
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    Partition,
+    GraphPartition,
+    "macro",
+    "graph",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "balanced partition of the switch graph minimizing cut links")
+
+  GraphPartition(SST::Params& params, ParallelRuntime* rt);
+
+  ~GraphPartition() override;
+
+  void partitionSwitches() override;
+
+ protected:
+  /** A weighted undirected graph in compressed sparse row format */
+  struct Graph {
+    std::vector<int> xadj;
+    std::vector<int> adjncy;
+    std::vector<int64_t> adjwgt;
+    std::vector<int64_t> vwgt;
+
+    int size() const {
+      return vwgt.size();
+    }
+  };
+
+  /**
+   * @brief switchWeights Estimate the work done by each switch
+   * @param weights [out] A weight for each switch
+   */
+  virtual void switchWeights(std::vector<int64_t>& weights);
+
+  /**
+   * @brief linkWeight
+   * @return The weight of cutting the links between two switches
+   */
+  virtual int64_t linkWeight(int src, int dst, int num_links){
+    return num_links;
+  }
+
+  /**
+   * @brief partition Split a graph into balanced parts
+   * @param g     The graph
+   * @param nparts The number of parts
+   * @param part  [out] The part of each vertex
+   * @return The total weight of edges cut
+   */
+  int64_t partition(const Graph& g, int nparts, std::vector<int>& part) const;
+
+  double imbalance_;
+
+  int64_t switch_weight_;
+
+  int64_t node_weight_;
+
+  int64_t occupied_weight_;
+
+  /** The number of nodes allocated to jobs on each switch */
+  std::vector<int> occupied_nodes_;
+
+  std::string weights_file_;
+
+  bool print_summary_;
+
+ private:
+  void buildGraph(Graph& g);
+
+  void printSummary(const Graph& g) const;
+
+  void computeOccupiedNodes(SST::Params& params);
+
+  void coarsen(const Graph& fine, Graph& coarse, std::vector<int>& cmap,
+               int64_t max_vwgt, std::mt19937& rng) const;
+
+  int64_t initialPartition(const Graph& g, int nparts, int64_t max_pwgt,
+                           std::vector<int>& part, std::mt19937& rng) const;
+
+  void refine(const Graph& g, int nparts, int64_t max_pwgt,
+              std::vector<int>& part, std::mt19937& rng) const;
+
+  void ensureThreadsPerRank(const Graph& g, std::vector<int>& rank_part) const;
+
+  static int64_t edgeCut(const Graph& g, const std::vector<int>& part);
+
+  static void subgraph(const Graph& g, const std::vector<int>& vertices, Graph& sub);
+
+};
+
+/**
+ * Graph partition weighted by the events each switch and link executed in a previous run,
+ * as written by event_profile_file.
+ */
+class ProfilePartition :
+  public GraphPartition
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    Partition,
+    ProfilePartition,
+    "macro",
+    "profile",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "graph partition weighted by an event profile from a previous run")
+
+  ProfilePartition(SST::Params& params, ParallelRuntime* rt);
+
+  ~ProfilePartition() override;
+
+ protected:
+  void switchWeights(std::vector<int64_t>& weights) override;
+
+  int64_t linkWeight(int src, int dst, int num_links) override;
+
+ private:
+  std::vector<int64_t> switch_events_;
+
+  std::map<std::pair<int,int>,int64_t> link_events_;
+
+};
+
 }
 
 #endif 
@@ -63,6 +63,7 @@ MpiRuntime::voteReduceFunction(void *invec, void *inoutvec, int *len, MPI_Dataty
   int length = *len;
   for (int i=0; i < length; ++i){
     out[i].time_vote = std::min(out[i].time_vote, in[i].time_vote);
+    out[i].global_vote = std::min(out[i].global_vote, in[i].global_vote);
     out[i].max_bytes = std::max(out[i].max_bytes, in[i].max_bytes);
     out[i].num_sent += in[i].num_sent;
   }
@@ -188,8 +189,22 @@ MpiRuntime::initRuntimeParams(SST::Params& params)
 
 MpiRuntime::MpiRuntime(SST::Params& params) :
   ParallelRuntime(params,
-  initRank(params),
-  initSize(params))
+  initRank(MPI_THREAD_SINGLE),
+  initSize(MPI_THREAD_SINGLE))
+{
+  initVote();
+}
+
+MpiRuntime::MpiRuntime(SST::Params& params, int thread_level) :
+  ParallelRuntime(params,
+  initRank(thread_level),
+  initSize(thread_level))
+{
+  initVote();
+}
+
+void
+MpiRuntime::initVote()
 {
   epoch_ = 0;
   int rc = MPI_Op_create(&voteReduceFunction, 1, &vote_op_);
@@ -197,7 +212,7 @@ MpiRuntime::MpiRuntime(SST::Params& params) :
     sprockit::abort("failed making vote MPI op");
   }
 
-  rc = MPI_Type_contiguous(3, MPI_LONG_LONG_INT, &vote_type_);
+  rc = MPI_Type_contiguous(4, MPI_LONG_LONG_INT, &vote_type_);
   if (rc != MPI_SUCCESS){
     sprockit::abort("failed making vote MPI datatype");
   }
@@ -205,36 +220,40 @@ MpiRuntime::MpiRuntime(SST::Params& params) :
   MPI_Type_commit(&vote_type_);
 }
 
-int
-MpiRuntime::initSize(SST::Params& params)
+void
+MpiRuntime::initMpi(int thread_level)
 {
   int inited;
   MPI_Initialized(&inited);
   if (!inited){
     int argc = 1;
     char** argv = nullptr;
-    int rc = MPI_Init(&argc, &argv);
+    int provided;
+    int rc = MPI_Init_thread(&argc, &argv, thread_level, &provided);
     if (rc != MPI_SUCCESS){
       spkt_abort_printf("mpi_runtime::init_rank: could not MPI_Init");
     }
   }
+  int provided;
+  MPI_Query_thread(&provided);
+  if (provided < thread_level){
+    spkt_abort_printf("mpi_runtime: MPI provides thread level %d, but %d is required",
+                      provided, thread_level);
+  }
+}
+
+int
+MpiRuntime::initSize(int thread_level)
+{
+  initMpi(thread_level);
   MPI_Comm_size(MPI_COMM_WORLD, &nproc_);
   return nproc_;
 }
 
 int
-MpiRuntime::initRank(SST::Params& params)
+MpiRuntime::initRank(int thread_level)
 {
-  int inited;
-  MPI_Initialized(&inited);
-  if (!inited){
-    int argc = 1;
-    char** argv = nullptr;
-    int rc = MPI_Init(&argc, &argv);
-    if (rc != MPI_SUCCESS){
-      spkt_abort_printf("mpi_runtime::init_rank: could not MPI_Init");
-    }
-  }
+  initMpi(thread_level);
   MPI_Comm_rank(MPI_COMM_WORLD, &me_);
   return me_;
 }
@@ -253,6 +272,29 @@ MpiRuntime::bcast(void *buffer, int bytes, int root)
 
 Timestamp
 MpiRuntime::sendRecvMessages(Timestamp vote)
+{
+  for (int i=0; i < nproc_; ++i){
+    votes_[i].time_vote = vote.time.ticks();
+    votes_[i].global_vote = vote.time.ticks();
+  }
+  send_recv_vote incoming = exchangeMessages();
+  return Timestamp(0, incoming.time_vote);
+}
+
+Timestamp
+MpiRuntime::sendRecvMessages(const std::vector<Timestamp>& votes, Timestamp& global_vote)
+{
+  for (int i=0; i < nproc_; ++i){
+    votes_[i].time_vote = votes[i].time.ticks();
+    votes_[i].global_vote = global_vote.time.ticks();
+  }
+  send_recv_vote incoming = exchangeMessages();
+  global_vote = Timestamp(0, incoming.global_vote);
+  return Timestamp(0, incoming.time_vote);
+}
+
+MpiRuntime::send_recv_vote
+MpiRuntime::exchangeMessages()
 {
   //okay - it's possible that we have pending events
   //that aren't serialized yet because we overran the buffers
@@ -278,7 +320,6 @@ MpiRuntime::sendRecvMessages(Timestamp vote)
     } else {
       votes_[i].num_sent = 0;
     }
-    votes_[i].time_vote = vote.time.ticks();
     //wait to fill this in until we know the size of all pending messages
     votes_[i].max_bytes = commSize;
   }
@@ -314,7 +355,7 @@ MpiRuntime::sendRecvMessages(Timestamp vote)
 
   std::swap(payload_tag, next_payload_tag);
   ++epoch_;
-  return Timestamp(0, incoming.time_vote);
+  return incoming;
 }
 
 void
@@ -99,22 +99,40 @@ class MpiRuntime :
 
   Timestamp sendRecvMessages(Timestamp vote) override;
 
+  Timestamp sendRecvMessages(const std::vector<Timestamp>& votes, Timestamp& global_vote) override;
+
  protected:
+  /**
+   * @param thread_level The MPI thread support required if MPI is not yet initialized
+   */
+  MpiRuntime(SST::Params& params, int thread_level);
+
   void doReduce(void* data, int nelems, MPI_Datatype ty, MPI_Op op, int root);
 
   void finalize() override;
 
  private:
-  int initRank(SST::Params& params);
-  int initSize(SST::Params& params);
+  static void initMpi(int thread_level);
+  int initRank(int thread_level);
+  int initSize(int thread_level);
 
- private:
+  void initVote();
+
+ protected:
   struct send_recv_vote {
     uint64_t time_vote;
+    uint64_t global_vote;
     uint64_t num_sent;
     uint64_t max_bytes;
   };
 
+  /**
+   * Send all pending buffers and receive incoming buffers.
+   * The time votes in votes_ must be filled in before calling.
+   * @return The reduced vote for this LP
+   */
+  send_recv_vote exchangeMessages();
+
   std::vector<MPI_Request> requests_;
   std::vector<MPI_Status> statuses_;
   std::vector<send_recv_vote> votes_;
@@ -0,0 +1,399 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/backends/mpi/overlap_mpi_runtime.h>
+#include <sstmac/common/sst_event.h>
+#include <sstmac/common/event_manager.h>
+#include <sprockit/keyword_registration.h>
+#include <sprockit/errors.h>
+#include <sched.h>
+#include <cinttypes>
+#include <cstring>
+
+RegisterKeywords(
+{ "overlap_chunk_size", "the number of bytes of events packed for one rank before the communication thread sends them" },
+);
+
+#define overlap_debug(...) \
+  debug_printf(sprockit::dbg::parallel, "LP %d: %s", me_, sprockit::sprintf(__VA_ARGS__).c_str())
+
+namespace sstmac {
+namespace mpi {
+
+OverlapMpiRuntime::OverlapMpiRuntime(SST::Params& params) :
+  //the main thread may run collectives while the communication thread polls
+  MpiRuntime(params, MPI_THREAD_MULTIPLE),
+  chunk_size_(0),
+  comm_thread_running_(false),
+  state_(idle),
+  exchange_done_(false),
+  num_recvd_(0),
+  recv_parity_(0),
+  comm_parity_(0),
+  num_chunks_sent_(0),
+  num_chunks_overlapped_(0)
+{
+  tags_[0] = 44;
+  tags_[1] = 45;
+  pthread_mutex_init(&comm_lock_, nullptr);
+  pthread_cond_init(&comm_cond_, nullptr);
+}
+
+OverlapMpiRuntime::~OverlapMpiRuntime()
+{
+  if (comm_thread_running_) stopCommThread();
+  for (OpenChunk& open : open_chunks_){
+    if (open.chunk) delete open.chunk;
+  }
+  for (SendChunk* chunk : ship_queue_) delete chunk;
+  for (SendChunk* chunk : free_chunks_) delete chunk;
+  pthread_mutex_destroy(&comm_lock_);
+  pthread_cond_destroy(&comm_cond_);
+}
+
+void
+OverlapMpiRuntime::initRuntimeParams(SST::Params& params)
+{
+  MpiRuntime::initRuntimeParams(params);
+  chunk_size_ = params.find<SST::UnitAlgebra>("overlap_chunk_size", "64KB").getRoundedValue();
+  open_chunks_.resize(nproc_);
+  chunks_sent_.resize(nproc_, 0);
+  if (nproc_ > 1) startCommThread();
+}
+
+void
+OverlapMpiRuntime::startCommThread()
+{
+  int rc = pthread_create(&comm_thread_, nullptr, runCommThread, this);
+  if (rc != 0){
+    spkt_abort_printf("overlap_mpi_runtime: failed creating communication thread: %s", ::strerror(rc));
+  }
+  comm_thread_running_ = true;
+}
+
+void
+OverlapMpiRuntime::stopCommThread()
+{
+  pthread_mutex_lock(&comm_lock_);
+  state_ = terminate;
+  pthread_cond_signal(&comm_cond_);
+  pthread_mutex_unlock(&comm_lock_);
+  pthread_join(comm_thread_, nullptr);
+  comm_thread_running_ = false;
+}
+
+void*
+OverlapMpiRuntime::runCommThread(void* args)
+{
+  OverlapMpiRuntime* rt = (OverlapMpiRuntime*) args;
+  rt->commLoop();
+  return nullptr;
+}
+
+void
+OverlapMpiRuntime::commLoop()
+{
+  while (1){
+    pthread_mutex_lock(&comm_lock_);
+    while (state_ == idle){
+      pthread_cond_wait(&comm_cond_, &comm_lock_);
+    }
+    comm_state_t state = state_;
+    pthread_mutex_unlock(&comm_lock_);
+
+    if (state == terminate) break;
+
+    bool busy = progress(state == active);
+    if (state == exchange){
+      exchangeVotes();
+    } else if (!busy){
+      sched_yield();
+    }
+  }
+
+  for (SendChunk* chunk : in_flight_){
+    MPI_Wait(&chunk->req, MPI_STATUS_IGNORE);
+    delete chunk;
+  }
+  in_flight_.clear();
+}
+
+bool
+OverlapMpiRuntime::progress(bool overlapped)
+{
+  bool busy = false;
+
+  std::vector<SendChunk*> to_ship;
+  pthread_mutex_lock(&comm_lock_);
+  to_ship.swap(ship_queue_);
+  pthread_mutex_unlock(&comm_lock_);
+
+  for (SendChunk* chunk : to_ship){
+    overlap_debug("sending chunk of %lu bytes to LP %d on epoch %d",
+                  chunk->size, chunk->dst, epoch_);
+    MPI_Isend(chunk->data.data(), chunk->size, MPI_BYTE, chunk->dst,
+              tags_[comm_parity_], MPI_COMM_WORLD, &chunk->req);
+    chunks_sent_[chunk->dst]++;
+    in_flight_.push_back(chunk);
+    ++num_chunks_sent_;
+    if (overlapped) ++num_chunks_overlapped_;
+    busy = true;
+  }
+
+  while (receiveChunk(false)){
+    busy = true;
+  }
+
+  int num_in_flight = 0;
+  for (SendChunk* chunk : in_flight_){
+    int done;
+    MPI_Test(&chunk->req, &done, MPI_STATUS_IGNORE);
+    if (done){
+      pthread_mutex_lock(&comm_lock_);
+      free_chunks_.push_back(chunk);
+      pthread_mutex_unlock(&comm_lock_);
+    } else {
+      in_flight_[num_in_flight++] = chunk;
+    }
+  }
+  in_flight_.resize(num_in_flight);
+
+  return busy;
+}
+
+bool
+OverlapMpiRuntime::receiveChunk(bool blocking)
+{
+  MPI_Status stat;
+  int flag = 1;
+  if (blocking){
+    MPI_Probe(MPI_ANY_SOURCE, tags_[comm_parity_], MPI_COMM_WORLD, &stat);
+  } else {
+    MPI_Iprobe(MPI_ANY_SOURCE, tags_[comm_parity_], MPI_COMM_WORLD, &flag, &stat);
+  }
+  if (!flag) return false;
+
+  int count;
+  MPI_Get_count(&stat, MPI_BYTE, &count);
+  RecvSet& set = recv_sets_[comm_parity_];
+  if (set.num_done == int(set.chunks.size())){
+    set.chunks.emplace_back();
+    set.chunks.back().realloc(chunk_size_);
+  }
+  CommBuffer& buf = set.chunks[set.num_done];
+  buf.ensureSpace(count);
+  MPI_Recv(buf.buffer(), count, MPI_BYTE, stat.MPI_SOURCE, stat.MPI_TAG,
+           MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+  buf.shift(count);
+  overlap_debug("received chunk of %d bytes from LP %d on epoch %d",
+                count, stat.MPI_SOURCE, epoch_);
+  ++set.num_done;
+  ++num_recvd_;
+  return true;
+}
+
+void
+OverlapMpiRuntime::exchangeVotes()
+{
+  for (int i=0; i < nproc_; ++i){
+    votes_[i].num_sent = chunks_sent_[i];
+    votes_[i].max_bytes = 0;
+    chunks_sent_[i] = 0;
+  }
+
+  send_recv_vote incoming;
+  MPI_Reduce_scatter_block(votes_.data(), &incoming, 1, vote_type_, vote_op_, MPI_COMM_WORLD);
+  overlap_debug("expecting %" PRIu64 " chunks on epoch %d, already have %d",
+                incoming.num_sent, epoch_, num_recvd_);
+  while (num_recvd_ < int(incoming.num_sent)){
+    receiveChunk(true);
+  }
+  num_recvd_ = 0;
+
+  pthread_mutex_lock(&comm_lock_);
+  result_ = incoming;
+  recv_parity_ = comm_parity_;
+  comm_parity_ = 1 - comm_parity_;
+  //nothing more will be sent once no LP has events left
+  bool finished = incoming.global_vote == EventManager::no_events_left_time.time.ticks();
+  state_ = finished ? idle : active;
+  exchange_done_ = true;
+  pthread_cond_signal(&comm_cond_);
+  pthread_mutex_unlock(&comm_lock_);
+}
+
+OverlapMpiRuntime::SendChunk*
+OverlapMpiRuntime::newChunk(int dst, size_t size)
+{
+  SendChunk* chunk = nullptr;
+  pthread_mutex_lock(&comm_lock_);
+  if (!free_chunks_.empty()){
+    chunk = free_chunks_.back();
+    free_chunks_.pop_back();
+  }
+  pthread_mutex_unlock(&comm_lock_);
+
+  if (!chunk) chunk = new SendChunk;
+  size_t capacity = std::max(chunk_size_, size);
+  if (chunk->data.size() < capacity){
+    chunk->data.resize(capacity);
+  }
+  chunk->dst = dst;
+  chunk->size = 0;
+  return chunk;
+}
+
+void
+OverlapMpiRuntime::shipChunk(SendChunk* chunk)
+{
+  pthread_mutex_lock(&comm_lock_);
+  ship_queue_.push_back(chunk);
+  if (state_ == idle){
+    state_ = active;
+    pthread_cond_signal(&comm_cond_);
+  }
+  pthread_mutex_unlock(&comm_lock_);
+}
+
+void
+OverlapMpiRuntime::sendEvent(IpcEvent* iev)
+{
+  sizeEvent(iev);
+  OpenChunk& open = open_chunks_[iev->rank];
+  open.lock();
+  if (open.chunk && open.chunk->size + iev->ser_size > open.chunk->data.size()){
+    shipChunk(open.chunk);
+    open.chunk = nullptr;
+  }
+  if (!open.chunk){
+    open.chunk = newChunk(iev->rank, iev->ser_size);
+  }
+  packEvent(iev, open.chunk->data.data() + open.chunk->size);
+  open.chunk->size += iev->ser_size;
+  if (open.chunk->size >= chunk_size_){
+    shipChunk(open.chunk);
+    open.chunk = nullptr;
+  }
+  open.unlock();
+}
+
+void
+OverlapMpiRuntime::flushChunks()
+{
+  for (OpenChunk& open : open_chunks_){
+    if (open.chunk){
+      shipChunk(open.chunk);
+      open.chunk = nullptr;
+    }
+  }
+}
+
+OverlapMpiRuntime::send_recv_vote
+OverlapMpiRuntime::requestExchange()
+{
+  //all simulation threads are done with the epoch, nothing else can be packed
+  flushChunks();
+
+  pthread_mutex_lock(&comm_lock_);
+  state_ = exchange;
+  exchange_done_ = false;
+  pthread_cond_signal(&comm_cond_);
+  while (!exchange_done_){
+    pthread_cond_wait(&comm_cond_, &comm_lock_);
+  }
+  send_recv_vote incoming = result_;
+  pthread_mutex_unlock(&comm_lock_);
+
+  ++epoch_;
+  return incoming;
+}
+
+Timestamp
+OverlapMpiRuntime::sendRecvMessages(Timestamp vote)
+{
+  for (int i=0; i < nproc_; ++i){
+    votes_[i].time_vote = vote.time.ticks();
+    votes_[i].global_vote = vote.time.ticks();
+  }
+  send_recv_vote incoming = requestExchange();
+  return Timestamp(0, incoming.time_vote);
+}
+
+Timestamp
+OverlapMpiRuntime::sendRecvMessages(const std::vector<Timestamp>& votes, Timestamp& global_vote)
+{
+  for (int i=0; i < nproc_; ++i){
+    votes_[i].time_vote = votes[i].time.ticks();
+    votes_[i].global_vote = global_vote.time.ticks();
+  }
+  send_recv_vote incoming = requestExchange();
+  global_vote = Timestamp(0, incoming.global_vote);
+  return Timestamp(0, incoming.time_vote);
+}
+
+void
+OverlapMpiRuntime::resetSendRecv()
+{
+  RecvSet& set = recv_sets_[recv_parity_];
+  for (int i=0; i < set.num_done; ++i){
+    set.chunks[i].reset();
+  }
+  set.num_done = 0;
+}
+
+void
+OverlapMpiRuntime::finalize()
+{
+  if (comm_thread_running_) stopCommThread();
+  uint64_t counts[2] = { num_chunks_sent_, num_chunks_overlapped_ };
+  globalSum(counts, 2, 0);
+  if (me_ == 0 && counts[0]){
+    printf("Overlapped %" PRIu64 " of %" PRIu64 " event chunk sends with event execution\n",
+           counts[1], counts[0]);
+  }
+  MpiRuntime::finalize();
+}
+
+}
+}
@@ -0,0 +1,195 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef OVERLAP_MPI_RUNTIME_H
+#define OVERLAP_MPI_RUNTIME_H
+
+#include <sstmac/backends/mpi/mpi_runtime.h>
+#include <pthread.h>
+#include <deque>
+
+namespace sstmac {
+namespace mpi {
+
+/**
+ * MPI runtime in which a dedicated communication thread ships serialized events
+ * to other ranks while the event managers are still executing the epoch.
+ * Events for each destination are packed into chunks. A full chunk is handed to the
+ * communication thread immediately, which sends it and concurrently receives chunks from other ranks.
+ * The end-of-epoch step then only flushes partially filled chunks,
+ * votes on the minimum time and the number of chunks sent to each rank,
+ * and waits for whatever chunks are still in flight.
+ */
+class OverlapMpiRuntime :
+  public MpiRuntime
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    ParallelRuntime,
+    OverlapMpiRuntime,
+    "macro",
+    "mpi_overlap",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "provides a parallel MPI runtime that overlaps sending events with executing them")
+
+  OverlapMpiRuntime(SST::Params& params);
+
+  ~OverlapMpiRuntime() override;
+
+  void initRuntimeParams(SST::Params& params) override;
+
+  void sendEvent(IpcEvent* iev) override;
+
+  Timestamp sendRecvMessages(Timestamp vote) override;
+
+  Timestamp sendRecvMessages(const std::vector<Timestamp>& votes, Timestamp& global_vote) override;
+
+  int numRecvsDone() const override {
+    return recv_sets_[recv_parity_].num_done;
+  }
+
+  const CommBuffer& recvBuffer(int idx) const override {
+    return recv_sets_[recv_parity_].chunks[idx];
+  }
+
+  void resetSendRecv() override;
+
+ protected:
+  void finalize() override;
+
+ private:
+  struct SendChunk {
+    int dst;
+    size_t size;
+    std::vector<char> data;
+    MPI_Request req;
+  };
+
+  /** The chunk currently being filled for one destination */
+  struct OpenChunk : public Lockable {
+    OpenChunk() : chunk(nullptr) {}
+    SendChunk* chunk;
+  };
+
+  /** Chunks received for one epoch, kept in a deque so that receiving never moves a buffer */
+  struct RecvSet {
+    RecvSet() : num_done(0) {}
+    std::deque<CommBuffer> chunks;
+    int num_done;
+  };
+
+  enum comm_state_t {
+    idle,      //not allowed to call MPI
+    active,    //sending and receiving chunks
+    exchange,  //the main thread is waiting for the end-of-epoch vote
+    terminate
+  };
+
+  static void* runCommThread(void* args);
+
+  void commLoop();
+
+  /**
+   * @brief progress Send queued chunks, receive arrived chunks, and recycle completed sends
+   * @param overlapped Whether the simulation threads are still executing the epoch
+   * @return Whether anything happened
+   */
+  bool progress(bool overlapped);
+
+  bool receiveChunk(bool blocking);
+
+  /**
+   * @brief exchangeVotes Run on the communication thread at the end of an epoch
+   */
+  void exchangeVotes();
+
+  send_recv_vote requestExchange();
+
+  void shipChunk(SendChunk* chunk);
+
+  void flushChunks();
+
+  SendChunk* newChunk(int dst, size_t size);
+
+  void startCommThread();
+
+  void stopCommThread();
+
+  size_t chunk_size_;
+
+  std::vector<OpenChunk> open_chunks_;
+
+  pthread_t comm_thread_;
+  bool comm_thread_running_;
+
+  /** Protects everything below, shared between the simulation threads and the communication thread */
+  pthread_mutex_t comm_lock_;
+  pthread_cond_t comm_cond_;
+  comm_state_t state_;
+  bool exchange_done_;
+  send_recv_vote result_;
+  std::vector<SendChunk*> ship_queue_;
+  std::vector<SendChunk*> free_chunks_;
+
+  /** Only touched by the communication thread */
+  std::vector<SendChunk*> in_flight_;
+  std::vector<uint64_t> chunks_sent_;
+  int num_recvd_;
+  int tags_[2];
+
+  /** Alternate between epochs so the next epoch can receive while the last is being scheduled */
+  RecvSet recv_sets_[2];
+  int recv_parity_;
+  int comm_parity_;
+
+  uint64_t num_chunks_sent_;
+  /** Chunks sent while the epoch was still executing rather than at the exchange */
+  uint64_t num_chunks_overlapped_;
+
+};
+
+}
+}
+
+#endif // OVERLAP_MPI_RUNTIME_H
@@ -0,0 +1,219 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <sstmac/common/sstmac_config.h>
+#if !SSTMAC_INTEGRATED_SST_CORE
+#include <sstmac/backends/native/channel_event_container.h>
+#include <sstmac/hardware/interconnect/interconnect.h>
+#include <sprockit/util.h>
+#include <limits>
+#include <cinttypes>
+
+#define event_debug(...) \
+  debug_printf(sprockit::dbg::parallel, "manager %d:%d %s", \
+    rt_->me(), thread_id_, sprockit::sprintf(__VA_ARGS__).c_str())
+
+namespace sstmac {
+namespace native {
+
+constexpr uint64_t ChannelEventMap::unreachable;
+
+ChannelEventMap::ChannelEventMap(SST::Params& params, ParallelRuntime* rt) :
+  ClockCycleEventMap(params, rt)
+{
+  if (nthread_ > 1){
+    sprockit::abort("channel_parallel event manager only supports one thread per rank");
+  }
+  min_send_times_.resize(nproc_, no_events_left_time);
+  votes_.resize(nproc_);
+}
+
+void
+ChannelEventMap::ipcSchedule(IpcEvent* iev)
+{
+  Timestamp& t = min_send_times_[iev->rank];
+  t = std::min(t, iev->t);
+  EventManager::ipcSchedule(iev);
+}
+
+void
+ChannelEventMap::initChannels()
+{
+  std::vector<uint64_t> my_lookaheads(nproc_, 0);
+  auto& latencies = EventLink::minRankLatencies();
+  for (int i=0; i < int(latencies.size()); ++i){
+    my_lookaheads[i] = latencies[i].ticks();
+  }
+  lookaheads_.resize(nproc_*nproc_);
+  rt_->allgather(my_lookaheads.data(), nproc_*sizeof(uint64_t), lookaheads_.data());
+
+  //an event can reach an LP through intermediate LPs, or come back to the LP that caused it,
+  //so the bound on each channel is the shortest path, with the shortest cycle on the diagonal
+  distances_.resize(nproc_*nproc_, unreachable);
+  for (int i=0; i < int(lookaheads_.size()); ++i){
+    if (lookaheads_[i]) distances_[i] = lookaheads_[i];
+  }
+  for (int mid=0; mid < nproc_; ++mid){
+    for (int src=0; src < nproc_; ++src){
+      uint64_t to_mid = distances_[src*nproc_ + mid];
+      if (to_mid == unreachable) continue;
+      for (int dst=0; dst < nproc_; ++dst){
+        uint64_t from_mid = distances_[mid*nproc_ + dst];
+        if (from_mid == unreachable) continue;
+        uint64_t& dist = distances_[src*nproc_ + dst];
+        dist = std::min(dist, to_mid + from_mid);
+      }
+    }
+  }
+
+  if (rt_->me() == 0){
+    uint64_t min_lookahead = std::numeric_limits<uint64_t>::max();
+    uint64_t max_lookahead = 0;
+    int num_channels = 0;
+    for (uint64_t la : lookaheads_){
+      if (la){
+        min_lookahead = std::min(min_lookahead, la);
+        max_lookahead = std::max(max_lookahead, la);
+        ++num_channels;
+      }
+    }
+    if (num_channels){
+      printf("Running parallel simulation on %d channels with lookahead %10.6fus-%10.6fus\n",
+             num_channels, TimeDelta(min_lookahead, TimeDelta::exact).usec(),
+             TimeDelta(max_lookahead, TimeDelta::exact).usec());
+    } else {
+      printf("Running parallel simulation with no channels between LPs\n");
+    }
+  }
+}
+
+Timestamp
+ChannelEventMap::channelHorizon(Timestamp local_min, Timestamp& global_min)
+{
+  //an LP can only cause events on other LPs after executing its own events
+  //or the events currently in flight to it - both bound what each LP can receive
+  for (int dst=0; dst < nproc_; ++dst){
+    votes_[dst] = no_events_left_time;
+    if (hasPath(me_, dst) && local_min != no_events_left_time){
+      votes_[dst] = local_min + distance(me_, dst);
+    }
+  }
+
+  global_min = local_min;
+  for (int mid=0; mid < nproc_; ++mid){
+    Timestamp sent = min_send_times_[mid];
+    if (sent == no_events_left_time) continue;
+
+    global_min = std::min(global_min, sent);
+    for (int dst=0; dst < nproc_; ++dst){
+      if (hasPath(mid, dst)){
+        votes_[dst] = std::min(votes_[dst], sent + distance(mid, dst));
+      }
+    }
+    min_send_times_[mid] = no_events_left_time;
+  }
+
+  event_debug("voting for minimum time %10.6e on epoch %d", global_min.sec(), epoch());
+  Timestamp horizon = rt_->sendRecvMessages(votes_, global_min);
+  event_debug("got back horizon %10.6e and minimum time %10.6e",
+              horizon.sec(), global_min.sec());
+
+  scheduleIncomingBuffers();
+
+  //an LP with no incoming channels gets no bound and can run all its events,
+  //but must keep participating until the global minimum shows all LPs are done
+  return horizon;
+}
+
+void
+ChannelEventMap::dropEvents()
+{
+  registerPending();
+  while (!event_queue_->empty()){
+    ExecutionEvent* ev = event_queue_->top();
+    event_queue_->pop();
+    delete ev;
+  }
+}
+
+void
+ChannelEventMap::run()
+{
+  interconn_->setup();
+
+  if (nproc_ == 1){
+    EventManager::run();
+    return;
+  }
+
+  initChannels();
+
+  registerPending();
+  Timestamp global_min;
+  Timestamp horizon = channelHorizon(minEventTime(), global_min);
+  uint64_t epoch = 0;
+  while (global_min != no_events_left_time){
+    if (stopped_){
+      //every LP stops at the same time, but must keep voting until the events
+      //other LPs sent before stopping have been received - these all fall after the stop
+      dropEvents();
+      horizon = channelHorizon(no_events_left_time, global_min);
+    } else {
+      event_debug("running to horizon %10.6e", horizon.sec());
+      runEvents(horizon);
+      horizon = channelHorizon(minEventTime(), global_min);
+    }
+    ++epoch;
+  }
+  dropEvents();
+  computeFinalTime(now_);
+  if (rt_->me() == 0) printf("Ran %" PRIu64 " epochs on MPI parallel with channel lookahead\n", epoch);
+}
+
+}
+}
+
+#endif // !SSTMAC_INTEGRATED_SST_CORE
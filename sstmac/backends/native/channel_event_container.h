@@ -0,0 +1,138 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef CHANNEL_EVENT_CONTAINER_H
+#define CHANNEL_EVENT_CONTAINER_H
+
+#include <sstmac/common/sstmac_config.h>
+#if !SSTMAC_INTEGRATED_SST_CORE
+
+#include <sstmac/backends/native/clock_cycle_event_container.h>
+#include <limits>
+
+namespace sstmac {
+namespace native {
+
+/**
+ * Conservative parallel event manager that tracks lookahead separately
+ * for each pair of logical processes (LPs) instead of using one global
+ * lookahead window. The lookahead on each channel is the minimum latency
+ * of the IPC links actually created between the two ranks by the interconnect.
+ * At each synchronization every LP sends each other LP a bound on the
+ * earliest event it could cause there through any chain of channels, accounting
+ * for both its own pending events and the events it has in flight to third
+ * parties. LPs connected only through long-latency links therefore run far
+ * ahead of their neighbors.
+ */
+class ChannelEventMap :
+  public ClockCycleEventMap
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    EventManager,
+    ChannelEventMap,
+    "macro",
+    "channel_parallel",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "Implements a parallel event queue with a separate lookahead on each channel between LPs")
+
+  ChannelEventMap(SST::Params& params, ParallelRuntime* rt);
+
+  ~ChannelEventMap() throw() override {}
+
+  void ipcSchedule(IpcEvent* iev) override;
+
+ private:
+  void run() override;
+
+  /**
+   * @brief initChannels
+   * Exchange the link latencies between all pairs of LPs
+   */
+  void initChannels();
+
+  /**
+   * @brief channelHorizon
+   * @param local_min The earliest pending event on this LP
+   * @param global_min [out] The earliest pending or in-flight event on any LP
+   * @return The time up to which this LP can safely run
+   */
+  Timestamp channelHorizon(Timestamp local_min, Timestamp& global_min);
+
+  /**
+   * @brief dropEvents
+   * Discard events received after this LP stopped early
+   */
+  void dropEvents();
+
+  bool hasPath(int src, int dst) const {
+    return distances_[src*nproc_ + dst] != unreachable;
+  }
+
+  TimeDelta distance(int src, int dst) const {
+    return TimeDelta(distances_[src*nproc_ + dst], TimeDelta::exact);
+  }
+
+  static constexpr uint64_t unreachable = std::numeric_limits<uint64_t>::max();
+
+  /** Flattened nproc x nproc matrix, zero if no channel */
+  std::vector<uint64_t> lookaheads_;
+
+  /** Flattened nproc x nproc matrix of the shortest path between LPs through any channels,
+   *  the diagonal holds the shortest path back to the same LP */
+  std::vector<uint64_t> distances_;
+
+  /** The earliest event sent to each LP in the current epoch */
+  std::vector<Timestamp> min_send_times_;
+
+  std::vector<Timestamp> votes_;
+
+};
+
+}
+}
+
+#endif // !SSTMAC_INTEGRATED_SST_CORE
+
+#endif // CHANNEL_EVENT_CONTAINER_H
@@ -128,6 +128,13 @@ ClockCycleEventMap::receiveIncomingEvents(Timestamp vote)
 
   event_debug("got back minimum time %10.6e", min_time.sec());
 
+  scheduleIncomingBuffers();
+  return min_time;
+}
+
+void
+ClockCycleEventMap::scheduleIncomingBuffers()
+{
   int num_recvs = rt_->numRecvsDone();
   for (int i=0; i < num_recvs; ++i){
     auto& buf = rt_->recvBuffer(i);
@@ -140,7 +147,6 @@ ClockCycleEventMap::receiveIncomingEvents(Timestamp vote)
     }
   }
   rt_->resetSendRecv();
-  return min_time;
 }
 
 
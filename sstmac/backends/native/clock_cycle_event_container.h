@@ -51,6 +51,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/common/event_manager.h>
 #include <sstmac/hardware/interconnect/interconnect_fwd.h>
 #include <sstmac/backends/common/parallel_runtime.h>
+#include <chrono>
 
 DeclareDebugSlot(EventManager_time_vote);
 
@@ -64,9 +65,15 @@ enum class vote_type_t {
 
 static inline uint64_t rdtsc(void)
 {
+#if defined(__x86_64__) || defined(__i386__)
   uint32_t hi, lo;
   __asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
   return uint64_t( (uint64_t)lo | (uint64_t)hi<<32);
+#else
+  //no cycle counter - fall back to nanoseconds
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
 }
 
 class ClockCycleEventMap :
@@ -95,13 +102,19 @@ class ClockCycleEventMap :
 
   void computeFinalTime(Timestamp vote);
 
+  /**
+   * @brief scheduleIncomingBuffers
+   * Unpack and schedule all events received in the last exchange
+   */
+  void scheduleIncomingBuffers();
+
+  virtual int handleIncoming(char* buf);
+
   int num_profile_loops_;
 
  private:
   void run() override;
 
-  int handleIncoming(char* buf);
-
 
   
 
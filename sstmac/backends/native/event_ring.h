@@ -0,0 +1,128 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_BACKENDS_NATIVE_EVENT_RING_H
+#define SSTMAC_BACKENDS_NATIVE_EVENT_RING_H
+
+#include <sstmac/common/sst_event_fwd.h>
+#include <atomic>
+#include <cstdint>
+
+namespace sstmac {
+namespace native {
+
+/**
+ * Bounded, lock-free single-producer single-consumer ring of events
+ * sent from one thread to another. The producer only writes tail_
+ * and the consumer only writes head_, padded onto separate cache lines,
+ * so a push or a drain touches one shared variable at most once.
+ */
+class EventRing
+{
+ public:
+  /**
+   * @param capacity Rounded up to a power of two
+   */
+  explicit EventRing(uint32_t capacity) :
+    head_(0), tail_(0), cached_head_(0)
+  {
+    uint32_t size = 1;
+    while (size < capacity) size *= 2;
+    mask_ = size - 1;
+    slots_ = new ExecutionEvent*[size];
+  }
+
+  ~EventRing(){
+    delete[] slots_;
+  }
+
+  EventRing(const EventRing&) = delete;
+  EventRing& operator=(const EventRing&) = delete;
+
+  /**
+   * @brief push Called only by the producing thread
+   * @return Whether there was space, the caller must hold on to the event if not
+   */
+  bool push(ExecutionEvent* ev){
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ > mask_){
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ > mask_) return false;
+    }
+    slots_[tail & mask_] = ev;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief drain Called only by the consuming thread. Everything pushed before the call
+   *        is handed to fxn and the space is released in one batch at the end.
+   * @return The number of events drained
+   */
+  template <class Fxn>
+  uint32_t drain(Fxn&& fxn){
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    for (uint64_t i=head; i < tail; ++i){
+      fxn(slots_[i & mask_]);
+    }
+    head_.store(tail, std::memory_order_release);
+    return tail - head;
+  }
+
+ private:
+  std::atomic<uint64_t> head_;
+  char head_pad_[64 - sizeof(std::atomic<uint64_t>)];
+  std::atomic<uint64_t> tail_;
+  /** The producer's last view of head_, avoids reading the consumer's line on every push */
+  uint64_t cached_head_;
+  uint64_t mask_;
+  ExecutionEvent** slots_;
+
+};
+
+}
+}
+
+#endif
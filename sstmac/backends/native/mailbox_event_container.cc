@@ -0,0 +1,395 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/common/sstmac_config.h>
+#if !SSTMAC_INTEGRATED_SST_CORE
+#define __STDC_FORMAT_MACROS
+#include <sstmac/backends/native/mailbox_event_container.h>
+#include <sstmac/hardware/interconnect/interconnect.h>
+#include <sprockit/keyword_registration.h>
+#include <sprockit/errors.h>
+#include <cinttypes>
+#include <climits>
+#include <cstring>
+#include <limits>
+#include <sched.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+RegisterKeywords(
+ { "mailbox_size", "the number of events each thread can send another thread in an epoch before falling back to a vector" },
+ { "barrier_spin_count", "the number of backoff rounds a thread spins in the barrier before sleeping" },
+);
+
+static int barrier_spin_count = 1000;
+static const int max_backoff = 64;
+static int epoch_print_interval = 10000;
+
+static const int64_t terminate_sentinel = std::numeric_limits<int64_t>::max();
+
+namespace sstmac {
+namespace native {
+
+static inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __asm__ __volatile__("pause");
+#else
+  __asm__ __volatile__("");
+#endif
+}
+
+/**
+ * @brief wait_for_change Block until word no longer has the value old
+ */
+static void
+wait_for_change(std::atomic<uint32_t>& word, uint32_t old, std::atomic<uint32_t>& waiters)
+{
+  int backoff = 1;
+  for (int i=0; i < barrier_spin_count; ++i){
+    if (word.load(std::memory_order_acquire) != old) return;
+    for (int p=0; p < backoff; ++p) cpu_relax();
+    if (backoff < max_backoff) backoff *= 2;
+  }
+
+  waiters.fetch_add(1);
+  while (word.load() == old){
+#ifdef __linux__
+    //returns immediately if word has already changed
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, old, nullptr, nullptr, 0);
+#else
+    sched_yield();
+#endif
+  }
+  waiters.fetch_sub(1);
+}
+
+static void
+signal_change(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiters)
+{
+  word.fetch_add(1);
+#ifdef __linux__
+  if (waiters.load()){
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+  }
+#endif
+}
+
+static void
+release_children(MailboxThread* t, int64_t delta_t)
+{
+  if (t->child1){
+    t->child1->delta_t = delta_t;
+    signal_change(t->child1->go, t->child1->go_waiters);
+  }
+  if (t->child2){
+    t->child2->delta_t = delta_t;
+    signal_change(t->child2->go, t->child2->go_waiters);
+  }
+}
+
+static void
+wait_on_children(MailboxThread* t, uint32_t epoch, Timestamp& min_time)
+{
+  if (t->child1){
+    wait_for_change(t->child1->done, epoch, t->child1->done_waiters);
+    min_time = std::min(min_time, t->child1->min_time);
+  }
+  if (t->child2){
+    wait_for_change(t->child2->done, epoch, t->child2->done_waiters);
+    min_time = std::min(min_time, t->child2->min_time);
+  }
+}
+
+static void
+run_mailbox_worker(void* args)
+{
+  MailboxThread* t = (MailboxThread*) args;
+  Timestamp horizon;
+  uint32_t epoch = 0;
+  uint64_t t_wait = rdtsc();
+  debug_printf(sprockit::dbg::parallel, "spun up mailbox subthread");
+  while (1){
+    wait_for_change(t->go, epoch, t->go_waiters);
+    int64_t delta_t = t->delta_t;
+    release_children(t, delta_t);
+    if (delta_t == terminate_sentinel){
+      return;
+    }
+
+    uint64_t t_start = rdtsc();
+    if (delta_t != 0){
+      horizon += TimeDelta(delta_t, TimeDelta::exact);
+      t->min_time = t->mgr->runEvents(horizon);
+    }
+    uint64_t t_run = rdtsc();
+    wait_on_children(t, epoch, t->min_time);
+    signal_change(t->done, t->done_waiters);
+
+    t->event_cycles += t_run - t_start;
+    t->barrier_cycles += t_start - t_wait;
+    t_wait = t_run;
+    ++t->epochs;
+    ++epoch;
+  }
+}
+
+static void*
+spin_up_mailbox_worker(void* args)
+{
+  MailboxThread* t = (MailboxThread*) args;
+  t->mgr->spinUp(run_mailbox_worker, t);
+  return 0;
+}
+
+MailboxEventContainer::MailboxEventContainer(SST::Params& params, ParallelRuntime* rt) :
+  ClockCycleEventMap(params, rt)
+{
+  me_ = rt_->me();
+  nproc_ = rt_->nproc();
+  if (params.contains("cpu_affinity")) {
+    params.find_array("cpu_affinity", cpu_affinity_);
+  }
+  barrier_spin_count = params.find<int>("barrier_spin_count", barrier_spin_count);
+  epoch_print_interval = params.find<int>("epoch_print_interval", epoch_print_interval);
+  int mailbox_size = params.find<int>("mailbox_size", 1024);
+  if (mailbox_size <= 0){
+    spkt_abort_printf("mailbox_size=%d must be positive", mailbox_size);
+  }
+
+  num_subthreads_ = rt->nthread() - 1;
+  pthreads_.resize(num_subthreads_);
+  pthread_attrs_.resize(num_subthreads_);
+  thread_managers_.resize(num_subthreads_);
+  for (int i=0; i < num_subthreads_; ++i){
+    thread_managers_[i] = new EventManager(params, rt);
+    thread_managers_[i]->setThread(i);
+    int status = pthread_attr_init(&pthread_attrs_[i]);
+    if (status != 0){
+      sprockit::abort("mailbox_event_container: failed creating pthread attributes");
+    }
+  }
+  setThread(num_subthreads_);
+
+  int nthr = num_subthreads_ + 1;
+  threads_ = new MailboxThread[nthr];
+  threads_[0].mgr = this;
+  for (int i=1; i < nthr; ++i){
+    threads_[i].mgr = thread_managers_[i-1];
+  }
+  for (int i=0; i < nthr; ++i){
+    int c1 = 2*i + 1;
+    int c2 = 2*i + 2;
+    if (c1 < nthr) threads_[i].child1 = &threads_[c1];
+    if (c2 < nthr) threads_[i].child2 = &threads_[c2];
+  }
+
+  for (int dst=0; dst < nthr; ++dst){
+    for (int src=0; src < nthr; ++src){
+      if (src == dst) continue;
+      EventRing* ring = new EventRing(mailbox_size);
+      rings_.push_back(ring);
+      threadManager(dst)->setInbox(src, ring);
+    }
+  }
+}
+
+MailboxEventContainer::~MailboxEventContainer() throw ()
+{
+  for (EventRing* ring : rings_) delete ring;
+  delete[] threads_;
+}
+
+void
+MailboxEventContainer::scheduleStop(Timestamp until)
+{
+  for (EventManager* mgr : thread_managers_){
+    mgr->scheduleStop(until);
+  }
+  EventManager::scheduleStop(until);
+}
+
+void
+MailboxEventContainer::runWork()
+{
+  MailboxThread* root = &threads_[0];
+  Timestamp last_horizon;
+  Timestamp lower_bound;
+  uint32_t epoch = 0;
+  int num_loops_left = num_profile_loops_;
+  if (num_loops_left && rt_->me() == 0){
+    printf("Running %d profile loops\n", num_loops_left);
+    fflush(stdout);
+  }
+  if (lookahead_.ticks() == 0){
+    sprockit::abort("Zero-latency link - no lookahead, cannot run in parallel");
+  }
+  if (rt_->me() == 0){
+    printf("Running parallel simulation with lookahead %10.6fus\n", lookahead_.usec());
+  }
+
+  while (lower_bound != no_events_left_time || num_loops_left > 0){
+    Timestamp horizon = lower_bound + lookahead_;
+    int64_t delta_t = (horizon - last_horizon).ticks();
+    if (num_loops_left != 0){
+      if (delta_t == 0){
+        delta_t = 1;
+      }
+    } else if (horizon == last_horizon){
+      spkt_abort_printf("Time did not advance - caught in infinite time loop");
+    }
+
+    release_children(root, delta_t);
+    uint64_t t_start = rdtsc();
+    Timestamp min_time = runEvents(horizon);
+    uint64_t t_run = rdtsc();
+    wait_on_children(root, epoch, min_time);
+
+    if (stopped_){
+      lower_bound = no_events_left_time; //done
+    } else {
+      lower_bound = receiveIncomingEvents(min_time);
+    }
+    if (num_loops_left > 0) --num_loops_left;
+    last_horizon = horizon;
+    uint64_t t_stop = rdtsc();
+    root->event_cycles += t_run - t_start;
+    root->barrier_cycles += t_stop - t_run;
+    ++root->epochs;
+    if (epoch % epoch_print_interval == 0 && rt_->me() == 0){
+      debug_printf(sprockit::dbg::parallel,
+           "Epoch %-10" PRIu32 " ran until horizon %" PRIu64 ":%" PRIu64 " - new bound = %" PRIu64 ":%" PRIu64 "\n",
+           epoch, horizon.epochs, horizon.time.ticks(), lower_bound.epochs, lower_bound.time.ticks());
+    }
+    ++epoch;
+  }
+
+  release_children(root, terminate_sentinel);
+
+  if (rt_->me() == 0) printf("Ran %" PRIu32 " epochs in mailbox multithreading run\n", epoch);
+}
+
+void
+MailboxEventContainer::printThreadCycles()
+{
+  if (rt_->me() != 0) return;
+
+  int nthr = num_subthreads_ + 1;
+  for (int i=0; i < nthr; ++i){
+    MailboxThread& t = threads_[i];
+    uint64_t total = t.event_cycles + t.barrier_cycles;
+    double barrier_percent = total ? 100.0 * t.barrier_cycles / total : 0;
+    printf("Thread %3d: %13" PRIu64 " event cycles %13" PRIu64 " barrier cycles (%5.1f%% barrier)\n",
+           t.mgr->thread(), t.event_cycles, t.barrier_cycles, barrier_percent);
+  }
+  fflush(stdout);
+}
+
+void
+MailboxEventContainer::run()
+{
+  interconn_->setup();
+
+  for (EventManager* mgr : thread_managers_){
+    mgr->setInterconnect(interconn_);
+  }
+
+  finalizeStatsInit();
+
+#if SSTMAC_USE_CPU_AFFINITY
+  if (!cpu_affinity_.size()) {
+    sprockit::abort("cpu_affinity array is required with cpu affinity enabled");
+  }
+  int task_affinity = cpu_affinity_[me_ % cpu_affinity_.size()];
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(task_affinity, &cpuset);
+  sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
+#endif
+
+  //the main thread does the work of node zero
+  for (int i=0; i < num_subthreads_; ++i){
+    int status;
+#if SSTMAC_USE_CPU_AFFINITY
+    cpu_set_t thread_cpuset;
+    CPU_ZERO(&thread_cpuset);
+    CPU_SET(task_affinity + i + 1, &thread_cpuset);
+    status = pthread_attr_setaffinity_np(&pthread_attrs_[i], sizeof(cpu_set_t), &thread_cpuset);
+    if (status != 0){
+      sprockit::abort("mailbox_event_container::run: failed setting pthread affinity");
+    }
+#endif
+    status = pthread_create(&pthreads_[i], &pthread_attrs_[i], spin_up_mailbox_worker, &threads_[i+1]);
+    if (status != 0){
+      spkt_abort_printf("mailbox_event_container::run: failed creating pthread=%d:\n%s",
+                        status, ::strerror(status));
+    }
+  }
+
+  runWork();
+
+  Timestamp final_time = now_;
+  for (int i=0; i < num_subthreads_; ++i){
+    void* ignore;
+    int status = pthread_join(pthreads_[i], &ignore);
+    if (status != 0){
+      sprockit::abort("mailbox_event_container::run: failed joining pthread");
+    }
+    final_time = std::max(final_time, thread_managers_[i]->now());
+  }
+
+  printThreadCycles();
+  computeFinalTime(final_time);
+
+  //the statistics of every thread are output together
+  finalizeStatsOutput();
+}
+
+}
+}
+
+#endif // !SSTMAC_INTEGRATED_SST_CORE
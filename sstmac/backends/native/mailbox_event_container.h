@@ -0,0 +1,157 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef MAILBOX_EVENT_CONTAINER_H
+#define MAILBOX_EVENT_CONTAINER_H
+
+#include <sstmac/common/sstmac_config.h>
+#if !SSTMAC_INTEGRATED_SST_CORE
+
+#include <sstmac/backends/native/clock_cycle_event_container.h>
+#include <sstmac/backends/native/event_ring.h>
+#include <pthread.h>
+#include <atomic>
+
+namespace sstmac {
+namespace native {
+
+/**
+ * A node in the barrier tree, one per thread.
+ * The parent bumps go to start an epoch, the thread bumps done
+ * once it and all of its children have finished the epoch.
+ */
+struct MailboxThread
+{
+  MailboxThread() :
+    go(0), go_waiters(0), delta_t(0),
+    done(0), done_waiters(0),
+    mgr(nullptr), child1(nullptr), child2(nullptr),
+    epochs(0), event_cycles(0), barrier_cycles(0)
+  {
+  }
+
+  std::atomic<uint32_t> go;
+  std::atomic<uint32_t> go_waiters;
+  int64_t delta_t;
+  char go_pad[48];
+
+  std::atomic<uint32_t> done;
+  std::atomic<uint32_t> done_waiters;
+  Timestamp min_time;
+  char done_pad[64 - sizeof(Timestamp) % 64];
+
+  EventManager* mgr;
+  MailboxThread* child1;
+  MailboxThread* child2;
+  uint64_t epochs;
+  uint64_t event_cycles;
+  uint64_t barrier_cycles;
+
+};
+
+/**
+ * Thread-parallel event manager in which every pair of threads exchanges events
+ * through a bounded lock-free ring. The rings are drained in one batch at the start of each epoch.
+ * Threads synchronize on a binary tree barrier that spins with exponential backoff
+ * for a while and then sleeps on a futex, so idle threads do not compete
+ * for cores with the threads still executing events.
+ */
+class MailboxEventContainer :
+  public ClockCycleEventMap
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    EventManager,
+    MailboxEventContainer,
+    "macro",
+    "multithread_mailbox",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "Implements a thread-parallel event queue with lock-free mailboxes and a futex tree barrier")
+
+  MailboxEventContainer(SST::Params& params, ParallelRuntime* rt);
+
+  ~MailboxEventContainer() throw () override;
+
+  void run() override;
+
+  void scheduleStop(Timestamp until) override;
+
+  EventManager* threadManager(int thr) const override {
+    if (thr == num_subthreads_) {
+      return const_cast<MailboxEventContainer*>(this);
+    } else {
+      return thread_managers_[thr];
+    }
+  }
+
+ private:
+  void runWork();
+
+  /**
+   * @brief printThreadCycles
+   * Report the cycles each thread spent executing events and waiting in the barrier
+   */
+  void printThreadCycles();
+
+  int num_subthreads_;
+
+  std::vector<EventManager*> thread_managers_;
+
+  /** The main thread is node zero, the children of node i are 2i+1 and 2i+2 */
+  MailboxThread* threads_;
+
+  std::vector<EventRing*> rings_;
+
+  std::vector<int> cpu_affinity_;
+  std::vector<pthread_t> pthreads_;
+  std::vector<pthread_attr_t> pthread_attrs_;
+
+};
+
+}
+}
+
+#endif // !SSTMAC_INTEGRATED_SST_CORE
+
+#endif // MAILBOX_EVENT_CONTAINER_H
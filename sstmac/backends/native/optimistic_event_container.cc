@@ -0,0 +1,380 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <sstmac/common/sstmac_config.h>
+#if !SSTMAC_INTEGRATED_SST_CORE
+#include <sstmac/backends/native/optimistic_event_container.h>
+#include <sstmac/common/handler_event_queue_entry.h>
+#include <sstmac/common/event_queue.h>
+#include <sstmac/hardware/interconnect/interconnect.h>
+#include <sprockit/keyword_registration.h>
+#include <sprockit/util.h>
+#include <cinttypes>
+
+#define event_debug(...) \
+  debug_printf(sprockit::dbg::parallel, "manager %d:%d %s", \
+    rt_->me(), thread_id_, sprockit::sprintf(__VA_ARGS__).c_str())
+
+RegisterKeywords(
+  { "optimistic_window", "how far past the global virtual time LPs may execute optimistically" },
+  { "optimistic_rollback_check", "force a rollback after this many optimistic events to validate rollback support" },
+);
+
+namespace sstmac {
+namespace native {
+
+/**
+ * Sent in place of an event that was sent by a rolled back event.
+ * The IPC header carries the link and seqnum of the event to cancel.
+ */
+class AntiMessage : public Event
+{
+  ImplementSerializable(AntiMessage)
+ public:
+  void serialize_order(serializer&) override {}
+};
+
+OptimisticEventMap::OptimisticEventMap(SST::Params& params, ParallelRuntime* rt) :
+  ClockCycleEventMap(params, rt),
+  current_(nullptr),
+  num_optimistic_(0),
+  num_undone_(0),
+  num_rollbacks_(0),
+  num_anti_messages_(0)
+{
+  if (nthread_ > 1){
+    sprockit::abort("optimistic_parallel event manager only supports one thread per rank");
+  }
+  if (params.contains("optimistic_window")){
+    window_ = TimeDelta(params.find<SST::UnitAlgebra>("optimistic_window").getValue().toDouble());
+  }
+  check_interval_ = params.find<int>("optimistic_rollback_check", 0);
+  min_ipc_time_ = no_events_left_time;
+}
+
+OptimisticEventMap::~OptimisticEventMap() throw()
+{
+  commit(no_events_left_time);
+}
+
+void
+OptimisticEventMap::ipcSchedule(IpcEvent* iev)
+{
+  if (current_){
+    current_->sent.push_back(*iev);
+  }
+  EventManager::ipcSchedule(iev);
+}
+
+void
+OptimisticEventMap::forgetRemote(ExecutionEvent* ev)
+{
+  if (remote_events_.empty()) return;
+
+  auto iter = remote_events_.find(RemoteKey(ev->linkId(), ev->seqnum()));
+  if (iter != remote_events_.end() && iter->second == ev){
+    remote_events_.erase(iter);
+  }
+}
+
+void
+OptimisticEventMap::cancel(ExecutionEvent* ev)
+{
+  event_queue_->erase(ev);
+  ev->discard();
+  delete ev;
+}
+
+void
+OptimisticEventMap::commit(Timestamp t)
+{
+  while (!history_.empty() && history_.front().ev->time() < t){
+    ProcessedEvent& rec = history_.front();
+    for (auto& pair : rec.states){
+      delete pair.second;
+    }
+    for (auto& fxn : rec.on_commit){
+      fxn();
+    }
+    forgetRemote(rec.ev);
+    commit_time_ = rec.ev->time();
+    rec.ev->discard();
+    delete rec.ev;
+    history_.pop_front();
+  }
+}
+
+void
+OptimisticEventMap::undo(size_t n)
+{
+  if (n == 0) return;
+
+  for (size_t i=0; i < n; ++i){
+    ProcessedEvent& rec = history_.back();
+    for (auto iter = rec.states.rbegin(); iter != rec.states.rend(); ++iter){
+      iter->first->restoreState(iter->second);
+      delete iter->second;
+    }
+    for (auto iter = rec.scheduled.rbegin(); iter != rec.scheduled.rend(); ++iter){
+      cancel(*iter);
+    }
+    //cannot send while the runtime is still unpacking incoming buffers
+    pending_anti_.insert(pending_anti_.end(), rec.sent.begin(), rec.sent.end());
+    event_queue_->push(rec.ev);
+    history_.pop_back();
+  }
+  now_ = history_.empty() ? commit_time_ : history_.back().ev->time();
+  num_undone_ += n;
+  ++num_rollbacks_;
+}
+
+void
+OptimisticEventMap::rollback(Timestamp t)
+{
+  //events at the same time need not be executed in key order,
+  //so undo everything at time t rather than searching for the key
+  size_t n = 0;
+  for (auto iter = history_.rbegin(); iter != history_.rend() && !(iter->ev->time() < t); ++iter){
+    ++n;
+  }
+  event_debug("rolling back %zu events to t=%10.6e", n, t.sec());
+  undo(n);
+}
+
+void
+OptimisticEventMap::sendAntiMessages()
+{
+  for (IpcEventBase& msg : pending_anti_){
+    AntiMessage anti;
+    IpcEvent iev;
+    static_cast<IpcEventBase&>(iev) = msg;
+    iev.ev = &anti;
+    setMinIpcTime(iev.t);
+    EventManager::ipcSchedule(&iev);
+  }
+  num_anti_messages_ += pending_anti_.size();
+  pending_anti_.clear();
+}
+
+void
+OptimisticEventMap::annihilate(const IpcEvent& iev)
+{
+  auto iter = remote_events_.find(RemoteKey(iev.link, iev.seqnum));
+  if (iter == remote_events_.end()){
+    spkt_abort_printf("LP %d got anti-message for unknown event on link %" PRIu64 " seq=%" PRIu32,
+                      me_, iev.link, iev.seqnum);
+  }
+  if (!history_.empty() && !(history_.back().ev->time() < iev.t)){
+    rollback(iev.t);
+  }
+  cancel(iter->second);
+  remote_events_.erase(iter);
+}
+
+int
+OptimisticEventMap::handleIncoming(char* buf)
+{
+  serializer ser;
+  uint32_t bigSize = 1 << 30;
+  ser.start_unpacking(buf, bigSize); //just pass in a huge number
+  IpcEvent iev;
+  ParallelRuntime::runSerialize(ser, &iev);
+  if (dynamic_cast<AntiMessage*>(iev.ev)){
+    annihilate(iev);
+    delete iev.ev;
+  } else {
+    if (!history_.empty() && !(history_.back().ev->time() < iev.t)){
+      rollback(iev.t);
+    }
+    ExecutionEvent* ev = scheduleIncoming(&iev);
+    remote_events_[RemoteKey(iev.link, iev.seqnum)] = ev;
+  }
+  size_t size = ser.unpacker().size();
+  align64(size);
+  return size;
+}
+
+Timestamp
+OptimisticEventMap::computeGVT()
+{
+  sendAntiMessages();
+  if (nproc_ == 1) return minEventTime();
+
+  Timestamp vote = std::min(minEventTime(), min_ipc_time_);
+  event_debug("voting for minimum time %10.6e on epoch %d", vote.sec(), epoch());
+  Timestamp gvt = rt_->sendRecvMessages(vote);
+  event_debug("got back GVT %10.6e", gvt.sec());
+  min_ipc_time_ = no_events_left_time;
+  scheduleIncomingBuffers();
+  //anti-messages from stragglers just received go out in the next exchange
+  sendAntiMessages();
+  return gvt;
+}
+
+void
+OptimisticEventMap::executeDirect(ExecutionEvent* ev)
+{
+  //an event that cannot be undone commits everything before it
+  commit(no_events_left_time);
+  now_ = ev->time();
+  commit_time_ = now_;
+  forgetRemote(ev);
+  if (profile_) profile_->count(ev->linkId());
+  ev->execute();
+  delete ev;
+}
+
+void
+OptimisticEventMap::executeOptimistic(ExecutionEvent* ev, ExecutionEvent* cpy)
+{
+  now_ = ev->time();
+  history_.emplace_back();
+  ProcessedEvent& rec = history_.back();
+  rec.ev = ev;
+  current_ = &rec;
+  state_log_ = &rec.states;
+  schedule_log_ = &rec.scheduled;
+  commit_log_ = &rec.on_commit;
+  //rolled back events are counted again when they are re-executed
+  if (profile_) profile_->count(cpy->linkId());
+  //the copy is executed and consumed, the original stays pristine
+  cpy->execute();
+  delete cpy;
+  current_ = nullptr;
+  state_log_ = nullptr;
+  schedule_log_ = nullptr;
+  commit_log_ = nullptr;
+  ++num_optimistic_;
+}
+
+void
+OptimisticEventMap::runOptimistic(Timestamp safe, Timestamp limit)
+{
+  while (!event_queue_->empty()){
+    ExecutionEvent* ev = event_queue_->top();
+    Timestamp t = ev->time();
+    if (t >= limit) return;
+
+    ExecutionEvent* cpy = nullptr;
+    //in check mode, speculate even on events that could never be rolled back
+    if (ev->reversible() && (check_interval_ || t >= safe)){
+      cpy = ev->clone();
+    }
+
+    if (cpy){
+      event_queue_->pop();
+      executeOptimistic(ev, cpy);
+      if (check_interval_ && num_optimistic_ % check_interval_ == 0){
+        undo(std::min(history_.size(), size_t(check_interval_ / 2)));
+      }
+    } else if (t < safe){
+      event_queue_->pop();
+      executeDirect(ev);
+      if (stopped_) return;
+    } else {
+      return;
+    }
+  }
+}
+
+void
+OptimisticEventMap::run()
+{
+  interconn_->setup();
+  finalizeStatsInit();
+
+  if (nproc_ > 1 && lookahead_.ticks() == 0){
+    sprockit::abort("Zero-latency link - no lookahaed, cannot run in parallel");
+  }
+  if (window_.ticks() == 0){
+    window_ = lookahead_ * 10.0;
+  }
+  if (rt_->me() == 0 && nproc_ > 1){
+    printf("Running optimistic parallel simulation with lookahead %10.6fus and window %10.6fus\n",
+           lookahead_.usec(), window_.usec());
+  }
+
+  registerPending();
+  Timestamp gvt = computeGVT();
+  uint64_t epoch = 0;
+  while (gvt != no_events_left_time){
+    //with one LP nothing can arrive from the past
+    Timestamp safe = nproc_ == 1 ? no_events_left_time : gvt + lookahead_;
+    Timestamp limit = nproc_ == 1 ? no_events_left_time : std::max(safe, gvt + window_);
+    event_debug("running optimistically to %10.6e with safe horizon %10.6e",
+                limit.sec(), safe.sec());
+    commit(safe);
+    runOptimistic(safe, limit);
+    if (stopped_){
+      if (nproc_ > 1){
+        spkt_abort_printf("optimistic_parallel event manager cannot stop early");
+      }
+      break;
+    }
+    gvt = computeGVT();
+    ++epoch;
+  }
+  commit(no_events_left_time);
+  computeFinalTime(now_);
+  finalizeStatsOutput();
+
+  uint64_t counts[] = { num_optimistic_, num_undone_, num_rollbacks_, num_anti_messages_ };
+  if (nproc_ > 1){
+    rt_->globalSum(counts, 4, 0);
+  }
+  if (rt_->me() == 0){
+    printf("Ran %" PRIu64 " epochs on MPI parallel with optimistic execution\n", epoch);
+    printf("Executed %" PRIu64 " events optimistically, %" PRIu64 " undone in %" PRIu64
+           " rollbacks with %" PRIu64 " anti-messages\n",
+           counts[0], counts[1], counts[2], counts[3]);
+  }
+}
+
+}
+}
+
+#endif // !SSTMAC_INTEGRATED_SST_CORE
@@ -0,0 +1,184 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+
+#ifndef OPTIMISTIC_EVENT_CONTAINER_H
+#define OPTIMISTIC_EVENT_CONTAINER_H
+
+#include <sstmac/common/sstmac_config.h>
+#if !SSTMAC_INTEGRATED_SST_CORE
+
+#include <sstmac/backends/native/clock_cycle_event_container.h>
+#include <sstmac/common/ipc_event.h>
+#include <sstmac/common/rollback.h>
+#include <deque>
+#include <functional>
+#include <map>
+
+namespace sstmac {
+namespace native {
+
+/**
+ * Optimistic (Time Warp) parallel event manager.
+ * Events whose handlers support rollback are executed beyond the
+ * conservative lookahead window. Components save their state before
+ * an event modifies it. When an event arrives in the past of an LP (a straggler),
+ * every event executed after it is undone: saved state is restored,
+ * events scheduled locally are cancelled, and anti-messages cancel
+ * the events sent to other LPs. Events without rollback support
+ * only execute once the global virtual time (GVT) plus lookahead
+ * guarantees no straggler can arrive before them.
+ * Processed events below that bound are committed (fossil collected).
+ */
+class OptimisticEventMap :
+  public ClockCycleEventMap
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    EventManager,
+    OptimisticEventMap,
+    "macro",
+    "optimistic_parallel",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "Implements a parallel event queue with optimistic execution and rollback")
+
+  OptimisticEventMap(SST::Params& params, ParallelRuntime* rt);
+
+  ~OptimisticEventMap() throw() override;
+
+  void ipcSchedule(IpcEvent* iev) override;
+
+ private:
+  /** An event executed optimistically that might still be rolled back */
+  struct ProcessedEvent {
+    /** The original event, never executed itself so it can be scheduled again */
+    ExecutionEvent* ev;
+    /** The state of each component before the event modified it */
+    SavedStateList states;
+    /** The events the event scheduled locally */
+    std::vector<ExecutionEvent*> scheduled;
+    /** The events the event sent to other LPs */
+    std::vector<IpcEventBase> sent;
+    /** Side effects such as statistics, run when the event commits */
+    std::vector<std::function<void()>> on_commit;
+  };
+
+  using RemoteKey = std::pair<uint32_t,uint32_t>;
+
+  void run() override;
+
+  int handleIncoming(char* buf) override;
+
+  /**
+   * @brief computeGVT
+   * Exchange events with all other LPs and agree on the global virtual time
+   * @return The earliest time any LP could still execute or roll back to
+   */
+  Timestamp computeGVT();
+
+  /**
+   * @brief runOptimistic
+   * @param safe Events before this time can never be rolled back
+   * @param limit Do not execute events at or after this time
+   */
+  void runOptimistic(Timestamp safe, Timestamp limit);
+
+  void executeDirect(ExecutionEvent* ev);
+
+  void executeOptimistic(ExecutionEvent* ev, ExecutionEvent* cpy);
+
+  /**
+   * @brief rollback Undo every processed event at or after time t
+   */
+  void rollback(Timestamp t);
+
+  /**
+   * @brief undo Undo the last n processed events
+   */
+  void undo(size_t n);
+
+  /**
+   * @brief commit Fossil collect every processed event before time t
+   */
+  void commit(Timestamp t);
+
+  void cancel(ExecutionEvent* ev);
+
+  void annihilate(const IpcEvent& iev);
+
+  void sendAntiMessages();
+
+  void forgetRemote(ExecutionEvent* ev);
+
+  std::deque<ProcessedEvent> history_;
+
+  /** Uncommitted events received from other LPs, indexed by link and seqnum */
+  std::map<RemoteKey,ExecutionEvent*> remote_events_;
+
+  /** The record of the event currently executing optimistically, if any */
+  ProcessedEvent* current_;
+
+  /** Anti-messages for rolled back sends, held until the next exchange */
+  std::vector<IpcEventBase> pending_anti_;
+
+  /** The time of the last event that can no longer be rolled back */
+  Timestamp commit_time_;
+
+  TimeDelta window_;
+
+  uint64_t check_interval_;
+
+  uint64_t num_optimistic_;
+  uint64_t num_undone_;
+  uint64_t num_rollbacks_;
+  uint64_t num_anti_messages_;
+
+};
+
+}
+}
+
+#endif // !SSTMAC_INTEGRATED_SST_CORE
+
+#endif // OPTIMISTIC_EVENT_CONTAINER_H
@@ -48,9 +48,55 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/common/event_handler.h>
 #include <sstmac/common/sst_event.h>
 #include <sprockit/thread_safe_new.h>
+#include <type_traits>
 
 namespace sstmac {
 
+#if !SSTMAC_INTEGRATED_SST_CORE
+/**
+ * Copies callback arguments when a callback is cloned for optimistic execution.
+ * Events passed by pointer are owned by the callback and are copied,
+ * all other arguments are copied by value.
+ */
+template <class T>
+struct CallbackArg {
+  static T clone(const T& t, bool& /*ok*/){
+    return t;
+  }
+
+  static void discard(T& /*t*/){}
+};
+
+template <class T>
+struct CallbackArg<T*> {
+  static T* clone(T* t, bool& ok){
+    return cloneImpl(t, ok, std::is_base_of<Event,T>());
+  }
+
+  static void discard(T* t){
+    discardImpl(t, std::is_base_of<Event,T>());
+  }
+
+ private:
+  static T* cloneImpl(T* t, bool& ok, std::true_type){
+    if (!t) return nullptr;
+    T* cpy = static_cast<T*>(t->clone());
+    if (!cpy) ok = false;
+    return cpy;
+  }
+
+  static T* cloneImpl(T* t, bool& /*ok*/, std::false_type){
+    return t;
+  }
+
+  static void discardImpl(T* t, std::true_type){
+    if (t) delete t;
+  }
+
+  static void discardImpl(T* /*t*/, std::false_type){}
+};
+#endif
+
 template <class Cls, typename Fxn, class ...Args>
 class MemberFxnCallback :
   public ExecutionEvent,
@@ -71,11 +117,41 @@ class MemberFxnCallback :
   {
   }
 
+#if !SSTMAC_INTEGRATED_SST_CORE
+  ExecutionEvent* clone() const override {
+    return cloneParams(typename gens<sizeof...(Args)>::type());
+  }
+
+  void discard() override {
+    discardParams(typename gens<sizeof...(Args)>::type());
+  }
+#endif
+
  private:
   template <int ...S> void dispatch(seq<S...>){
     (obj_->*fxn_)(std::get<S>(params_)...);
   }
 
+#if !SSTMAC_INTEGRATED_SST_CORE
+  template <int ...S> ExecutionEvent* cloneParams(seq<S...>) const {
+    bool ok = true;
+    auto* cpy = new MemberFxnCallback(obj_, fxn_,
+                    CallbackArg<Args>::clone(std::get<S>(params_), ok)...);
+    if (!ok){
+      cpy->discard();
+      delete cpy;
+      return nullptr;
+    }
+    cloneHeader(cpy);
+    return cpy;
+  }
+
+  template <int ...S> void discardParams(seq<S...>){
+    int dummy[] = { 0, (CallbackArg<Args>::discard(std::get<S>(params_)), 0)... };
+    (void) dummy;
+  }
+#endif
+
   std::tuple<Args...> params_;
   Fxn fxn_;
   Cls* obj_;
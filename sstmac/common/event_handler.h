@@ -68,8 +68,23 @@ class EventHandler : public sprockit::printable
 
   virtual void handle(Event* ev) = 0;
 
+  /**
+   * @return Whether the object handling the events saves its state before modifying it
+   *         so that the events can be executed optimistically and rolled back
+   */
+  bool reversible() const {
+    return reversible_;
+  }
+
+  void setReversible(bool flag = true) {
+    reversible_ = flag;
+  }
+
  protected:
-  EventHandler() {}
+  EventHandler() : reversible_(false) {}
+
+ private:
+  bool reversible_;
 
 };
 
@@ -56,17 +56,26 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sprockit/util.h>
 #include <sprockit/output.h>
 #include <sprockit/thread_safe_new.h>
+#include <sprockit/keyword_registration.h>
 #include <limits>
+#include <set>
 
 #include <cinttypes>
 
 RegisterDebugSlot(event_manager);
 
+RegisterKeywords(
+{ "event_queue", "the data structure used for the queue of pending events" },
+{ "event_profile_file", "file to write the number of events executed on each switch and link to for partition=profile" },
+);
+
 #define prll_debug(...) \
   debug_printf(sprockit::dbg::parallel, "LP %d: %s", rt_->me(), sprockit::sprintf(__VA_ARGS__).c_str())
 
 namespace sstmac {
 
+static const int epochs_per_trim = 1024;
+
 const Timestamp EventManager::no_events_left_time(0, std::numeric_limits<uint64_t>::max());
 
 class StopEvent : public ExecutionEvent
@@ -114,7 +123,13 @@ EventManager::EventManager(SST::Params& params, ParallelRuntime *rt) :
   me_(rt->me()),
   nproc_(rt->nproc()),
   nthread_(rt->nthread()),
-  thread_id_(0)
+  thread_id_(0),
+  state_log_(nullptr),
+  schedule_log_(nullptr),
+  commit_log_(nullptr),
+  profile_(nullptr),
+  profile_top_(nullptr),
+  epochs_since_trim_(0)
 {
   for (int i=0; i < num_pendingSlots; ++i){
     pending_events_[i].resize(nthread_);
@@ -130,6 +145,14 @@ EventManager::EventManager(SST::Params& params, ParallelRuntime *rt) :
 
   sprockit::thread_stack_size<int>() = sw::StackAlloc::stacksize();
 
+  auto queue_type = params.find<std::string>("event_queue", "set");
+  event_queue_ = sprockit::create<EventQueue>("macro", queue_type, params);
+
+  profile_file_ = params.find<std::string>("event_profile_file", "");
+  if (!profile_file_.empty()){
+    profile_ = new EventProfile;
+  }
+
   //make sure there's a good bit of space
   pending_serialization_.reserve(1024);
 }
@@ -137,6 +160,8 @@ EventManager::EventManager(SST::Params& params, ParallelRuntime *rt) :
 EventManager::~EventManager()
 {
   if (des_context_) delete des_context_;
+  delete event_queue_;
+  if (profile_) delete profile_;
   for (auto& pair : stat_groups_){
     StatisticGroup* grp = pair.second;
     for (auto* stat : grp->stats){
@@ -160,10 +185,11 @@ void
 EventManager::stop()
 {
   printf("Shutting down simulation at t=%20.12fs\n", now().sec());
-  for (ExecutionEvent* ev : event_queue_){
+  while (!event_queue_->empty()){
+    ExecutionEvent* ev = event_queue_->top();
+    event_queue_->pop();
     delete ev;
   }
-  event_queue_.clear();
   min_ipc_time_ = no_events_left_time;
   stopped_ = true;
 }
@@ -180,10 +206,9 @@ EventManager::runEvents(Timestamp event_horizon)
   registerPending();
   min_ipc_time_ = no_events_left_time;
   prll_debug("manager %d:%d running to horizon %10.5e with %llu events in queue on epoch %d",
-             me_, thread_id_, event_horizon.sec(), event_queue_.size(), epoch());
-  while (!event_queue_.empty()){
-    auto iter = event_queue_.begin();
-    ExecutionEvent* ev = *iter;
+             me_, thread_id_, event_horizon.sec(), event_queue_->size(), epoch());
+  while (!event_queue_->empty()){
+    ExecutionEvent* ev = event_queue_->top();
     prll_debug("manager %d:%d pulled event %" PRIu32 " from link %" PRIu64 " at t=%10.7e on epoch %d",
                 me_, thread_id_, ev->seqnum(), ev->linkId(), ev->time().sec(), epoch());
 #if SSTMAC_SANITY_CHECK
@@ -198,7 +223,8 @@ EventManager::runEvents(Timestamp event_horizon)
       return ret;
     } else {
       now_ = ev->time();
-      event_queue_.erase(iter);
+      event_queue_->pop();
+      if (profile_) profile_->count(ev->linkId());
       ev->execute();
       delete ev;
     }
@@ -217,6 +243,7 @@ EventManager::setInterconnect(hw::Interconnect* interconn)
 {
   lookahead_ = interconn->lookahead();
   interconn_ = interconn;
+  profile_top_ = interconn->topology();
 }
 
 int
@@ -268,19 +295,33 @@ EventManager::finalizeStatsInit()
 void
 EventManager::finalizeStatsOutput()
 {
-  for (auto& pair : stat_groups_){
-    StatisticGroup* grp = pair.second;
+  //each thread registers statistics with its own manager,
+  //collect the groups with the same name so they are output together
+  std::map<std::string, std::vector<StatisticGroup*>> groups;
+  std::set<EventManager*> visited;
+  for (int i=0; i < nthread_; ++i){
+    EventManager* mgr = threadManager(i);
+    if (!visited.insert(mgr).second) continue;
+    for (auto& pair : mgr->stat_groups_){
+      groups[pair.first].push_back(pair.second);
+    }
+  }
+
+  for (auto& pair : groups){
+    StatisticGroup* grp = pair.second.front();
     grp->output->startOutputGroup(grp);
-    for (auto* stat : grp->stats){
-      grp->output->output(stat, true);
-      //stat->outputStatisticData(grp.output, true/*only ever end of sim*/);
-      //grp.output->stopOutputEntries();
+    for (StatisticGroup* thr_grp : pair.second){
+      for (auto* stat : thr_grp->stats){
+        grp->output->output(stat, true);
+        //stat->outputStatisticData(grp.output, true/*only ever end of sim*/);
+        //grp.output->stopOutputEntries();
+      }
     }
     grp->output->stopOutputGroup();
   }
 }
 
-void
+ExecutionEvent*
 EventManager::scheduleIncoming(IpcEvent* iev)
 {
 #if SSTMAC_SANITY_CHECK
@@ -308,14 +349,15 @@ EventManager::scheduleIncoming(IpcEvent* iev)
   qev->setTime(iev->t);
   qev->setLink(iev->link);
 #if SSTMAC_SANITY_CHECK
-  size_t prev_size = event_queue_.size();
+  size_t prev_size = event_queue_->size();
 #endif
   schedule(qev);
 #if SSTMAC_SANITY_CHECK
-  if (event_queue_.size() == prev_size){
+  if (event_queue_->size() == prev_size){
     spkt_abort_printf("event queue lost event while scheduling! identical events added on link %" PRIu64, iev->link);
   }
 #endif
+  return qev;
 }
 
 void
@@ -341,7 +383,19 @@ EventManager::registerPending()
     pendingVec.clear();
     ++idx;
   }
+
+  for (native::EventRing* ring : inboxes_){
+    if (ring){
+      ring->drain([this](ExecutionEvent* ev){ schedule(ev); });
+    }
+  }
   pendingSlot_ = (pendingSlot_+1) % num_pendingSlots;
+
+  //hand objects freed on other threads back to this thread's pools and drop idle slabs
+  if (++epochs_since_trim_ == epochs_per_trim){
+    sprockit::SlabAllocator::trim();
+    epochs_since_trim_ = 0;
+  }
 }
 
 static int nactive_threads = 0;
@@ -421,7 +475,7 @@ EventManager::scheduleStop(Timestamp until)
   StopEvent* ev = new StopEvent(this);
   ev->setTime(until);
   ev->setSeqnum(0);
-  event_queue_.insert(ev);
+  event_queue_->push(ev);
 }
 
 Partition*
@@ -434,6 +488,16 @@ EventManager::topologyPartition() const
 void
 EventManager::finishStats()
 {
+  if (profile_){
+    std::vector<EventProfile*> profiles(nthread_);
+    for (int i=0; i < nthread_; ++i){
+      profiles[i] = threadManager(i)->profile();
+    }
+    EventProfile::write(profile_file_, profiles, profile_top_, rt_);
+  }
+  if (sprockit::Debug::slotActive(sprockit::dbg::allocator)){
+    sprockit::SlabAllocator::printStats(std::cout);
+  }
 }
 
 void 
@@ -443,14 +507,15 @@ EventManager::schedule(ExecutionEvent* ev){
     spkt_abort_printf("Time went backwards on manager %d:%d to t=%10.6e for link=%" PRIu64 " seq=%" PRIu32,
                       me_, thread_id_, ev->time().sec(), ev->linkId(), ev->seqnum());
   }
-  size_t prev_size = event_queue_.size();
+  size_t prev_size = event_queue_->size();
   debug_printf(sprockit::dbg::event_manager,
                "manager %d:%d adding event to run at t=%" PRIu64 " seqnum=%" PRIu32 " on link=%" PRIu64,
                me_, thread_id_, ev->time().time.ticks(), ev->seqnum(), ev->linkId());
 #endif
-  event_queue_.insert(ev);
+  if (schedule_log_) schedule_log_->push_back(ev);
+  event_queue_->push(ev);
 #if SSTMAC_SANITY_CHECK
-  if (prev_size == event_queue_.size()){
+  if (prev_size == event_queue_->size()){
     spkt_abort_printf("dropped event seqnum=%" PRIu32 " on link %" PRIu64,
                       ev->seqnum(), ev->linkId());
   }
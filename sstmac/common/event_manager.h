@@ -55,6 +55,8 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/hardware/common/flow_fwd.h>
 #include <sstmac/common/event_handler_fwd.h>
 #include <sstmac/common/event_scheduler.h>
+#include <sstmac/common/event_queue.h>
+#include <sstmac/common/rollback.h>
 #include <sstmac/common/sst_event_fwd.h>
 #include <sstmac/common/stats/stat_collector_fwd.h>
 #include <sprockit/sim_parameters_fwd.h>
@@ -63,17 +65,21 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sprockit/allocator.h>
 
 #include <sstmac/hardware/interconnect/interconnect_fwd.h>
+#include <sstmac/hardware/topology/topology_fwd.h>
 #include <sstmac/backends/common/sim_partition_fwd.h>
 #include <sstmac/backends/common/parallel_runtime_fwd.h>
 #include <sstmac/common/event_scheduler_fwd.h>
 #include <sstmac/backends/native/manager_fwd.h>
+#include <sstmac/backends/native/event_ring.h>
 #include <sstmac/common/sst_event.h>
+#include <sstmac/common/event_profile.h>
 #include <sstmac/software/threading/threading_interface_fwd.h>
 
 #include <vector>
 #include <queue>
 #include <cstdint>
 #include <cstddef>
+#include <functional>
 
 #include <cinttypes>
 
@@ -187,10 +193,22 @@ class EventManager
     return const_cast<EventManager*>(this);
   }
 
-  void ipcSchedule(IpcEvent* iev);
+  virtual void ipcSchedule(IpcEvent* iev);
 
   void multithreadSchedule(int slot, int srcThread, ExecutionEvent* ev){
-    pending_events_[slot][srcThread].push_back(ev);
+    if (inboxes_.empty() || !inboxes_[srcThread]->push(ev)){
+      //no mailbox or the mailbox is full, fall back to the slot for this epoch
+      pending_events_[slot][srcThread].push_back(ev);
+    }
+  }
+
+  /**
+   * @brief setInbox Receive events from another thread through a ring instead of the pending slots
+   * @param srcThread The thread that pushes into the ring
+   */
+  void setInbox(int srcThread, native::EventRing* ring){
+    inboxes_.resize(nthread_, nullptr);
+    inboxes_[srcThread] = ring;
   }
 
   void schedulePendingSerialization(char* buf){
@@ -233,9 +251,9 @@ class EventManager
   }
 
   Timestamp minEventTime() const {
-    return event_queue_.empty()
+    return event_queue_->empty()
           ? no_events_left_time
-          : (*event_queue_.begin())->time();
+          : event_queue_->top()->time();
   }
 
   void setComponentManager(uint32_t comp_id, int thread){
@@ -249,6 +267,41 @@ class EventManager
 
   void addLinkHandler(uint64_t linkId, EventHandler* handler);
 
+  /**
+   * @return The counts of executed events, null unless event_profile_file is set
+   */
+  EventProfile* profile() const {
+    return profile_;
+  }
+
+  /**
+   * @brief logState Save the state of a component before the current event modifies it.
+   *        This only has an effect while executing an event that might be rolled back.
+   */
+  void logState(Rollback* r){
+    if (state_log_){
+      for (auto& pair : *state_log_){
+        if (pair.first == r) return;
+      }
+      state_log_->emplace_back(r, r->saveState());
+    }
+  }
+
+  /**
+   * @return Whether the current event is executing optimistically and might be rolled back
+   */
+  bool speculative() const {
+    return commit_log_ != nullptr;
+  }
+
+  /**
+   * @brief deferCommit Run fxn once the current (optimistic) event is committed.
+   *        The function is dropped if the event is rolled back.
+   */
+  void deferCommit(std::function<void()>&& fxn){
+    commit_log_->push_back(std::move(fxn));
+  }
+
  protected:
   void registerPending();
 
@@ -260,6 +313,8 @@ class EventManager
   int pendingSlot_;
   std::vector<std::vector<ExecutionEvent*>> pending_events_[num_pendingSlots];
   std::vector<char*> pending_serialization_;
+  /** Rings indexed by source thread, empty unless the event manager uses mailboxes */
+  std::vector<native::EventRing*> inboxes_;
 
  protected:
   bool complete_;
@@ -291,25 +346,11 @@ class EventManager
 
   void finalizeStatsInit();
 
-  void scheduleIncoming(IpcEvent* iev);
+  ExecutionEvent* scheduleIncoming(IpcEvent* iev);
 
   int serializeSchedule(char* buf);
 
-  struct EventCompare {
-    bool operator()(ExecutionEvent* lhs, ExecutionEvent* rhs) const {
-      bool neq = lhs->time() != rhs->time();
-      if (neq) return lhs->time() < rhs->time();
-
-      if (lhs->linkId() == rhs->linkId()){
-        return lhs->seqnum() < rhs->seqnum();
-      } else {
-        return lhs->linkId() < rhs->linkId();
-      }
-    }
-  };
-  using queue_t = std::set<ExecutionEvent*, EventCompare,
-                    sprockit::allocator<ExecutionEvent*>> ;
-  queue_t event_queue_;
+  EventQueue* event_queue_;
 
   StatisticOutput* dflt_stat_output_;
 
@@ -319,6 +360,24 @@ class EventManager
 
   std::unordered_map<uint32_t,int> component_to_thread_;
 
+  /** States saved during the current event, null unless executing optimistically */
+  SavedStateList* state_log_;
+
+  /** Events scheduled by the current event, null unless executing optimistically */
+  std::vector<ExecutionEvent*>* schedule_log_;
+
+  /** Side effects deferred until the current event commits, null unless executing optimistically */
+  std::vector<std::function<void()>>* commit_log_;
+
+  EventProfile* profile_;
+
+  std::string profile_file_;
+
+  /** The interconnect is deleted when the run ends, but the profile is written after */
+  hw::Topology* profile_top_;
+
+  int epochs_since_trim_;
+
 };
 
 class NullEventManager : public EventManager
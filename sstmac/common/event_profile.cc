@@ -0,0 +1,164 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+
+#include <sstmac/common/event_profile.h>
+#include <sstmac/hardware/topology/topology.h>
+#include <sstmac/backends/common/parallel_runtime.h>
+#include <sstmac/backends/common/sim_partition.h>
+#include <sprockit/errors.h>
+#include <sprockit/output.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+
+namespace sstmac {
+
+void
+EventProfile::setSelfLink(uint32_t linkId, uint32_t componentId)
+{
+  uint32_t offset = std::numeric_limits<uint32_t>::max() - linkId;
+  if (offset >= self_components_.size()){
+    self_components_.resize(offset + 1, std::numeric_limits<uint32_t>::max());
+  }
+  self_components_[offset] = componentId;
+}
+
+void
+EventProfile::setLinkSwitches(uint64_t first, uint64_t last, int src, int dst)
+{
+  if (last > link_switches_.size()){
+    link_switches_.resize(last, LinkSwitches{-1,-1});
+  }
+  for (uint64_t id=first; id < last; ++id){
+    link_switches_[id] = LinkSwitches{src, dst};
+  }
+}
+
+void
+EventProfile::write(const std::string& filename,
+                    const std::vector<EventProfile*>& profiles,
+                    hw::Topology* top, ParallelRuntime* rt)
+{
+  uint32_t num_nodes = top->numNodes();
+  uint32_t num_switches = top->numSwitches();
+
+  //links are numbered consistently on all ranks, but only one thread holds the switches of each link
+  const std::vector<LinkSwitches>* link_switches = nullptr;
+  for (EventProfile* prof : profiles){
+    if (!link_switches || prof->link_switches_.size() > link_switches->size()){
+      link_switches = &prof->link_switches_;
+    }
+  }
+
+  int num_links = link_switches->size();
+  std::vector<uint64_t> switch_events(num_switches, 0);
+  std::vector<uint64_t> link_events(num_links, 0);
+  for (EventProfile* prof : profiles){
+    for (size_t i=0; i < prof->self_events_.size(); ++i){
+      uint32_t comp = i < prof->self_components_.size()
+          ? prof->self_components_[i] : std::numeric_limits<uint32_t>::max();
+      if (comp < num_nodes){
+        switch_events[top->endpointToSwitch(comp)] += prof->self_events_[i];
+      } else if (comp < num_nodes + num_switches){
+        switch_events[comp - num_nodes] += prof->self_events_[i];
+      }
+    }
+    int nlinks = std::min<int>(num_links, prof->link_events_.size());
+    for (int i=0; i < nlinks; ++i){
+      link_events[i] += prof->link_events_[i];
+    }
+  }
+
+  rt->globalSum(switch_events.data(), num_switches, 0);
+  rt->globalSum(link_events.data(), num_links, 0);
+  if (rt->me() != 0) return;
+
+  //merge both directions of each link into one edge
+  std::map<std::pair<int,int>, uint64_t> edges;
+  for (int i=0; i < num_links; ++i){
+    const LinkSwitches& ls = (*link_switches)[i];
+    if (ls.dst < 0) continue;
+    switch_events[ls.dst] += link_events[i];
+    if (ls.src != ls.dst && link_events[i]){
+      edges[std::make_pair(std::min(ls.src, ls.dst), std::max(ls.src, ls.dst))] += link_events[i];
+    }
+  }
+
+  uint64_t total = 0;
+  for (uint64_t n : switch_events) total += n;
+  uint64_t between = 0;
+  uint64_t cut = 0;
+  Partition* part = rt->topologyPartition();
+  for (auto& pair : edges){
+    int a = pair.first.first;
+    int b = pair.first.second;
+    between += pair.second;
+    if (part->lpidForSwitch(a) != part->lpidForSwitch(b)
+        || part->threadForSwitch(a) != part->threadForSwitch(b)){
+      cut += pair.second;
+    }
+  }
+
+  std::ofstream out(filename);
+  if (!out.is_open()){
+    spkt_abort_printf("could not open event profile file %s", filename.c_str());
+  }
+  out << "# events " << total
+      << ", between switches " << between
+      << ", across partitions " << cut << "\n";
+  out << "switches " << num_switches << "\n";
+  for (uint32_t i=0; i < num_switches; ++i){
+    if (switch_events[i]) out << "switch " << i << " " << switch_events[i] << "\n";
+  }
+  for (auto& pair : edges){
+    out << "link " << pair.first.first << " " << pair.first.second
+        << " " << pair.second << "\n";
+  }
+  cout0 << "Wrote event profile " << filename << ": " << total << " events, "
+        << cut << " sent across partitions\n";
+}
+
+}
@@ -0,0 +1,127 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+
+#ifndef SSTMAC_COMMON_EVENT_PROFILE_H_INCLUDED
+#define SSTMAC_COMMON_EVENT_PROFILE_H_INCLUDED
+
+#include <sstmac/hardware/topology/topology_fwd.h>
+#include <sstmac/backends/common/parallel_runtime_fwd.h>
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <limits>
+
+namespace sstmac {
+
+/**
+ * Counts the events executed on each link and self link of an event manager.
+ * At the end of the run the counts are attributed to switches (a node's events to the switch it is attached to)
+ * and to pairs of connected switches, then written to a compact profile
+ * that partition=profile reads to balance the next run of the same configuration.
+ */
+class EventProfile
+{
+ public:
+  /**
+   * @brief count Record the execution of an event
+   * @param linkId The link the event arrived on
+   */
+  void count(uint32_t linkId) {
+    if (linkId > max_link_id){
+      uint32_t offset = std::numeric_limits<uint32_t>::max() - linkId;
+      if (offset >= self_events_.size()) self_events_.resize(offset + 1, 0);
+      ++self_events_[offset];
+    } else {
+      if (linkId >= link_events_.size()) link_events_.resize(linkId + 1, 0);
+      ++link_events_[linkId];
+    }
+  }
+
+  /**
+   * @brief setSelfLink Attribute events on a component's self link to the component
+   */
+  void setSelfLink(uint32_t linkId, uint32_t componentId);
+
+  /**
+   * @brief setLinkSwitches Attribute events on a range of interconnect links
+   * @param first The first link id
+   * @param last One past the last link id
+   * @param src The switch sending on the links
+   * @param dst The switch receiving on the links, which executes the events
+   */
+  void setLinkSwitches(uint64_t first, uint64_t last, int src, int dst);
+
+  /**
+   * @brief write Combine the counts of all threads and ranks and write the profile from rank 0
+   * @param profiles The profiles of each thread on this rank
+   * @param top The topology, which outlives the interconnect deleted when the run ends
+   */
+  static void write(const std::string& filename,
+                    const std::vector<EventProfile*>& profiles,
+                    hw::Topology* top, ParallelRuntime* rt);
+
+ private:
+  /** Interconnect link ids are allocated from zero, self link ids down from the maximum */
+  static const uint32_t max_link_id = std::numeric_limits<uint32_t>::max() / 2;
+
+  struct LinkSwitches {
+    int src;
+    int dst;
+  };
+
+  std::vector<uint64_t> link_events_;
+
+  std::vector<uint64_t> self_events_;
+
+  std::vector<LinkSwitches> link_switches_;
+
+  std::vector<uint32_t> self_components_;
+
+};
+
+}
+
+#endif
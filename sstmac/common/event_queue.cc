@@ -0,0 +1,280 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <sstmac/common/event_queue.h>
+#include <sstmac/common/timestamp.h>
+#include <sprockit/sim_parameters.h>
+#include <sprockit/errors.h>
+#include <sprockit/keyword_registration.h>
+#include <algorithm>
+
+RegisterKeywords(
+{ "event_queue_buckets", "the initial number of buckets in a calendar event queue" },
+{ "event_queue_bucket_width", "the initial time width of each bucket in a calendar event queue" },
+{ "event_queue_resize", "whether a calendar event queue adapts its bucket count and width" },
+{ "event_queue_record_backend", "the event queue that records forward operations to" },
+{ "event_queue_record_file", "the binary file an event queue stream is recorded to" },
+);
+
+namespace sstmac {
+
+/** Number of leading events sampled to estimate the bucket width */
+static const size_t calendar_sample_size = 32;
+
+CalendarEventQueue::CalendarEventQueue(SST::Params& params) :
+  EventQueue(params),
+  size_(0),
+  top_bucket_(nullptr)
+{
+  min_buckets_ = params.find<int>("event_queue_buckets", 64);
+  if (min_buckets_ < 2 || (min_buckets_ & (min_buckets_ - 1))){
+    spkt_abort_printf("event_queue_buckets=%d must be a power of two >= 2",
+                      int(min_buckets_));
+  }
+  TimeDelta width(params.find<SST::UnitAlgebra>("event_queue_bucket_width", "1ns").getValue().toDouble());
+  width_ = std::max(width.ticks(), uint64_t(1));
+  resize_enabled_ = params.find<bool>("event_queue_resize", true);
+  buckets_.resize(min_buckets_);
+  mask_ = min_buckets_ - 1;
+  setCurrent(0);
+}
+
+void
+CalendarEventQueue::push(ExecutionEvent* ev)
+{
+  uint64_t t = ticks(ev);
+  bucket_t& bucket = buckets_[bucketIndex(t)];
+  //buckets are short and new events are usually later than the ones
+  //already present, so a linear scan from the front (latest) is cheapest
+  auto iter = bucket.begin();
+  auto end = bucket.end();
+  EventCompare cmp;
+  while (iter != end && cmp(ev, *iter)){
+    ++iter;
+  }
+  bucket.insert(iter, ev);
+  ++size_;
+  top_bucket_ = nullptr;
+
+  //an event scheduled before the current position moves the calendar backwards
+  if (t + width_ < cur_top_){
+    setCurrent(t);
+  }
+
+  if (resize_enabled_ && size_ > 2*buckets_.size()){
+    resize(2*buckets_.size());
+  }
+}
+
+ExecutionEvent*
+CalendarEventQueue::top()
+{
+  if (size_ == 0) return nullptr;
+  if (top_bucket_) return top_bucket_->back();
+
+  size_t nbuckets = buckets_.size();
+  for (size_t i=0; i < nbuckets; ++i){
+    bucket_t& bucket = buckets_[cur_bucket_];
+    if (!bucket.empty() && ticks(bucket.back()) < cur_top_){
+      top_bucket_ = &bucket;
+      return bucket.back();
+    }
+    cur_bucket_ = (cur_bucket_ + 1) & mask_;
+    cur_top_ += width_;
+  }
+
+  //nothing within a full year - fall back to a direct search
+  ExecutionEvent* min_ev = nullptr;
+  EventCompare cmp;
+  for (bucket_t& bucket : buckets_){
+    if (!bucket.empty() && (!min_ev || cmp(bucket.back(), min_ev))){
+      min_ev = bucket.back();
+      top_bucket_ = &bucket;
+    }
+  }
+  setCurrent(ticks(min_ev));
+  return min_ev;
+}
+
+void
+CalendarEventQueue::pop()
+{
+  if (!top_bucket_) top();
+  top_bucket_->pop_back();
+  top_bucket_ = nullptr;
+  --size_;
+
+  if (resize_enabled_ && buckets_.size() > min_buckets_ && size_ < buckets_.size() / 2){
+    resize(buckets_.size() / 2);
+  }
+}
+
+void
+CalendarEventQueue::erase(ExecutionEvent* ev)
+{
+  bucket_t& bucket = buckets_[bucketIndex(ticks(ev))];
+  EventCompare cmp;
+  for (auto iter = bucket.begin(); iter != bucket.end(); ++iter){
+    if (!cmp(ev, *iter) && !cmp(*iter, ev)){
+      bucket.erase(iter);
+      top_bucket_ = nullptr;
+      --size_;
+      return;
+    }
+  }
+  spkt_abort_printf("calendar queue cannot erase missing event at t=%" PRIu64 " on link %" PRIu32,
+                    ticks(ev), ev->linkId());
+}
+
+uint64_t
+CalendarEventQueue::sampleWidth(std::vector<ExecutionEvent*>& events) const
+{
+  size_t nsample = std::min(events.size(), calendar_sample_size);
+  if (nsample < 2) return width_;
+
+  std::partial_sort(events.begin(), events.begin() + nsample, events.end(), EventCompare());
+
+  uint64_t total = ticks(events[nsample-1]) - ticks(events[0]);
+  if (total == 0) return width_;
+  uint64_t avg = total / (nsample - 1);
+
+  //following Brown, ignore large gaps that would inflate the estimate
+  uint64_t trimmed_total = 0;
+  size_t ngaps = 0;
+  for (size_t i=1; i < nsample; ++i){
+    uint64_t gap = ticks(events[i]) - ticks(events[i-1]);
+    if (gap <= 2*avg){
+      trimmed_total += gap;
+      ++ngaps;
+    }
+  }
+  uint64_t sep = ngaps ? trimmed_total / ngaps : avg;
+  return std::max(3*sep, uint64_t(1));
+}
+
+void
+CalendarEventQueue::resize(size_t nbuckets)
+{
+  std::vector<ExecutionEvent*> events;
+  events.reserve(size_);
+  for (bucket_t& bucket : buckets_){
+    events.insert(events.end(), bucket.begin(), bucket.end());
+    bucket.clear();
+  }
+
+  width_ = sampleWidth(events);
+  buckets_.resize(nbuckets);
+  mask_ = nbuckets - 1;
+  size_ = 0;
+  top_bucket_ = nullptr;
+
+  uint64_t min_ticks = events.empty() ? 0 : ticks(events[0]);
+  bool was_enabled = resize_enabled_;
+  resize_enabled_ = false;
+  for (ExecutionEvent* ev : events){
+    min_ticks = std::min(min_ticks, ticks(ev));
+    push(ev);
+  }
+  resize_enabled_ = was_enabled;
+  setCurrent(min_ticks);
+}
+
+RecordingEventQueue::RecordingEventQueue(SST::Params& params) :
+  EventQueue(params)
+{
+  auto backend = params.find<std::string>("event_queue_record_backend", "set");
+  if (backend == "record"){
+    spkt_abort_printf("event_queue_record_backend cannot itself be a recording queue");
+  }
+  queue_ = sprockit::create<EventQueue>("macro", backend, params);
+
+  auto fname = params.find<std::string>("event_queue_record_file", "event_queue.bin");
+  file_ = fopen(fname.c_str(), "wb");
+  if (!file_){
+    spkt_abort_printf("failed to open event queue record file %s", fname.c_str());
+  }
+}
+
+RecordingEventQueue::~RecordingEventQueue()
+{
+  fclose(file_);
+  delete queue_;
+}
+
+void
+RecordingEventQueue::record(ExecutionEvent* ev, Record::op_t op)
+{
+  Record rec;
+  rec.ticks = ev->time().time.ticks();
+  rec.linkId = ev->linkId();
+  rec.seqnum = ev->seqnum();
+  rec.op = op;
+  rec.pad = 0;
+  fwrite(&rec, sizeof(Record), 1, file_);
+}
+
+void
+RecordingEventQueue::push(ExecutionEvent* ev)
+{
+  record(ev, Record::push);
+  queue_->push(ev);
+}
+
+void
+RecordingEventQueue::pop()
+{
+  record(queue_->top(), Record::pop);
+  queue_->pop();
+}
+
+void
+RecordingEventQueue::erase(ExecutionEvent* ev)
+{
+  record(ev, Record::erase);
+  queue_->erase(ev);
+}
+
+}
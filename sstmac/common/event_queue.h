@@ -0,0 +1,283 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_COMMON_EVENT_QUEUE_H_INCLUDED
+#define SSTMAC_COMMON_EVENT_QUEUE_H_INCLUDED
+
+#include <sstmac/common/sst_event.h>
+#include <sstmac/sst_core/integrated_component.h>
+#include <sprockit/factory.h>
+#include <sprockit/allocator.h>
+
+#include <set>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+namespace sstmac {
+
+/**
+ * Total ordering on events used by every event queue.
+ * Events are ordered by time, ties are broken by link id
+ * and then by the sequence number assigned on the link.
+ */
+struct EventCompare {
+  bool operator()(ExecutionEvent* lhs, ExecutionEvent* rhs) const {
+    bool neq = lhs->time() != rhs->time();
+    if (neq) return lhs->time() < rhs->time();
+
+    if (lhs->linkId() == rhs->linkId()){
+      return lhs->seqnum() < rhs->seqnum();
+    } else {
+      return lhs->linkId() < rhs->linkId();
+    }
+  }
+};
+
+/**
+ * Priority queue of pending events for an event manager.
+ * All implementations must pop events in exactly the order
+ * defined by EventCompare so that results do not depend on the backend.
+ */
+class EventQueue
+{
+ public:
+  SST_ELI_DECLARE_BASE(EventQueue)
+  SST_ELI_DECLARE_DEFAULT_INFO()
+  SST_ELI_DECLARE_CTOR(SST::Params&)
+
+  virtual ~EventQueue(){}
+
+  virtual void push(ExecutionEvent* ev) = 0;
+
+  /**
+   * @return The earliest event in the queue, nullptr if empty
+   */
+  virtual ExecutionEvent* top() = 0;
+
+  /**
+   * Remove the event most recently returned by top()
+   */
+  virtual void pop() = 0;
+
+  /**
+   * Remove a pending event before it reaches the top of the queue.
+   * Used by optimistic event managers to cancel rolled back events.
+   * @param ev An event with the same time, link, and seqnum as the one to remove
+   */
+  virtual void erase(ExecutionEvent* ev) = 0;
+
+  virtual size_t size() const = 0;
+
+  bool empty() const {
+    return size() == 0;
+  }
+
+ protected:
+  EventQueue(SST::Params&){}
+  EventQueue(){}
+};
+
+class SetEventQueue : public EventQueue
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    EventQueue,
+    SetEventQueue,
+    "macro",
+    "set",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "event queue based on a balanced binary tree")
+
+  SetEventQueue(SST::Params& params) :
+    EventQueue(params)
+  {
+  }
+
+  void push(ExecutionEvent* ev) override {
+    queue_.insert(ev);
+  }
+
+  ExecutionEvent* top() override {
+    return queue_.empty() ? nullptr : *queue_.begin();
+  }
+
+  void pop() override {
+    queue_.erase(queue_.begin());
+  }
+
+  void erase(ExecutionEvent* ev) override {
+    queue_.erase(ev);
+  }
+
+  size_t size() const override {
+    return queue_.size();
+  }
+
+ private:
+  using queue_t = std::set<ExecutionEvent*, EventCompare,
+                    sprockit::allocator<ExecutionEvent*>>;
+  queue_t queue_;
+};
+
+/**
+ * Calendar queue (R. Brown, CACM 1988) giving O(1) amortized push/pop.
+ * Events are hashed by time into a ring of buckets one "day" wide.
+ * Each bucket is kept sorted by EventCompare so that ties are broken
+ * identically to SetEventQueue. The number of buckets and the bucket
+ * width are adjusted as the queue grows and shrinks.
+ */
+class CalendarEventQueue : public EventQueue
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    EventQueue,
+    CalendarEventQueue,
+    "macro",
+    "calendar",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "event queue based on a self-resizing calendar queue")
+
+  CalendarEventQueue(SST::Params& params);
+
+  void push(ExecutionEvent* ev) override;
+
+  ExecutionEvent* top() override;
+
+  void pop() override;
+
+  void erase(ExecutionEvent* ev) override;
+
+  size_t size() const override {
+    return size_;
+  }
+
+ private:
+  /** Sorted so that the earliest event is at the back */
+  using bucket_t = std::vector<ExecutionEvent*>;
+
+  static uint64_t ticks(ExecutionEvent* ev) {
+    return ev->time().time.ticks();
+  }
+
+  size_t bucketIndex(uint64_t t) const {
+    return (t / width_) & mask_;
+  }
+
+  void setCurrent(uint64_t t){
+    cur_bucket_ = bucketIndex(t);
+    cur_top_ = (t / width_ + 1) * width_;
+  }
+
+  void resize(size_t nbuckets);
+
+  uint64_t sampleWidth(std::vector<ExecutionEvent*>& events) const;
+
+  std::vector<bucket_t> buckets_;
+  uint64_t width_;
+  size_t mask_;
+  size_t size_;
+  size_t min_buckets_;
+  /** The bucket from which the next event is expected */
+  size_t cur_bucket_;
+  /** The end of the current bucket in the current year */
+  uint64_t cur_top_;
+  /** The bucket holding the event last returned by top() */
+  bucket_t* top_bucket_;
+  bool resize_enabled_;
+};
+
+/**
+ * Decorator that forwards to another queue while recording
+ * every push and pop into a binary file. The recorded stream can be
+ * replayed against each backend with benchmarks/event_queue.
+ */
+class RecordingEventQueue : public EventQueue
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    EventQueue,
+    RecordingEventQueue,
+    "macro",
+    "record",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "event queue that records the stream of operations on another queue")
+
+  struct Record {
+    enum op_t : uint32_t { push=0, pop=1, erase=2 };
+    uint64_t ticks;
+    uint32_t linkId;
+    uint32_t seqnum;
+    uint32_t op;
+    uint32_t pad;
+  };
+
+  RecordingEventQueue(SST::Params& params);
+
+  ~RecordingEventQueue() override;
+
+  void push(ExecutionEvent* ev) override;
+
+  ExecutionEvent* top() override {
+    return queue_->top();
+  }
+
+  void pop() override;
+
+  void erase(ExecutionEvent* ev) override;
+
+  size_t size() const override {
+    return queue_->size();
+  }
+
+ private:
+  void record(ExecutionEvent* ev, Record::op_t op);
+
+  EventQueue* queue_;
+  FILE* file_;
+};
+
+}
+
+#endif
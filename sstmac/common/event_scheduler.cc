@@ -106,6 +106,24 @@ MacroBaseComponent::endSimulation()
   mgr_->stop();
 }
 
+void
+MacroBaseComponent::logState(Rollback* r)
+{
+  mgr_->logState(r);
+}
+
+bool
+MacroBaseComponent::speculative() const
+{
+  return mgr_->speculative();
+}
+
+void
+MacroBaseComponent::deferCommit(std::function<void()>&& fxn)
+{
+  mgr_->deferCommit(std::move(fxn));
+}
+
 void
 MacroBaseComponent::sendExecutionEvent(Timestamp arrival, ExecutionEvent *ev)
 {
@@ -142,10 +160,14 @@ MacroBaseComponent::setManager()
   thread_id_ = mgr_->thread();
   nthread_ = EventManager::global->nthread();
   now_ = mgr_->nowPtr();
+  if (mgr_->profile()){
+    mgr_->profile()->setSelfLink(selfLinkId_, id_);
+  }
 }
 
 TimeDelta EventLink::minRemoteLatency_;
 TimeDelta EventLink::minThreadLatency_;
+std::vector<TimeDelta> EventLink::minRankLatency_;
 uint32_t EventLink::selfLinkIdCounter_{0};
 #endif
 
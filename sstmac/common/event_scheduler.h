@@ -50,6 +50,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/common/handler_event_queue_entry.h>
 #include <sstmac/common/sst_event_fwd.h>
 #include <sstmac/common/sstmac_config.h>
+#include <sstmac/common/rollback.h>
 #include <sstmac/common/stats/stat_collector.h>
 #include <sstmac/common/event_manager_fwd.h>
 #include <sstmac/common/event_scheduler_fwd.h>
@@ -58,6 +59,9 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sprockit/sim_parameters_fwd.h>
 #include <unusedvariablemacro.h>
 
+#include <vector>
+#include <functional>
+
 
 extern int run_standalone(int, char**);
 
@@ -138,8 +142,30 @@ class EventLink {
     return minRemoteLatency_;
   }
 
+  /**
+   * @return The minimum latency of links from this rank to each remote rank,
+   *         indexed by rank with zero for ranks that have no link
+   */
+  static const std::vector<TimeDelta>& minRankLatencies() {
+    return minRankLatency_;
+  }
+
   static uint64_t allocateSelfLinkId();
 
+  /**
+   * @return The sequence number of the next event sent on the link
+   */
+  uint32_t seqnum() const {
+    return seqnum_;
+  }
+
+  /**
+   * @brief setSeqnum Only used to restore the link when rolling back optimistic execution
+   */
+  void setSeqnum(uint32_t seqnum) {
+    seqnum_ = seqnum;
+  }
+
  protected:
   EventLink(uint64_t linkId, TimeDelta latency) :
     seqnum_(0),
@@ -159,7 +185,7 @@ class EventLink {
     }
   }
 
-  static void setMinRemoteLatency(TimeDelta t){
+  static void setMinRemoteLatency(TimeDelta t, int rank){
     if (t.ticks() == 0){
       spkt_abort_printf("setting link latency to zero across threads!");
     }
@@ -168,6 +194,15 @@ class EventLink {
     } else {
       minRemoteLatency_ = std::min(minRemoteLatency_, t);
     }
+    if (rank >= int(minRankLatency_.size())){
+      minRankLatency_.resize(rank+1);
+    }
+    TimeDelta& rankLatency = minRankLatency_[rank];
+    if (rankLatency.ticks() == 0){
+      rankLatency = t;
+    } else {
+      rankLatency = std::min(rankLatency, t);
+    }
   }
 
   uint32_t seqnum_;
@@ -175,6 +210,7 @@ class EventLink {
   TimeDelta latency_;
   static TimeDelta minThreadLatency_;
   static TimeDelta minRemoteLatency_;
+  static std::vector<TimeDelta> minRankLatency_;
   static uint32_t selfLinkIdCounter_;
 
 };
@@ -280,6 +316,14 @@ class IntegratedBaseComponent :
     spkt_abort_printf("intgrated core does not support stopping");
   }
 
+  void logState(Rollback* /*r*/) {
+    //no optimistic execution in the integrated core
+  }
+
+  template <class Fxn> void runOnCommit(Fxn&& fxn){
+    fxn();
+  }
+
   void handleExecutionEvent(Event* ev){
     ExecutionEvent* sev = dynamic_cast<ExecutionEvent*>(ev);
     sev->execute();
@@ -375,6 +419,25 @@ class MacroBaseComponent
 
   void endSimulation();
 
+  /**
+   * @brief logState Save the state of r before the current event modifies it.
+   *        This does nothing unless the event is being executed optimistically.
+   */
+  void logState(Rollback* r);
+
+  /**
+   * @brief runOnCommit Run a side effect that cannot be rolled back, e.g. collecting statistics.
+   *        While executing optimistically, fxn is held until the current event commits
+   *        and dropped if the event is rolled back. Otherwise it runs immediately.
+   */
+  template <class Fxn> void runOnCommit(Fxn&& fxn){
+    if (speculative()){
+      deferCommit(std::function<void()>(std::forward<Fxn>(fxn)));
+    } else {
+      fxn();
+    }
+  }
+
   template <class T, class... Args> T* loadSub(const std::string& name, const std::string& /*iface*/, int slot_id,
                                 SST::Params& params, Args&&... args){
     return sprockit::create<T>("macro", name, componentId(), params, std::forward<Args>(args)...);
@@ -445,9 +508,24 @@ class MacroBaseComponent
 
   EventLink::ptr allocateSubLink(const std::string& /*name*/, TimeDelta lat, LinkHandler* handler);
 
+  /**
+   * @return The sequence number of the next self event, saved for rolling back optimistic execution
+   */
+  uint32_t selfSeqnum() const {
+    return seqnum_;
+  }
+
+  void setSelfSeqnum(uint32_t seqnum) {
+    seqnum_ = seqnum;
+  }
+
  private:
   void registerStatisticCore(StatisticBase* base, SST::Params& params);
 
+  bool speculative() const;
+
+  void deferCommit(std::function<void()>&& fxn);
+
   EventManager* mgr_;
   uint32_t seqnum_;
   uint32_t selfLinkId_;
@@ -509,6 +587,11 @@ template <class T, class Fxn>
 SST::Event::HandlerBase* newLinkHandler(const T* t, Fxn fxn){
   return new SST::Event::Handler<T>(const_cast<T*>(t), fxn);
 }
+
+template <class T, class Fxn>
+SST::Event::HandlerBase* newReversibleLinkHandler(const T* t, Fxn fxn){
+  return newLinkHandler(t, fxn);
+}
 #else
 template <class T, class Fxn, class... Args>
 SST::Event::HandlerBase* newLinkHandler(const T* t, Fxn fxn, Args&&... args){
@@ -516,6 +599,17 @@ SST::Event::HandlerBase* newLinkHandler(const T* t, Fxn fxn, Args&&... args){
         const_cast<T*>(t), fxn, std::forward<Args>(args)...);
 }
 
+/**
+ * A link handler whose target calls logState before modifying its state,
+ * allowing the events it receives to be executed optimistically
+ */
+template <class T, class Fxn, class... Args>
+SST::Event::HandlerBase* newReversibleLinkHandler(const T* t, Fxn fxn, Args&&... args){
+  auto* handler = newLinkHandler(t, fxn, std::forward<Args>(args)...);
+  handler->setReversible();
+  return handler;
+}
+
 class LocalLink : public EventLink {
  public:
   LocalLink(uint64_t linkId, TimeDelta latency, EventManager* mgr, EventHandler* hand) :
@@ -576,7 +670,7 @@ class IpcLink : public EventLink {
     ev_mgr_(src_mgr),
     ipc_mgr_(ipc_mgr)
   {
-    setMinRemoteLatency(latency);
+    setMinRemoteLatency(latency, rank);
   }
 
   std::string toString() const override {
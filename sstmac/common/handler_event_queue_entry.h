@@ -65,12 +65,30 @@ class HandlerExecutionEvent :
     ev_to_deliver_(ev),
     handler_(hand)
   {
+    reversible_ = hand->reversible();
   }
 
   void execute() override {
     handler_->handle(ev_to_deliver_);
   }
 
+#if !SSTMAC_INTEGRATED_SST_CORE
+  ExecutionEvent* clone() const override {
+    Event* ev = nullptr;
+    if (ev_to_deliver_){
+      ev = ev_to_deliver_->clone();
+      if (!ev) return nullptr;
+    }
+    auto* cpy = new HandlerExecutionEvent(ev, handler_);
+    cloneHeader(cpy);
+    return cpy;
+  }
+
+  void discard() override {
+    if (ev_to_deliver_) delete ev_to_deliver_;
+  }
+#endif
+
  protected:
   Event* ev_to_deliver_;
 
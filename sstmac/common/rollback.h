@@ -0,0 +1,93 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+
+#ifndef SSTMAC_COMMON_ROLLBACK_H_INCLUDED
+#define SSTMAC_COMMON_ROLLBACK_H_INCLUDED
+
+#include <vector>
+#include <utility>
+
+namespace sstmac {
+
+/**
+ * Opaque copy of the state of a component, owned by the event manager
+ * until the event that modified the component is either committed
+ * (and the state deleted) or rolled back (and the state restored).
+ */
+struct SavedState {
+  virtual ~SavedState(){}
+};
+
+/**
+ * Interface for components whose events can be executed optimistically.
+ * Before an event modifies the component, the component calls logState(this)
+ * and the optimistic event manager saves a copy of its state.
+ * If the event is later rolled back, the copy is handed back through restoreState.
+ */
+class Rollback
+{
+ public:
+  /**
+   * @return A copy of all state that a reversible event can modify
+   */
+  virtual SavedState* saveState() = 0;
+
+  /**
+   * @brief restoreState Return to a previously saved state.
+   * The caller deletes the state object afterwards,
+   * anything the component keeps must be taken out of it.
+   * @param state A state object returned by saveState
+   */
+  virtual void restoreState(SavedState* state) = 0;
+
+ protected:
+  ~Rollback(){}
+};
+
+using SavedStateList = std::vector<std::pair<Rollback*,SavedState*>>;
+
+}
+
+#endif
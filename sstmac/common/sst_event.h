@@ -64,6 +64,15 @@ class Event : public serializable
 {
  public:
   void serialize_order(serializer&) override{}
+
+  /**
+   * @brief clone Copy an event so that it can be delivered again
+   *        after a rollback of optimistic execution
+   * @return The copy, nullptr if the event does not support copies
+   */
+  virtual Event* clone() const {
+    return nullptr;
+  }
 };
 #endif
 
@@ -80,10 +89,39 @@ class ExecutionEvent : public Event
 #endif
   ExecutionEvent() :
     linkId_(-1),
-    seqnum_(-1)
+    seqnum_(-1),
+    reversible_(false)
   {
   }
 
+#if !SSTMAC_INTEGRATED_SST_CORE
+  /**
+   * @brief clone Copy the event and any payload it owns so that the original
+   *        can be executed again if the copy is rolled back
+   * @return The copy, nullptr if the payload cannot be copied
+   */
+  virtual ExecutionEvent* clone() const {
+    return nullptr;
+  }
+
+  /**
+   * @brief discard Delete any payload owned by an event that will never execute
+   */
+  virtual void discard() {}
+#endif
+
+  /**
+   * @return Whether the target of the event saves its state before modifying it
+   *         so that the event can be executed optimistically and rolled back
+   */
+  bool reversible() const {
+    return reversible_;
+  }
+
+  void setReversible(bool flag = true) {
+    reversible_ = flag;
+  }
+
   Timestamp time() const {
     return time_;
   }
@@ -109,10 +147,20 @@ class ExecutionEvent : public Event
   }
 
  protected:
+#if !SSTMAC_INTEGRATED_SST_CORE
+  void cloneHeader(ExecutionEvent* ev) const {
+    ev->time_ = time_;
+    ev->linkId_ = linkId_;
+    ev->seqnum_ = seqnum_;
+    ev->reversible_ = reversible_;
+  }
+#endif
+
   Timestamp time_;
   uint32_t linkId_;
   /** A unique sequence number from the source */
   uint32_t seqnum_;
+  bool reversible_;
 
 };
 
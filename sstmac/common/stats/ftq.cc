@@ -51,7 +51,11 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sprockit/sim_parameters.h>
 #include <sprockit/util.h>
 #include <sprockit/keyword_registration.h>
+#include <sprockit/statics.h>
 #include <sstream>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 
 RegisterKeywords(
  { "epoch", "the size of a time epoch" },
@@ -166,11 +170,336 @@ FTQAccumulator::outputStatisticFields(SST::Statistics::StatisticOutput * /*statO
   sprockit::abort("FTQAccumulator::outputStatisticData: not yet implemented");
 }
 
+/**
+ * The epochs of all streaming FTQ calendars in a group, merged across the threads of this process.
+ * With aggregate = false, each calendar has its own stream named <group>.<subid>.
+ * Merged epochs are kept until they fall flush_epochs behind the newest epoch flushed by any calendar
+ * and are then written to <name>.ftq (<name>.<rank>.ftq with several ranks). The file is a header -
+ * magic SSTFTQ\0\0, uint32 version, uint32 flags (1 if mean), uint64 ticks per epoch,
+ * uint64 ticks per second, uint64 number of calendars, uint64 number of records - followed by
+ * (uint64 epoch, uint32 type, uint32 unused, uint64 ticks) records and then the tag names -
+ * uint32 number of tags followed by (uint32 type, uint32 length, chars) for each.
+ * Records are in epoch order except for calendars that flush late, e.g. at the end of simulation,
+ * so readers should sum all records with the same epoch and type - which also merges the files of different ranks.
+ * bin/tools/read_ftq.py reads and merges the files.
+ */
+class FTQStream
+{
+ public:
+  static FTQStream* get(const std::string& name, SST::Params& params, bool aggregate);
+
+  void registerCalendar();
+
+  /**
+   * @brief flush Merge the bins of a calendar for epochs [first_epoch, stop_epoch)
+   * @param finished Whether the calendar will flush no more epochs
+   * @param max_tick The end of the last event of the calendar
+   */
+  void flush(uint64_t first_epoch, uint64_t stop_epoch,
+             const std::vector<std::vector<uint64_t>>& bins,
+             bool finished, uint64_t max_tick);
+
+  static void deleteStatics();
+
+ private:
+  FTQStream(const std::string& name, SST::Params& params, bool aggregate);
+
+  void addTicks(uint64_t epoch, uint32_t col, uint64_t ticks);
+
+  void padToMaxTick();
+
+  void printAggregate();
+
+  void writeRecord(uint64_t epoch, uint32_t col, uint64_t ticks);
+
+  void write(uint64_t stop_epoch);
+
+  void close();
+
+  std::string name_;
+  std::string fname_;
+  FILE* out_;
+  thread_lock lock_;
+  bool aggregate_;
+  bool compute_mean_;
+  bool use_ftq_tags_;
+  bool closed_;
+  uint64_t num_records_;
+  uint64_t ticks_per_epoch_;
+  uint64_t lag_epochs_;
+  uint64_t num_calendars_;
+  uint64_t num_finished_;
+  /** The first epoch that has not been written */
+  uint64_t written_epoch_;
+  uint64_t newest_epoch_;
+  /** For each column, the merged ticks in each epoch starting at written_epoch_ */
+  std::vector<std::vector<uint64_t>> totals_;
+  std::vector<uint64_t> column_totals_;
+  /** Like non-streaming calendars, each is padded with inactive time up to the last tick of any */
+  std::vector<uint64_t> finished_ticks_;
+  uint64_t max_tick_;
+};
+
+static const char ftq_magic[8] = {'S','S','T','F','T','Q','\0','\0'};
+static const uint32_t ftq_version = 2;
+/** Byte offset of the number of calendars, patched together with the number of records on close */
+static const long ftq_counts_offset = 32;
+
+static sprockit::NeedDeletestatics<FTQStream> del_statics;
+
+static thread_lock ftq_stream_lock;
+static std::map<std::string, FTQStream*> ftq_streams;
+
+FTQStream*
+FTQStream::get(const std::string& name, SST::Params& params, bool aggregate)
+{
+  ftq_stream_lock.lock();
+  FTQStream*& stream = ftq_streams[name];
+  if (!stream){
+    stream = new FTQStream(name, params, aggregate);
+  }
+  ftq_stream_lock.unlock();
+  return stream;
+}
+
+void
+FTQStream::deleteStatics()
+{
+  for (auto& pair : ftq_streams){
+    pair.second->close();
+    delete pair.second;
+  }
+  ftq_streams.clear();
+}
+
+FTQStream::FTQStream(const std::string& name, SST::Params& params, bool aggregate) :
+  name_(name),
+  out_(nullptr),
+  aggregate_(aggregate),
+  closed_(false),
+  num_records_(0),
+  num_calendars_(0),
+  num_finished_(0),
+  written_epoch_(0),
+  newest_epoch_(0),
+  max_tick_(0)
+{
+  SST::UnitAlgebra length = params.find<SST::UnitAlgebra>("epoch_length");
+  ticks_per_epoch_ = TimeDelta(length.toDouble()).ticks();
+  lag_epochs_ = params.find<int>("flush_epochs", 1024);
+  compute_mean_ = params.find<bool>("compute_mean", false);
+  use_ftq_tags_ = params.find<bool>("use_ftq_tags", !compute_mean_);
+
+  ParallelRuntime* rt = ParallelRuntime::staticRuntime(params);
+  if (rt && rt->nproc() > 1){
+    fname_ = sprockit::sprintf("%s.%d.ftq", name.c_str(), rt->me());
+  } else {
+    fname_ = name + ".ftq";
+  }
+}
+
+void
+FTQStream::registerCalendar()
+{
+  lock_.lock();
+  ++num_calendars_;
+  lock_.unlock();
+}
+
+void
+FTQStream::flush(uint64_t first_epoch, uint64_t stop_epoch,
+                 const std::vector<std::vector<uint64_t>>& bins,
+                 bool finished, uint64_t max_tick)
+{
+  lock_.lock();
+  uint64_t num_epochs = stop_epoch - first_epoch;
+  for (uint32_t col=0; col < bins.size(); ++col){
+    uint64_t num_binned = std::min<uint64_t>(num_epochs, bins[col].size());
+    for (uint64_t i=0; i < num_binned; ++i){
+      if (bins[col][i]){
+        addTicks(first_epoch + i, col, bins[col][i]);
+      }
+    }
+  }
+
+  newest_epoch_ = std::max(newest_epoch_, stop_epoch);
+  if (finished){
+    ++num_finished_;
+    finished_ticks_.push_back(max_tick);
+    max_tick_ = std::max(max_tick_, max_tick);
+  }
+  if (num_finished_ == num_calendars_){
+    padToMaxTick();
+    write(std::max(newest_epoch_, written_epoch_));
+    //keep the file open in case calendars of a later app join the group
+    if (out_) fflush(out_);
+    if (aggregate_ && !compute_mean_){
+      printAggregate();
+    }
+  } else if (newest_epoch_ >= written_epoch_ + 2*lag_epochs_){
+    write(newest_epoch_ - lag_epochs_);
+  }
+  lock_.unlock();
+}
+
+void
+FTQStream::addTicks(uint64_t epoch, uint32_t col, uint64_t ticks)
+{
+  if (totals_.size() <= col){
+    totals_.resize(col + 1);
+    column_totals_.resize(col + 1, 0);
+  }
+  column_totals_[col] += ticks;
+  if (epoch < written_epoch_){
+    //this calendar is behind the others, the epoch is already in the file
+    writeRecord(epoch, col, ticks);
+  } else {
+    auto& merged = totals_[col];
+    uint64_t offset = epoch - written_epoch_;
+    if (merged.size() <= offset){
+      merged.resize(offset + 1, 0);
+    }
+    merged[offset] += ticks;
+  }
+}
+
+void
+FTQStream::padToMaxTick()
+{
+  int col = compute_mean_ ? 0 : inactive.id();
+  uint64_t scale = compute_mean_ ? inactive.id() : 1;
+  for (uint64_t tick : finished_ticks_){
+    if (tick >= max_tick_) continue;
+    for (uint64_t ep=tick / ticks_per_epoch_; ep*ticks_per_epoch_ < max_tick_; ++ep){
+      uint64_t lo = std::max(tick, ep*ticks_per_epoch_);
+      uint64_t hi = std::min(max_tick_, (ep+1)*ticks_per_epoch_);
+      addTicks(ep, col, (hi - lo) * scale);
+      newest_epoch_ = std::max(newest_epoch_, ep + 1);
+    }
+  }
+  finished_ticks_.clear();
+}
+
+void
+FTQStream::writeRecord(uint64_t epoch, uint32_t col, uint64_t ticks)
+{
+  if (closed_){
+    spkt_abort_printf("FTQ stream: record for epoch %llu after %s was closed",
+                      (unsigned long long) epoch, fname_.c_str());
+  }
+
+  if (!out_){
+    out_ = fopen(fname_.c_str(), "wb");
+    if (!out_){
+      spkt_abort_printf("FTQ stream: failed to open %s: %s", fname_.c_str(), ::strerror(errno));
+    }
+    uint32_t flags = compute_mean_ ? 1 : 0;
+    uint64_t ticks_per_second = TimeDelta(1.0).ticks();
+    bool ok = fwrite(ftq_magic, sizeof(ftq_magic), 1, out_) == 1
+      && fwrite(&ftq_version, sizeof(ftq_version), 1, out_) == 1
+      && fwrite(&flags, sizeof(flags), 1, out_) == 1
+      && fwrite(&ticks_per_epoch_, sizeof(ticks_per_epoch_), 1, out_) == 1
+      && fwrite(&ticks_per_second, sizeof(ticks_per_second), 1, out_) == 1
+      && fwrite(&num_calendars_, sizeof(num_calendars_), 1, out_) == 1
+      && fwrite(&num_records_, sizeof(num_records_), 1, out_) == 1;
+    if (!ok){
+      spkt_abort_printf("FTQ stream: failed writing %s", fname_.c_str());
+    }
+  }
+
+  uint32_t unused = 0;
+  bool ok = fwrite(&epoch, sizeof(epoch), 1, out_) == 1
+    && fwrite(&col, sizeof(col), 1, out_) == 1
+    && fwrite(&unused, sizeof(unused), 1, out_) == 1
+    && fwrite(&ticks, sizeof(ticks), 1, out_) == 1;
+  if (!ok){
+    spkt_abort_printf("FTQ stream: failed writing %s", fname_.c_str());
+  }
+  ++num_records_;
+}
+
+void
+FTQStream::write(uint64_t stop_epoch)
+{
+  uint64_t num_epochs = stop_epoch - written_epoch_;
+  for (uint64_t i=0; i < num_epochs; ++i){
+    for (uint32_t col=0; col < totals_.size(); ++col){
+      auto& merged = totals_[col];
+      if (i < merged.size() && merged[i]){
+        writeRecord(written_epoch_ + i, col, merged[i]);
+      }
+    }
+  }
+  for (auto& merged : totals_){
+    merged.erase(merged.begin(), merged.begin() + std::min<uint64_t>(num_epochs, merged.size()));
+  }
+  written_epoch_ = stop_epoch;
+}
+
+void
+FTQStream::close()
+{
+  if (closed_) return;
+
+  //epochs of calendars that never finished
+  write(std::max(newest_epoch_, written_epoch_));
+  closed_ = true;
+  if (!out_) return;
+
+  uint32_t num_tags = FTQTag::numCategories();
+  bool ok = fwrite(&num_tags, sizeof(num_tags), 1, out_) == 1;
+  for (uint32_t tag=0; ok && tag < num_tags; ++tag){
+    std::string name = FTQTag::name(tag);
+    uint32_t length = name.size();
+    ok = fwrite(&tag, sizeof(tag), 1, out_) == 1
+      && fwrite(&length, sizeof(length), 1, out_) == 1
+      && fwrite(name.data(), 1, length, out_) == length;
+  }
+  ok = ok && fseek(out_, ftq_counts_offset, SEEK_SET) == 0
+    && fwrite(&num_calendars_, sizeof(num_calendars_), 1, out_) == 1
+    && fwrite(&num_records_, sizeof(num_records_), 1, out_) == 1;
+  if (fclose(out_) != 0 || !ok){
+    spkt_abort_printf("FTQ stream: failed writing %s", fname_.c_str());
+  }
+  out_ = nullptr;
+}
+
+void
+FTQStream::printAggregate()
+{
+  double ticks_s = TimeDelta(1.0).ticks();
+  std::cout << sprockit::sprintf("Aggregate time stats: %s\n", name_.c_str());
+  for (int col=0; col < int(column_totals_.size()); ++col){
+    if (column_totals_[col] == 0) continue;
+    std::string key = use_ftq_tags_ ? FTQTag::name(col) : sprockit::sprintf("%d", col);
+    std::cout << sprockit::sprintf("%16s: %16.5f s\n", key.c_str(), column_totals_[col] / ticks_s);
+  }
+}
+
 FTQCalendar::FTQCalendar(SST::BaseComponent *comp, const std::string &name,
                          const std::string &subName, SST::Params &params) :
   SST::Statistics::MultiStatistic<int,uint64_t,uint64_t>(comp,name,subName,params),
-  events_used_(0)
+  events_used_(0),
+  stream_(nullptr),
+  ticks_per_epoch_(0),
+  flush_epochs_(0),
+  compute_mean_(false),
+  first_epoch_(0),
+  stream_tick_(0)
 {
+  if (params.find<bool>("stream", false)){
+    if (!params.contains("epoch_length")){
+      spkt_abort_printf("must specify epoch_length for streaming FTQCalendar");
+    }
+    SST::UnitAlgebra length = params.find<SST::UnitAlgebra>("epoch_length");
+    ticks_per_epoch_ = TimeDelta(length.toDouble()).ticks();
+    flush_epochs_ = params.find<int>("flush_epochs", 1024);
+    compute_mean_ = params.find<bool>("compute_mean", false);
+    bool aggregate = params.find<bool>("aggregate", true);
+    std::string stream_name = aggregate ? groupName() : groupName() + "." + subName;
+    stream_ = FTQStream::get(stream_name, params, aggregate);
+    stream_->registerCalendar();
+  }
 }
 
 void
@@ -195,9 +524,70 @@ void
 FTQCalendar::addData_impl(int event_typeid, uint64_t ticks_begin, uint64_t num_ticks)
 {
   if (num_ticks){
-    events_.emplace_back(event_typeid, ticks_begin, num_ticks);
     events_used_ = events_used_ | (1<<event_typeid);
+    if (stream_){
+      binEvent(event_typeid, ticks_begin, num_ticks);
+    } else {
+      events_.emplace_back(event_typeid, ticks_begin, num_ticks);
+    }
+  }
+}
+
+void
+FTQCalendar::binEvent(int event_typeid, uint64_t ticks_begin, uint64_t num_ticks)
+{
+  int col = compute_mean_ ? 0 : event_typeid;
+  uint64_t scale = compute_mean_ ? event_typeid : 1;
+
+  uint64_t first_tick = first_epoch_ * ticks_per_epoch_;
+  if (ticks_begin < first_tick){
+    //events for a calendar arrive in time order, but tolerate one that starts
+    //in an epoch that was already flushed by moving it to the first open epoch
+    ticks_begin = first_tick;
+  }
+  uint64_t ticks_end = ticks_begin + num_ticks;
+  stream_tick_ = std::max(stream_tick_, ticks_end);
+  uint64_t start_epoch = ticks_begin / ticks_per_epoch_;
+  uint64_t stop_epoch = (ticks_end - 1) / ticks_per_epoch_;
+
+  if (int(bins_.size()) <= col){
+    bins_.resize(col+1);
+  }
+  auto& bins = bins_[col];
+  if (bins.size() <= stop_epoch - first_epoch_){
+    bins.resize(stop_epoch - first_epoch_ + 1, 0);
+  }
+  for (uint64_t ep=start_epoch; ep <= stop_epoch; ++ep){
+    uint64_t lo = std::max(ticks_begin, ep*ticks_per_epoch_);
+    uint64_t hi = std::min(ticks_end, (ep+1)*ticks_per_epoch_);
+    bins[ep - first_epoch_] += (hi - lo) * scale;
+  }
+
+  //no later event starts before this one, so earlier epochs are complete
+  if (start_epoch - first_epoch_ >= flush_epochs_){
+    flushEpochs(start_epoch, false);
+  }
+}
+
+void
+FTQCalendar::flushEpochs(uint64_t stop_epoch, bool finished)
+{
+  stream_->flush(first_epoch_, stop_epoch, bins_, finished, stream_tick_);
+  for (auto& bins : bins_){
+    bins.erase(bins.begin(), bins.begin() + std::min<uint64_t>(stop_epoch - first_epoch_, bins.size()));
   }
+  first_epoch_ = stop_epoch;
+}
+
+void
+FTQCalendar::finishStream()
+{
+  uint64_t stop_epoch = first_epoch_;
+  for (auto& bins : bins_){
+    stop_epoch = std::max(stop_epoch, first_epoch_ + bins.size());
+  }
+  flushEpochs(stop_epoch, true);
+  bins_.clear();
 }
 
 void
@@ -236,9 +626,6 @@ void
 FTQOutput::startOutputGroup(StatisticGroup *grp)
 {
   active_group_ = grp->name;
-
-  std::string dat_fname = sprockit::sprintf("%s.csv", active_group_.c_str());
-  out_.open(dat_fname.c_str());
   includeHeaders_ = true;
 }
 
@@ -250,6 +637,12 @@ FTQOutput::output(StatisticBase *statistic, bool  /*endOfSimFlag*/)
     spkt_abort_printf("FTQOutput can only be used with FTQCalendar statistic");
   }
 
+  if (calendar->streaming()){
+    //streaming calendars have already written their epochs
+    calendar->finishStream();
+    return;
+  }
+
   if (aggregate_){
     aggregateCalendars_.push_back(calendar);
   } else {
@@ -385,6 +778,12 @@ FTQOutput::dump(const std::vector<FTQCalendar*>& calendars, std::ostream& os,
 void
 FTQOutput::stopOutputGroup()
 {
+  if (aggregateCalendars_.empty() && individualCalendars_.empty()){
+    return;
+  }
+
+  std::string dat_fname = sprockit::sprintf("%s.csv", active_group_.c_str());
+  out_.open(dat_fname.c_str());
   if (aggregate_){
     dump(aggregateCalendars_, out_, true, "");
   } else {
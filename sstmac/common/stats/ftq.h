@@ -64,6 +64,8 @@ Questions? Contact sst-macro-help@sandia.gov
 #if !SSTMAC_INTEGRATED_SST_CORE
 namespace sstmac {
 
+class FTQStream;
+
 
 class FTQAccumulator : public SST::Statistics::MultiStatistic<int,uint64_t,uint64_t>
 {
@@ -121,6 +123,21 @@ class FTQCalendar : public SST::Statistics::MultiStatistic<int,uint64_t,uint64_t
 
   ~FTQCalendar() override{}
 
+  /**
+   * With stream = true, events are binned into epochs as they arrive instead of being kept.
+   * Every flush_epochs epochs, the completed bins are merged into the stream shared by all
+   * calendars of the group in this process, which writes them to a binary file.
+   * Memory then depends on flush_epochs and the number of event types, not the length of the run.
+   */
+  bool streaming() const {
+    return stream_;
+  }
+
+  /**
+   * @brief finishStream Flush all remaining bins of a streaming calendar at the end of simulation
+   */
+  void finishStream();
+
   void addData_impl(int event_typeid, uint64_t ticks_begin, uint64_t num_ticks) override;
 
   bool empty() const {
@@ -142,7 +159,9 @@ class FTQCalendar : public SST::Statistics::MultiStatistic<int,uint64_t,uint64_t
   void padToMaxTick(uint64_t max_tick);
 
   uint64_t maxTick() const {
-    if (events_.empty()){
+    if (stream_){
+      return stream_tick_;
+    } else if (events_.empty()){
       return 0;
     } else {
       auto& ev = events_.back();
@@ -155,9 +174,24 @@ class FTQCalendar : public SST::Statistics::MultiStatistic<int,uint64_t,uint64_t
   }
 
  private:
+  void binEvent(int event_typeid, uint64_t ticks_begin, uint64_t num_ticks);
+
+  void flushEpochs(uint64_t stop_epoch, bool finished);
+
   std::vector<Event> events_;
   uint64_t events_used_;
 
+  FTQStream* stream_;
+  uint64_t ticks_per_epoch_;
+  uint64_t flush_epochs_;
+  bool compute_mean_;
+  /** The first epoch that has not been flushed */
+  uint64_t first_epoch_;
+  /** For each event type (or just the mean), the ticks in each epoch starting at first_epoch_ */
+  std::vector<std::vector<uint64_t>> bins_;
+  /** The end of the last streamed event */
+  uint64_t stream_tick_;
+
 };
 
 class FTQOutput : public sstmac::StatisticOutput
@@ -0,0 +1,331 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/common/stats/stat_columnar.h>
+#include <sstmac/common/thread_lock.h>
+#include <sstmac/backends/common/parallel_runtime.h>
+#include <sprockit/errors.h>
+#include <sprockit/sim_parameters.h>
+#include <sprockit/statics.h>
+#include <sprockit/util.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+#if !SSTMAC_INTEGRATED_SST_CORE
+
+namespace sstmac {
+
+static const char columnar_magic[8] = {'S','S','T','C','O','L','S','\0'};
+static const uint32_t columnar_version = 1;
+
+int
+ColumnarTable::column(const std::string& name)
+{
+  auto iter = column_ids_.find(name);
+  if (iter != column_ids_.end()){
+    return iter->second;
+  }
+  int idx = columns_.size();
+  column_ids_[name] = idx;
+  columns_.emplace_back(name);
+  columns_.back().values.resize(numRows(), 0);
+  columns_.back().present.resize(numRows(), 0);
+  return idx;
+}
+
+void
+ColumnarTable::addRow(const std::string& statName, const std::string& component)
+{
+  stat_names_.push_back(statName);
+  components_.push_back(component);
+  for (Column& c : columns_){
+    c.values.push_back(0);
+    c.present.push_back(0);
+  }
+}
+
+double
+ColumnarTable::toDouble(uint64_t bits, type_t type)
+{
+  union {
+    uint64_t bits;
+    int32_t i32;
+    uint32_t u32;
+    int64_t i64;
+    uint64_t u64;
+    float f32;
+    double f64;
+  } u;
+  u.bits = bits;
+  switch(type){
+    case int32: return u.i32;
+    case uint32: return u.u32;
+    case int64: return u.i64;
+    case uint64: return u.u64;
+    case float32: return u.f32;
+    case float64: return u.f64;
+    default: return 0;
+  }
+}
+
+void
+ColumnarTable::promote(Column& c)
+{
+  for (uint64_t& bits : c.values){
+    double d = toDouble(bits, c.type);
+    std::memcpy(&bits, &d, sizeof(double));
+  }
+  c.type = float64;
+}
+
+void
+ColumnarTable::append(const ColumnarTable& other)
+{
+  uint64_t first_row = numRows();
+  uint64_t num_new = other.numRows();
+  stat_names_.insert(stat_names_.end(), other.stat_names_.begin(), other.stat_names_.end());
+  components_.insert(components_.end(), other.components_.begin(), other.components_.end());
+  for (Column& c : columns_){
+    c.values.resize(first_row + num_new, 0);
+    c.present.resize(first_row + num_new, 0);
+  }
+
+  for (const Column& oc : other.columns_){
+    Column& c = columns_[column(oc.name)];
+    bool convert = false;
+    if (c.type == none){
+      c.type = oc.type;
+    } else if (oc.type != none && oc.type != c.type){
+      if (c.type != float64) promote(c);
+      convert = true;
+    }
+    for (uint64_t i=0; i < num_new; ++i){
+      uint64_t bits = oc.values[i];
+      if (convert){
+        double d = toDouble(bits, oc.type);
+        std::memcpy(&bits, &d, sizeof(double));
+      }
+      c.values[first_row + i] = bits;
+      c.present[first_row + i] = oc.present[i];
+    }
+  }
+}
+
+void
+ColumnarTable::clear()
+{
+  stat_names_.clear();
+  components_.clear();
+  columns_.clear();
+  column_ids_.clear();
+}
+
+static size_t
+typeSize(ColumnarTable::type_t type)
+{
+  switch(type){
+    case ColumnarTable::int32:
+    case ColumnarTable::uint32:
+    case ColumnarTable::float32:
+      return 4;
+    case ColumnarTable::int64:
+    case ColumnarTable::uint64:
+    case ColumnarTable::float64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+static void
+writeStrings(FILE* f, const std::vector<std::string>& strs, bool& ok)
+{
+  uint64_t total = 0;
+  std::vector<uint32_t> lengths(strs.size());
+  for (size_t i=0; i < strs.size(); ++i){
+    lengths[i] = strs[i].size();
+    total += lengths[i];
+  }
+  ok = ok && fwrite(&total, sizeof(total), 1, f) == 1;
+  ok = ok && fwrite(lengths.data(), sizeof(uint32_t), lengths.size(), f) == lengths.size();
+  for (const std::string& str : strs){
+    ok = ok && fwrite(str.data(), 1, str.size(), f) == str.size();
+  }
+}
+
+void
+ColumnarTable::write(const std::string& fname, int rank, int nproc) const
+{
+  FILE* f = fopen(fname.c_str(), "wb");
+  if (!f){
+    spkt_abort_printf("columnar stats: failed to open %s: %s", fname.c_str(), ::strerror(errno));
+  }
+
+  uint32_t header[] = { columnar_version, uint32_t(rank), uint32_t(nproc), uint32_t(columns_.size()) };
+  uint64_t num_rows = numRows();
+  bool ok = fwrite(columnar_magic, sizeof(columnar_magic), 1, f) == 1
+    && fwrite(header, sizeof(header), 1, f) == 1
+    && fwrite(&num_rows, sizeof(num_rows), 1, f) == 1;
+  writeStrings(f, stat_names_, ok);
+  writeStrings(f, components_, ok);
+
+  std::vector<uint8_t> bitmap((num_rows + 7) / 8);
+  std::vector<char> packed;
+  for (const Column& c : columns_){
+    uint32_t name_length = c.name.size();
+    uint32_t type = c.type;
+    ok = ok && fwrite(&name_length, sizeof(name_length), 1, f) == 1
+      && fwrite(c.name.data(), 1, name_length, f) == name_length
+      && fwrite(&type, sizeof(type), 1, f) == 1;
+
+    std::fill(bitmap.begin(), bitmap.end(), 0);
+    for (uint64_t i=0; i < num_rows; ++i){
+      if (c.present[i]) bitmap[i/8] |= 1 << (i%8);
+    }
+    ok = ok && fwrite(bitmap.data(), 1, bitmap.size(), f) == bitmap.size();
+
+    //values are kept as raw bits in the low bytes - pack them at the width of the type
+    size_t width = typeSize(c.type);
+    packed.resize(width * num_rows);
+    for (uint64_t i=0; i < num_rows; ++i){
+      std::memcpy(&packed[i*width], &c.values[i], width);
+    }
+    ok = ok && fwrite(packed.data(), 1, packed.size(), f) == packed.size();
+  }
+
+  if (fclose(f) != 0 || !ok){
+    spkt_abort_printf("columnar stats: failed writing %s", fname.c_str());
+  }
+}
+
+namespace {
+/** The tables of all outputs for a group in this process, written once the last one finishes */
+struct SharedColumnarTable {
+  ColumnarTable table;
+  int num_outputs = 0;
+  int num_done = 0;
+  int rank = 0;
+  int nproc = 1;
+
+  std::string filename(const std::string& group) const {
+    return nproc > 1 ? sprockit::sprintf("%s.%d.stats", group.c_str(), rank) : group + ".stats";
+  }
+};
+}
+
+static sprockit::NeedDeletestatics<StatOutputColumnar> del_statics;
+
+static thread_lock columnar_lock;
+static std::map<std::string, SharedColumnarTable*> columnar_tables;
+
+StatOutputColumnar::StatOutputColumnar(SST::Params& params) :
+  StatisticFieldsOutput(params)
+{
+  group_ = params.find<std::string>("group", "default");
+  ParallelRuntime* rt = ParallelRuntime::staticRuntime(params);
+
+  columnar_lock.lock();
+  SharedColumnarTable*& shared = columnar_tables[group_];
+  if (!shared){
+    shared = new SharedColumnarTable;
+    if (rt){
+      shared->rank = rt->me();
+      shared->nproc = rt->nproc();
+    }
+  }
+  ++shared->num_outputs;
+  columnar_lock.unlock();
+}
+
+void
+StatOutputColumnar::deleteStatics()
+{
+  //write anything left by outputs that never finished
+  for (auto& pair : columnar_tables){
+    SharedColumnarTable* shared = pair.second;
+    if (shared->num_done > 0 && shared->num_done < shared->num_outputs){
+      shared->table.write(shared->filename(pair.first), shared->rank, shared->nproc);
+    }
+    delete shared;
+  }
+  columnar_tables.clear();
+}
+
+void
+StatOutputColumnar::startOutputGroup(StatisticGroup *grp)
+{
+  group_ = grp->name;
+  table_.clear();
+  field_columns_.resize(grp->columns.size());
+  for (auto& pair : grp->columns){
+    field_columns_[pair.first] = table_.column(pair.second);
+  }
+}
+
+void
+StatOutputColumnar::startOutputEntries(StatisticBase *stat)
+{
+  StatisticFieldsOutput::startOutputEntries(stat);
+  table_.addRow(stat->getStatName(), stat->getStatSubId());
+}
+
+void
+StatOutputColumnar::stopOutputGroup()
+{
+  columnar_lock.lock();
+  SharedColumnarTable* shared = columnar_tables[group_];
+  shared->table.append(table_);
+  ++shared->num_done;
+  if (shared->num_done == shared->num_outputs){
+    shared->table.write(shared->filename(group_), shared->rank, shared->nproc);
+    shared->table.clear();
+  }
+  columnar_lock.unlock();
+  table_.clear();
+}
+
+}
+
+#endif
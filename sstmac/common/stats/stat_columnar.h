@@ -0,0 +1,212 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef sstmac_common_stats_STAT_COLUMNAR_H
+#define sstmac_common_stats_STAT_COLUMNAR_H
+
+#include <sstmac/common/stats/stat_collector.h>
+#include <sstmac/common/sstmac_config.h>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#if !SSTMAC_INTEGRATED_SST_CORE
+namespace sstmac {
+
+/**
+ * Statistic fields stored by column, one typed column per field.
+ * Statistics that do not output a field leave its entry absent.
+ */
+class ColumnarTable
+{
+ public:
+  enum type_t {
+    none=0,
+    int32=1,
+    uint32=2,
+    int64=3,
+    uint64=4,
+    float32=5,
+    float64=6
+  };
+
+  /**
+   * @brief column
+   * @return The index of the column with the given name, created if it does not exist
+   */
+  int column(const std::string& name);
+
+  void addRow(const std::string& statName, const std::string& component);
+
+  template <class T> void set(int col, T data, type_t type){
+    Column& c = columns_[col];
+    if (c.type == none){
+      c.type = type;
+    } else if (c.type != type && c.type != float64){
+      promote(c);
+    }
+    if (c.type == float64 && type != float64){
+      double d = data;
+      std::memcpy(&c.values.back(), &d, sizeof(double));
+    } else {
+      std::memcpy(&c.values.back(), &data, sizeof(T));
+    }
+    c.present.back() = 1;
+  }
+
+  /**
+   * @brief append Add the rows of another table, matching columns by name
+   */
+  void append(const ColumnarTable& other);
+
+  void clear();
+
+  uint64_t numRows() const {
+    return stat_names_.size();
+  }
+
+  /**
+   * @brief write
+   * The file is a header - magic SSTCOLS\0, uint32 version, uint32 rank, uint32 nproc,
+   * uint32 number of columns, uint64 number of rows - then the stat name and component
+   * string columns, each as uint64 total bytes, uint32 length of each row, and the characters.
+   * Each field column follows as uint32 name length, name, uint32 type, a bitmap of the rows
+   * that have a value, and the value of every row packed at the width of the type.
+   */
+  void write(const std::string& fname, int rank, int nproc) const;
+
+ private:
+  struct Column {
+    std::string name;
+    type_t type;
+    /** Raw bits of the value of each row, zero if absent */
+    std::vector<uint64_t> values;
+    std::vector<uint8_t> present;
+    Column(const std::string& n) : name(n), type(none) {}
+  };
+
+  /** Convert all values of a column with mixed types to double */
+  static void promote(Column& c);
+
+  static double toDouble(uint64_t bits, type_t type);
+
+  std::vector<std::string> stat_names_;
+  std::vector<std::string> components_;
+  std::vector<Column> columns_;
+  std::map<std::string,int> column_ids_;
+
+};
+
+/**
+ * Writes statistic fields in a binary columnar format instead of formatting text like csv.
+ * The groups of all threads in a process are merged into one file per rank,
+ * <group>.stats or <group>.<rank>.stats with several ranks.
+ * bin/tools/read_stats.py converts these files to csv and merges files from several ranks.
+ */
+class StatOutputColumnar : public StatisticFieldsOutput {
+ public:
+  SST_ELI_REGISTER_DERIVED(
+      StatisticOutput,
+      StatOutputColumnar,
+      "macro",
+      "columnar",
+      SST_ELI_ELEMENT_VERSION(1,0,0),
+      "writes binary columnar output")
+
+  StatOutputColumnar(SST::Params& params);
+
+  void outputField(fieldHandle_t fieldHandle, int32_t data) override {
+    table_.set(fieldColumn(fieldHandle), data, ColumnarTable::int32);
+  }
+
+  void outputField(fieldHandle_t fieldHandle, uint32_t data) override {
+    table_.set(fieldColumn(fieldHandle), data, ColumnarTable::uint32);
+  }
+
+  void outputField(fieldHandle_t fieldHandle, int64_t data) override {
+    table_.set(fieldColumn(fieldHandle), data, ColumnarTable::int64);
+  }
+
+  void outputField(fieldHandle_t fieldHandle, uint64_t data) override {
+    table_.set(fieldColumn(fieldHandle), data, ColumnarTable::uint64);
+  }
+
+  void outputField(fieldHandle_t fieldHandle, float data) override {
+    table_.set(fieldColumn(fieldHandle), data, ColumnarTable::float32);
+  }
+
+  void outputField(fieldHandle_t fieldHandle, double data) override {
+    table_.set(fieldColumn(fieldHandle), data, ColumnarTable::float64);
+  }
+
+  void startOutputGroup(StatisticGroup* grp) override;
+
+  void startOutputEntries(StatisticBase *stat) override;
+
+  void stopOutputGroup() override;
+
+  bool checkOutputParameters() override { return true; }
+  void startOfSimulation() override {}
+  void endOfSimulation() override {}
+  void printUsage() override {}
+
+  static void deleteStatics();
+
+ private:
+  int fieldColumn(fieldHandle_t handle) const {
+    return field_columns_[handle];
+  }
+
+  std::string group_;
+  ColumnarTable table_;
+  /** The table column of each field handle in the active group */
+  std::vector<int> field_columns_;
+
+};
+
+}
+#endif
+
+#endif
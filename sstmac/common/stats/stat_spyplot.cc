@@ -44,16 +44,141 @@ Questions? Contact sst-macro-help@sandia.gov
 
 #include <sstmac/common/stats/stat_spyplot.h>
 #include <sstmac/backends/common/parallel_runtime.h>
+#include <sstmac/common/thread_lock.h>
 #include <sprockit/output.h>
 #include <sprockit/errors.h>
 #include <sprockit/sim_parameters.h>
 #include <sprockit/util.h>
+#include <sprockit/statics.h>
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
 #include <list>
 
 namespace sstmac {
 
 SST_ELI_INSTANTIATE_MULTI_STATISTIC(StatSpyplot,int,uint64_t)
+SST_ELI_INSTANTIATE_MULTI_STATISTIC(StatSparseSpyplot,int,uint64_t)
+
+#if !SSTMAC_INTEGRATED_SST_CORE
+static const char coo_magic[8] = {'S','S','T','S','P','Y','\0','\0'};
+static const uint32_t coo_version = 1;
+
+static sprockit::NeedDeletestatics<SpyplotCOOOutput> del_statics;
+
+static thread_lock coo_lock;
+/** The entries of each group merged across the threads that have finished so far */
+static std::map<std::string, std::vector<SpyplotCOOOutput::Entry>> coo_merged;
+
+SpyplotCOOOutput::SpyplotCOOOutput(SST::Params& params) :
+  sstmac::StatisticOutput(params)
+{
+  binary_ = params.find<bool>("binary", true);
+  ParallelRuntime* rt = ParallelRuntime::staticRuntime(params);
+  if (rt && rt->nproc() > 1){
+    suffix_ = sprockit::sprintf(".%d.coo", rt->me());
+  } else {
+    suffix_ = ".coo";
+  }
+}
+
+void
+SpyplotCOOOutput::deleteStatics()
+{
+  coo_merged.clear();
+}
+
+void
+SpyplotCOOOutput::startOutputGroup(StatisticGroup *grp)
+{
+  active_group_ = grp->name;
+  entries_.clear();
+}
+
+void
+SpyplotCOOOutput::output(StatisticBase *statistic, bool  /*endOfSimFlag*/)
+{
+  auto* spy = dynamic_cast<StatSparseSpyplot<int,uint64_t>*>(statistic);
+  if (!spy){
+    spkt_abort_printf("SpyplotCOOOutput can only be used with sparse_spyplot statistic, got %s",
+                      statistic->name().c_str());
+  }
+  if (spy->row() < 0){
+    spkt_abort_printf("sparse_spyplot %s.%s was never given a row",
+                      statistic->name().c_str(), statistic->getStatSubId().c_str());
+  }
+
+  for (auto& pair : spy->entries()){
+    entries_.push_back({spy->row(), pair.first, pair.second});
+  }
+}
+
+void
+SpyplotCOOOutput::stopOutputGroup()
+{
+  auto less = [](const Entry& l, const Entry& r){
+    return l.row != r.row ? l.row < r.row : l.col < r.col;
+  };
+  std::sort(entries_.begin(), entries_.end(), less);
+
+  //each thread owns a disjoint set of rows, but merge duplicates anyway
+  //in case several components collect for the same source
+  coo_lock.lock();
+  std::vector<Entry>& prev = coo_merged[active_group_];
+  std::vector<Entry> merged;
+  merged.reserve(prev.size() + entries_.size());
+  std::merge(prev.begin(), prev.end(), entries_.begin(), entries_.end(),
+             std::back_inserter(merged), less);
+  prev.clear();
+  for (const Entry& e : merged){
+    if (!prev.empty() && prev.back().row == e.row && prev.back().col == e.col){
+      prev.back().count += e.count;
+    } else {
+      prev.push_back(e);
+    }
+  }
+  //rewrite the file with every thread merged so far - the last thread to finish leaves the full matrix
+  write(active_group_ + suffix_, prev);
+  coo_lock.unlock();
+
+  entries_.clear();
+}
+
+void
+SpyplotCOOOutput::write(const std::string& fname, const std::vector<Entry>& entries)
+{
+  if (binary_){
+    FILE* f = fopen(fname.c_str(), "wb");
+    if (!f){
+      spkt_abort_printf("SpyplotCOOOutput: failed to open %s: %s",
+                        fname.c_str(), ::strerror(errno));
+    }
+    uint32_t entry_size = 2*sizeof(int32_t) + sizeof(uint64_t);
+    uint64_t num_entries = entries.size();
+    bool ok = fwrite(coo_magic, sizeof(coo_magic), 1, f) == 1
+        && fwrite(&coo_version, sizeof(coo_version), 1, f) == 1
+        && fwrite(&entry_size, sizeof(entry_size), 1, f) == 1
+        && fwrite(&num_entries, sizeof(num_entries), 1, f) == 1;
+    for (const Entry& e : entries){
+      if (!ok) break;
+      ok = fwrite(&e.row, sizeof(e.row), 1, f) == 1
+        && fwrite(&e.col, sizeof(e.col), 1, f) == 1
+        && fwrite(&e.count, sizeof(e.count), 1, f) == 1;
+    }
+    if (fclose(f) != 0 || !ok){
+      spkt_abort_printf("SpyplotCOOOutput: failed writing %s", fname.c_str());
+    }
+  } else {
+    std::ofstream out(fname.c_str());
+    out << "row,col,count\n";
+    for (const Entry& e : entries){
+      out << e.row << "," << e.col << "," << e.count << "\n";
+    }
+  }
+}
+#endif
 
 
 } //end namespace
@@ -48,7 +48,9 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/common/event_scheduler.h>
 #include <sstmac/common/stats/stat_collector.h>
 #include <sstmac/common/timestamp.h>
+#include <sstmac/common/sstmac_config.h>
 #include <sprockit/sim_parameters.h>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <map>
@@ -76,7 +78,8 @@ class StatSpyplot : public SST::Statistics::MultiStatistic<Dst,Count>
 
   StatSpyplot(SST::BaseComponent* comp, const std::string& name,
               const std::string& statName, SST::Params& params)
-    : SST::Statistics::MultiStatistic<Dst,Count>(comp, name, statName, params)
+    : SST::Statistics::MultiStatistic<Dst,Count>(comp, name, statName, params),
+    row_(-1)
   {
     n_dst_ = params.find<Dst>("ncols");
     vals_.resize(n_dst_);
@@ -85,6 +88,17 @@ class StatSpyplot : public SST::Statistics::MultiStatistic<Dst,Count>
 
   ~StatSpyplot() override {}
 
+  /**
+   * @brief setRow Set the source (row of the traffic matrix) this statistic collects for
+   */
+  void setRow(int row){
+    row_ = row;
+  }
+
+  int row() const {
+    return row_;
+  }
+
   void addData_impl(int dest, uint64_t num) override {
     vals_[dest] += num;
   }
@@ -103,12 +117,146 @@ class StatSpyplot : public SST::Statistics::MultiStatistic<Dst,Count>
   }
 
  protected:
+  /** For subclasses that do not keep a dense row */
+  StatSpyplot(SST::BaseComponent* comp, const std::string& name,
+              const std::string& statName, SST::Params& params, bool  /*dense*/)
+    : SST::Statistics::MultiStatistic<Dst,Count>(comp, name, statName, params),
+    n_dst_(0), row_(-1)
+  {
+  }
+
   std::vector<Count> vals_;
   Dst n_dst_;
+  int row_;
   std::vector<SST::Statistics::StatisticOutput::fieldHandle_t> fields_;
 
 };
 
+/**
+ * this stat_collector class keeps a spy plot with only the nonzero entries of its row,
+ * so that the memory and output scale with the traffic rather than the number of destinations
+ */
+template <class Dst, class Count>
+class StatSparseSpyplot : public StatSpyplot<Dst,Count>
+{
+ public:
+  SST_ELI_DECLARE_STATISTIC_TEMPLATE(
+    StatSparseSpyplot,
+    "macro",
+    "sparse_spyplot",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "spyplot storing only the nonzero entries of the traffic matrix",
+    "Statistic<Src,Dst,Count>")
+
+  StatSparseSpyplot(SST::BaseComponent* comp, const std::string& name,
+                    const std::string& statName, SST::Params& params)
+    : StatSpyplot<Dst,Count>(comp, name, statName, params, false)
+  {
+  }
+
+  ~StatSparseSpyplot() override {}
+
+  void addData_impl(int dest, uint64_t num) override {
+    nonzeros_[dest] += num;
+  }
+
+  size_t numNonzeros() const {
+    return nonzeros_.size();
+  }
+
+  /**
+   * @brief entries
+   * @return The nonzero (destination,count) pairs of this row sorted by destination
+   */
+  std::vector<std::pair<Dst,Count>> entries() const {
+    std::vector<std::pair<Dst,Count>> ret(nonzeros_.begin(), nonzeros_.end());
+    std::sort(ret.begin(), ret.end());
+    return ret;
+  }
+
+  /**
+   * A sparse row has no fixed set of columns, so field outputs like csv
+   * only get a per-row summary. Use the coo output for the full matrix.
+   */
+  void registerOutputFields(SST::Statistics::StatisticFieldsOutput* output) override {
+    row_field_ = output->registerField<int32_t>("row");
+    nnz_field_ = output->registerField<uint64_t>("nnz");
+    total_field_ = output->registerField<uint64_t>("total");
+  }
+
+  void outputStatisticFields(SST::Statistics::StatisticFieldsOutput* output, bool  /*endOfSim*/) override {
+    uint64_t total = 0;
+    for (auto& pair : nonzeros_){
+      total += pair.second;
+    }
+    output->outputField(row_field_, int32_t(this->row_));
+    output->outputField(nnz_field_, uint64_t(nonzeros_.size()));
+    output->outputField(total_field_, total);
+  }
+
+ private:
+  std::unordered_map<Dst,Count> nonzeros_;
+  SST::Statistics::StatisticOutput::fieldHandle_t row_field_;
+  SST::Statistics::StatisticOutput::fieldHandle_t nnz_field_;
+  SST::Statistics::StatisticOutput::fieldHandle_t total_field_;
+
+};
+
+#if !SSTMAC_INTEGRATED_SST_CORE
+/**
+ * Writes the sparse spyplots of a group as a single traffic matrix in coordinate format.
+ * The rows collected by every thread in the process are merged into one file <group>.coo,
+ * or <group>.<rank>.coo when there are several ranks.
+ * The binary file has a header (magic SSTSPY\0\0, uint32 version, uint32 entry size,
+ * uint64 number of entries) followed by (int32 row, int32 col, uint64 count) entries
+ * sorted by row and column. With binary = false, the entries are written as text lines.
+ */
+class SpyplotCOOOutput : public sstmac::StatisticOutput
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    SST::Statistics::StatisticOutput,
+    SpyplotCOOOutput,
+    "macro",
+    "coo",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "Writes sparse spyplots as a coordinate-format traffic matrix")
+
+  struct Entry {
+    int32_t row;
+    int32_t col;
+    uint64_t count;
+  };
+
+  SpyplotCOOOutput(SST::Params& params);
+
+  ~SpyplotCOOOutput() override{}
+
+  void registerStatistic(SST::Statistics::StatisticBase*) override {}
+
+  void startOutputGroup(SST::Statistics::StatisticGroup * grp) override;
+  void stopOutputGroup() override;
+
+  void output(SST::Statistics::StatisticBase* statistic, bool endOfSimFlag) override;
+
+  bool checkOutputParameters() override { return true; }
+  void startOfSimulation() override {}
+  void endOfSimulation() override {}
+  void printUsage() override {}
+
+  static void deleteStatics();
+
+ private:
+  void write(const std::string& fname, const std::vector<Entry>& entries);
+
+  std::string active_group_;
+  std::vector<Entry> entries_;
+  std::string suffix_;
+  bool binary_;
+
+};
+#endif
+
 
 }
 
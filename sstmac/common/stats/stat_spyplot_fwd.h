@@ -48,6 +48,7 @@ Questions? Contact sst-macro-help@sandia.gov
 namespace sstmac {
 
 template <class Dst, class Count> class StatSpyplot;
+template <class Dst, class Count> class StatSparseSpyplot;
 
 }
 
@@ -0,0 +1,469 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/dumpi_util/dumpi_reader.h>
+#include <sprockit/sim_parameters.h>
+#include <sprockit/keyword_registration.h>
+#include <sprockit/statics.h>
+#include <sprockit/errors.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+RegisterDebugSlot(dumpi_reader, "print the file and read-ahead statistics of DUMPI trace streams");
+
+RegisterKeywords(
+{ "dumpi_read_batch_size", "the number of bytes of a DUMPI trace file read at once for a rank" },
+{ "dumpi_max_open_files", "the maximum number of DUMPI trace files kept open at once" },
+{ "dumpi_prefetch", "whether a helper thread reads the next batch of each DUMPI stream ahead of the rank" },
+);
+
+namespace sstmac {
+namespace sw {
+
+static sprockit::NeedDeletestatics<DumpiReader> del_statics;
+
+static pthread_mutex_t dumpi_reader_init_lock = PTHREAD_MUTEX_INITIALIZER;
+
+DumpiReader* DumpiReader::reader_ = nullptr;
+
+struct DumpiReader::Stream {
+  enum prefetch_state_t {
+    no_prefetch,
+    prefetch_queued,
+    prefetch_running,
+    prefetch_ready
+  };
+
+  DumpiReader* reader;
+  std::string fname;
+  long size;
+  long pos;
+
+  int fd;
+  int pins;
+  std::list<Stream*>::iterator lru;
+
+  std::vector<char> buf;
+  long buf_offset;
+  size_t buf_len;
+
+  std::vector<char> next;
+  long next_offset;
+  size_t next_len;
+  prefetch_state_t next_state;
+};
+
+DumpiReader*
+DumpiReader::get(SST::Params& params)
+{
+  pthread_mutex_lock(&dumpi_reader_init_lock);
+  if (!reader_){
+    reader_ = new DumpiReader(params);
+  }
+  pthread_mutex_unlock(&dumpi_reader_init_lock);
+  return reader_;
+}
+
+void
+DumpiReader::deleteStatics()
+{
+  if (reader_ && sprockit::Debug::slotActive(sprockit::dbg::dumpi_reader)){
+    reader_->printStats(std::cout);
+  }
+  delete reader_;
+  reader_ = nullptr;
+}
+
+DumpiReader::DumpiReader(SST::Params& params) :
+  num_open_(0),
+  stop_prefetch_(false),
+  bytes_read_(0),
+  batches_read_(0),
+  files_opened_(0),
+  files_evicted_(0),
+  prefetch_hits_(0),
+  prefetch_waits_(0),
+  read_seconds_(0)
+{
+  batch_size_ = params.find<SST::UnitAlgebra>("dumpi_read_batch_size", "64KB").getRoundedValue();
+  max_open_files_ = params.find<int>("dumpi_max_open_files", 256);
+  prefetch_ = params.find<bool>("dumpi_prefetch", false);
+  if (batch_size_ == 0){
+    spkt_abort_printf("dumpi_read_batch_size must be positive");
+  }
+  if (max_open_files_ < 1){
+    spkt_abort_printf("dumpi_max_open_files must be at least 1, got %d", max_open_files_);
+  }
+
+  pthread_mutex_init(&lock_, nullptr);
+  pthread_cond_init(&cond_, nullptr);
+  if (prefetch_){
+    int rc = pthread_create(&prefetch_thread_, nullptr, runPrefetchThread, this);
+    if (rc != 0){
+      spkt_abort_printf("failed creating DUMPI prefetch thread: %s", ::strerror(rc));
+    }
+  }
+}
+
+DumpiReader::~DumpiReader()
+{
+  if (prefetch_){
+    pthread_mutex_lock(&lock_);
+    stop_prefetch_ = true;
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&lock_);
+    pthread_join(prefetch_thread_, nullptr);
+  }
+  for (Stream* s : open_lru_){
+    ::close(s->fd);
+    s->fd = -1;
+  }
+  pthread_mutex_destroy(&lock_);
+  pthread_cond_destroy(&cond_);
+}
+
+FILE*
+DumpiReader::open(const std::string& fname, long offset)
+{
+  struct stat st;
+  if (::stat(fname.c_str(), &st) != 0){
+    spkt_throw_printf(sprockit::IOError,
+      "DumpiReader: unable to stat %s: %s",
+      fname.c_str(), ::strerror(errno));
+  }
+
+  Stream* s = new Stream;
+  s->reader = this;
+  s->fname = fname;
+  s->size = st.st_size;
+  s->pos = offset;
+  s->fd = -1;
+  s->pins = 0;
+  s->buf_offset = offset;
+  s->buf_len = 0;
+  s->next_offset = 0;
+  s->next_len = 0;
+  s->next_state = Stream::no_prefetch;
+
+#ifdef __APPLE__
+  FILE* f = funopen(s,
+    [](void* cookie, char* buf, int size) -> int {
+      return readStream(cookie, buf, size);
+    },
+    nullptr,
+    [](void* cookie, fpos_t offset, int whence) -> fpos_t {
+      int64_t off = offset;
+      return seekStream(cookie, &off, whence) == 0 ? off : -1;
+    },
+    [](void* cookie){
+      return closeStream(cookie);
+    });
+#else
+  cookie_io_functions_t io;
+  io.read = [](void* cookie, char* buf, size_t size){
+    return readStream(cookie, buf, size);
+  };
+  io.write = nullptr;
+  io.seek = [](void* cookie, off64_t* offset, int whence){
+    int64_t off = *offset;
+    int rc = seekStream(cookie, &off, whence);
+    *offset = off;
+    return rc;
+  };
+  io.close = [](void* cookie){
+    return closeStream(cookie);
+  };
+  FILE* f = fopencookie(s, "r", io);
+#endif
+  if (!f){
+    delete s;
+    spkt_throw_printf(sprockit::IOError,
+      "DumpiReader: unable to create stream for %s", fname.c_str());
+  }
+  return f;
+}
+
+ssize_t
+DumpiReader::readStream(void* cookie, char* buf, size_t size)
+{
+  Stream* s = (Stream*) cookie;
+  size_t done = 0;
+  while (done < size && s->pos < s->size){
+    if (s->pos < s->buf_offset || s->pos >= s->buf_offset + long(s->buf_len)){
+      s->reader->refill(s);
+    }
+    size_t avail = s->buf_offset + s->buf_len - s->pos;
+    size_t n = std::min(avail, size - done);
+    ::memcpy(buf + done, s->buf.data() + (s->pos - s->buf_offset), n);
+    done += n;
+    s->pos += n;
+  }
+  return done;
+}
+
+int
+DumpiReader::seekStream(void* cookie, int64_t* offset, int whence)
+{
+  Stream* s = (Stream*) cookie;
+  int64_t base = 0;
+  switch (whence){
+    case SEEK_SET: base = 0; break;
+    case SEEK_CUR: base = s->pos; break;
+    case SEEK_END: base = s->size; break;
+    default: return -1;
+  }
+  int64_t pos = base + *offset;
+  if (pos < 0){
+    return -1;
+  }
+  //the buffer stays valid, readStream only refills once pos leaves it
+  s->pos = pos;
+  *offset = pos;
+  return 0;
+}
+
+int
+DumpiReader::closeStream(void* cookie)
+{
+  Stream* s = (Stream*) cookie;
+  DumpiReader* r = s->reader;
+  pthread_mutex_lock(&r->lock_);
+  r->waitPrefetch(s);
+  if (s->fd >= 0){
+    ::close(s->fd);
+    r->open_lru_.erase(s->lru);
+    --r->num_open_;
+  }
+  pthread_mutex_unlock(&r->lock_);
+  delete s;
+  return 0;
+}
+
+void
+DumpiReader::waitPrefetch(Stream* s)
+{
+  if (s->next_state == Stream::prefetch_queued){
+    //not started yet, just drop it
+    auto iter = std::find(prefetch_queue_.begin(), prefetch_queue_.end(), s);
+    prefetch_queue_.erase(iter);
+    s->next_state = Stream::no_prefetch;
+  } else if (s->next_state == Stream::prefetch_running){
+    ++prefetch_waits_;
+    while (s->next_state == Stream::prefetch_running){
+      pthread_cond_wait(&cond_, &lock_);
+    }
+  }
+}
+
+void
+DumpiReader::refill(Stream* s)
+{
+  long offset = s->pos;
+  bool hit = false;
+  if (prefetch_){
+    pthread_mutex_lock(&lock_);
+    waitPrefetch(s);
+    if (s->next_state == Stream::prefetch_ready){
+      if (s->next_offset == offset){
+        std::swap(s->buf, s->next);
+        s->buf_offset = s->next_offset;
+        s->buf_len = s->next_len;
+        ++prefetch_hits_;
+        hit = true;
+      }
+      s->next_state = Stream::no_prefetch;
+    }
+    pthread_mutex_unlock(&lock_);
+  }
+
+  if (!hit){
+    s->buf_len = readBatch(s, offset, s->buf);
+    s->buf_offset = offset;
+  }
+
+  long next_offset = s->buf_offset + s->buf_len;
+  if (prefetch_ && next_offset < s->size){
+    pthread_mutex_lock(&lock_);
+    s->next_offset = next_offset;
+    s->next_state = Stream::prefetch_queued;
+    prefetch_queue_.push_back(s);
+    pthread_cond_broadcast(&cond_);
+    pthread_mutex_unlock(&lock_);
+  }
+}
+
+size_t
+DumpiReader::readBatch(Stream* s, long offset, std::vector<char>& dst)
+{
+  size_t len = std::min<long>(batch_size_, s->size - offset);
+  dst.resize(batch_size_);
+
+  auto start = std::chrono::steady_clock::now();
+  int fd = acquireFd(s);
+  size_t done = 0;
+  while (done < len){
+    ssize_t rc = ::pread(fd, dst.data() + done, len - done, offset + done);
+    if (rc < 0 && errno == EINTR){
+      continue;
+    } else if (rc < 0){
+      spkt_abort_printf("DumpiReader: failed reading %s at offset %ld: %s",
+                        s->fname.c_str(), offset + done, ::strerror(errno));
+    } else if (rc == 0){
+      spkt_abort_printf("DumpiReader: %s was truncated at offset %ld",
+                        s->fname.c_str(), offset + done);
+    }
+    done += rc;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  pthread_mutex_lock(&lock_);
+  --s->pins;
+  bytes_read_ += len;
+  ++batches_read_;
+  read_seconds_ += elapsed.count();
+  pthread_mutex_unlock(&lock_);
+  return len;
+}
+
+int
+DumpiReader::acquireFd(Stream* s)
+{
+  pthread_mutex_lock(&lock_);
+  if (s->fd >= 0){
+    open_lru_.splice(open_lru_.begin(), open_lru_, s->lru);
+    ++s->pins;
+    pthread_mutex_unlock(&lock_);
+    return s->fd;
+  }
+
+  if (num_open_ >= max_open_files_){
+    //close the least recently used file that nobody is reading,
+    //if every file is being read this open goes over the limit for a moment
+    for (auto iter = open_lru_.rbegin(); iter != open_lru_.rend(); ++iter){
+      Stream* victim = *iter;
+      if (victim->pins == 0){
+        ::close(victim->fd);
+        victim->fd = -1;
+        open_lru_.erase(victim->lru);
+        --num_open_;
+        ++files_evicted_;
+        break;
+      }
+    }
+  }
+
+  s->fd = ::open(s->fname.c_str(), O_RDONLY);
+  if (s->fd < 0){
+    int err = errno;
+    int num_open = num_open_;
+    pthread_mutex_unlock(&lock_);
+    spkt_abort_printf("DumpiReader: unable to open %s with %d files open: %s",
+                      s->fname.c_str(), num_open, ::strerror(err));
+  }
+  open_lru_.push_front(s);
+  s->lru = open_lru_.begin();
+  ++num_open_;
+  ++files_opened_;
+  ++s->pins;
+  pthread_mutex_unlock(&lock_);
+  return s->fd;
+}
+
+void*
+DumpiReader::runPrefetchThread(void* reader)
+{
+  ((DumpiReader*)reader)->prefetchLoop();
+  return nullptr;
+}
+
+void
+DumpiReader::prefetchLoop()
+{
+  pthread_mutex_lock(&lock_);
+  while (!stop_prefetch_){
+    if (prefetch_queue_.empty()){
+      pthread_cond_wait(&cond_, &lock_);
+      continue;
+    }
+    Stream* s = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    s->next_state = Stream::prefetch_running;
+    pthread_mutex_unlock(&lock_);
+
+    size_t len = readBatch(s, s->next_offset, s->next);
+
+    pthread_mutex_lock(&lock_);
+    s->next_len = len;
+    s->next_state = Stream::prefetch_ready;
+    pthread_cond_broadcast(&cond_);
+  }
+  pthread_mutex_unlock(&lock_);
+}
+
+void
+DumpiReader::printStats(std::ostream& os)
+{
+  pthread_mutex_lock(&lock_);
+  double mb = bytes_read_ / 1e6;
+  os << "DUMPI reader: read " << mb << " MB in " << batches_read_ << " batches"
+     << " at " << (read_seconds_ > 0 ? mb / read_seconds_ : 0.) << " MB/s\n"
+     << "DUMPI reader: " << files_opened_ << " file opens, "
+     << files_evicted_ << " evictions, "
+     << num_open_ << " files still open\n";
+  if (prefetch_){
+    os << "DUMPI reader: " << prefetch_hits_ << " prefetch hits, "
+       << prefetch_waits_ << " waits on a running prefetch\n";
+  }
+  pthread_mutex_unlock(&lock_);
+}
+
+}
+}
@@ -0,0 +1,155 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_DUMPI_UTIL_DUMPI_READER_H
+#define SSTMAC_DUMPI_UTIL_DUMPI_READER_H
+
+#include <sprockit/sim_parameters_fwd.h>
+#include <sprockit/debug.h>
+
+#include <pthread.h>
+#include <cstdio>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+DeclareDebugSlot(dumpi_reader);
+
+namespace sstmac {
+namespace sw {
+
+/**
+ * Serves the per-rank .bin files of a DUMPI trace to libundumpi.
+ * The FILE handles it returns hold no file descriptor. Data is read in large
+ * batches into a per-stream buffer, descriptors are only borrowed from a bounded
+ * LRU pool while a batch is read, and a closed file is resumed at the
+ * offset of the next batch. The next batch of a stream can optionally be
+ * prefetched by a helper thread while the rank replays the current one.
+ */
+class DumpiReader
+{
+ public:
+  /**
+   * @brief get The reader shared by all ranks in this process
+   * @param params The app params, only used by the first call
+   */
+  static DumpiReader* get(SST::Params& params);
+
+  /**
+   * @brief open
+   * @param fname The trace file
+   * @param offset The position of the returned stream
+   * @return A read-only stream, released with fclose
+   */
+  FILE* open(const std::string& fname, long offset);
+
+  void printStats(std::ostream& os);
+
+  static void deleteStatics();
+
+  ~DumpiReader();
+
+ private:
+  struct Stream;
+
+  DumpiReader(SST::Params& params);
+
+  static ssize_t readStream(void* cookie, char* buf, size_t size);
+
+  static int seekStream(void* cookie, int64_t* offset, int whence);
+
+  static int closeStream(void* cookie);
+
+  static void* runPrefetchThread(void* reader);
+
+  void prefetchLoop();
+
+  /**
+   * @brief refill Make the batch starting at the stream position the current buffer
+   */
+  void refill(Stream* s);
+
+  /** Read one batch, borrowing a descriptor from the pool */
+  size_t readBatch(Stream* s, long offset, std::vector<char>& dst);
+
+  int acquireFd(Stream* s);
+
+  /** Wait for an outstanding prefetch of the stream to land, with the lock held */
+  void waitPrefetch(Stream* s);
+
+  static DumpiReader* reader_;
+
+  size_t batch_size_;
+  int max_open_files_;
+  bool prefetch_;
+
+  /** Protects the descriptor pool, the prefetch queue and the stats */
+  pthread_mutex_t lock_;
+  pthread_cond_t cond_;
+
+  /** Streams holding an open descriptor, least recently used at the back */
+  std::list<Stream*> open_lru_;
+  int num_open_;
+
+  std::deque<Stream*> prefetch_queue_;
+  pthread_t prefetch_thread_;
+  bool stop_prefetch_;
+
+  uint64_t bytes_read_;
+  uint64_t batches_read_;
+  uint64_t files_opened_;
+  uint64_t files_evicted_;
+  uint64_t prefetch_hits_;
+  uint64_t prefetch_waits_;
+  double read_seconds_;
+
+};
+
+}
+}
+
+#endif
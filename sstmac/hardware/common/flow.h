@@ -50,11 +50,17 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/common/node_address.h>
 #include <sstmac/common/request.h>
 #include <sprockit/printable.h>
+#include <sprockit/thread_safe_new.h>
 
 
 namespace sstmac {
 
-class Flow : public Request
+/**
+ * Flows and the messages derived from them are pooled, each size in its own slab class
+ */
+class Flow :
+  public Request,
+  public sprockit::thread_safe_new<Flow>
 {
  public:
   /**
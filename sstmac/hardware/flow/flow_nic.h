@@ -0,0 +1,106 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_HARDWARE_FLOW_FLOW_NIC_H_INCLUDED
+#define SSTMAC_HARDWARE_FLOW_FLOW_NIC_H_INCLUDED
+
+#include <sstmac/hardware/nic/nic.h>
+
+namespace sstmac {
+namespace hw {
+
+/**
+ * @brief A NIC that hands every message to the flow switch on its thread.
+ *        Injection bandwidth is modeled by the flow switch as the first link of each flow,
+ *        and the injection ack arrives when the flow finishes.
+ */
+class FlowNIC :
+  public NIC
+{
+ public:
+#if SSTMAC_INTEGRATED_SST_CORE
+  SST_ELI_REGISTER_SUBCOMPONENT_DERIVED(
+    FlowNIC,
+    "macro",
+    "flow_nic",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "implements a nic that injects messages as flows into a flow-level network model",
+    sstmac::hw::NIC)
+#else
+  SST_ELI_REGISTER_DERIVED(
+    NIC,
+    FlowNIC,
+    "macro",
+    "flow",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "implements a nic that injects messages as flows into a flow-level network model")
+#endif
+
+  FlowNIC(uint32_t id, SST::Params& params, Node* parent);
+
+  void connectOutput(int src_outport, int dst_inport, EventLink::ptr&& link) override;
+
+  void connectInput(int src_outport, int dst_inport, EventLink::ptr&& link) override;
+
+  void dropEvent(Event*){}
+
+  std::string toString() const override {
+    return "flow nic";
+  }
+
+  LinkHandler* creditHandler(int  /*port*/) override {
+    return newLinkHandler(this, &FlowNIC::dropEvent);
+  }
+
+  LinkHandler* payloadHandler(int port) override;
+
+ protected:
+  void doSend(NetworkMessage* msg) override;
+
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,392 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/hardware/flow/flow_switch.h>
+#include <sstmac/hardware/topology/topology.h>
+#include <sstmac/hardware/network/network_message.h>
+#include <sstmac/hardware/nic/nic.h>
+#include <sstmac/common/event_callback.h>
+#include <sprockit/util.h>
+#include <sprockit/sim_parameters.h>
+#include <sprockit/keyword_registration.h>
+
+#include <deque>
+#include <functional>
+#include <queue>
+
+RegisterKeywords(
+{ "injection_bandwidth", "the bandwidth of the injection and ejection links of each node" },
+{ "injection_latency", "the latency of injecting a flow into the network" },
+{ "negligible_size", "messages up to this size bypass the flow model" },
+);
+
+MakeDebugSlot(flow)
+
+#define flow_debug(...) \
+  debug_printf(sprockit::dbg::flow, "flow switch %d: %s", \
+    int(componentId()), sprockit::sprintf(__VA_ARGS__).c_str())
+
+namespace sstmac {
+namespace hw {
+
+FlowSwitch::FlowSwitch(uint32_t cid, SST::Params& params) :
+  LogPSwitch(cid, params),
+  visit_(0)
+{
+  SST::Params link_params = params.get_scoped_params("link");
+  double link_bw = link_params.contains("bandwidth")
+      ? link_params.find<SST::UnitAlgebra>("bandwidth").getValue().toDouble()
+      : params.find<SST::UnitAlgebra>("bandwidth").getValue().toDouble();
+  link_latency_ = link_params.contains("latency")
+      ? TimeDelta(link_params.find<SST::UnitAlgebra>("latency").getValue().toDouble())
+      : hop_latency_;
+  double inj_bw = params.contains("injection_bandwidth")
+      ? params.find<SST::UnitAlgebra>("injection_bandwidth").getValue().toDouble()
+      : link_bw;
+  injection_latency_ = TimeDelta(params.find<SST::UnitAlgebra>("injection_latency", "0ns").getValue().toDouble());
+  negligible_size_ = params.find<int>("negligible_size", 256);
+
+  num_nodes_ = top_->numNodes();
+  int num_switches = top_->numSwitches();
+  links_.resize(2 * num_nodes_);
+  for (Link& link : links_){
+    link.bandwidth = inj_bw;
+  }
+
+  std::vector<Topology::Connection> conns;
+  std::vector<uint32_t> in_degree(num_switches, 0);
+  adjacency_offsets_.push_back(0);
+  for (int sw=0; sw < num_switches; ++sw){
+    top_->connectedOutports(sw, conns);
+    for (Topology::Connection& conn : conns){
+      Link link;
+      link.bandwidth = link_bw * top_->portScaleFactor(sw, conn.src_outport);
+      links_.push_back(link);
+      adjacency_dst_.push_back(conn.dst);
+      in_degree[conn.dst]++;
+    }
+    adjacency_offsets_.push_back(adjacency_dst_.size());
+  }
+
+  reverse_offsets_.resize(num_switches + 1, 0);
+  for (int sw=0; sw < num_switches; ++sw){
+    reverse_offsets_[sw+1] = reverse_offsets_[sw] + in_degree[sw];
+  }
+  reverse_src_.resize(adjacency_dst_.size());
+  std::vector<uint32_t> fill(reverse_offsets_.begin(), reverse_offsets_.end() - 1);
+  for (int sw=0; sw < num_switches; ++sw){
+    for (uint32_t i=adjacency_offsets_[sw]; i < adjacency_offsets_[sw+1]; ++i){
+      reverse_src_[fill[adjacency_dst_[i]]++] = sw;
+    }
+  }
+  distances_.resize(num_switches);
+
+  for (Link& link : links_){
+    link.residual = 0;
+    link.unfrozen = 0;
+    link.version = 0;
+    link.visit = 0;
+  }
+}
+
+const std::vector<uint16_t>&
+FlowSwitch::distancesTo(SwitchId dst)
+{
+  std::vector<uint16_t>& dist = distances_[dst];
+  if (!dist.empty()){
+    return dist;
+  }
+
+  static const uint16_t unreachable = uint16_t(-1);
+  dist.resize(distances_.size(), unreachable);
+  dist[dst] = 0;
+  std::deque<SwitchId> queue(1, dst);
+  while (!queue.empty()){
+    SwitchId sw = queue.front();
+    queue.pop_front();
+    for (uint32_t i=reverse_offsets_[sw]; i < reverse_offsets_[sw+1]; ++i){
+      SwitchId prev = reverse_src_[i];
+      if (dist[prev] == unreachable){
+        dist[prev] = dist[sw] + 1;
+        queue.push_back(prev);
+      }
+    }
+  }
+  return dist;
+}
+
+void
+FlowSwitch::routeFlow(NodeId src, NodeId dst, std::vector<uint32_t>& links)
+{
+  links.clear();
+  links.push_back(injectionLink(src));
+
+  SwitchId sw = top_->endpointToSwitch(src);
+  SwitchId dst_sw = top_->endpointToSwitch(dst);
+  const std::vector<uint16_t>& dist = distancesTo(dst_sw);
+  if (dist[sw] == uint16_t(-1)){
+    spkt_abort_printf("flow switch: no path from node %d to node %d", int(src), int(dst));
+  }
+
+  //spread node pairs over equal-cost next hops, like a static hash-based router
+  uint64_t hash = (uint64_t(src) << 32 | dst) * 0x9E3779B97F4A7C15ULL;
+  while (sw != dst_sw){
+    uint32_t num_choices = 0;
+    for (uint32_t i=adjacency_offsets_[sw]; i < adjacency_offsets_[sw+1]; ++i){
+      if (dist[adjacency_dst_[i]] + 1 == dist[sw]) ++num_choices;
+    }
+    uint32_t choice = (hash >> 32) % num_choices;
+    hash = hash * 0x9E3779B97F4A7C15ULL + 1;
+    for (uint32_t i=adjacency_offsets_[sw]; i < adjacency_offsets_[sw+1]; ++i){
+      if (dist[adjacency_dst_[i]] + 1 == dist[sw] && choice-- == 0){
+        links.push_back(2 * num_nodes_ + i);
+        sw = adjacency_dst_[i];
+        break;
+      }
+    }
+  }
+  links.push_back(ejectionLink(dst));
+}
+
+void
+FlowSwitch::startFlow(Event* ev)
+{
+  NicEvent* nev = static_cast<NicEvent*>(ev);
+  NetworkMessage* msg = nev->msg();
+  delete nev;
+
+  if (msg->byteLength() <= uint64_t(negligible_size_)){
+    //the NIC already acked this, give it a simple latency/bandwidth delay
+    send(now(), msg);
+    return;
+  }
+
+  uint32_t fid;
+  if (free_flows_.empty()){
+    fid = flows_.size();
+    flows_.emplace_back();
+  } else {
+    fid = free_flows_.back();
+    free_flows_.pop_back();
+  }
+
+  FluidFlow& flow = flows_[fid];
+  flow.msg = msg;
+  routeFlow(msg->fromaddr(), msg->toaddr(), flow.links);
+  flow.remaining = msg->byteLength();
+  flow.rate = 0;
+  flow.new_rate = 0;
+  flow.last_update = now();
+  flow.latency = injection_latency_ + link_latency_ * double(flow.links.size() - 1);
+  flow.visit = 0;
+  flow.scheduled = false;
+  for (uint32_t lid : flow.links){
+    links_[lid].flows.push_back(fid);
+  }
+
+  flow_debug("starting flow %u for %s over %d links",
+             fid, msg->toString().c_str(), int(flow.links.size()));
+
+  reallocate(flow.links);
+  scheduleWakeup();
+}
+
+void
+FlowSwitch::finishFlows()
+{
+  Timestamp now_ = now();
+  auto iter = wakeups_.find(now_);
+  if (iter != wakeups_.end()){
+    wakeups_.erase(iter);
+  }
+
+  std::vector<uint32_t> seeds;
+  while (!finish_order_.empty() && finish_order_.begin()->first <= now_){
+    uint32_t fid = finish_order_.begin()->second;
+    finish_order_.erase(finish_order_.begin());
+    FluidFlow& flow = flows_[fid];
+    for (uint32_t lid : flow.links){
+      std::vector<uint32_t>& link_flows = links_[lid].flows;
+      for (uint32_t i=0; i < link_flows.size(); ++i){
+        if (link_flows[i] == fid){
+          link_flows[i] = link_flows.back();
+          link_flows.pop_back();
+          break;
+        }
+      }
+      if (!link_flows.empty()){
+        seeds.push_back(lid);
+      }
+    }
+
+    NetworkMessage* msg = flow.msg;
+    flow_debug("finished flow %u for %s", fid, msg->toString().c_str());
+    if (msg->needsAck()){
+      nic_links_[msg->fromaddr()]->send(new NicEvent(msg->cloneInjectionAck()));
+    }
+    //the link to the NIC already carries the out-in latency
+    TimeDelta delay = flow.latency > out_in_lat_ ? flow.latency - out_in_lat_ : TimeDelta();
+    nic_links_[msg->toaddr()]->send(delay, new NicEvent(msg));
+
+    flow.msg = nullptr;
+    flow.links.clear();
+    free_flows_.push_back(fid);
+  }
+
+  if (!seeds.empty()){
+    reallocate(seeds);
+  }
+  scheduleWakeup();
+}
+
+void
+FlowSwitch::scheduleWakeup()
+{
+  if (finish_order_.empty()) return;
+
+  Timestamp next = finish_order_.begin()->first;
+  if (wakeups_.empty() || next < *wakeups_.begin()){
+    wakeups_.insert(next);
+    sendExecutionEvent(next, newCallback(this, &FlowSwitch::finishFlows));
+  }
+}
+
+void
+FlowSwitch::setRate(uint32_t fid, double rate)
+{
+  FluidFlow& flow = flows_[fid];
+  if (flow.scheduled && rate == flow.rate) return;
+
+  Timestamp now_ = now();
+  if (flow.scheduled){
+    finish_order_.erase(std::make_pair(flow.finish, fid));
+    flow.remaining -= flow.rate * (now_ - flow.last_update).sec();
+    if (flow.remaining < 0) flow.remaining = 0;
+  }
+  flow.last_update = now_;
+  flow.rate = rate;
+  flow.finish = now_ + TimeDelta(flow.remaining / rate);
+  flow.scheduled = true;
+  finish_order_.insert(std::make_pair(flow.finish, fid));
+}
+
+void
+FlowSwitch::reallocate(const std::vector<uint32_t>& seed_links)
+{
+  //find every link and flow sharing bandwidth with the seeds
+  ++visit_;
+  component_links_.clear();
+  component_flows_.clear();
+  std::vector<uint32_t> stack;
+  for (uint32_t lid : seed_links){
+    if (links_[lid].visit != visit_){
+      links_[lid].visit = visit_;
+      stack.push_back(lid);
+    }
+  }
+  while (!stack.empty()){
+    uint32_t lid = stack.back();
+    stack.pop_back();
+    component_links_.push_back(lid);
+    for (uint32_t fid : links_[lid].flows){
+      FluidFlow& flow = flows_[fid];
+      if (flow.visit == visit_) continue;
+      flow.visit = visit_;
+      component_flows_.push_back(fid);
+      for (uint32_t next : flow.links){
+        if (links_[next].visit != visit_){
+          links_[next].visit = visit_;
+          stack.push_back(next);
+        }
+      }
+    }
+  }
+
+  //progressive filling: repeatedly freeze the flows on the link with the smallest fair share
+  typedef std::pair<double,std::pair<uint32_t,uint32_t>> ShareEntry;
+  std::priority_queue<ShareEntry, std::vector<ShareEntry>, std::greater<ShareEntry>> shares;
+  for (uint32_t lid : component_links_){
+    Link& link = links_[lid];
+    link.residual = link.bandwidth;
+    link.unfrozen = link.flows.size();
+    link.version++;
+    if (link.unfrozen){
+      shares.push(std::make_pair(link.residual / link.unfrozen, std::make_pair(lid, link.version)));
+    }
+  }
+  for (uint32_t fid : component_flows_){
+    flows_[fid].new_rate = -1;
+  }
+
+  while (!shares.empty()){
+    ShareEntry entry = shares.top();
+    shares.pop();
+    Link& bottleneck = links_[entry.second.first];
+    if (entry.second.second != bottleneck.version || bottleneck.unfrozen == 0) continue;
+
+    //never stall a flow on rounding error
+    double share = std::max(entry.first, 1.0);
+    for (uint32_t fid : bottleneck.flows){
+      FluidFlow& flow = flows_[fid];
+      if (flow.new_rate >= 0) continue;
+      flow.new_rate = share;
+      for (uint32_t lid : flow.links){
+        Link& link = links_[lid];
+        link.residual = std::max(link.residual - share, 0.0);
+        link.unfrozen--;
+        link.version++;
+        if (link.unfrozen){
+          shares.push(std::make_pair(link.residual / link.unfrozen, std::make_pair(lid, link.version)));
+        }
+      }
+    }
+  }
+
+  for (uint32_t fid : component_flows_){
+    setRate(fid, flows_[fid].new_rate);
+  }
+}
+
+}
+}
@@ -0,0 +1,163 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_HARDWARE_FLOW_FLOW_SWITCH_H_INCLUDED
+#define SSTMAC_HARDWARE_FLOW_FLOW_SWITCH_H_INCLUDED
+
+#include <sstmac/hardware/logp/logp_switch.h>
+
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace sstmac {
+namespace hw {
+
+/**
+ * @brief Implements a flow-level (fluid) network model.
+ *        Each message is a flow across the injection link, the network links of a minimal path,
+ *        and the ejection link. Links are shared max-min fairly between the flows crossing them.
+ *        Rates are only recomputed for the flows that share links, directly or transitively,
+ *        with a flow that arrives or departs.
+ *        Like the LogP switch, one flow switch runs on each thread and
+ *        only captures contention between flows injected on that thread.
+ */
+class FlowSwitch : public LogPSwitch
+{
+ public:
+  SST_ELI_REGISTER_COMPONENT(
+    FlowSwitch,
+    "macro",
+    "flow_switch",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "A switch that models messages as flows sharing link bandwidth max-min fairly",
+    COMPONENT_CATEGORY_NETWORK)
+
+  FlowSwitch(uint32_t cid, SST::Params& params);
+
+  std::string toString() const override {
+    return "flow switch";
+  }
+
+  LinkHandler* payloadHandler(int  /*port*/) override {
+    return newLinkHandler(this, &FlowSwitch::startFlow);
+  }
+
+  void startFlow(Event* ev);
+
+ private:
+  struct Link {
+    double bandwidth;
+    std::vector<uint32_t> flows;
+    double residual;
+    uint32_t unfrozen;
+    uint32_t version;
+    uint32_t visit;
+  };
+
+  struct FluidFlow {
+    NetworkMessage* msg;
+    std::vector<uint32_t> links;
+    double remaining;
+    double rate;
+    double new_rate;
+    Timestamp last_update;
+    Timestamp finish;
+    TimeDelta latency;
+    uint32_t visit;
+    bool scheduled;
+  };
+
+  void finishFlows();
+
+  void reallocate(const std::vector<uint32_t>& seed_links);
+
+  void setRate(uint32_t fid, double rate);
+
+  void scheduleWakeup();
+
+  void routeFlow(NodeId src, NodeId dst, std::vector<uint32_t>& links);
+
+  const std::vector<uint16_t>& distancesTo(SwitchId dst);
+
+  uint32_t injectionLink(NodeId nid) const {
+    return nid;
+  }
+
+  uint32_t ejectionLink(NodeId nid) const {
+    return num_nodes_ + nid;
+  }
+
+  int negligible_size_;
+  uint32_t num_nodes_;
+  TimeDelta link_latency_;
+  TimeDelta injection_latency_;
+
+  /** Network links from each switch in compressed rows, link ids follow the node links */
+  std::vector<uint32_t> adjacency_offsets_;
+  std::vector<SwitchId> adjacency_dst_;
+  /** The switches with a link into each switch */
+  std::vector<uint32_t> reverse_offsets_;
+  std::vector<SwitchId> reverse_src_;
+  /** Hop counts to each destination switch, computed the first time it is used */
+  std::vector<std::vector<uint16_t>> distances_;
+
+  std::vector<Link> links_;
+  std::vector<FluidFlow> flows_;
+  std::vector<uint32_t> free_flows_;
+
+  /** Active flows ordered by the time they will finish at their current rate */
+  std::set<std::pair<Timestamp,uint32_t>> finish_order_;
+  std::multiset<Timestamp> wakeups_;
+
+  uint32_t visit_;
+  std::vector<uint32_t> component_links_;
+  std::vector<uint32_t> component_flows_;
+
+};
+
+}
+}
+
+#endif
@@ -54,6 +54,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/hardware/pisces/pisces.h>
 #include <sstmac/hardware/switch/network_switch.h>
 #include <sstmac/hardware/logp/logp_switch.h>
+#include <sstmac/hardware/flow/flow_switch.h>
 #include <sstmac/backends/common/parallel_runtime.h>
 #include <sstmac/backends/common/sim_partition.h>
 #include <sstmac/common/runtime.h>
@@ -140,15 +141,29 @@ Interconnect::Interconnect(SST::Params& params, SSTMAC_MAYBE_UNUSED EventManager
 
   std::string switch_model = switch_params->getLowercaseParam("name");
   bool logp_model = switch_model == "logp" || switch_model == "simple" || switch_model == "macrels";
+  //the flow model replaces the LogP switches and needs no network switches of its own
+  bool flow_model = switch_model == "flow";
 
   switches_.resize(num_switches_);
   nodes_.resize(num_nodes_);
 
   SST::Params logp_params;
-  if (logp_model){
+  if (logp_model || flow_model){
     logp_params.insert(switch_params);
   }
   logp_params.insert(switch_params.get_scoped_params("logp"));
+  if (flow_model){
+    SST::Params inj_params = nic_params.get_scoped_params("injection");
+    if (inj_params.contains("bandwidth")){
+      logp_params.insert("injection_bandwidth", inj_params.find<std::string>("bandwidth"), false);
+    }
+    if (inj_params.contains("latency")){
+      logp_params.insert("injection_latency", inj_params.find<std::string>("latency"), false);
+    }
+    if (nic_params.contains("negligible_size")){
+      logp_params.insert("negligible_size", nic_params.find<std::string>("negligible_size"), false);
+    }
+  }
 
   logp_switches_.resize(rt_->nthread());
   uint32_t my_offset = rt_->me() * rt_->nthread() + top->numNodes() + top->numSwitches();
@@ -156,13 +171,17 @@ Interconnect::Interconnect(SST::Params& params, SSTMAC_MAYBE_UNUSED EventManager
     uint32_t id = my_offset + i;
     interconn_debug("set LogP %d component %u to thread %d", i, id, i);
     mgr->setComponentManager(id, i);
-    logp_switches_[i] = new LogPSwitch(id, logp_params);
+    if (flow_model){
+      logp_switches_[i] = new FlowSwitch(id, logp_params);
+    } else {
+      logp_switches_[i] = new LogPSwitch(id, logp_params);
+    }
   }
 
   buildEndpoints(node_params, nic_params, mgr);
 
   uint64_t linkId = connectLogP(0/*number from zero*/, mgr, node_params, nic_params);
-  if (!logp_model){
+  if (!logp_model && !flow_model){
     buildSwitches(switch_params, mgr);
     linkId = connectSwitches(linkId, mgr, switch_params);
     linkId = connectEndpoints(linkId, mgr, nic_params, switch_params);
@@ -250,6 +269,7 @@ Interconnect::connectEndpoints(uint64_t linkIdOffset,
 
     NetworkSwitch* injsw = switches_[i];
     NetworkSwitch* ejsw = switches_[i];
+    uint64_t firstLinkId = linkId;
 
     topology_->endpointsConnectedToInjectionSwitch(i, ports);
     for (Topology::InjectionPort& p : ports){
@@ -288,6 +308,9 @@ Interconnect::connectEndpoints(uint64_t linkIdOffset,
         linkId += 2;
       }
     }
+    if (mgr->profile()){
+      mgr->profile()->setLinkSwitches(firstLinkId, linkId, i, i);
+    }
   }
   return linkId;
 }
@@ -342,6 +365,7 @@ Interconnect::connectLogP(
     int target_rank = partition_->lpidForSwitch(sid);
     LogPSwitch* local_logp_switch = logp_switches_[target_thread];
     TimeDelta logp_link_latency = local_logp_switch->out_in_latency();
+    uint64_t firstLinkId = linkId;
 
     for (Topology::InjectionPort& conn : nodes){
       Node* nd = nodes_[conn.nid];
@@ -410,6 +434,10 @@ Interconnect::connectLogP(
         }
       }
     }
+    if (mgr->profile()){
+      //everything on these links is executed by the nodes of this switch
+      mgr->profile()->setLinkSwitches(firstLinkId, linkId, sid, sid);
+    }
   }
   return linkId;
 }
@@ -539,6 +567,12 @@ Interconnect::connectSwitches(uint64_t linkIdOffset, EventManager* mgr, SST::Par
       int dst_rank = partition_->lpidForSwitch(conn.dst);
       int dst_thread = partition_->threadForSwitch(conn.dst);
 
+      if (mgr->profile()){
+        //payloads are received by the destination, credits by the source
+        mgr->profile()->setLinkSwitches(linkId, linkId+1, conn.src, conn.dst);
+        mgr->profile()->setLinkSwitches(linkId+1, linkId+2, conn.dst, conn.src);
+      }
+
       interconn_debug("%s connecting to %s on ports %d:%d",
                 topology_->switchLabel(src).c_str(),
                 topology_->switchLabel(conn.dst).c_str(),
@@ -130,7 +130,7 @@ class LogPSwitch : public ConnectableComponent
     return out_in_lat_;
   }
 
- private:
+ protected:
   TimeDelta inj_lat_;
   TimeDelta out_in_lat_;
 
@@ -110,6 +110,7 @@ NIC::NIC(uint32_t id, SST::Params& params, Node* parent) :
   //no calls are made to this statistic unless it is non-null
   //nullness checks are deferred to other places
   spy_bytes_ = dynamic_cast<StatSpyplot<int,uint64_t>*>(spy);
+  if (spy_bytes_) spy_bytes_->setRow(my_addr_);
 
   xmit_flows_ = registerStatistic<uint64_t>(params, "xmit_flows", subname);
 }
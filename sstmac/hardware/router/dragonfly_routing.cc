@@ -148,22 +148,15 @@ struct DragonflyMinimalRouter : public Router {
   void route(Packet *pkt) override
   {
     auto* hdr = pkt->rtrHeader<header>();
-    long long int  *hops = dfly_->hop_array();
-    long long int *ql = dfly_->q_l_array();
 
     SwitchId ejaddr = pkt->toaddr() / dfly_->concentration();
     if (ejaddr == my_addr_){
 
-     if(hdr->st==0){
-       *(hops+0)= *(hops+0)+1;
-     }else{
-       *(hops+hdr->st)= *(hops+hdr->st)+1;
-     }
 
       int port = pkt->toaddr() % dfly_->concentration();
       int e_port =  dfly_->a() + dfly_->h() + port;
       hdr->q_length=hdr->q_length+netsw_->queueLength(e_port, all_vcs);
-           *(ql+hdr->q_length)= *(ql+hdr->q_length)+1;
+      countEjection(hdr->st, hdr->q_length);
 
       hdr->edge_port = dfly_->a() + dfly_->h() + port;
       hdr->deadlock_vc = 0;
@@ -204,7 +197,38 @@ struct DragonflyMinimalRouter : public Router {
     }
   }
 
+  SavedState* saveState() override {
+    auto* state = new State;
+    state->parent = Router::saveState();
+    state->group_port_rotaters = group_port_rotaters_;
+    return state;
+  }
+
+  void restoreState(SavedState* saved) override {
+    auto* state = static_cast<State*>(saved);
+    Router::restoreState(state->parent);
+    group_port_rotaters_ = state->group_port_rotaters;
+  }
+
  protected:
+  struct State : public DerivedState {
+    std::vector<int> group_port_rotaters;
+  };
+
+  /**
+   * @brief countEjection Update the topology's hop and ejection queue length counters,
+   *        deferred while routing optimistically so rolled back packets are not counted
+   */
+  void countEjection(int num_hops, int q_length){
+    Dragonfly* dfly = dfly_;
+    netsw_->runOnCommit([=]{
+      long long int* hops = dfly->hop_array();
+      long long int* ql = dfly->q_l_array();
+      ++hops[num_hops];
+      ++ql[q_length];
+    });
+  }
+
   Dragonfly* dfly_;
 
   std::vector<std::vector<int>> group_ports_;
@@ -329,21 +353,14 @@ class DragonflyValiantRouter : public DragonflyMinimalRouter {
 
   void route(Packet *pkt) override {
     auto hdr = pkt->rtrHeader<header>();
-    long long int  *hops = dfly_->hop_array();
-    long long int *ql = dfly_->q_l_array();
 
     SwitchId ej_addr = pkt->toaddr() / dfly_->concentration();
     if (ej_addr == my_addr_){
-      if(hdr->st==0){
-       *(hops+0)= *(hops+0)+1;
-     }else{
-       *(hops+hdr->st)= *(hops+hdr->st)+1;
-     }
       
       hdr->edge_port = dfly_->a() + dfly_->h() + pkt->toaddr() % dfly_->concentration();
       int e_port =  dfly_->a() + dfly_->h() + pkt->toaddr() % dfly_->concentration();
       hdr->q_length=hdr->q_length+netsw_->queueLength(e_port, all_vcs);
-           *(ql+hdr->q_length)= *(ql+hdr->q_length)+1;
+      countEjection(hdr->st, hdr->q_length);
 
       hdr->deadlock_vc = 0;
       return;
@@ -384,7 +401,24 @@ class DragonflyValiantRouter : public DragonflyMinimalRouter {
     ++hdr->num_hops;
   }
 
+  SavedState* saveState() override {
+    auto* state = new ValiantState;
+    state->parent = DragonflyMinimalRouter::saveState();
+    state->gateway_rotater = gateway_rotater_;
+    return state;
+  }
+
+  void restoreState(SavedState* saved) override {
+    auto* state = static_cast<ValiantState*>(saved);
+    DragonflyMinimalRouter::restoreState(state->parent);
+    gateway_rotater_ = state->gateway_rotater;
+  }
+
  protected:
+  struct ValiantState : public DerivedState {
+    std::vector<int> gateway_rotater;
+  };
+
   std::vector<int> gateway_rotater_; //for non-minimal
   std::vector<std::vector<std::pair<int,int>>> group_gateways_;
 };
@@ -490,21 +524,14 @@ class DragonflyUGALRouter : public DragonflyValiantRouter {
 
   void route(Packet *pkt) override {
     auto hdr = pkt->rtrHeader<header>();
-    long long int  *hops = dfly_->hop_array();
-    long long int *ql = dfly_->q_l_array();
 
     SwitchId ej_addr = pkt->toaddr() / dfly_->concentration();
     if (ej_addr == my_addr_){ 
-      if(hdr->st==0){
-       *(hops+0)= *(hops+0)+1;
-     }else{
-       *(hops+hdr->st)= *(hops+hdr->st)+1;
-     }
 
       int port = pkt->toaddr() % dfly_->concentration();
       int e_port =  dfly_->a() + dfly_->h() + port;
       hdr->q_length=hdr->q_length+netsw_->queueLength(e_port, all_vcs);
-           *(ql+hdr->q_length)= *(ql+hdr->q_length)+1;
+      countEjection(hdr->st, hdr->q_length);
 
       hdr->edge_port = dfly_->a() + dfly_->h() + port;
       hdr->deadlock_vc = 0;
@@ -589,23 +616,16 @@ class DragonflyPARRouter : public DragonflyUGALRouter {
 
   void route(Packet *pkt) override {
     auto hdr = pkt->rtrHeader<header>();
-    long long int  *hops = dfly_->hop_array();
-    long long int *ql = dfly_->q_l_array();
 
     SwitchId ej_addr = pkt->toaddr() / dfly_->concentration();
     if (ej_addr == my_addr_){
 
-      if(hdr->st==0){
-       *(hops+0)= *(hops+0)+1;
-     }else{
-       *(hops+hdr->st)= *(hops+hdr->st)+1;
-     }
 
       int port = pkt->toaddr() % dfly_->concentration();
       hdr->edge_port = dfly_->a() + dfly_->h() + port;
       int e_port = dfly_->a() + dfly_->h() + port;
       hdr->q_length=hdr->q_length+netsw_->queueLength(e_port, all_vcs);
-           *(ql+hdr->q_length)= *(ql+hdr->q_length)+1;
+      countEjection(hdr->st, hdr->q_length);
 
       hdr->deadlock_vc = 0;
       return;
@@ -885,7 +905,24 @@ struct DragonflyRotateRouter : public DragonflyMinimalRouter {
     hdr->num_hops++;
   }
 
+  SavedState* saveState() override {
+    auto* state = new RotateState;
+    state->parent = DragonflyMinimalRouter::saveState();
+    state->port_rotater = port_rotater_;
+    return state;
+  }
+
+  void restoreState(SavedState* saved) override {
+    auto* state = static_cast<RotateState*>(saved);
+    DragonflyMinimalRouter::restoreState(state->parent);
+    port_rotater_ = state->port_rotater;
+  }
+
  private:
+  struct RotateState : public DerivedState {
+    std::set<int>::iterator port_rotater;
+  };
+
   std::set<int>::iterator port_rotater_;
   std::set<int> valid_ports_;
 };
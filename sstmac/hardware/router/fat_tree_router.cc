@@ -187,6 +187,25 @@ FatTreeRouter::getUpPort() {
   return port;
 }
 
+SavedState*
+FatTreeRouter::saveState()
+{
+  auto* state = new State;
+  state->parent = Router::saveState();
+  state->up_next = up_next_;
+  state->down_rotaters = down_rotaters_;
+  return state;
+}
+
+void
+FatTreeRouter::restoreState(SavedState* saved)
+{
+  auto* state = static_cast<State*>(saved);
+  Router::restoreState(state->parent);
+  up_next_ = state->up_next;
+  down_rotaters_ = state->down_rotaters;
+}
+
 int
 FatTreeRouter::getDownPort(int path)
 {
@@ -102,7 +102,15 @@ class FatTreeRouter : public Router
 
   int numVC() const override { return 1; }
 
+  SavedState* saveState() override;
+
+  void restoreState(SavedState* state) override;
+
  private:
+  struct State : public DerivedState {
+    int up_next;
+    std::vector<int> down_rotaters;
+  };
 
   FatTree* ft_;
 
@@ -113,6 +113,18 @@ Router::randomNumber(uint32_t max, uint32_t attempt, uint32_t seed) const
   return rng_->value_in_range(max);
 }
 
+SavedState*
+Router::saveState()
+{
+  return new RngState(*rng_);
+}
+
+void
+Router::restoreState(SavedState* state)
+{
+  *rng_ = static_cast<RngState*>(state)->rng;
+}
+
 Router::~Router()
 {
   if (rng_) delete rng_;
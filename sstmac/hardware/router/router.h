@@ -46,6 +46,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #define SSTMAC_HARDWARE_NETWORK_ROUTING_ROUTER_H_INCLUDED
 
 #include <sstmac/common/rng.h>
+#include <sstmac/common/rollback.h>
 #include <sstmac/common/node_address.h>
 #include <sstmac/common/event_manager_fwd.h>
 #include <sstmac/hardware/common/packet.h>
@@ -76,7 +77,7 @@ namespace hw {
   a 'component' in the network - those are switches.  Switch and router
   are not synonymous in SST/macro.  All switches have routers.
 */
-class Router : public sprockit::printable
+class Router : public sprockit::printable, public Rollback
 {
  public:
    SST_ELI_DECLARE_BASE(Router)
@@ -123,6 +124,15 @@ class Router : public sprockit::printable
     vl_offset_ = offset;
   }
 
+  /**
+   * @brief saveState Save the random number generator.
+   * Routers that keep other state between routing decisions, e.g. port rotaters,
+   * must extend this for the switch to roll back optimistically routed packets.
+   */
+  SavedState* saveState() override;
+
+  void restoreState(SavedState* state) override;
+
   /**
    * @brief random_number
    * @param max     Select number [0,max) exclusive
@@ -147,6 +157,17 @@ class Router : public sprockit::printable
   bool switchPaths(int orig_distance, int new_distance,
           int orig_port, int new_port, int vl = all_vcs) const;
 
+  /**
+   * State of a derived router, chained to the state of its base class
+   */
+  struct DerivedState : public SavedState {
+    SavedState* parent;
+
+    ~DerivedState() override {
+      delete parent;
+    }
+  };
+
  protected:
   static constexpr int all_vcs = -1;
 
@@ -164,6 +185,12 @@ class Router : public sprockit::printable
 
   int vl_offset_;
 
+ private:
+  struct RngState : public SavedState {
+    RngState(const RNG::MWC& r) : rng(r) {}
+    RNG::MWC rng;
+  };
+
 };
 
 }
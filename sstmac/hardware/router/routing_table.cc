@@ -0,0 +1,354 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/hardware/router/routing_table.h>
+#include <sstmac/hardware/router/router.h>
+#include <sstmac/hardware/topology/topology.h>
+#include <sstmac/hardware/topology/file.h>
+#include <sstmac/common/thread_lock.h>
+#include <sstmac/libraries/nlohmann/json.hpp>
+#include <sprockit/statics.h>
+#include <sprockit/errors.h>
+#include <sprockit/spkt_printf.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sstmac {
+namespace hw {
+
+static const char routing_table_magic[8] = {'S','S','T','R','T','B','L','\0'};
+static const uint32_t routing_table_version = 1;
+
+/**
+ * Start of a binary routing table, followed by the flat arrays in the order of the header counts.
+ * The size and time stamp of the JSON file it was built from detect stale tables.
+ */
+struct RoutingTableHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_switches;
+  uint32_t num_nodes;
+  uint32_t num_ranges;
+  uint32_t num_sets;
+  uint32_t num_ports;
+  uint64_t json_size;
+  int64_t json_mtime;
+};
+
+static sprockit::NeedDeletestatics<RoutingTable> del_statics;
+
+static thread_lock routing_table_lock;
+static std::map<Topology*, const RoutingTable*> routing_tables;
+
+const RoutingTable*
+RoutingTable::get(Topology* top)
+{
+  routing_table_lock.lock();
+  auto iter = routing_tables.find(top);
+  if (iter != routing_tables.end()){
+    routing_table_lock.unlock();
+    return iter->second;
+  }
+  //only one router builds the table, all others wait on the lock
+  const RoutingTable* table = new RoutingTable(top);
+  routing_tables[top] = table;
+  routing_table_lock.unlock();
+  return table;
+}
+
+void
+RoutingTable::deleteStatics()
+{
+  for (auto& pair : routing_tables){
+    delete pair.second;
+  }
+  routing_tables.clear();
+}
+
+RoutingTable::RoutingTable(Topology* top) :
+  num_nodes_(top->numNodes())
+{
+  const std::string& json_file = top->routingTablesFile();
+  const std::string& bin_file = top->routingTablesBinary();
+  uint64_t json_size = 0;
+  int64_t json_mtime = 0;
+  bool have_json = false;
+  if (!json_file.empty()){
+    struct stat st;
+    if (::stat(json_file.c_str(), &st) == 0){
+      json_size = st.st_size;
+      json_mtime = st.st_mtime;
+      have_json = true;
+    }
+  }
+
+  if (!bin_file.empty() && read(bin_file, top, json_size, json_mtime)){
+    debug_printf(sprockit::dbg::router,
+      "read routing tables for %u switches from %s: %u ranges, %u port sets, %llu bytes",
+      numSwitches(), bin_file.c_str(), switch_offsets_.back(),
+      uint32_t(set_offsets_.size() - 1), (unsigned long long) numBytes());
+    return;
+  }
+
+  build(top);
+  debug_printf(sprockit::dbg::router,
+    "built routing tables for %u switches from %s: %u ranges, %u port sets, %llu bytes",
+    numSwitches(), json_file.c_str(), switch_offsets_.back(),
+    uint32_t(set_offsets_.size() - 1), (unsigned long long) numBytes());
+
+  if (!bin_file.empty() && have_json){
+    write(bin_file, top, json_size, json_mtime);
+  }
+}
+
+uint64_t
+RoutingTable::numBytes() const
+{
+  return switch_offsets_.size() * sizeof(uint32_t)
+      + range_starts_.size() * sizeof(uint32_t)
+      + range_sets_.size() * sizeof(uint32_t)
+      + set_offsets_.size() * sizeof(uint32_t)
+      + set_ports_.size() * sizeof(int32_t);
+}
+
+void
+RoutingTable::build(Topology* top)
+{
+  int num_switches = top->numSwitches();
+  int num_nodes = top->numNodes();
+  FileTopology* file_topo = dynamic_cast<FileTopology*>(top);
+
+  std::map<std::vector<int>, uint32_t> set_ids;
+  auto intern = [&](const std::vector<int>& ports) -> uint32_t {
+    auto iter = set_ids.find(ports);
+    if (iter != set_ids.end()) return iter->second;
+    uint32_t id = set_offsets_.size() - 1;
+    set_ids[ports] = id;
+    set_ports_.insert(set_ports_.end(), ports.begin(), ports.end());
+    set_offsets_.push_back(set_ports_.size());
+    return id;
+  };
+
+  static const uint32_t no_set = uint32_t(-1);
+  std::vector<uint32_t> dest_sets(num_nodes);
+  std::vector<int> ports;
+  switch_offsets_.reserve(num_switches + 1);
+  switch_offsets_.push_back(0);
+  set_offsets_.push_back(0);
+  for (int sid=0; sid < num_switches; ++sid){
+    nlohmann::json port_channels;
+    if (file_topo){
+      try {
+        nlohmann::json switch_ports = file_topo->getSwitchJson(sid);
+        auto pch_it = switch_ports.find("port_channels");
+        if (pch_it != switch_ports.end()){
+          port_channels = *pch_it;
+        }
+      } catch (nlohmann::detail::exception& e) {
+        spkt_abort_printf("failed getting switch JSON info in TableRouter for switch %d", sid);
+      }
+    }
+
+    //port channels are shared by many destinations, look each one up only once
+    std::map<std::string, uint32_t> pch_sets;
+    std::fill(dest_sets.begin(), dest_sets.end(), no_set);
+    const nlohmann::json& routes = top->getRoutingTable(sid);
+    for (auto it = routes.begin(); it != routes.end(); ++it){
+      NodeId dest_nid = top->nodeNameToId(it.key());
+      if (it.value().is_number()){
+        //this is a single port
+        ports.assign(1, int(it.value()));
+        dest_sets[dest_nid] = intern(ports);
+      } else {
+        std::string pch_name = it.value();
+        auto pch_it = pch_sets.find(pch_name);
+        if (pch_it == pch_sets.end()){
+          ports.clear();
+          for (auto p : port_channels.at(pch_name).at("ports")){
+            ports.push_back(p);
+          }
+          pch_it = pch_sets.emplace(pch_name, intern(ports)).first;
+        }
+        dest_sets[dest_nid] = pch_it->second;
+      }
+    }
+
+    for (int dst=0; dst < num_nodes; ++dst){
+      uint32_t set = dest_sets[dst];
+      if (set == no_set){
+        spkt_abort_printf("No port specified on switch %d to destination %d",
+                          sid, dst);
+      }
+      if (dst == 0 || set != dest_sets[dst-1]){
+        range_starts_.push_back(dst);
+        range_sets_.push_back(set);
+      }
+    }
+    switch_offsets_.push_back(range_starts_.size());
+  }
+}
+
+template <class T>
+static bool
+readArray(FILE* f, std::vector<T>& vec, uint32_t size)
+{
+  vec.resize(size);
+  return size == 0 || fread(vec.data(), sizeof(T), size, f) == size;
+}
+
+bool
+RoutingTable::read(const std::string& fname, Topology* top, uint64_t json_size, int64_t json_mtime)
+{
+  FILE* f = fopen(fname.c_str(), "rb");
+  if (!f){
+    return false;
+  }
+
+  RoutingTableHeader header;
+  bool ok = fread(&header, sizeof(header), 1, f) == 1
+    && ::memcmp(header.magic, routing_table_magic, sizeof(routing_table_magic)) == 0
+    && header.version == routing_table_version
+    && header.num_switches == top->numSwitches()
+    && header.num_nodes == top->numNodes();
+  //without the JSON file there is nothing to compare against
+  if (ok && json_size != 0){
+    ok = header.json_size == json_size && header.json_mtime == json_mtime;
+  }
+  ok = ok
+    && readArray(f, switch_offsets_, header.num_switches + 1)
+    && readArray(f, range_starts_, header.num_ranges)
+    && readArray(f, range_sets_, header.num_ranges)
+    && readArray(f, set_offsets_, header.num_sets + 1)
+    && readArray(f, set_ports_, header.num_ports)
+    && valid();
+  fclose(f);
+
+  if (!ok){
+    debug_printf(sprockit::dbg::router,
+      "routing tables in %s are missing or stale, rebuilding them", fname.c_str());
+    switch_offsets_.clear();
+    range_starts_.clear();
+    range_sets_.clear();
+    set_offsets_.clear();
+    set_ports_.clear();
+  }
+  return ok;
+}
+
+bool
+RoutingTable::valid() const
+{
+  if (switch_offsets_.front() != 0 || switch_offsets_.back() != range_starts_.size()){
+    return false;
+  }
+  for (uint32_t sid=0; sid < numSwitches(); ++sid){
+    uint32_t first = switch_offsets_[sid];
+    uint32_t last = switch_offsets_[sid+1];
+    //every switch needs a range starting at node 0 for findRange
+    if (last <= first || range_starts_[first] != 0) return false;
+    for (uint32_t r=first+1; r < last; ++r){
+      if (range_starts_[r] <= range_starts_[r-1]) return false;
+    }
+    if (range_starts_[last-1] >= num_nodes_) return false;
+  }
+
+  uint32_t num_sets = set_offsets_.size() - 1;
+  for (uint32_t set : range_sets_){
+    if (set >= num_sets) return false;
+  }
+  if (set_offsets_.front() != 0 || set_offsets_.back() != set_ports_.size()){
+    return false;
+  }
+  for (uint32_t set=0; set < num_sets; ++set){
+    //an empty port set would leave routing nowhere to go
+    if (set_offsets_[set+1] <= set_offsets_[set]) return false;
+  }
+  for (int32_t port : set_ports_){
+    if (port < 0) return false;
+  }
+  return true;
+}
+
+void
+RoutingTable::write(const std::string& fname, Topology* top, uint64_t json_size, int64_t json_mtime) const
+{
+  RoutingTableHeader header;
+  ::memset(&header, 0, sizeof(header));
+  ::memcpy(header.magic, routing_table_magic, sizeof(routing_table_magic));
+  header.version = routing_table_version;
+  header.num_switches = numSwitches();
+  header.num_nodes = top->numNodes();
+  header.num_ranges = range_starts_.size();
+  header.num_sets = set_offsets_.size() - 1;
+  header.num_ports = set_ports_.size();
+  header.json_size = json_size;
+  header.json_mtime = json_mtime;
+
+  //write to a temporary file so that other processes never read a partial table
+  std::string tmp_name = sprockit::sprintf("%s.%d", fname.c_str(), int(::getpid()));
+  FILE* f = fopen(tmp_name.c_str(), "wb");
+  if (!f){
+    std::cerr << "WARNING: unable to write routing tables to " << fname << std::endl;
+    return;
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+    && fwrite(switch_offsets_.data(), sizeof(uint32_t), switch_offsets_.size(), f) == switch_offsets_.size()
+    && fwrite(range_starts_.data(), sizeof(uint32_t), range_starts_.size(), f) == range_starts_.size()
+    && fwrite(range_sets_.data(), sizeof(uint32_t), range_sets_.size(), f) == range_sets_.size()
+    && fwrite(set_offsets_.data(), sizeof(uint32_t), set_offsets_.size(), f) == set_offsets_.size()
+    && fwrite(set_ports_.data(), sizeof(int32_t), set_ports_.size(), f) == set_ports_.size();
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || ::rename(tmp_name.c_str(), fname.c_str()) != 0){
+    ::remove(tmp_name.c_str());
+    std::cerr << "WARNING: unable to write routing tables to " << fname << std::endl;
+  }
+}
+
+}
+}
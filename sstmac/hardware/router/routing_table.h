@@ -0,0 +1,160 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_HARDWARE_NETWORK_SWTICHES_ROUTING_ROUTING_TABLE_H_INCLUDED
+#define SSTMAC_HARDWARE_NETWORK_SWTICHES_ROUTING_ROUTING_TABLE_H_INCLUDED
+
+#include <sstmac/common/node_address.h>
+#include <sstmac/hardware/topology/topology_fwd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sstmac {
+namespace hw {
+
+/**
+ * The routing tables of every switch, shared by all table routers in a process.
+ * Consecutive destinations sent to the same ports are merged into one range,
+ * and identical port lists are stored once no matter how many switches use them.
+ */
+class RoutingTable
+{
+ public:
+  /**
+   * @brief get The routing table for a topology, built on first use
+   * from the routing_tables_binary file if it is up to date or else from the routing_tables JSON
+   */
+  static const RoutingTable* get(Topology* top);
+
+  static void deleteStatics();
+
+  /**
+   * @return The first range of the switch, range indices are global to the table
+   */
+  uint32_t firstRange(SwitchId sid) const {
+    return switch_offsets_[sid];
+  }
+
+  uint32_t numRanges(SwitchId sid) const {
+    return switch_offsets_[sid+1] - switch_offsets_[sid];
+  }
+
+  /**
+   * @return The range of the switch that contains the destination
+   */
+  uint32_t findRange(SwitchId sid, NodeId dst) const {
+    auto begin = range_starts_.begin() + switch_offsets_[sid];
+    auto end = range_starts_.begin() + switch_offsets_[sid+1];
+    return std::upper_bound(begin, end, dst) - range_starts_.begin() - 1;
+  }
+
+  /**
+   * @return The first destination in the range
+   */
+  NodeId rangeStart(uint32_t range) const {
+    return range_starts_[range];
+  }
+
+  /**
+   * @return One past the last destination in the range
+   */
+  NodeId rangeEnd(uint32_t range) const {
+    //the last range of each switch runs to the last node
+    bool last = range + 1 == range_starts_.size() || range_starts_[range+1] == 0;
+    return last ? num_nodes_ : range_starts_[range+1];
+  }
+
+  uint32_t numPorts(uint32_t range) const {
+    uint32_t set = range_sets_[range];
+    return set_offsets_[set+1] - set_offsets_[set];
+  }
+
+  int port(uint32_t range, uint32_t idx) const {
+    return set_ports_[set_offsets_[range_sets_[range]] + idx];
+  }
+
+  uint32_t numSwitches() const {
+    return switch_offsets_.size() - 1;
+  }
+
+  /**
+   * @return The bytes used by the flat arrays
+   */
+  uint64_t numBytes() const;
+
+ private:
+  RoutingTable(Topology* top);
+
+  void build(Topology* top);
+
+  bool read(const std::string& fname, Topology* top, uint64_t json_size, int64_t json_mtime);
+
+  void write(const std::string& fname, Topology* top, uint64_t json_size, int64_t json_mtime) const;
+
+  /**
+   * @brief valid Check that every offset and index read from a file is in bounds
+   */
+  bool valid() const;
+
+  uint32_t num_nodes_;
+
+  /** For each switch, the index of its first range, with a trailing entry for the total */
+  std::vector<uint32_t> switch_offsets_;
+  /** The first destination in each range, increasing within a switch */
+  std::vector<uint32_t> range_starts_;
+  /** The port set of each range */
+  std::vector<uint32_t> range_sets_;
+  /** For each port set, the index of its first port, with a trailing entry for the total */
+  std::vector<uint32_t> set_offsets_;
+  std::vector<int32_t> set_ports_;
+
+};
+
+}
+}
+
+#endif
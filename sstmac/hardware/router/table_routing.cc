@@ -43,15 +43,12 @@ Questions? Contact sst-macro-help@sandia.gov
 */
 
 #include <sstmac/hardware/router/router.h>
+#include <sstmac/hardware/router/routing_table.h>
 #include <sstmac/hardware/switch/network_switch.h>
 #include <sstmac/hardware/topology/topology.h>
 #include <sprockit/util.h>
 #include <sprockit/sim_parameters.h>
 #include <sprockit/keyword_registration.h>
-#include <sstmac/hardware/topology/file.h>
-#include <sstmac/libraries/nlohmann/json.hpp>
-#include <sstream>
-#include <fstream>
 
 
 namespace sstmac {
@@ -63,33 +60,6 @@ class TableRouter : public Router {
     uint8_t num_hops;
   };
 
-  struct Port {
-    Port(const nlohmann::json& pch) :
-      rotater(0)
-    {
-      for (auto p : pch.at("ports")){
-        ports.push_back(p);
-      }
-    }
-
-    Port(int port) :
-      ports(1, port),
-      rotater(0)
-    {
-    }
-
-    Port() : rotater(0), ports(0) {}
-
-    int nextPort(){
-      int ret = ports[rotater];
-      rotater = (rotater + 1) % ports.size();
-      return ret;
-    }
-
-    std::vector<int> ports;
-    int rotater;
-  };
-
  public:
   SST_ELI_REGISTER_DERIVED(
     Router,
@@ -101,45 +71,24 @@ class TableRouter : public Router {
 
   TableRouter(SST::Params& params, Topology* top, NetworkSwitch* sw) :
     Router(params, top, sw),
-    table_(top->numNodes()),
     num_vcs_(1)
   {
-
-    FileTopology* file_topo = dynamic_cast<FileTopology*>(top);
-    nlohmann::json port_channels;
-    if (file_topo){
-      try {
-        nlohmann::json switch_ports = file_topo->getSwitchJson(my_addr_);
-        auto pch_it = switch_ports.find("port_channels");
-        if (pch_it != switch_ports.end()){
-          port_channels = *pch_it;
-        }
-      } catch (nlohmann::detail::exception& e) {
-        spkt_abort_printf("failed getting switch JSON info in TableRouter for switch %d",
-                          int(addr()));
-      }
-    }
-
-    nlohmann::json routes = top->getRoutingTable(my_addr_);
-    for (auto it = routes.begin(); it != routes.end(); ++it){
-      NodeId dest_nid = top->nodeNameToId(it.key());
-      if (it.value().is_number()){
-        //this is a single port
-        table_[dest_nid] = Port(int(it.value()));
-      } else {
-        std::string pch_name = it.value();
-        table_[dest_nid] = Port(port_channels.at(pch_name));
-      }
-    }
-
-
-    int size = table_.size();
-    for (int i=0; i < size; ++i){
-      if (table_[i].ports.size() == 0){
-        spkt_abort_printf("No port specified on switch %d to destination %d",
-                          my_addr_, i);
+    //every switch in the process shares one compressed table
+    table_ = RoutingTable::get(top);
+
+    //only destinations reached through more than one port need a round-robin position
+    first_range_ = table_->firstRange(my_addr_);
+    uint32_t num_ranges = table_->numRanges(my_addr_);
+    rotater_offsets_.resize(num_ranges);
+    uint32_t num_rotaters = 0;
+    for (uint32_t r=0; r < num_ranges; ++r){
+      uint32_t range = first_range_ + r;
+      rotater_offsets_[r] = num_rotaters;
+      if (table_->numPorts(range) > 1){
+        num_rotaters += table_->rangeEnd(range) - table_->rangeStart(range);
       }
     }
+    rotaters_.resize(num_rotaters, 0);
 
     increment_vcs_ = params.find<bool>("increment_vcs", false);
     if (increment_vcs_){
@@ -157,7 +106,17 @@ class TableRouter : public Router {
   }
 
   void route(Packet *pkt) override {
-    int port = table_[pkt->toaddr()].nextPort();
+    uint32_t range = table_->findRange(my_addr_, pkt->toaddr());
+    uint32_t num_ports = table_->numPorts(range);
+    int port;
+    if (num_ports == 1){
+      port = table_->port(range, 0);
+    } else {
+      uint32_t offset = rotater_offsets_[range - first_range_] + pkt->toaddr() - table_->rangeStart(range);
+      uint16_t& rotater = rotaters_[offset];
+      port = table_->port(range, rotater);
+      rotater = (rotater + 1) % num_ports;
+    }
     pkt->setEdgeOutport(port);
 
     auto* hdr = pkt->rtrHeader<header>();
@@ -173,7 +132,12 @@ class TableRouter : public Router {
   }
 
  private:
-  std::vector<Port> table_;
+  const RoutingTable* table_;
+  uint32_t first_range_;
+  /** For each range of this switch, the index of its first destination's rotater */
+  std::vector<uint32_t> rotater_offsets_;
+  /** Round-robin position within the port set of each destination with more than one port */
+  std::vector<uint16_t> rotaters_;
   bool increment_vcs_;
   int num_vcs_;
 };
@@ -82,6 +82,12 @@ class SnapprPacket :
 
   ~SnapprPacket() override {}
 
+#if !SSTMAC_INTEGRATED_SST_CORE
+  Event* clone() const override {
+    return new SnapprPacket(*this);
+  }
+#endif
+
   int nextPort() const {
     return rtrHeader<Header>()->edge_port;
   }
@@ -230,6 +236,12 @@ class SnapprCredit :
 
   ~SnapprCredit() override {}
 
+#if !SSTMAC_INTEGRATED_SST_CORE
+  Event* clone() const override {
+    return new SnapprCredit(*this);
+  }
+#endif
+
   void serialize_order(serializer& ser) override;
 
  private:
@@ -171,10 +171,33 @@ SnapprNIC::payloadHandler(int port)
   if (port == NIC::LogP){
     return newLinkHandler(this, &NIC::mtlHandle);
   } else {
-    return newLinkHandler(this, &SnapprNIC::handlePayload);
+    return newReversibleLinkHandler(this, &SnapprNIC::handlePayload);
   }
 }
 
+SavedState*
+SnapprNIC::saveState()
+{
+  State* state = new State;
+  state->ej_next_free = ej_next_free_;
+#if !SSTMAC_INTEGRATED_SST_CORE
+  state->self_seqnum = selfSeqnum();
+  state->credit_seqnum = credit_link_ ? credit_link_->seqnum() : 0;
+#endif
+  return state;
+}
+
+void
+SnapprNIC::restoreState(SavedState* saved)
+{
+  State* state = static_cast<State*>(saved);
+  ej_next_free_ = state->ej_next_free;
+#if !SSTMAC_INTEGRATED_SST_CORE
+  setSelfSeqnum(state->self_seqnum);
+  if (credit_link_) credit_link_->setSeqnum(state->credit_seqnum);
+#endif
+}
+
 void
 SnapprNIC::deadlockCheck()
 {
@@ -266,6 +289,16 @@ SnapprNIC::doSend(NetworkMessage* payload)
 void
 SnapprNIC::cqHandle(SnapprPacket* pkt)
 {
+  if (pkt->isTail()){
+    NetworkMessage* netmsg = static_cast<NetworkMessage*>(pkt->flow());
+    TimeDelta total_delay = now() - netmsg->timeStarted();
+    TimeDelta min_delay = total_delay - netmsg->injectionDelay() 
+                                      - pkt->congestionDelay() 
+                                      - netmsg->congestionDelay();
+    netmsg->setMinDelay(min_delay);
+    netmsg->setTimeArrived(now()); //TODO add a set time arrived
+  }
+
   Flow* msg = cq_.recv(pkt);
   if (msg){
     NetworkMessage* netmsg = static_cast<NetworkMessage*>(msg);
@@ -283,6 +316,7 @@ SnapprNIC::eject(SnapprPacket* pkt)
 {
   //on the eject side, assume cache injection for now
   //so we don't want to create memory traffic right now
+  logState(this);
   Timestamp now_ = now();
   if (now_ > ej_next_free_){
     ej_next_free_ = now_;
@@ -295,17 +329,9 @@ SnapprNIC::eject(SnapprPacket* pkt)
             ej_next_free_.sec(), pkt->toString().c_str());
   TimeDelta time_to_send; //TODO = pkt->byteLength() * inj_byte_delay_;
   ej_next_free_ = ej_next_free_ + time_to_send;
+  //the message is shared by all its packets and is only updated in cqHandle,
+  //which is never executed optimistically
   auto qev = newCallback(this, &SnapprNIC::cqHandle, pkt);
-  if (pkt->isTail()){
-    NetworkMessage* netmsg = static_cast<NetworkMessage*>(pkt->flow());
-    TimeDelta total_delay = ej_next_free_ - netmsg->timeStarted();
-    TimeDelta min_delay = total_delay - netmsg->injectionDelay() 
-                                      - pkt->congestionDelay() 
-                                      - netmsg->congestionDelay();
-    netmsg->setMinDelay(min_delay);
-    netmsg->setTimeArrived(ej_next_free_); //TODO add a set time arrived
-  }
-
   sendExecutionEvent(ej_next_free_, qev);
   if (flow_control_){
     auto* credit = new SnapprCredit(pkt->byteLength(), pkt->virtualLane(), switch_outport_);
@@ -318,6 +344,7 @@ SnapprNIC::eject(SnapprPacket* pkt)
 void
 SnapprNIC::handlePayload(Event *ev)
 {
+  logState(this);
   SnapprPacket* pkt = static_cast<SnapprPacket*>(ev);
   if (pkt->deadlocked()){
     std::cerr << "NIC " << addr() << " is part of deadlock" << std::endl;
@@ -331,6 +358,7 @@ SnapprNIC::handlePayload(Event *ev)
               pkt->timeToSend().sec(), time_to_send.sec(), pkt->toString().c_str());
     //tail flit cannot arrive here before it leaves the prev switch
     auto ev = newCallback(this, &SnapprNIC::eject, pkt);
+    ev->setReversible();
     TimeDelta delta_t = pkt->timeToSend() - time_to_send;
     sendDelayedExecutionEvent(delta_t, ev);
   } else {
@@ -50,6 +50,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/hardware/interconnect/interconnect_fwd.h>
 #include <sstmac/hardware/snappr/snappr_switch.h>
 #include <sstmac/hardware/common/recv_cq.h>
+#include <sstmac/common/rollback.h>
 
 
 namespace sstmac {
@@ -57,10 +58,13 @@ namespace hw {
 
 /**
  @class SnapprNIC
- Network interface compatible with snappr network model
+ Network interface compatible with snappr network model.
+ Only ejection supports rollback, injection touches
+ the node and memory model and is never executed optimistically.
  */
 class SnapprNIC :
-  public NIC
+  public NIC,
+  public Rollback
 {
  public:
 #if SSTMAC_INTEGRATED_SST_CORE
@@ -128,8 +132,17 @@ class SnapprNIC :
 
   void deadlockCheck() override;
 
+  SavedState* saveState() override;
+
+  void restoreState(SavedState* state) override;
 
  private:
+  struct State : public SavedState {
+    Timestamp ej_next_free;
+    uint32_t self_seqnum;
+    uint32_t credit_seqnum;
+  };
+
   void doSend(NetworkMessage* payload) override;
 
   void cqHandle(SnapprPacket* pkt);
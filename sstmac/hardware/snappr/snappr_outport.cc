@@ -83,7 +83,8 @@ SnapprOutPort::SnapprOutPort(uint32_t id, SST::Params& params,
     congestion_(congestion), 
     portName_(subId), 
     number_(number),
-    notifier_(nullptr)
+    notifier_(nullptr),
+    owner_(dynamic_cast<Rollback*>(parent))
 {
   std::string arb = params.find<std::string>("arbitrator", "fifo");
   arb_ = sprockit::create<SnapprPortArbitrator>("macro", arb, byte_delay, params, vls_per_qos);
@@ -114,6 +115,51 @@ SnapprOutPort::handle(Event *ev)
   handleCredit(static_cast<SnapprCredit*>(ev));
 }
 
+SavedState*
+SnapprOutPort::saveState()
+{
+  State* state = new State;
+  state->arbitration_scheduled = arbitration_scheduled;
+  state->next_free = next_free;
+  state->stall_start = stall_start;
+  state->last_queue_depth_collection = last_queue_depth_collection;
+  state->total_packets = total_packets_;
+#if !SSTMAC_INTEGRATED_SST_CORE
+  state->link_seqnum = link ? link->seqnum() : 0;
+#endif
+  state->arb = arb_->clone();
+  return state;
+}
+
+void
+SnapprOutPort::restoreState(SavedState* saved)
+{
+  State* state = static_cast<State*>(saved);
+  arbitration_scheduled = state->arbitration_scheduled;
+  next_free = state->next_free;
+  stall_start = state->stall_start;
+  last_queue_depth_collection = state->last_queue_depth_collection;
+  total_packets_ = state->total_packets;
+#if !SSTMAC_INTEGRATED_SST_CORE
+  if (link) link->setSeqnum(state->link_seqnum);
+#endif
+  arb_->deletePackets();
+  delete arb_;
+  //the saved copy is discarded after restoring, take it over
+  arb_ = state->arb;
+  state->arb = nullptr;
+}
+
+void
+SnapprOutPort::logState()
+{
+  if (owner_){
+    //packets and credits are sent through the parent's self link and the inport links
+    SubComponent::logState(this);
+    SubComponent::logState(owner_);
+  }
+}
+
 std::string
 SnapprOutPort::toString() const
 {
@@ -123,6 +169,7 @@ SnapprOutPort::toString() const
 void
 SnapprOutPort::handleCredit(SnapprCredit* credit)
 {
+  logState();
   addCredits(credit->virtualLane(), credit->numBytes());
   pkt_debug("crediting port=%d vl=%d with %" PRIu32" credits",
             number_, credit->virtualLane(), credit->numBytes());
@@ -142,43 +189,50 @@ SnapprOutPort::send(SnapprPacket* pkt, Timestamp now)
   }
 #endif
 
+  //the port state changes now, but statistics are only collected
+  //once an optimistically executed send can no longer be rolled back
+  Timestamp stall_begin = stall_start;
+  Timestamp idle_begin = next_free;
+  Timestamp idle_end;
   if (!stall_start.empty()){
-    TimeDelta stall_time = now - stall_start;
-    xmit_stall->addData(stall_time.ticks());
-#if !SSTMAC_INTEGRATED_SST_CORE
-    if (state_ftq){
-      state_ftq->addData(ftq_stalled_state, stall_start.time.ticks(), stall_time.ticks());
-    }
-#endif
     if (stall_start > next_free){
       //we also have idle time
-      TimeDelta idle_time = stall_start -next_free;
+      idle_end = stall_start;
+    }
+    stall_start = Timestamp();
+  } else if (now > next_free){
+    idle_end = now;
+  }
+
+  TimeDelta time_to_send = pkt->numBytes() * byte_delay;
+  uint32_t num_bytes = pkt->numBytes();
+  runOnCommit([=]{
+    if (!stall_begin.empty()){
+      TimeDelta stall_time = now - stall_begin;
+      xmit_stall->addData(stall_time.ticks());
+#if !SSTMAC_INTEGRATED_SST_CORE
+      if (state_ftq){
+        state_ftq->addData(ftq_stalled_state, stall_begin.time.ticks(), stall_time.ticks());
+      }
+#endif
+    }
+    if (!idle_end.empty()){
+      TimeDelta idle_time = idle_end - idle_begin;
       xmit_idle->addData(idle_time.ticks());
 #if !SSTMAC_INTEGRATED_SST_CORE
       if (state_ftq){
-        state_ftq->addData(ftq_idle_state, next_free.time.ticks(), idle_time.ticks());
+        state_ftq->addData(ftq_idle_state, idle_begin.time.ticks(), idle_time.ticks());
       }
 #endif
     }
-    stall_start = Timestamp();
-  } else if (now > next_free){
-    TimeDelta idle_time = now - next_free;
-    xmit_idle->addData(idle_time.ticks());
+    bytes_sent->addData(num_bytes);
+    xmit_active->addData(time_to_send.ticks());
 #if !SSTMAC_INTEGRATED_SST_CORE
     if (state_ftq){
-      state_ftq->addData(ftq_idle_state, next_free.time.ticks(), idle_time.ticks());
+      state_ftq->addData(ftq_active_state, now.time.ticks(), time_to_send.ticks());
     }
 #endif
-  }
-
-  TimeDelta time_to_send = pkt->numBytes() * byte_delay;
-  bytes_sent->addData(pkt->numBytes());
-  xmit_active->addData(time_to_send.ticks());
-#if !SSTMAC_INTEGRATED_SST_CORE
-  if (state_ftq){
-    state_ftq->addData(ftq_active_state, now.time.ticks(), time_to_send.ticks());
-  }
-#endif
+  });
   next_free = now + time_to_send + flit_overhead;
   pkt->setTimeToSend(time_to_send);
   pkt->accumulateCongestionDelay(now);
@@ -192,6 +246,7 @@ SnapprOutPort::send(SnapprPacket* pkt, Timestamp now)
     queue(pkt); //put the packet back
     SnapprCredit* credit = new SnapprCredit(pkt->numBytes(), pkt->virtualLane(), -1);
     auto* ev = newCallback(this, &SnapprOutPort::handleCredit, credit); //port doesn't matter
+    if (owner_) ev->setReversible();
     parent_->sendExecutionEvent(next_free, ev);
   } else {
     //actually send it
@@ -236,6 +291,7 @@ SnapprOutPort::scheduleArbitration()
             number_, next_free.sec(), queueLength());
   //schedule this port to pull another packet
   auto* ev = newCallback(this, &SnapprOutPort::arbitrate);
+  if (owner_) ev->setReversible();
   parent_->sendExecutionEvent(next_free, ev);
   arbitration_scheduled = true;
 }
@@ -296,6 +352,7 @@ SnapprOutPort::arbitrate()
   }
 #endif
 
+  logState();
   arbitration_scheduled = false;
   if (ready()){
     logQueueDepth();
@@ -318,8 +375,11 @@ SnapprOutPort::logQueueDepth()
 #if !SSTMAC_INTEGRATED_SST_CORE
   if (queue_depth_ftq){
     Timestamp now = parent_->now();
-    TimeDelta dt = now - last_queue_depth_collection;
-    queue_depth_ftq->addData(queueLength(), last_queue_depth_collection.time.ticks(), dt.ticks());
+    Timestamp last = last_queue_depth_collection;
+    int depth = queueLength();
+    runOnCommit([=]{
+      queue_depth_ftq->addData(depth, last.time.ticks(), (now - last).ticks());
+    });
     last_queue_depth_collection = now;
   }
 #endif
@@ -332,6 +392,7 @@ SnapprOutPort::tryToSendPacket(SnapprPacket* pkt)
             pkt->toString().c_str(), pkt->inport(), pkt->inputVirtualLane(),
             pkt->nextPort(), pkt->virtualLane(), pkt->deadlockVC());
 
+  logState();
   Timestamp now = parent_->now();
   pkt->setArrival(now);
   if (!congestion_){
@@ -460,6 +521,22 @@ struct FifoPortArbitrator : public SnapprPortArbitrator
     return port_queue_.empty();
   }
 
+  SnapprPortArbitrator* clone() const override {
+    auto* cpy = new FifoPortArbitrator(*this);
+    for (VirtualLane& vl : cpy->vls_){
+      clonePackets(vl.pending);
+    }
+    clonePackets(cpy->port_queue_);
+    return cpy;
+  }
+
+  void deletePackets() override {
+    for (VirtualLane& vl : vls_){
+      SnapprPortArbitrator::deletePackets(vl.pending);
+    }
+    SnapprPortArbitrator::deletePackets(port_queue_);
+  }
+
  private:
   std::vector<VirtualLane> vls_;
   std::queue<SnapprPacket*> port_queue_;
@@ -965,6 +1042,41 @@ struct WRR_PortArbitrator : public SnapprPortArbitrator
   bool empty() const override {
     return port_queue_.empty() && bw_cap_queue_.empty();
   }
+
+  SnapprPortArbitrator* clone() const override {
+    auto* cpy = new WRR_PortArbitrator(*this);
+    //copy the heaps exactly so that ties pop in the same order
+    cpy->remapLanes(cpy->bw_cap_queue_, vls_.data());
+    cpy->remapLanes(cpy->port_queue_, vls_.data());
+    for (VirtualLane& vl : cpy->vls_){
+      clonePackets(vl.pending);
+    }
+    return cpy;
+  }
+
+  void deletePackets() override {
+    for (VirtualLane& vl : vls_){
+      SnapprPortArbitrator::deletePackets(vl.pending);
+    }
+  }
+
+ private:
+  /**
+   * @brief remapLanes Point the entries of a copied heap at this arbitrator's lanes
+   * @param q
+   * @param old_lanes The lanes of the arbitrator that was copied
+   */
+  template <class Queue>
+  void remapLanes(Queue& q, const VirtualLane* old_lanes){
+    struct Access : public Queue {
+      static typename Queue::container_type& container(Queue& q){
+        return q.*(&Access::c);
+      }
+    };
+    for (VirtualLane*& vl : Access::container(q)){
+      vl = &vls_[vl - old_lanes];
+    }
+  }
 };
 
 }
@@ -50,6 +50,8 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/common/event_scheduler.h>
 #include <sstmac/hardware/snappr/snappr.h>
 #include <sstmac/hardware/snappr/snappr_inport.h>
+#include <sstmac/common/rollback.h>
+#include <queue>
 
 namespace sstmac {
 namespace hw {
@@ -58,6 +60,8 @@ struct SnapprPortArbitrator {
   SPKT_DECLARE_BASE(SnapprPortArbitrator)
   SPKT_DECLARE_CTOR(TimeDelta, SST::Params&, const std::vector<int>&)
 
+  virtual ~SnapprPortArbitrator(){}
+
   virtual void insert(uint64_t cycle, SnapprPacket* pkt) = 0;
 
   virtual void addCredits(int vl, uint32_t credits) = 0;
@@ -76,9 +80,35 @@ struct SnapprPortArbitrator {
 
   virtual int numVirtualLanes() const = 0;
 
+  /**
+   * @brief clone Deep copy of the arbitrator, including copies of all queued packets
+   */
+  virtual SnapprPortArbitrator* clone() const = 0;
+
+  /**
+   * @brief deletePackets Free all queued packets, used before deleting a clone
+   */
+  virtual void deletePackets() = 0;
+
+ protected:
+  static void clonePackets(std::queue<SnapprPacket*>& q){
+    for (size_t i=0; i < q.size(); ++i){
+      SnapprPacket* pkt = q.front();
+      q.pop();
+      q.push(new SnapprPacket(*pkt));
+    }
+  }
+
+  static void deletePackets(std::queue<SnapprPacket*>& q){
+    while (!q.empty()){
+      delete q.front();
+      q.pop();
+    }
+  }
+
 };
 
-struct SnapprOutPort : public SubComponent {
+struct SnapprOutPort : public SubComponent, public Rollback {
 
 #if SSTMAC_INTEGRATED_SST_CORE
   SST_ELI_REGISTER_SUBCOMPONENT_API(sstmac::hw::SnapprOutPort,
@@ -193,6 +223,8 @@ struct SnapprOutPort : public SubComponent {
   template <class T, class Fxn>
   void addTailNotifier(T* t, Fxn f){
     notifier_ = new TailNotifierDerived<T,Fxn>(t,f);
+    //the notifier modifies state outside this port that cannot be rolled back
+    owner_ = nullptr;
   }
 
   SnapprOutPort(uint32_t id, SST::Params& params,
@@ -200,7 +232,33 @@ struct SnapprOutPort : public SubComponent {
                 bool congestion, bool flow_control, Component* parent,
                 const std::vector<int>& vls_per_qos);
 
+  SavedState* saveState() override;
+
+  void restoreState(SavedState* state) override;
+
  private:
+  struct State : public SavedState {
+    bool arbitration_scheduled;
+    Timestamp next_free;
+    Timestamp stall_start;
+    Timestamp last_queue_depth_collection;
+    int total_packets;
+    uint32_t link_seqnum;
+    SnapprPortArbitrator* arb;
+
+    ~State() override {
+      if (arb){
+        arb->deletePackets();
+        delete arb;
+      }
+    }
+  };
+
+  /**
+   * @brief logState Save this port and its parent before an event modifies them
+   */
+  void logState();
+
   void logQueueDepth();
 
   void arbitrate();
@@ -235,6 +293,8 @@ struct SnapprOutPort : public SubComponent {
   int number_;
   TailNotifier* notifier_;
   std::set<int> deadlocked_vls_;
+  /** The parent if it supports rollback, in which case events on this port can be rolled back */
+  Rollback* owner_;
 
 };
 
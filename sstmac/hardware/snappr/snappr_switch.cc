@@ -255,9 +255,38 @@ SnapprSwitch::deadlockCheck(int vl)
   }
 }
 
+SavedState*
+SnapprSwitch::saveState()
+{
+  State* state = new State;
+#if !SSTMAC_INTEGRATED_SST_CORE
+  state->self_seqnum = selfSeqnum();
+  state->inport_seqnums.resize(inports_.size());
+  for (size_t i=0; i < inports_.size(); ++i){
+    auto& link = inports_[i].link;
+    state->inport_seqnums[i] = link ? link->seqnum() : 0;
+  }
+#endif
+  return state;
+}
+
+void
+SnapprSwitch::restoreState(SavedState* saved)
+{
+  State* state = static_cast<State*>(saved);
+#if !SSTMAC_INTEGRATED_SST_CORE
+  setSelfSeqnum(state->self_seqnum);
+  for (size_t i=0; i < inports_.size(); ++i){
+    auto& link = inports_[i].link;
+    if (link) link->setSeqnum(state->inport_seqnums[i]);
+  }
+#endif
+}
+
 void
 SnapprSwitch::handlePayload(SnapprPacket* pkt, int inport)
 {
+  logState(this);
   if (pkt->deadlocked()){
     std::cerr << "Switch " << addr() << " is part of deadlock on inport" << std::endl;
     deadlockCheck(pkt->virtualLane());
@@ -267,6 +296,7 @@ SnapprSwitch::handlePayload(SnapprPacket* pkt, int inport)
   pkt->setInport(inport);
   pkt->saveInputVirtualLane();
   Router* rtr = routers_[pkt->qos()];
+  logState(rtr);
   rtr->route(pkt);
   int vl = rtr->vlOffset() + pkt->deadlockVC();
   pkt->setVirtualLane(vl);
@@ -278,6 +308,7 @@ SnapprSwitch::handlePayload(SnapprPacket* pkt, int inport)
   if (pkt->timeToSend() > time_to_send){
     //delay the packet
     auto ev = newCallback(p, &SnapprOutPort::tryToSendPacket, pkt);
+    ev->setReversible();
     TimeDelta delta_t = pkt->timeToSend() - time_to_send;
     sendDelayedExecutionEvent(delta_t, ev);
   } else {
@@ -295,14 +326,14 @@ LinkHandler*
 SnapprSwitch::creditHandler(int port)
 {
   switch_debug("returning credit handler on output port %d", port);
-  return newLinkHandler(outports_[port], &SnapprOutPort::handle);
+  return newReversibleLinkHandler(outports_[port], &SnapprOutPort::handle);
 }
 
 LinkHandler*
 SnapprSwitch::payloadHandler(int port)
 {
   switch_debug("returning payload handler on input port %d", port);
-  return newLinkHandler(&inports_[port], &SnapprInPort::handle);
+  return newReversibleLinkHandler(&inports_[port], &SnapprInPort::handle);
 }
 
 
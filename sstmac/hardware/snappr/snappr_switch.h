@@ -52,6 +52,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/common/sstmac_config.h>
 #include <sstmac/common/stats/stat_collector.h>
 #include <sstmac/common/stats/ftq_fwd.h>
+#include <sstmac/common/rollback.h>
 #include <queue>
 
 namespace sstmac {
@@ -63,7 +64,8 @@ namespace hw {
  to the next link in the network
  */
 class SnapprSwitch :
-  public NetworkSwitch
+  public NetworkSwitch,
+  public Rollback
 {
 
  public:
@@ -108,7 +110,20 @@ class SnapprSwitch :
 
   void deadlockCheck() override;
 
+  SavedState* saveState() override;
+
+  void restoreState(SavedState* state) override;
+
  private:
+  /**
+   * The link state not owned by an outport that forwarding a packet changes.
+   * Routers save their own state.
+   */
+  struct State : public SavedState {
+    uint32_t self_seqnum;
+    std::vector<uint32_t> inport_seqnums;
+  };
+
   friend struct SnapprInPort;
 
   void handlePayload(SnapprPacket* ev, int port);
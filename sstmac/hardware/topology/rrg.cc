@@ -57,6 +57,7 @@ RegisterKeywords(
 { "N_", "the number of routers" },
 { "r_", "network degree of each router"},
 { "K_", "path spread to be used in KSP routing"},
+{ "compute_paths", "compute the K shortest paths on demand instead of reading an .allroutes file"},
 );
 
 namespace sstmac {
@@ -72,6 +73,9 @@ rrg::rrg(SST::Params& params) :
     K_ = args[2];
 	
 	is_slimfly_instance_=false;
+    compute_paths_ = params.find<bool>("compute_paths", false);
+    paths_ = nullptr;
+    path_finder_ = nullptr;
     if(args.size()>3){
       if(args[3]==1)
         is_slimfly_instance_ = true;
@@ -149,57 +153,25 @@ void rrg::read_allpaths_from_file()
 {
 
   char allpath_filename[100];
-  std::ifstream ifs;
   if(is_slimfly_instance_==true)
     sprintf(allpath_filename,"sfly_q%d_K%d.allroutes", (int)sqrt(N_/2), K_);
   else 
     sprintf(allpath_filename,"rrg_%ld_%ld_K%d.allroutes", N_, r_,K_);
 
-  ifs.open(allpath_filename);
-  if(!ifs.is_open()){
-    spkt_abort_printf("[read_allpaths_from_file]: error reading from file %s\n", allpath_filename);
-  }
-  int s,d,pathcount;
-  while(ifs >> s >> d >> pathcount){
-    if(pathcount<K_){
-      spkt_abort_printf("[rrg::read_allpaths_from_file]:Sd pair (%d,%d) has only %d paths, required Kvalue is %d\n",s,d,pathcount,K_ );
+  //without precomputed routes, find the paths of each switch pair the first time it is routed
+  if(compute_paths_ || !RrgPathStore::exists(allpath_filename)){
+    path_finder_ = new RrgPathFinder(graph_, N_, r_, K_);
+    if(compute_paths_){
+      top_debug("compute_paths is set, computing %d shortest paths on demand", K_);
+    } else {
+      top_debug("No file %s, computing %d shortest paths on demand",allpath_filename, K_);
     }
-    ifs.ignore(200,'\n'); 
-    top_debug("Debug: %d %d %d",s,d,pathcount);
-
-    //the following <pathcount> lines will contain routes from s to d
-	std::vector<std::vector<int>> pathlists_between_s_and_d;
-	std::vector<std::vector<int>> shortpathlists_between_s_and_d;
-    for(int i=0; i<pathcount; i++){
-      std::string line;
-      getline(ifs, line);
-      //std::cout<<"path line: " << line<<std::endl;
-	  std::vector <int> single_path;
-      std::stringstream ss(line);
-      int currenthop, nexthop;
-      ss >> currenthop;
-	  single_path.push_back(currenthop);
-      //std::cout<<"Hops: "<< currenthop <<" ";
-	  int hop_counter=0;
-	  while(ss >> nexthop){
-        //std::cout<<nexthop <<" ";
-        single_path.push_back(nexthop);
-		hop_counter++;
-     }
-	 pathlists_between_s_and_d.push_back(single_path);
-     if(hop_counter <=diameter_) 
-	 {
-		 shortpathlists_between_s_and_d.push_back(single_path);
-	 }
-     single_path.clear();
-    } //end for
-	path_lists[std::make_pair(s,d)] = pathlists_between_s_and_d;
-        short_path_lists[std::make_pair(s,d)] = shortpathlists_between_s_and_d;
-    pathlists_between_s_and_d.clear();
-	shortpathlists_between_s_and_d.clear();
-  } //end while
+    return;
+  }
+
+  //the paths are parsed once per process and mapped from a binary copy in later runs
+  paths_ = RrgPathStore::get(allpath_filename, N_, diameter_, K_);
   top_debug("Successfully read all paths from file %s\n",allpath_filename);
-  ifs.close();
 }
 
 
@@ -237,9 +209,21 @@ rrg::endpointsConnectedToInjectionSwitch(SwitchId swid,
 //function for getting all paths between a source and destination router
 void rrg::find_paths(SwitchId src,SwitchId dst,std::vector<std::vector<int>>& pathlists)
 {
-    for(int i=0;i<path_lists.at(std::make_pair(src,dst)).size();i++)
+    if(path_finder_)
+    {
+        const RrgPathFinder::PathList& computed = path_finder_->paths(src,dst);
+        pathlists.insert(pathlists.end(), computed.begin(), computed.end());
+        return;
+    }
+    int num_paths = paths_->numPaths(src,dst);
+    if(num_paths==0)
+    {
+        spkt_abort_printf("[rrg::find_paths]: no paths from switch %d to %d", src, dst);
+    }
+    for(int i=0;i<num_paths;i++)
     {
-        pathlists.push_back(path_lists.at(std::make_pair(src,dst)).at(i));
+        RrgPathStore::Path path = paths_->path(src,dst,i);
+        pathlists.emplace_back(path.hops, path.hops + path.size);
     }
 }
 
@@ -49,6 +49,8 @@ Questions? Contact sst-macro-help@sandia.gov
 #define SSTMAC_HARDWARE_NETWORK_TOPOLOGY_RRG_H_INCLUDED
 
 #include <sstmac/hardware/topology/structured_topology.h>
+#include <sstmac/hardware/topology/rrg_path_store.h>
+#include <sstmac/hardware/topology/rrg_path_finder.h>
 
 //typedef long long int (*mytype)[10];
 
@@ -115,6 +117,7 @@ long long int* q_l_array()
      {
           printf("Number of packets wait time equal %d = %lld\n",i,ql_array[i]);
      }
+     delete path_finder_;
 
 
   }
@@ -230,6 +233,11 @@ long long int* q_l_array()
   // returns all the paths between source and destination switch
   void find_paths(SwitchId src,SwitchId dst,std::vector<std::vector<int>>& pathlists);
 
+  // the paths between all switch pairs, shared by every router, null if paths are computed
+  const RrgPathStore* pathStore() const {
+    return paths_;
+  }
+
   protected:
   long N_; //the number of routers
   long r_; //'network degree' of each router
@@ -241,10 +249,11 @@ long long int* q_l_array()
   
   std::map<std::pair<SwitchId, SwitchId>, int> inport_map_;
   std::map<std::pair<SwitchId, SwitchId>, int> inport_map1_;
-  //maps all the paths between source and destination switch pairs
-  std::map< std::pair<SwitchId, SwitchId>, std::vector<std::vector<int>> > path_lists;
-   //maps all the shortest paths between source and destination switch pairs
-  std::map< std::pair<SwitchId, SwitchId>, std::vector<std::vector<int>> > short_path_lists;
+  //all the paths and the shortest paths between source and destination switch pairs
+  const RrgPathStore* paths_;
+  //computes paths on demand when there is no .allroutes file
+  RrgPathFinder* path_finder_;
+  bool compute_paths_;
   
  };
 
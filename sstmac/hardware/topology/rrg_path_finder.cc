@@ -0,0 +1,215 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/hardware/topology/rrg_path_finder.h>
+#include <sstmac/hardware/topology/topology.h>
+#include <sstmac/common/thread_lock.h>
+#include <sprockit/errors.h>
+
+#include <algorithm>
+#include <deque>
+
+namespace sstmac {
+namespace hw {
+
+static thread_lock rrg_path_rows_lock;
+
+RrgPathFinder::RrgPathFinder(int** graph, int num_switches, int degree, int k) :
+  num_switches_(num_switches),
+  k_(k),
+  rows_(new std::atomic<std::atomic<const PathList*>*>[num_switches])
+{
+  adjacency_offsets_.push_back(0);
+  for (int sw=0; sw < num_switches; ++sw){
+    for (int i=0; i < degree; ++i){
+      int neighbor = graph[sw][i];
+      if (neighbor == -1) break; //reached the unused ports
+      if (neighbor == sw) continue; //possible loopback link
+      adjacency_.push_back(neighbor);
+    }
+    adjacency_offsets_.push_back(adjacency_.size());
+    rows_[sw].store(nullptr);
+  }
+}
+
+RrgPathFinder::~RrgPathFinder()
+{
+  for (int sw=0; sw < num_switches_; ++sw){
+    std::atomic<const PathList*>* row = rows_[sw].load();
+    if (row){
+      for (int dst=0; dst < num_switches_; ++dst){
+        delete row[dst].load();
+      }
+      delete[] row;
+    }
+  }
+}
+
+const RrgPathFinder::PathList&
+RrgPathFinder::paths(SwitchId src, SwitchId dst)
+{
+  std::atomic<const PathList*>* row = rows_[src].load(std::memory_order_acquire);
+  if (!row){
+    rrg_path_rows_lock.lock();
+    row = rows_[src].load(std::memory_order_acquire);
+    if (!row){
+      row = new std::atomic<const PathList*>[num_switches_];
+      for (int i=0; i < num_switches_; ++i){
+        row[i].store(nullptr, std::memory_order_relaxed);
+      }
+      rows_[src].store(row, std::memory_order_release);
+    }
+    rrg_path_rows_lock.unlock();
+  }
+
+  const PathList* list = row[dst].load(std::memory_order_acquire);
+  if (list){
+    return *list;
+  }
+
+  //compute outside any lock, if another thread finished the same pair first keep its copy
+  PathList* computed = new PathList;
+  yen(src, dst, *computed);
+  const PathList* expected = nullptr;
+  if (!row[dst].compare_exchange_strong(expected, computed,
+          std::memory_order_acq_rel, std::memory_order_acquire)){
+    delete computed;
+    return *expected;
+  }
+  debug_printf(sprockit::dbg::topology,
+    "computed %d paths from switch %d to %d", int(computed->size()), int(src), int(dst));
+  return *computed;
+}
+
+bool
+RrgPathFinder::bfs(int src, int dst, const std::vector<char>& removed_nodes,
+                   const EdgeSet& removed_edges, std::vector<int>& parents,
+                   std::vector<int>& path) const
+{
+  path.clear();
+  std::fill(parents.begin(), parents.end(), -1);
+  parents[src] = src;
+  std::deque<int> queue(1, src);
+  while (!queue.empty()){
+    int sw = queue.front();
+    queue.pop_front();
+    if (sw == dst){
+      for (int hop=dst; hop != src; hop = parents[hop]){
+        path.push_back(hop);
+      }
+      path.push_back(src);
+      std::reverse(path.begin(), path.end());
+      return true;
+    }
+    for (int i=adjacency_offsets_[sw]; i < adjacency_offsets_[sw+1]; ++i){
+      int next = adjacency_[i];
+      if (parents[next] != -1 || removed_nodes[next]) continue;
+      if (!removed_edges.empty() && removed_edges.count(std::make_pair(sw, next))) continue;
+      parents[next] = sw;
+      queue.push_back(next);
+    }
+  }
+  return false;
+}
+
+void
+RrgPathFinder::yen(SwitchId src, SwitchId dst, PathList& paths) const
+{
+  std::vector<char> removed_nodes(num_switches_, 0);
+  std::vector<int> parents(num_switches_);
+  EdgeSet removed_edges;
+  std::vector<int> spur_path;
+
+  if (src == dst){
+    paths.push_back(std::vector<int>(1, int(src)));
+    return;
+  }
+
+  paths.emplace_back();
+  if (!bfs(src, dst, removed_nodes, removed_edges, parents, paths[0])){
+    spkt_abort_printf("[rrg]: no path from switch %d to %d", int(src), int(dst));
+  }
+
+  //candidates ordered by length, then by switch ids so results are reproducible
+  auto shorter = [](const std::vector<int>& a, const std::vector<int>& b){
+    return a.size() != b.size() ? a.size() < b.size() : a < b;
+  };
+  std::set<std::vector<int>, decltype(shorter)> candidates(shorter);
+
+  while (int(paths.size()) < k_){
+    const std::vector<int> prev = paths.back();
+    for (int i=0; i+1 < int(prev.size()); ++i){
+      int spur = prev[i];
+      //remove the next hop of every known path sharing this root
+      removed_edges.clear();
+      for (const std::vector<int>& p : paths){
+        if (int(p.size()) > i+1 && std::equal(prev.begin(), prev.begin() + i + 1, p.begin())){
+          removed_edges.insert(std::make_pair(p[i], p[i+1]));
+        }
+      }
+      //keep the path loopless
+      for (int j=0; j < i; ++j){
+        removed_nodes[prev[j]] = 1;
+      }
+      if (bfs(spur, dst, removed_nodes, removed_edges, parents, spur_path)){
+        std::vector<int> total(prev.begin(), prev.begin() + i);
+        total.insert(total.end(), spur_path.begin(), spur_path.end());
+        if (std::find(paths.begin(), paths.end(), total) == paths.end()){
+          candidates.insert(std::move(total));
+        }
+      }
+      for (int j=0; j < i; ++j){
+        removed_nodes[prev[j]] = 0;
+      }
+    }
+    if (candidates.empty()){
+      break;
+    }
+    paths.push_back(*candidates.begin());
+    candidates.erase(candidates.begin());
+  }
+}
+
+}
+}
@@ -0,0 +1,110 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_HARDWARE_NETWORK_TOPOLOGY_RRG_PATH_FINDER_H_INCLUDED
+#define SSTMAC_HARDWARE_NETWORK_TOPOLOGY_RRG_PATH_FINDER_H_INCLUDED
+
+#include <sstmac/common/node_address.h>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace sstmac {
+namespace hw {
+
+/**
+ * Computes the k shortest loopless paths between rrg switches with Yen's algorithm,
+ * using a breadth-first search for each spur path.  Paths are only computed
+ * for the switch pairs that are actually routed, the first time a pair is requested.
+ * Different pairs can be computed concurrently by different threads.
+ */
+class RrgPathFinder
+{
+ public:
+  typedef std::vector<std::vector<int>> PathList;
+
+  /**
+   * @param graph The neighbors of each switch, -1 for unconnected ports
+   * @param num_switches
+   * @param degree The number of network ports per switch
+   * @param k The number of paths to compute for each pair
+   */
+  RrgPathFinder(int** graph, int num_switches, int degree, int k);
+
+  ~RrgPathFinder();
+
+  /**
+   * @return The paths from src to dst in order of increasing length,
+   *         including both switches. The list is never modified once returned.
+   */
+  const PathList& paths(SwitchId src, SwitchId dst);
+
+ private:
+  typedef std::set<std::pair<int,int>> EdgeSet;
+
+  void yen(SwitchId src, SwitchId dst, PathList& paths) const;
+
+  bool bfs(int src, int dst, const std::vector<char>& removed_nodes,
+           const EdgeSet& removed_edges, std::vector<int>& parents,
+           std::vector<int>& path) const;
+
+  int num_switches_;
+  int k_;
+
+  /** The neighbors of each switch without unconnected ports or loopbacks */
+  std::vector<int> adjacency_offsets_;
+  std::vector<int> adjacency_;
+
+  /** For each source switch, a row with the computed paths to each destination */
+  std::unique_ptr<std::atomic<std::atomic<const PathList*>*>[]> rows_;
+
+};
+
+}
+}
+
+#endif
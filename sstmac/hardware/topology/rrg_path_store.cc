@@ -0,0 +1,388 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/hardware/topology/rrg_path_store.h>
+#include <sstmac/hardware/topology/topology.h>
+#include <sstmac/common/thread_lock.h>
+#include <sprockit/statics.h>
+#include <sprockit/errors.h>
+#include <sprockit/debug.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sstmac {
+namespace hw {
+
+static const char rrg_path_magic[8] = {'S','S','T','R','R','G','P','\0'};
+static const uint32_t rrg_path_version = 1;
+
+/**
+ * Start of a binary path file, followed by the pair offsets, the short pair offsets,
+ * the path offsets, the short path indices and the hops.
+ * The size and time stamp of the .allroutes file it was built from detect stale files.
+ */
+struct RrgPathHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_switches;
+  int32_t diameter;
+  uint32_t num_paths;
+  uint32_t num_short;
+  uint32_t num_hops;
+  uint64_t text_size;
+  int64_t text_mtime;
+};
+
+static uint64_t
+binarySize(const RrgPathHeader& header)
+{
+  uint64_t num_pairs = uint64_t(header.num_switches) * header.num_switches;
+  return sizeof(RrgPathHeader)
+      + 2 * (num_pairs + 1) * sizeof(uint32_t)
+      + (uint64_t(header.num_paths) + 1) * sizeof(uint32_t)
+      + uint64_t(header.num_short) * sizeof(uint32_t)
+      + uint64_t(header.num_hops) * sizeof(int32_t);
+}
+
+static sprockit::NeedDeletestatics<RrgPathStore> del_statics;
+
+static thread_lock rrg_path_lock;
+static std::map<std::string, const RrgPathStore*> rrg_path_stores;
+
+const RrgPathStore*
+RrgPathStore::get(const std::string& allroutes, int num_switches, int diameter, int min_paths)
+{
+  rrg_path_lock.lock();
+  auto iter = rrg_path_stores.find(allroutes);
+  if (iter != rrg_path_stores.end()){
+    rrg_path_lock.unlock();
+    return iter->second;
+  }
+  const RrgPathStore* store = new RrgPathStore(allroutes, num_switches, diameter, min_paths);
+  rrg_path_stores[allroutes] = store;
+  rrg_path_lock.unlock();
+  return store;
+}
+
+void
+RrgPathStore::deleteStatics()
+{
+  for (auto& pair : rrg_path_stores){
+    delete pair.second;
+  }
+  rrg_path_stores.clear();
+}
+
+bool
+RrgPathStore::exists(const std::string& allroutes)
+{
+  struct stat st;
+  std::string bin_file = allroutes + ".bin";
+  return ::stat(allroutes.c_str(), &st) == 0 || ::stat(bin_file.c_str(), &st) == 0;
+}
+
+RrgPathStore::RrgPathStore(const std::string& allroutes, int num_switches,
+                           int diameter, int min_paths) :
+  num_switches_(num_switches),
+  diameter_(diameter),
+  mapped_(nullptr),
+  mapped_size_(0)
+{
+  std::string bin_file = allroutes + ".bin";
+  uint64_t text_size = 0;
+  int64_t text_mtime = 0;
+  struct stat st;
+  bool have_text = ::stat(allroutes.c_str(), &st) == 0;
+  if (have_text){
+    text_size = st.st_size;
+    text_mtime = st.st_mtime;
+  }
+
+  if (map(bin_file, text_size, text_mtime)){
+    debug_printf(sprockit::dbg::topology,
+      "mapped %u rrg paths from %s", pair_offsets_[uint64_t(num_switches_)*num_switches_],
+      bin_file.c_str());
+    return;
+  }
+
+  if (!have_text){
+    spkt_abort_printf("[read_allpaths_from_file]: error reading from file %s\n", allroutes.c_str());
+  }
+  parse(allroutes, min_paths);
+
+  //serve the paths from the page cache so other processes on the node share them
+  if (write(bin_file, text_size, text_mtime) && map(bin_file, text_size, text_mtime)){
+    pair_offsets_vec_ = std::vector<uint32_t>();
+    short_offsets_vec_ = std::vector<uint32_t>();
+    short_paths_vec_ = std::vector<uint32_t>();
+    path_offsets_vec_ = std::vector<uint32_t>();
+    hops_vec_ = std::vector<int32_t>();
+  }
+  debug_printf(sprockit::dbg::topology,
+    "read %u rrg paths from %s", pair_offsets_[uint64_t(num_switches_)*num_switches_],
+    allroutes.c_str());
+}
+
+RrgPathStore::~RrgPathStore()
+{
+  if (mapped_){
+    ::munmap(mapped_, mapped_size_);
+  }
+}
+
+void
+RrgPathStore::setArrays()
+{
+  pair_offsets_ = pair_offsets_vec_.data();
+  short_offsets_ = short_offsets_vec_.data();
+  short_paths_ = short_paths_vec_.data();
+  path_offsets_ = path_offsets_vec_.data();
+  hops_ = hops_vec_.data();
+}
+
+bool
+RrgPathStore::map(const std::string& fname, uint64_t text_size, int64_t text_mtime)
+{
+  int fd = ::open(fname.c_str(), O_RDONLY);
+  if (fd < 0){
+    return false;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(RrgPathHeader)){
+    ::close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED){
+    return false;
+  }
+
+  const RrgPathHeader* header = (const RrgPathHeader*) mapped;
+  bool ok = ::memcmp(header->magic, rrg_path_magic, sizeof(rrg_path_magic)) == 0
+    && header->version == rrg_path_version
+    && header->num_switches == num_switches_
+    && header->diameter == diameter_
+    && binarySize(*header) == size;
+  //without the .allroutes file there is nothing to compare against
+  if (ok && text_size != 0){
+    ok = header->text_size == text_size && header->text_mtime == text_mtime;
+  }
+  if (!ok){
+    debug_printf(sprockit::dbg::topology,
+      "rrg paths in %s are stale, rereading the .allroutes file", fname.c_str());
+    ::munmap(mapped, size);
+    return false;
+  }
+
+  uint64_t num_pairs = uint64_t(num_switches_) * num_switches_;
+  const uint32_t* arrays = (const uint32_t*) (header + 1);
+  pair_offsets_ = arrays;
+  short_offsets_ = pair_offsets_ + num_pairs + 1;
+  path_offsets_ = short_offsets_ + num_pairs + 1;
+  short_paths_ = path_offsets_ + header->num_paths + 1;
+  hops_ = (const int32_t*) (short_paths_ + header->num_short);
+  mapped_ = mapped;
+  mapped_size_ = size;
+  return true;
+}
+
+bool
+RrgPathStore::write(const std::string& fname, uint64_t text_size, int64_t text_mtime) const
+{
+  RrgPathHeader header;
+  ::memset(&header, 0, sizeof(header));
+  ::memcpy(header.magic, rrg_path_magic, sizeof(rrg_path_magic));
+  header.version = rrg_path_version;
+  header.num_switches = num_switches_;
+  header.diameter = diameter_;
+  header.num_paths = path_offsets_vec_.size() - 1;
+  header.num_short = short_paths_vec_.size();
+  header.num_hops = hops_vec_.size();
+  header.text_size = text_size;
+  header.text_mtime = text_mtime;
+
+  //write to a temporary file so that other processes never map a partial file
+  std::string tmp_name = fname + "." + std::to_string(::getpid());
+  FILE* f = fopen(tmp_name.c_str(), "wb");
+  if (!f){
+    std::cerr << "WARNING: unable to write rrg paths to " << fname << std::endl;
+    return false;
+  }
+  auto put = [f](const void* data, size_t bytes){
+    return bytes == 0 || fwrite(data, 1, bytes, f) == bytes;
+  };
+  bool ok = put(&header, sizeof(header))
+    && put(pair_offsets_vec_.data(), pair_offsets_vec_.size() * sizeof(uint32_t))
+    && put(short_offsets_vec_.data(), short_offsets_vec_.size() * sizeof(uint32_t))
+    && put(path_offsets_vec_.data(), path_offsets_vec_.size() * sizeof(uint32_t))
+    && put(short_paths_vec_.data(), short_paths_vec_.size() * sizeof(uint32_t))
+    && put(hops_vec_.data(), hops_vec_.size() * sizeof(int32_t));
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || ::rename(tmp_name.c_str(), fname.c_str()) != 0){
+    ::remove(tmp_name.c_str());
+    std::cerr << "WARNING: unable to write rrg paths to " << fname << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief parseInts Read the integers on one line of an .allroutes file
+ */
+static void
+parseInts(const char* line, std::vector<int32_t>& vals)
+{
+  vals.clear();
+  char* end;
+  while (true){
+    long val = ::strtol(line, &end, 10);
+    if (end == line) break;
+    vals.push_back(val);
+    line = end;
+  }
+}
+
+void
+RrgPathStore::parse(const std::string& allroutes, int min_paths)
+{
+  FILE* f = fopen(allroutes.c_str(), "r");
+  if (!f){
+    spkt_abort_printf("[read_allpaths_from_file]: error reading from file %s\n", allroutes.c_str());
+  }
+
+  //paths in the order of the file, the block of each pair is reordered below
+  struct Block {
+    uint32_t first_path;
+    uint32_t num_paths;
+  };
+  uint64_t num_pairs = uint64_t(num_switches_) * num_switches_;
+  static const uint32_t no_block = uint32_t(-1);
+  std::vector<uint32_t> pair_blocks(num_pairs, no_block);
+  std::vector<Block> blocks;
+  std::vector<uint64_t> file_offsets(1, 0);
+  std::vector<int32_t> file_hops;
+
+  char* line = nullptr;
+  size_t line_capacity = 0;
+  std::vector<int32_t> vals;
+  while (::getline(&line, &line_capacity, f) > 0){
+    parseInts(line, vals);
+    if (vals.empty()) continue;
+    if (vals.size() < 3){
+      spkt_abort_printf("[rrg::read_allpaths_from_file]: bad pair line in %s: %s",
+                        allroutes.c_str(), line);
+    }
+    int s = vals[0], d = vals[1], pathcount = vals[2];
+    if (pathcount < min_paths){
+      spkt_abort_printf("[rrg::read_allpaths_from_file]:Sd pair (%d,%d) has only %d paths, required Kvalue is %d\n",
+                        s, d, pathcount, min_paths);
+    }
+    if (s < 0 || d < 0 || uint32_t(s) >= num_switches_ || uint32_t(d) >= num_switches_){
+      spkt_abort_printf("[rrg::read_allpaths_from_file]: Sd pair (%d,%d) out of range in %s",
+                        s, d, allroutes.c_str());
+    }
+
+    //the following <pathcount> lines will contain routes from s to d
+    Block blk;
+    blk.first_path = file_offsets.size() - 1;
+    blk.num_paths = pathcount;
+    for (int i=0; i < pathcount; ++i){
+      if (::getline(&line, &line_capacity, f) <= 0){
+        spkt_abort_printf("[rrg::read_allpaths_from_file]: %s ends inside the paths from %d to %d",
+                          allroutes.c_str(), s, d);
+      }
+      parseInts(line, vals);
+      file_hops.insert(file_hops.end(), vals.begin(), vals.end());
+      file_offsets.push_back(file_hops.size());
+    }
+    //a pair listed twice keeps its last paths
+    pair_blocks[uint64_t(s) * num_switches_ + d] = blocks.size();
+    blocks.push_back(blk);
+  }
+  ::free(line);
+  fclose(f);
+
+  if (file_hops.size() >= no_block || file_offsets.size() >= no_block){
+    spkt_abort_printf("[rrg::read_allpaths_from_file]: %s has too many paths", allroutes.c_str());
+  }
+
+  pair_offsets_vec_.resize(num_pairs + 1);
+  short_offsets_vec_.resize(num_pairs + 1);
+  path_offsets_vec_.reserve(file_offsets.size());
+  path_offsets_vec_.push_back(0);
+  hops_vec_.reserve(file_hops.size());
+  for (uint64_t pair=0; pair < num_pairs; ++pair){
+    pair_offsets_vec_[pair] = path_offsets_vec_.size() - 1;
+    short_offsets_vec_[pair] = short_paths_vec_.size();
+    if (pair_blocks[pair] == no_block) continue;
+
+    const Block& blk = blocks[pair_blocks[pair]];
+    for (uint32_t p=blk.first_path; p < blk.first_path + blk.num_paths; ++p){
+      uint32_t path = path_offsets_vec_.size() - 1;
+      uint64_t size = file_offsets[p+1] - file_offsets[p];
+      hops_vec_.insert(hops_vec_.end(), file_hops.begin() + file_offsets[p],
+                       file_hops.begin() + file_offsets[p+1]);
+      path_offsets_vec_.push_back(hops_vec_.size());
+      if (size > 0 && int(size - 1) <= diameter_){
+        short_paths_vec_.push_back(path);
+      }
+    }
+  }
+  pair_offsets_vec_[num_pairs] = path_offsets_vec_.size() - 1;
+  short_offsets_vec_[num_pairs] = short_paths_vec_.size();
+  setArrays();
+}
+
+}
+}
@@ -0,0 +1,163 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_HARDWARE_NETWORK_TOPOLOGY_RRG_PATH_STORE_H_INCLUDED
+#define SSTMAC_HARDWARE_NETWORK_TOPOLOGY_RRG_PATH_STORE_H_INCLUDED
+
+#include <sstmac/common/node_address.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sstmac {
+namespace hw {
+
+/**
+ * All paths between every pair of switches in an rrg, read from an .allroutes file.
+ * Paths are stored once in flat arrays indexed by src*N+dst, and the short paths
+ * are a second index into the same paths.  The arrays are written next to the
+ * .allroutes file in a binary form that later runs map directly into memory,
+ * so that every router and thread shares one read-only copy.
+ */
+class RrgPathStore
+{
+ public:
+  /**
+   * The switches along a path, including the source and destination
+   */
+  struct Path {
+    const int32_t* hops;
+    uint32_t size;
+
+    int32_t operator[](uint32_t i) const {
+      return hops[i];
+    }
+  };
+
+  /**
+   * @brief get The paths in an .allroutes file, read on first use
+   * @param allroutes The text file of paths
+   * @param num_switches The number of switches in the topology
+   * @param diameter Paths with at most this many hops are short paths
+   * @param min_paths Abort if any listed switch pair has fewer paths
+   */
+  static const RrgPathStore* get(const std::string& allroutes, int num_switches,
+                                 int diameter, int min_paths);
+
+  static void deleteStatics();
+
+  /**
+   * @return Whether the .allroutes file or its binary form exists
+   */
+  static bool exists(const std::string& allroutes);
+
+  uint32_t numPaths(SwitchId src, SwitchId dst) const {
+    uint64_t pair = uint64_t(src) * num_switches_ + dst;
+    return pair_offsets_[pair+1] - pair_offsets_[pair];
+  }
+
+  Path path(SwitchId src, SwitchId dst, uint32_t idx) const {
+    uint64_t pair = uint64_t(src) * num_switches_ + dst;
+    return makePath(pair_offsets_[pair] + idx);
+  }
+
+  uint32_t numShortPaths(SwitchId src, SwitchId dst) const {
+    uint64_t pair = uint64_t(src) * num_switches_ + dst;
+    return short_offsets_[pair+1] - short_offsets_[pair];
+  }
+
+  Path shortPath(SwitchId src, SwitchId dst, uint32_t idx) const {
+    uint64_t pair = uint64_t(src) * num_switches_ + dst;
+    return makePath(short_paths_[short_offsets_[pair] + idx]);
+  }
+
+  ~RrgPathStore();
+
+ private:
+  RrgPathStore(const std::string& allroutes, int num_switches, int diameter, int min_paths);
+
+  Path makePath(uint32_t path) const {
+    Path p;
+    p.hops = hops_ + path_offsets_[path];
+    p.size = path_offsets_[path+1] - path_offsets_[path];
+    return p;
+  }
+
+  bool map(const std::string& fname, uint64_t text_size, int64_t text_mtime);
+
+  void parse(const std::string& allroutes, int min_paths);
+
+  bool write(const std::string& fname, uint64_t text_size, int64_t text_mtime) const;
+
+  void setArrays();
+
+  uint32_t num_switches_;
+  int diameter_;
+
+  /** For each switch pair, the index of its first path, with a trailing entry for the total */
+  const uint32_t* pair_offsets_;
+  /** For each switch pair, the index of its first short path in short_paths_ */
+  const uint32_t* short_offsets_;
+  /** The path index of each short path */
+  const uint32_t* short_paths_;
+  /** For each path, the index of its first hop, with a trailing entry for the total */
+  const uint32_t* path_offsets_;
+  const int32_t* hops_;
+
+  /** The arrays are mapped from the binary file, or else owned here */
+  void* mapped_;
+  size_t mapped_size_;
+  std::vector<uint32_t> pair_offsets_vec_;
+  std::vector<uint32_t> short_offsets_vec_;
+  std::vector<uint32_t> short_paths_vec_;
+  std::vector<uint32_t> path_offsets_vec_;
+  std::vector<int32_t> hops_vec_;
+
+};
+
+}
+}
+
+#endif
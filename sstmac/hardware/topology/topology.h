@@ -516,9 +516,23 @@ class Topology : public sprockit::printable
 
   static std::string getPortNamespace(int port);
 
-  const nlohmann::json& getRoutingTable(SwitchId sid) const {
-    std::string name = switchIdToName(sid);
-    return routing_tables_.at(name).at("routes");
+  /**
+   * @brief getRoutingTable The JSON routes of a switch, the routing_tables file is parsed on first use
+   */
+  const nlohmann::json& getRoutingTable(SwitchId sid) const;
+
+  /**
+   * @return The JSON file given by routing_tables, empty if there is none
+   */
+  const std::string& routingTablesFile() const {
+    return routing_tables_file_;
+  }
+
+  /**
+   * @return The binary form of the routing tables given by routing_tables_binary, empty if there is none
+   */
+  const std::string& routingTablesBinary() const {
+    return routing_tables_binary_;
   }
 
  protected:
@@ -538,7 +552,10 @@ class Topology : public sprockit::printable
   std::string dot_file_;
   std::string xyz_file_;
   std::string dump_file_;
-  nlohmann::json routing_tables_;
+  std::string routing_tables_file_;
+  std::string routing_tables_binary_;
+  mutable nlohmann::json routing_tables_;
+  mutable bool routing_tables_loaded_;
 
 };
 
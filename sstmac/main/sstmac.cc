@@ -326,8 +326,9 @@ tryMain(sprockit::SimParameters::ptr params,
   SST::Params mainParams(params);
   if (!oo.benchmark.empty()){
     Benchmark* bm = Benchmark::getBuilderLibrary("macro")
-        ->getBuilder(oo.benchmark)->create();
+        ->getBuilder(oo.benchmark)->create(mainParams);
     bm->run();
+    delete bm;
     return 0;
   }
 
@@ -114,7 +114,9 @@ namespace sstmac {
 struct Benchmark {
   SST_ELI_DECLARE_BASE(Benchmark)
   SST_ELI_DECLARE_DEFAULT_INFO()
-  SST_ELI_DECLARE_DEFAULT_CTOR()
+  SST_ELI_DECLARE_CTOR(SST::Params&)
+
+  virtual ~Benchmark(){}
 
   virtual void run() = 0;
 
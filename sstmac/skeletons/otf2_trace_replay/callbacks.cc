@@ -79,7 +79,9 @@ using std::setw;
  *
  * OTF2 definition reader will use these as callbacks when streaming through a
  * trace definition file. Definitions are necessary for converting callback
- * data (integer hashes) into meaningful data about MPI calls
+ * data (integer hashes) into meaningful data about MPI calls.
+ * Global definitions are read once per process into a shared OTF2_GlobalDefs,
+ * which is passed as the userData.
  */
 
 OTF2_CallbackCode def_clock_properties(
@@ -88,8 +90,8 @@ OTF2_CallbackCode def_clock_properties(
   uint64_t globalOffset,
   uint64_t traceLength )
 {
-  auto app = (OTF2TraceReplayApp*)userData;
-  app->otf2_clock_properties =  {
+  auto defs = (OTF2_GlobalDefs*)userData;
+  defs->clockProperties =  {
     timerResolution, globalOffset, traceLength
   };
 
@@ -101,13 +103,12 @@ OTF2_CallbackCode def_string(
   OTF2_StringRef self,
   const char*    str)
 {
-  auto app = (OTF2TraceReplayApp*)userData;
-  app->otf2_string_table[self] = str;
+  auto defs = (OTF2_GlobalDefs*)userData;
+  defs->stringTable[self] = str;
   DEF_PRINT("STRING\n");
   return OTF2_CALLBACK_SUCCESS;
 }
 
-// probably not needed
 OTF2_CallbackCode def_location(
   void*                 userData,
   OTF2_LocationRef      self,
@@ -116,6 +117,8 @@ OTF2_CallbackCode def_location(
   uint64_t              numberOfEvents,
   OTF2_LocationGroupRef locationGroup )
 {
+  auto defs = (OTF2_GlobalDefs*)userData;
+  defs->totalEvents += numberOfEvents;
   return OTF2_CALLBACK_SUCCESS;
 }
 
@@ -142,12 +145,11 @@ OTF2_CallbackCode def_region(
   uint32_t        beginLineNumber,
   uint32_t        endLineNumber )
 {
-  auto app = (OTF2TraceReplayApp*)userData;
+  auto defs = (OTF2_GlobalDefs*)userData;
 
-  auto& str = app->otf2_string_table[name];
-  MPI_CALL_ID id = MPI_call_to_id.get(str);
+  MPI_CALL_ID id = MPI_call_to_id.get(defs->string(name));
   if (id != ID_NULL){
-    app->otf2_regions[self] = id;
+    defs->regions[self] = id;
   }
 
   DEF_PRINT("REGION\n");
@@ -160,14 +162,13 @@ OTF2_CallbackCode def_callpath(
   OTF2_CallpathRef parent,
   OTF2_RegionRef   region )
 {
-  auto app = (OTF2TraceReplayApp*)userData;
-  app->otf2_callpaths.push_back({parent, region});
+  auto defs = (OTF2_GlobalDefs*)userData;
+  defs->callpaths.push_back({parent, region});
 
   DEF_PRINT("CALLPATH\n");
   return OTF2_CALLBACK_SUCCESS;
 }
 
-// May be useful for ID'ing threads
 OTF2_CallbackCode def_group(
   void*           userData,
   OTF2_GroupRef   id,
@@ -178,20 +179,17 @@ OTF2_CallbackCode def_group(
   uint32_t        numberOfMembers,
   const uint64_t* members )
 {
-  auto app = (OTF2TraceReplayApp*)userData;
-
-  if (groupType == OTF2_GROUP_TYPE_COMM_SELF){
-    int me = app->rank();
-    app->getMpi()->groupCreateWithId(id, 1, &me);
-    app->otf2_groups[id] = true; //yes, needed
-  } else {
-    std::vector<int> member_vect(numberOfMembers);
-    for (int i = 0; i < numberOfMembers; i++){
-      member_vect[i] = members[i];
+  auto defs = (OTF2_GlobalDefs*)userData;
+  defs->groups.emplace_back();
+  OTF2_Group& grp = defs->groups.back();
+  grp.id = id;
+  grp.groupType = groupType;
+  //the members of a COMM_SELF group depend on the rank creating it
+  if (groupType != OTF2_GROUP_TYPE_COMM_SELF){
+    grp.members.resize(numberOfMembers);
+    for (uint32_t i = 0; i < numberOfMembers; i++){
+      grp.members[i] = members[i];
     }
-
-    bool included = app->getMpi()->groupCreateWithId(id, numberOfMembers, member_vect.data());
-    app->otf2_groups[id] = included;
   }
 
   DEF_PRINT("GROUP\n");
@@ -205,25 +203,8 @@ OTF2_CallbackCode def_comm(
   OTF2_GroupRef  group,
   OTF2_CommRef   parent )
 {
-  auto app = (OTF2TraceReplayApp*)userData;
-  //As I understand it, OTF2 has already done the local to global conversion
-  //All comm IDs in the trace are global IDs
-  auto local_comm_id = id; //app->convertGlobalToLocalComm(id);
-  app->getMpi()->setGenerateIds(false);
-  bool need_comm = app->otf2_groups[group];
-  if (need_comm){
-    app->getMpi()->commCreateWithId(MPI_COMM_WORLD, group, local_comm_id);
-  } else {
-    auto& str = app->otf2_string_table[name];
-    if (str == "MPI_COMM_WORLD"){
-      MPI_Comm output = local_comm_id;
-      app->getMpi()->commDup(MPI_COMM_WORLD, &output);
-    } else if (str == "MPI_COMM_SELF"){
-      MPI_Comm output = local_comm_id;
-      app->getMpi()->commDup(MPI_COMM_SELF, &output);
-    } else {
-    }
-  }
+  auto defs = (OTF2_GlobalDefs*)userData;
+  defs->comms.push_back({id, name, group});
   DEF_PRINT("COMMUNICATOR\n");
   return OTF2_CALLBACK_SUCCESS;
 }
@@ -653,8 +634,9 @@ OTF2_CallbackCode event_enter(
 
     auto app = (OTF2TraceReplayApp*)userData;
 
-    auto iter = app->otf2_regions.find(region);
-    if (iter == app->otf2_regions.end()){
+    auto& regions = app->globalDefs().regions;
+    auto iter = regions.find(region);
+    if (iter == regions.end()){
       if (app->printUnknownCallback()) {
         std::cout << "unknown OTF2 region \""
                   << region
@@ -1109,8 +1091,9 @@ OTF2_CallbackCode event_leave(
   auto app = (OTF2TraceReplayApp*)userData;
   CallQueue& callqueue = app->getCallQueue();
 
-  auto iter = app->otf2_regions.find(region);
-  if (iter == app->otf2_regions.end()){
+  auto& regions = app->globalDefs().regions;
+  auto iter = regions.find(region);
+  if (iter == regions.end()){
     if (app->printUnknownCallback()) {
       std::cerr << "unknown OTF2 region " << region << std::endl;
     }
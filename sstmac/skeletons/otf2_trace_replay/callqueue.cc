@@ -102,8 +102,8 @@ MpiCall::trigger() {
 sstmac::TimeDelta
 MpiCall::convertTime(const OTF2_TimeStamp ts) const
 {
-  const auto start_offset = app->otf2_clock_properties.globalOffset;
-  const auto ticks_per_second = app->otf2_clock_properties.timerResolution;
+  const auto start_offset = app->globalDefs().clockProperties.globalOffset;
+  const auto ticks_per_second = app->globalDefs().clockProperties.timerResolution;
   return sstmac::TimeDelta(((double(ts) - start_offset)/ticks_per_second));
 }
 
@@ -44,6 +44,8 @@ Questions? Contact sst-macro-help@sandia.gov
 
 #include "otf2_trace_replay.h"
 #include "callbacks.h"
+#include <sstmac/common/thread_lock.h>
+#include <sprockit/statics.h>
 #include <algorithm>
 #include <iomanip>
 #include <string>
@@ -118,9 +120,69 @@ static void check_status(OTF2_ErrorCode status, const std::string& description)
   }
 }
 
+static sprockit::NeedDeletestatics<OTF2_GlobalDefs> del_statics;
+
+static sstmac::thread_lock global_defs_lock;
+static std::map<std::string, OTF2_GlobalDefs*> global_defs_cache;
+
+const std::string&
+OTF2_GlobalDefs::string(OTF2_StringRef ref) const
+{
+  static const std::string empty;
+  auto iter = stringTable.find(ref);
+  return iter == stringTable.end() ? empty : iter->second;
+}
+
+const OTF2_GlobalDefs*
+OTF2_GlobalDefs::get(const std::string& metafile)
+{
+  //every rank of every app replaying the trace asks for the same definitions,
+  //only the first one pays for reading them
+  global_defs_lock.lock();
+  auto iter = global_defs_cache.find(metafile);
+  if (iter != global_defs_cache.end()){
+    global_defs_lock.unlock();
+    return iter->second;
+  }
+
+  auto defs = new OTF2_GlobalDefs;
+  auto reader = OTF2_Reader_Open(metafile.c_str());
+  if (!reader){
+    global_defs_lock.unlock();
+    spkt_abort_printf("OTF2 Error: unable to open trace metafile %s", metafile.c_str());
+  }
+  OTF2_Reader_SetSerialCollectiveCallbacks(reader);
+  check_status(OTF2_Reader_GetNumberOfLocations(reader, &defs->numberOfLocations),
+               "OTF2_Reader_GetNumberOfLocations\n");
+
+  OTF2_GlobalDefReader* global_def_reader = OTF2_Reader_GetGlobalDefReader(reader);
+  OTF2_GlobalDefReaderCallbacks* global_def_callbacks = create_global_def_callbacks();
+  check_status( OTF2_Reader_RegisterGlobalDefCallbacks(reader, global_def_reader, global_def_callbacks, (void*)defs),
+                "OTF2_Reader_RegisterGlobalDefCallbacks\n");
+  OTF2_GlobalDefReaderCallbacks_Delete(global_def_callbacks);
+  uint64_t definitions_read = 0;
+  check_status(OTF2_Reader_ReadAllGlobalDefinitions(reader, global_def_reader, &definitions_read),
+               "OTF2_Reader_ReadAllGlobalDefinitions\n");
+  OTF2_Reader_CloseGlobalDefReader(reader, global_def_reader);
+  OTF2_Reader_Close(reader);
+
+  global_defs_cache[metafile] = defs;
+  global_defs_lock.unlock();
+  return defs;
+}
+
+void
+OTF2_GlobalDefs::deleteStatics()
+{
+  for (auto& pair : global_defs_cache){
+    delete pair.second;
+  }
+  global_defs_cache.clear();
+}
+
 OTF2TraceReplayApp::OTF2TraceReplayApp(SST::Params& params,
         sumi::SoftwareId sid, sstmac::sw::OperatingSystem* os) :
-  App(params, sid, os), mpi_(nullptr), rank_(sid.task_), call_queue_(this), total_events_(0) {
+  App(params, sid, os), mpi_(nullptr), defs_(nullptr), rank_(sid.task_), call_queue_(this), total_events_(0) {
   timescale_ = params.find<double>("otf2_timescale", 1.0);
   terminate_percent_ = params.find<double>("otf2_terminate_percent", 1);
   print_progress_ = params.find<bool>("otf2_print_progress", true);
@@ -171,33 +233,11 @@ OTF2TraceReplayApp::endMpi(const sstmac::TimeDelta wall) {
   compute_time = wall;
 }
 
-struct c_vector {
-  size_t capacity;
-  size_t size;
-  uint64_t members[];
-};
-
-// What did this function do. It caused a memory error, disabling it doesn't seem to affect trace replay.
-static OTF2_CallbackCode
-GlobDefLocation_Register(void* userData,
-  OTF2_LocationRef location, OTF2_StringRef name,
-  OTF2_LocationType locationType, uint64_t numberOfEvents,
-  OTF2_LocationGroupRef locationGroup)
-{
-  auto app = (OTF2TraceReplayApp*)userData;
-  app->addEvents(numberOfEvents);
-
-  return OTF2_CALLBACK_SUCCESS;
-}
-
 OTF2_Reader*
 OTF2TraceReplayApp::initializeEventReader() {
-	// OTF2 has an excellent API
-	uint64_t number_of_locations;
-	//uint64_t trace_length = 0;
-  auto reader = OTF2_Reader_Open(metafile_.c_str());
-  OTF2_Reader_SetSerialCollectiveCallbacks(reader);
-  check_status(OTF2_Reader_GetNumberOfLocations(reader, &number_of_locations), "OTF2_Reader_GetNumberOfLocations\n");
+  defs_ = OTF2_GlobalDefs::get(metafile_);
+  total_events_ = defs_->totalEvents;
+  uint64_t number_of_locations = defs_->numberOfLocations;
 
   if (number_of_locations <= rank_) {
     cerr << "ERROR: Rank " << rank_ << " cannot participate in a trace replay with "
@@ -205,6 +245,11 @@ OTF2TraceReplayApp::initializeEventReader() {
     spkt_abort_printf("ASSERT FAILED: Number of MPI ranks must match the number of trace files");
   }
 
+  // the global definitions are shared, but each rank still needs its own
+  // local definitions and event stream
+  auto reader = OTF2_Reader_Open(metafile_.c_str());
+  OTF2_Reader_SetSerialCollectiveCallbacks(reader);
+
   bool successful_open_def_files = OTF2_Reader_OpenDefFiles(reader) == OTF2_SUCCESS;
   check_status(OTF2_Reader_OpenEvtFiles(reader), "OTF2_Reader_OpenEvtFiles\n");
 
@@ -224,20 +269,7 @@ OTF2TraceReplayApp::initializeEventReader() {
                  "OTF2_Reader_CloseDefFiles\n");
   }
 
-  //struct c_vector* locations = (c_vector*) malloc(sizeof(*locations) + number_of_locations * sizeof(*locations->members));
-  //locations->capacity = number_of_locations;
-  //locations->size = number_of_locations;
-  OTF2_GlobalDefReader* global_def_reader = OTF2_Reader_GetGlobalDefReader(reader);
-  OTF2_GlobalDefReaderCallbacks* global_def_callbacks;
-  global_def_callbacks = create_global_def_callbacks();
-  OTF2_GlobalDefReaderCallbacks_SetLocationCallback(global_def_callbacks, &GlobDefLocation_Register);
-  check_status( OTF2_Reader_RegisterGlobalDefCallbacks(reader, global_def_reader, global_def_callbacks, (void*)this),
-                "OTF2_Reader_RegisterGlobalDefCallbacks\n");
-  OTF2_GlobalDefReaderCallbacks_Delete(global_def_callbacks);
-  definitions_read = 0;
-  check_status(OTF2_Reader_ReadAllGlobalDefinitions(reader, global_def_reader, &definitions_read),
-               "OTF2_Reader_ReadAllGlobalDefinitions\n");
-  OTF2_Reader_CloseGlobalDefReader(reader, global_def_reader);
+  createGroupsAndComms();
 
   OTF2_EvtReader* evt_reader = OTF2_Reader_GetEvtReader(reader, rank_);
   OTF2_EvtReaderCallbacks* event_callbacks = create_evt_callbacks();
@@ -246,11 +278,41 @@ OTF2TraceReplayApp::initializeEventReader() {
       "OTF2_Reader_RegisterEvtCallbacks\n");
   OTF2_EvtReaderCallbacks_Delete(event_callbacks);
 
-  //free(locations);
-
   return reader;
 }
 
+void
+OTF2TraceReplayApp::createGroupsAndComms()
+{
+  std::map<OTF2_GroupRef,bool> included;
+  for (const OTF2_Group& grp : defs_->groups){
+    if (grp.groupType == OTF2_GROUP_TYPE_COMM_SELF){
+      int me = rank_;
+      mpi_->groupCreateWithId(grp.id, 1, &me);
+      included[grp.id] = true; //yes, needed
+    } else {
+      included[grp.id] = mpi_->groupCreateWithId(grp.id, grp.members.size(), grp.members.data());
+    }
+  }
+
+  //As I understand it, OTF2 has already done the local to global conversion
+  //All comm IDs in the trace are global IDs
+  mpi_->setGenerateIds(false);
+  for (const OTF2_Comm& comm : defs_->comms){
+    if (included[comm.group]){
+      mpi_->commCreateWithId(MPI_COMM_WORLD, comm.group, comm.id);
+    } else {
+      auto& str = defs_->string(comm.name);
+      MPI_Comm output = comm.id;
+      if (str == "MPI_COMM_WORLD"){
+        mpi_->commDup(MPI_COMM_WORLD, &output);
+      } else if (str == "MPI_COMM_SELF"){
+        mpi_->commDup(MPI_COMM_SELF, &output);
+      }
+    }
+  }
+}
+
 inline uint64_t
 handle_events(OTF2_Reader* reader, OTF2_EvtReader* event_reader) {
   uint64_t events_read = 0;
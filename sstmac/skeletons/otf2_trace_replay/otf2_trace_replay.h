@@ -99,8 +99,8 @@ class OTF2TraceReplayApp : public sstmac::sw::App {
     return rank_;
   }
 
-  void addEvents(int events){
-    total_events_ += events;
+  const OTF2_GlobalDefs& globalDefs() const {
+    return *defs_;
   }
 
   void localToGlobalComm(MPI_Comm local, MPI_Comm global){
@@ -122,16 +122,11 @@ class OTF2TraceReplayApp : public sstmac::sw::App {
 
   void endMpi(sstmac::TimeDelta);
 
-  OTF2_ClockProperties otf2_clock_properties;
-  std::map<OTF2_StringRef, std::string> otf2_string_table;
-  std::map<OTF2_RegionRef, MPI_CALL_ID> otf2_regions;
-  std::vector<OTF2_Callpath> otf2_callpaths;
-  std::map<OTF2_GroupRef,bool> otf2_groups;
-
   ~OTF2TraceReplayApp() throw()	{ }
 
  private:
   OTF2_Reader* initializeEventReader();
+  void createGroupsAndComms();
   void initiateTraceReplay(OTF2_Reader*);
   void verifyReplaySuccess();
 
@@ -145,6 +140,8 @@ class OTF2TraceReplayApp : public sstmac::sw::App {
 
   sumi::MpiApi* mpi_;
 
+  const OTF2_GlobalDefs* defs_;
+
   double timescale_;
   double terminate_percent_;
   bool print_progress_;
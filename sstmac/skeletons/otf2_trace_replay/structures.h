@@ -90,6 +90,55 @@ struct OTF2_Callpath {
   OTF2_RegionRef region;
 };
 
+struct OTF2_Group {
+  OTF2_GroupRef id;
+  OTF2_GroupType groupType;
+  std::vector<int> members;
+};
+
+struct OTF2_Comm {
+  OTF2_CommRef id;
+  OTF2_StringRef name;
+  OTF2_GroupRef group;
+};
+
+/**
+ * The global definitions of a trace archive. These are identical for every rank,
+ * so they are read once per process and shared read-only by all ranks replaying the archive.
+ * Groups and communicators are kept in definition order so each rank can
+ * create them against its own MPI instance.
+ */
+struct OTF2_GlobalDefs {
+  OTF2_ClockProperties clockProperties;
+  std::unordered_map<OTF2_StringRef, std::string> stringTable;
+  std::unordered_map<OTF2_RegionRef, MPI_CALL_ID> regions;
+  std::vector<OTF2_Callpath> callpaths;
+  std::vector<OTF2_Group> groups;
+  std::vector<OTF2_Comm> comms;
+  uint64_t numberOfLocations;
+  uint64_t totalEvents;
+
+  OTF2_GlobalDefs() :
+    clockProperties{0,0,0}, numberOfLocations(0), totalEvents(0)
+  {
+  }
+
+  /**
+   * @return The string for the reference, empty if it was never defined
+   */
+  const std::string& string(OTF2_StringRef ref) const;
+
+  /**
+   * @brief get Read the global definitions of a trace on first use
+   * @param metafile The path to the trace metafile
+   * @return The shared definitions, owned by the cache
+   */
+  static const OTF2_GlobalDefs* get(const std::string& metafile);
+
+  static void deleteStatics();
+
+};
+
 struct MPINameIDMap {
   std::unordered_map<std::string, MPI_CALL_ID> idMap;
   MPI_CALL_ID get(const std::string& str){
@@ -0,0 +1,620 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/skeletons/sstreplay/replay_convert.h>
+#include <sstmac/skeletons/sstreplay/replay_format.h>
+#include <sstmac/dumpi_util/dumpi_meta.h>
+#include <sstmac/dumpi_util/dumpi_util.h>
+#include <sprockit/errors.h>
+#include <dumpi/libundumpi/libundumpi.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace sumi {
+
+/**
+ * Converts the calls of one rank. Calls without a callback here are never seen,
+ * so their time is folded into the compute gap before the next converted call.
+ */
+class DumpiRankConverter
+{
+ public:
+  DumpiRankConverter(ReplayWriter& writer, ReplayRankWriter& rank) :
+    writer_(writer), rank_(rank),
+    initialized_(false), finalized_(false), pending_gap_(0),
+    next_comm_(replay_first_table_comm)
+  {
+    last_stop_.sec = 0;
+    last_stop_.nsec = 0;
+    ::memset(&sizes_, 0, sizeof(sizes_));
+  }
+
+  ~DumpiRankConverter(){
+    if (sizes_.size) ::free(sizes_.size);
+  }
+
+  void convert(const std::string& fname);
+
+  static libundumpi_callbacks* callbacks();
+
+ private:
+  /**
+   * @return The compute gap before this call, plus the gaps of calls that were dropped
+   */
+  uint64_t gap(const dumpi_time* wall){
+    uint64_t ns = pending_gap_;
+    pending_gap_ = 0;
+    if (initialized_){
+      int64_t dt = int64_t(wall->start.sec - last_stop_.sec) * 1000000000LL
+          + (wall->start.nsec - last_stop_.nsec);
+      if (dt > 0) ns += dt;
+    }
+    last_stop_ = wall->stop;
+    return ns;
+  }
+
+  void add(ReplayOp op, const dumpi_time* wall, std::vector<int64_t>&& args){
+    uint64_t ns = gap(wall);
+    if (!initialized_ && op != Replay_Init){
+      rank_.add(Replay_Init, 0, {});
+      initialized_ = true;
+    }
+    rank_.add(op, ns, std::move(args));
+  }
+
+  /** A call that produces no event, its duration is dropped */
+  void pass(const dumpi_time* wall){
+    pending_gap_ = gap(wall);
+  }
+
+  int64_t type(dumpi_datatype id){
+    if (id >= sizes_.count){
+      spkt_abort_printf("DUMPI datatype %d has no recorded size", int(id));
+    }
+    return writer_.internType(sizes_.size[id]);
+  }
+
+  int64_t comm(dumpi_comm id){
+    if (id == DUMPI_COMM_WORLD) return replay_comm_world;
+    if (id == DUMPI_COMM_SELF) return replay_comm_self;
+    auto iter = comms_.find(id);
+    if (iter == comms_.end()){
+      spkt_abort_printf("DUMPI comm %d was not created by MPI_Comm_split or MPI_Comm_dup",
+                        int(id));
+    }
+    return iter->second;
+  }
+
+  int64_t newComm(dumpi_comm id){
+    int64_t idx = next_comm_++;
+    comms_[id] = idx;
+    return idx;
+  }
+
+  static int64_t peer(dumpi_source id){
+    if (id == DUMPI_ANY_SOURCE) return replay_any_source;
+    if (id == DUMPI_ROOT) return replay_root;
+    return id;
+  }
+
+  static int64_t tag(dumpi_tag id){
+    if (id == DUMPI_ANY_TAG) return replay_any_tag;
+    return id;
+  }
+
+  /** Request ids are reused by the application, so are their slots */
+  int64_t slot(dumpi_request req){
+    auto iter = slots_.find(req);
+    if (iter == slots_.end()){
+      int64_t idx = slots_.size();
+      slots_[req] = idx;
+      return idx;
+    }
+    return iter->second;
+  }
+
+  void waitSlots(const dumpi_time* wall, std::vector<int64_t>& slots){
+    if (slots.empty()){
+      pass(wall);
+    } else if (slots.size() == 1){
+      add(Replay_Wait, wall, {slots[0]});
+    } else {
+      slots.insert(slots.begin(), int64_t(slots.size()));
+      add(Replay_Waitall, wall, std::move(slots));
+    }
+  }
+
+  void waitOne(const dumpi_time* wall, dumpi_request req){
+    std::vector<int64_t> slots;
+    if (req != DUMPI_REQUEST_NULL) slots.push_back(slot(req));
+    waitSlots(wall, slots);
+  }
+
+  void waitAll(const dumpi_time* wall, int count, const dumpi_request* reqs){
+    std::vector<int64_t> slots;
+    for (int i=0; i < count; ++i){
+      if (reqs[i] != DUMPI_REQUEST_NULL) slots.push_back(slot(reqs[i]));
+    }
+    waitSlots(wall, slots);
+  }
+
+  void waitSome(const dumpi_time* wall, int outcount, const int* indices,
+                const dumpi_request* reqs){
+    std::vector<int64_t> slots;
+    for (int i=0; i < outcount; ++i){
+      dumpi_request req = reqs[indices[i]];
+      if (req != DUMPI_REQUEST_NULL) slots.push_back(slot(req));
+    }
+    waitSlots(wall, slots);
+  }
+
+  std::vector<int64_t> counts(int n, const int* cnts){
+    std::vector<int64_t> args;
+    args.reserve(n + 1);
+    args.push_back(n);
+    for (int i=0; i < n; ++i) args.push_back(cnts[i]);
+    return args;
+  }
+
+  static DumpiRankConverter* get(void* uarg){
+    return static_cast<DumpiRankConverter*>(uarg);
+  }
+
+#define DUMPI_CONVERT_CALLBACK(name, type) \
+  static int name(const type* prm, uint16_t thread, const dumpi_time* cpu, \
+                  const dumpi_time* wall, const dumpi_perfinfo* perf, void* uarg)
+
+  DUMPI_CONVERT_CALLBACK(onSend, dumpi_send);
+  DUMPI_CONVERT_CALLBACK(onBsend, dumpi_bsend);
+  DUMPI_CONVERT_CALLBACK(onSsend, dumpi_ssend);
+  DUMPI_CONVERT_CALLBACK(onRsend, dumpi_rsend);
+  DUMPI_CONVERT_CALLBACK(onRecv, dumpi_recv);
+  DUMPI_CONVERT_CALLBACK(onIsend, dumpi_isend);
+  DUMPI_CONVERT_CALLBACK(onIbsend, dumpi_ibsend);
+  DUMPI_CONVERT_CALLBACK(onIssend, dumpi_issend);
+  DUMPI_CONVERT_CALLBACK(onIrsend, dumpi_irsend);
+  DUMPI_CONVERT_CALLBACK(onIrecv, dumpi_irecv);
+  DUMPI_CONVERT_CALLBACK(onWait, dumpi_wait);
+  DUMPI_CONVERT_CALLBACK(onTest, dumpi_test);
+  DUMPI_CONVERT_CALLBACK(onWaitany, dumpi_waitany);
+  DUMPI_CONVERT_CALLBACK(onTestany, dumpi_testany);
+  DUMPI_CONVERT_CALLBACK(onWaitall, dumpi_waitall);
+  DUMPI_CONVERT_CALLBACK(onTestall, dumpi_testall);
+  DUMPI_CONVERT_CALLBACK(onWaitsome, dumpi_waitsome);
+  DUMPI_CONVERT_CALLBACK(onTestsome, dumpi_testsome);
+  DUMPI_CONVERT_CALLBACK(onSendrecv, dumpi_sendrecv);
+  DUMPI_CONVERT_CALLBACK(onBarrier, dumpi_barrier);
+  DUMPI_CONVERT_CALLBACK(onBcast, dumpi_bcast);
+  DUMPI_CONVERT_CALLBACK(onReduce, dumpi_reduce);
+  DUMPI_CONVERT_CALLBACK(onAllreduce, dumpi_allreduce);
+  DUMPI_CONVERT_CALLBACK(onScan, dumpi_scan);
+  DUMPI_CONVERT_CALLBACK(onGather, dumpi_gather);
+  DUMPI_CONVERT_CALLBACK(onScatter, dumpi_scatter);
+  DUMPI_CONVERT_CALLBACK(onAllgather, dumpi_allgather);
+  DUMPI_CONVERT_CALLBACK(onAlltoall, dumpi_alltoall);
+  DUMPI_CONVERT_CALLBACK(onAllgatherv, dumpi_allgatherv);
+  DUMPI_CONVERT_CALLBACK(onAlltoallv, dumpi_alltoallv);
+  DUMPI_CONVERT_CALLBACK(onReduceScatter, dumpi_reduce_scatter);
+  DUMPI_CONVERT_CALLBACK(onCommSplit, dumpi_comm_split);
+  DUMPI_CONVERT_CALLBACK(onCommDup, dumpi_comm_dup);
+  DUMPI_CONVERT_CALLBACK(onCommFree, dumpi_comm_free);
+  DUMPI_CONVERT_CALLBACK(onInit, dumpi_init);
+  DUMPI_CONVERT_CALLBACK(onInitThread, dumpi_init_thread);
+  DUMPI_CONVERT_CALLBACK(onFinalize, dumpi_finalize);
+
+#undef DUMPI_CONVERT_CALLBACK
+
+  ReplayWriter& writer_;
+  ReplayRankWriter& rank_;
+  dumpi_sizeof sizes_;
+  dumpi_clock last_stop_;
+  bool initialized_;
+  bool finalized_;
+  uint64_t pending_gap_;
+  int64_t next_comm_;
+  std::unordered_map<int, int64_t> comms_;
+  std::unordered_map<dumpi_request, int64_t> slots_;
+};
+
+#define DUMPI_CONVERT_DEFINE(name, type) \
+  int DumpiRankConverter::name(const type* prm, uint16_t, const dumpi_time*, \
+                               const dumpi_time* wall, const dumpi_perfinfo*, void* uarg)
+
+#define DUMPI_CONVERT_FORWARD(name, type, target, target_type) \
+  DUMPI_CONVERT_DEFINE(name, type) \
+  { \
+    return target((const target_type*) prm, 0, nullptr, wall, nullptr, uarg); \
+  }
+
+DUMPI_CONVERT_DEFINE(onSend, dumpi_send)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Send, wall, {prm->count, cv->type(prm->datatype), peer(prm->dest),
+                              tag(prm->tag), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_FORWARD(onBsend, dumpi_bsend, onSend, dumpi_send)
+DUMPI_CONVERT_FORWARD(onSsend, dumpi_ssend, onSend, dumpi_send)
+DUMPI_CONVERT_FORWARD(onRsend, dumpi_rsend, onSend, dumpi_send)
+
+DUMPI_CONVERT_DEFINE(onRecv, dumpi_recv)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Recv, wall, {prm->count, cv->type(prm->datatype), peer(prm->source),
+                              tag(prm->tag), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onIsend, dumpi_isend)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Isend, wall, {prm->count, cv->type(prm->datatype), peer(prm->dest),
+                               tag(prm->tag), cv->comm(prm->comm), cv->slot(prm->request)});
+  return 1;
+}
+
+DUMPI_CONVERT_FORWARD(onIbsend, dumpi_ibsend, onIsend, dumpi_isend)
+DUMPI_CONVERT_FORWARD(onIssend, dumpi_issend, onIsend, dumpi_isend)
+DUMPI_CONVERT_FORWARD(onIrsend, dumpi_irsend, onIsend, dumpi_isend)
+
+DUMPI_CONVERT_DEFINE(onIrecv, dumpi_irecv)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Irecv, wall, {prm->count, cv->type(prm->datatype), peer(prm->source),
+                               tag(prm->tag), cv->comm(prm->comm), cv->slot(prm->request)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onWait, dumpi_wait)
+{
+  get(uarg)->waitOne(wall, prm->request);
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onTest, dumpi_test)
+{
+  //a successful test is replayed as the wait that completes the same request
+  if (prm->flag) get(uarg)->waitOne(wall, prm->request);
+  else get(uarg)->pass(wall);
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onWaitany, dumpi_waitany)
+{
+  if (prm->index >= 0 && prm->index < prm->count){
+    get(uarg)->waitOne(wall, prm->requests[prm->index]);
+  } else {
+    get(uarg)->pass(wall);
+  }
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onTestany, dumpi_testany)
+{
+  if (prm->flag && prm->index >= 0 && prm->index < prm->count){
+    get(uarg)->waitOne(wall, prm->requests[prm->index]);
+  } else {
+    get(uarg)->pass(wall);
+  }
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onWaitall, dumpi_waitall)
+{
+  get(uarg)->waitAll(wall, prm->count, prm->requests);
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onTestall, dumpi_testall)
+{
+  if (prm->flag) get(uarg)->waitAll(wall, prm->count, prm->requests);
+  else get(uarg)->pass(wall);
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onWaitsome, dumpi_waitsome)
+{
+  get(uarg)->waitSome(wall, prm->outcount, prm->indices, prm->requests);
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onTestsome, dumpi_testsome)
+{
+  get(uarg)->waitSome(wall, prm->outcount, prm->indices, prm->requests);
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onSendrecv, dumpi_sendrecv)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Sendrecv, wall, {prm->sendcount, cv->type(prm->sendtype), peer(prm->dest),
+                                  tag(prm->sendtag), prm->recvcount, cv->type(prm->recvtype),
+                                  peer(prm->source), tag(prm->recvtag), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onBarrier, dumpi_barrier)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Barrier, wall, {cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onBcast, dumpi_bcast)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Bcast, wall, {prm->count, cv->type(prm->datatype),
+                               peer(prm->root), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onReduce, dumpi_reduce)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Reduce, wall, {prm->count, cv->type(prm->datatype),
+                                peer(prm->root), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onAllreduce, dumpi_allreduce)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Allreduce, wall, {prm->count, cv->type(prm->datatype), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onScan, dumpi_scan)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Scan, wall, {prm->count, cv->type(prm->datatype), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onGather, dumpi_gather)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Gather, wall, {prm->sendcount, cv->type(prm->sendtype),
+                                prm->recvcount, cv->type(prm->recvtype),
+                                peer(prm->root), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onScatter, dumpi_scatter)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Scatter, wall, {prm->sendcount, cv->type(prm->sendtype),
+                                 prm->recvcount, cv->type(prm->recvtype),
+                                 peer(prm->root), cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onAllgather, dumpi_allgather)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Allgather, wall, {prm->sendcount, cv->type(prm->sendtype),
+                                   prm->recvcount, cv->type(prm->recvtype),
+                                   cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onAlltoall, dumpi_alltoall)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Alltoall, wall, {prm->sendcount, cv->type(prm->sendtype),
+                                  prm->recvcount, cv->type(prm->recvtype),
+                                  cv->comm(prm->comm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onAllgatherv, dumpi_allgatherv)
+{
+  auto cv = get(uarg);
+  std::vector<int64_t> args;
+  args.push_back(prm->sendcount);
+  args.push_back(cv->type(prm->sendtype));
+  std::vector<int64_t> recv = cv->counts(prm->commsize, prm->recvcounts);
+  args.insert(args.end(), recv.begin(), recv.end());
+  args.push_back(cv->type(prm->recvtype));
+  args.push_back(cv->comm(prm->comm));
+  cv->add(Replay_Allgatherv, wall, std::move(args));
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onAlltoallv, dumpi_alltoallv)
+{
+  auto cv = get(uarg);
+  std::vector<int64_t> args = cv->counts(prm->commsize, prm->sendcounts);
+  args.push_back(cv->type(prm->sendtype));
+  std::vector<int64_t> recv = cv->counts(prm->commsize, prm->recvcounts);
+  args.insert(args.end(), recv.begin(), recv.end());
+  args.push_back(cv->type(prm->recvtype));
+  args.push_back(cv->comm(prm->comm));
+  cv->add(Replay_Alltoallv, wall, std::move(args));
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onReduceScatter, dumpi_reduce_scatter)
+{
+  auto cv = get(uarg);
+  std::vector<int64_t> args = cv->counts(prm->commsize, prm->recvcounts);
+  args.push_back(cv->type(prm->datatype));
+  args.push_back(cv->comm(prm->comm));
+  cv->add(Replay_ReduceScatter, wall, std::move(args));
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onCommSplit, dumpi_comm_split)
+{
+  auto cv = get(uarg);
+  int64_t parent = cv->comm(prm->oldcomm);
+  int64_t color = prm->color == DUMPI_UNDEFINED ? replay_undefined : prm->color;
+  cv->add(Replay_CommSplit, wall, {parent, color, prm->key, cv->newComm(prm->newcomm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onCommDup, dumpi_comm_dup)
+{
+  auto cv = get(uarg);
+  int64_t parent = cv->comm(prm->oldcomm);
+  cv->add(Replay_CommDup, wall, {parent, cv->newComm(prm->newcomm)});
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onCommFree, dumpi_comm_free)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_CommFree, wall, {cv->comm(prm->comm)});
+  cv->comms_.erase(prm->comm);
+  return 1;
+}
+
+DUMPI_CONVERT_DEFINE(onInit, dumpi_init)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Init, wall, {});
+  cv->initialized_ = true;
+  return 1;
+}
+
+DUMPI_CONVERT_FORWARD(onInitThread, dumpi_init_thread, onInit, dumpi_init)
+
+DUMPI_CONVERT_DEFINE(onFinalize, dumpi_finalize)
+{
+  auto cv = get(uarg);
+  cv->add(Replay_Finalize, wall, {});
+  cv->finalized_ = true;
+  return 1;
+}
+
+libundumpi_callbacks*
+DumpiRankConverter::callbacks()
+{
+  static libundumpi_callbacks* cbacks = nullptr;
+  if (cbacks) return cbacks;
+
+  cbacks = new libundumpi_callbacks;
+  libundumpi_clear_callbacks(cbacks);
+  cbacks->on_send           = onSend;
+  cbacks->on_bsend          = onBsend;
+  cbacks->on_ssend          = onSsend;
+  cbacks->on_rsend          = onRsend;
+  cbacks->on_recv           = onRecv;
+  cbacks->on_isend          = onIsend;
+  cbacks->on_ibsend         = onIbsend;
+  cbacks->on_issend         = onIssend;
+  cbacks->on_irsend         = onIrsend;
+  cbacks->on_irecv          = onIrecv;
+  cbacks->on_wait           = onWait;
+  cbacks->on_test           = onTest;
+  cbacks->on_waitany        = onWaitany;
+  cbacks->on_testany        = onTestany;
+  cbacks->on_waitall        = onWaitall;
+  cbacks->on_testall        = onTestall;
+  cbacks->on_waitsome       = onWaitsome;
+  cbacks->on_testsome       = onTestsome;
+  cbacks->on_sendrecv       = onSendrecv;
+  cbacks->on_barrier        = onBarrier;
+  cbacks->on_bcast          = onBcast;
+  cbacks->on_reduce         = onReduce;
+  cbacks->on_allreduce      = onAllreduce;
+  cbacks->on_scan           = onScan;
+  cbacks->on_gather         = onGather;
+  cbacks->on_scatter        = onScatter;
+  cbacks->on_allgather      = onAllgather;
+  cbacks->on_alltoall       = onAlltoall;
+  cbacks->on_allgatherv     = onAllgatherv;
+  cbacks->on_alltoallv      = onAlltoallv;
+  cbacks->on_reduce_scatter = onReduceScatter;
+  cbacks->on_comm_split     = onCommSplit;
+  cbacks->on_comm_dup       = onCommDup;
+  cbacks->on_comm_free      = onCommFree;
+  cbacks->on_init           = onInit;
+  cbacks->on_init_thread    = onInitThread;
+  cbacks->on_finalize       = onFinalize;
+  return cbacks;
+}
+
+void
+DumpiRankConverter::convert(const std::string& fname)
+{
+  dumpi_profile* profile = undumpi_open(fname.c_str());
+  if (!profile){
+    throw sprockit::IOError("convertDumpi: unable to open \"" + fname + "\" for reading");
+  }
+  sizes_ = undumpi_read_datatype_sizes(profile);
+  int retval = undumpi_read_stream_full(fname.c_str(), profile, callbacks(), this, 0);
+  undumpi_close(profile);
+  if (retval != 1){
+    spkt_abort_printf("convertDumpi: failed reading dumpi stream %s", fname.c_str());
+  }
+  if (!finalized_){
+    rank_.add(Replay_Finalize, pending_gap_, {});
+  }
+}
+
+void
+convertDumpi(const std::string& metafile, const std::string& output, bool print_progress)
+{
+  sstmac::sw::DumpiMeta meta(metafile);
+  int nproc = meta.numProcs();
+  ReplayWriter writer(output, nproc);
+  for (int rank=0; rank < nproc; ++rank){
+    ReplayRankWriter rank_writer;
+    {
+      DumpiRankConverter converter(writer, rank_writer);
+      converter.convert(sstmac::sw::dumpiFileName(rank, meta.dirplusfileprefix_));
+    }
+    writer.writeRank(rank, rank_writer);
+    if (print_progress){
+      std::cout << "converted rank " << rank << ": "
+                << rank_writer.numEvents() << " events" << std::endl;
+    }
+  }
+  writer.close();
+}
+
+}
@@ -0,0 +1,558 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/skeletons/sstreplay/replay_convert.h>
+#include <sstmac/skeletons/sstreplay/replay_format.h>
+#include <sstmac/skeletons/otf2_trace_replay/structures.h>
+#include <sstmac/skeletons/otf2_trace_replay/callid.h>
+#include <sprockit/errors.h>
+#include <otf2/otf2.h>
+#include <iostream>
+#include <unordered_map>
+
+namespace sumi {
+
+static void
+check_status(OTF2_ErrorCode status, const char* description)
+{
+  if (status != OTF2_SUCCESS){
+    spkt_abort_printf("OTF2 Error: %s  %s", OTF2_Error_GetName(status), description);
+  }
+}
+
+/**
+ * The replay comm index and size of every OTF2 comm.
+ * OTF2 comm ids are global, so the table is shared by all ranks.
+ */
+class Otf2CommTable
+{
+ public:
+  Otf2CommTable(const OTF2_GlobalDefs* defs, ReplayWriter& writer) :
+    world_size_(defs->numberOfLocations)
+  {
+    std::unordered_map<OTF2_GroupRef, const OTF2_Group*> groups;
+    for (const OTF2_Group& grp : defs->groups){
+      groups[grp.id] = &grp;
+    }
+    for (const OTF2_Comm& comm : defs->comms){
+      auto iter = groups.find(comm.group);
+      const OTF2_Group* grp = iter == groups.end() ? nullptr : iter->second;
+      const std::string& name = defs->string(comm.name);
+      if (!grp || grp->groupType == OTF2_GROUP_TYPE_COMM_SELF || name == "MPI_COMM_SELF"){
+        comms_[comm.id] = {replay_comm_self, 1};
+      } else if (name == "MPI_COMM_WORLD"){
+        comms_[comm.id] = {replay_comm_world, world_size_};
+      } else {
+        int idx = writer.addComm(grp->members);
+        comms_[comm.id] = {idx, int(grp->members.size())};
+      }
+    }
+  }
+
+  int index(OTF2_CommRef comm) const {
+    return find(comm).first;
+  }
+
+  int size(OTF2_CommRef comm) const {
+    return find(comm).second;
+  }
+
+ private:
+  const std::pair<int,int>& find(OTF2_CommRef comm) const {
+    auto iter = comms_.find(comm);
+    if (iter == comms_.end()){
+      spkt_abort_printf("OTF2 comm %u has no definition", comm);
+    }
+    return iter->second;
+  }
+
+  int world_size_;
+  std::unordered_map<OTF2_CommRef, std::pair<int,int>> comms_;
+};
+
+/**
+ * Converts the events of one location. Calls are delimited by Enter/Leave of MPI regions,
+ * the message events inside a region give the arguments and the requests completed by it.
+ * Regions that produce no event have their time folded into the next compute gap.
+ */
+class Otf2RankConverter
+{
+ public:
+  Otf2RankConverter(const OTF2_GlobalDefs* defs, const Otf2CommTable& comms,
+                    ReplayWriter& writer, ReplayRankWriter& rank) :
+    defs_(defs), comms_(comms), rank_(rank),
+    byte_type_(writer.internType(1)),
+    int_type_(writer.internType(4)),
+    in_mpi_(false), depth_(0), started_(false), initialized_(false), finalized_(false),
+    call_(ID_NULL),
+    last_leave_(0), gap_(0), pending_gap_(0),
+    emitted_(false), have_send_(false), have_recv_(false)
+  {
+  }
+
+  void convert(OTF2_Reader* reader, OTF2_LocationRef loc);
+
+  static OTF2_EvtReaderCallbacks* createCallbacks();
+
+ private:
+  static Otf2RankConverter* get(void* userData){
+    return static_cast<Otf2RankConverter*>(userData);
+  }
+
+  uint64_t toNs(OTF2_TimeStamp ticks) const {
+    return uint64_t(double(ticks) * 1e9 / defs_->clockProperties.timerResolution);
+  }
+
+  /** The first event of a region carries the compute gap before it */
+  uint64_t takeGap(){
+    uint64_t gap = gap_;
+    gap_ = 0;
+    return gap;
+  }
+
+  void add(ReplayOp op, std::vector<int64_t>&& args){
+    if (!initialized_ && op != Replay_Init){
+      rank_.add(Replay_Init, 0, {});
+      initialized_ = true;
+    }
+    rank_.add(op, takeGap(), std::move(args));
+    emitted_ = true;
+  }
+
+  int64_t slot(uint64_t request){
+    auto iter = slots_.find(request);
+    if (iter == slots_.end()){
+      int64_t idx = slots_.size();
+      slots_[request] = idx;
+      return idx;
+    }
+    return iter->second;
+  }
+
+  void enter(OTF2_TimeStamp time, MPI_CALL_ID id);
+
+  void leave(OTF2_TimeStamp time);
+
+  void collective(OTF2_CollectiveOp op, OTF2_CommRef comm, uint32_t root,
+                  uint64_t sent, uint64_t recvd);
+
+  static OTF2_CallbackCode onEnter(OTF2_LocationRef, OTF2_TimeStamp time, uint64_t,
+                                   void* userData, OTF2_AttributeList*, OTF2_RegionRef region);
+
+  static OTF2_CallbackCode onLeave(OTF2_LocationRef, OTF2_TimeStamp time, uint64_t,
+                                   void* userData, OTF2_AttributeList*, OTF2_RegionRef region);
+
+  static OTF2_CallbackCode onSend(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                  void* userData, OTF2_AttributeList*, uint32_t receiver,
+                                  OTF2_CommRef comm, uint32_t tag, uint64_t length);
+
+  static OTF2_CallbackCode onRecv(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                  void* userData, OTF2_AttributeList*, uint32_t sender,
+                                  OTF2_CommRef comm, uint32_t tag, uint64_t length);
+
+  static OTF2_CallbackCode onIsend(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                   void* userData, OTF2_AttributeList*, uint32_t receiver,
+                                   OTF2_CommRef comm, uint32_t tag, uint64_t length,
+                                   uint64_t request);
+
+  static OTF2_CallbackCode onIsendComplete(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                           void* userData, OTF2_AttributeList*, uint64_t request);
+
+  static OTF2_CallbackCode onIrecvRequest(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                          void* userData, OTF2_AttributeList*, uint64_t request);
+
+  static OTF2_CallbackCode onIrecv(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                   void* userData, OTF2_AttributeList*, uint32_t sender,
+                                   OTF2_CommRef comm, uint32_t tag, uint64_t length,
+                                   uint64_t request);
+
+  static OTF2_CallbackCode onCollectiveEnd(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                           void* userData, OTF2_AttributeList*,
+                                           OTF2_CollectiveOp op, OTF2_CommRef comm,
+                                           uint32_t root, uint64_t sent, uint64_t recvd);
+
+  const OTF2_GlobalDefs* defs_;
+  const Otf2CommTable& comms_;
+  ReplayRankWriter& rank_;
+  int64_t byte_type_;
+  int64_t int_type_;
+
+  bool in_mpi_;
+  int depth_;
+  bool started_;
+  bool initialized_;
+  bool finalized_;
+  MPI_CALL_ID call_;
+  OTF2_TimeStamp last_leave_;
+  uint64_t gap_;
+  uint64_t pending_gap_;
+
+  //state of the region being converted
+  bool emitted_;
+  bool have_send_;
+  bool have_recv_;
+  std::vector<int64_t> send_args_;
+  std::vector<int64_t> recv_args_;
+  std::vector<int64_t> completed_;
+
+  std::unordered_map<uint64_t, int64_t> slots_;
+  std::unordered_map<uint64_t, size_t> pending_irecvs_;
+};
+
+void
+Otf2RankConverter::enter(OTF2_TimeStamp time, MPI_CALL_ID id)
+{
+  if (in_mpi_){
+    ++depth_;
+    return;
+  }
+  in_mpi_ = true;
+  call_ = id;
+  gap_ = pending_gap_;
+  pending_gap_ = 0;
+  if (started_ && time > last_leave_){
+    gap_ += toNs(time - last_leave_);
+  }
+  emitted_ = false;
+  have_send_ = false;
+  have_recv_ = false;
+  completed_.clear();
+}
+
+void
+Otf2RankConverter::leave(OTF2_TimeStamp time)
+{
+  if (depth_ > 0){
+    --depth_;
+    return;
+  }
+  if (!in_mpi_) return;
+
+  if (call_ == ID_MPI_Sendrecv && have_send_ && have_recv_){
+    std::vector<int64_t> args = {send_args_[0], send_args_[1], send_args_[2], send_args_[3],
+                                 recv_args_[0], recv_args_[1], recv_args_[2], recv_args_[3],
+                                 send_args_[4]};
+    add(Replay_Sendrecv, std::move(args));
+  } else {
+    if (have_send_) add(Replay_Send, std::move(send_args_));
+    if (have_recv_) add(Replay_Recv, std::move(recv_args_));
+  }
+
+  if (completed_.size() == 1){
+    add(Replay_Wait, {completed_[0]});
+  } else if (!completed_.empty()){
+    completed_.insert(completed_.begin(), int64_t(completed_.size()));
+    add(Replay_Waitall, std::move(completed_));
+  }
+
+  switch (call_){
+    case ID_MPI_Init:
+    case ID_MPI_Init_thread:
+      if (!initialized_){
+        add(Replay_Init, {});
+        initialized_ = true;
+      }
+      break;
+    case ID_MPI_Finalize:
+      add(Replay_Finalize, {});
+      finalized_ = true;
+      break;
+    default:
+      break;
+  }
+
+  if (!emitted_){
+    //nothing replayed, drop the duration of the call but keep the compute before it
+    pending_gap_ = gap_;
+  }
+  in_mpi_ = false;
+  started_ = true;
+  last_leave_ = time;
+}
+
+void
+Otf2RankConverter::collective(OTF2_CollectiveOp op, OTF2_CommRef comm, uint32_t root,
+                              uint64_t sent, uint64_t recvd)
+{
+  //OTF2 only records total bytes, the sizes follow the direct OTF2 replay
+  int64_t idx = comms_.index(comm);
+  int64_t size = comms_.size(comm);
+  switch (op){
+    case OTF2_COLLECTIVE_OP_BARRIER:
+      add(Replay_Barrier, {idx});
+      break;
+    case OTF2_COLLECTIVE_OP_BCAST:
+      add(Replay_Bcast, {int64_t(recvd), byte_type_, root, idx});
+      break;
+    case OTF2_COLLECTIVE_OP_GATHER:
+      add(Replay_Gather, {int64_t(sent), byte_type_, int64_t(sent), byte_type_, root, idx});
+      break;
+    case OTF2_COLLECTIVE_OP_SCATTER:
+      add(Replay_Scatter, {int64_t(recvd), byte_type_, int64_t(recvd), byte_type_, root, idx});
+      break;
+    case OTF2_COLLECTIVE_OP_ALLGATHER:
+      add(Replay_Allgather, {int64_t(sent)/size, byte_type_, int64_t(recvd)/size, byte_type_, idx});
+      break;
+    case OTF2_COLLECTIVE_OP_ALLTOALL:
+      add(Replay_Alltoall, {int64_t(sent)/size, byte_type_, int64_t(recvd)/size, byte_type_, idx});
+      break;
+    case OTF2_COLLECTIVE_OP_ALLREDUCE:
+      add(Replay_Allreduce, {(int64_t(recvd)/size)/4, int_type_, idx});
+      break;
+    case OTF2_COLLECTIVE_OP_REDUCE:
+      add(Replay_Reduce, {int64_t(sent)/4, int_type_, root, idx});
+      break;
+    case OTF2_COLLECTIVE_OP_REDUCE_SCATTER: {
+      std::vector<int64_t> args(size + 1, int64_t(recvd)/size);
+      args[0] = size;
+      args.push_back(byte_type_);
+      args.push_back(idx);
+      add(Replay_ReduceScatter, std::move(args));
+      break;
+    }
+    case OTF2_COLLECTIVE_OP_SCAN:
+      add(Replay_Scan, {int64_t(sent + recvd)/size, byte_type_, idx});
+      break;
+    default:
+      //v-collectives have no per-rank counts in OTF2, their time goes into the next gap
+      break;
+  }
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onEnter(OTF2_LocationRef, OTF2_TimeStamp time, uint64_t,
+                           void* userData, OTF2_AttributeList*, OTF2_RegionRef region)
+{
+  auto cv = get(userData);
+  auto iter = cv->defs_->regions.find(region);
+  if (iter != cv->defs_->regions.end()){
+    cv->enter(time, iter->second);
+  }
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onLeave(OTF2_LocationRef, OTF2_TimeStamp time, uint64_t,
+                           void* userData, OTF2_AttributeList*, OTF2_RegionRef region)
+{
+  auto cv = get(userData);
+  if (cv->defs_->regions.find(region) != cv->defs_->regions.end()){
+    cv->leave(time);
+  }
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onSend(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                          void* userData, OTF2_AttributeList*, uint32_t receiver,
+                          OTF2_CommRef comm, uint32_t tag, uint64_t length)
+{
+  auto cv = get(userData);
+  cv->send_args_ = {int64_t(length), cv->byte_type_, receiver, tag, cv->comms_.index(comm)};
+  cv->have_send_ = true;
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onRecv(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                          void* userData, OTF2_AttributeList*, uint32_t sender,
+                          OTF2_CommRef comm, uint32_t tag, uint64_t length)
+{
+  auto cv = get(userData);
+  cv->recv_args_ = {int64_t(length), cv->byte_type_, sender, tag, cv->comms_.index(comm)};
+  cv->have_recv_ = true;
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onIsend(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                           void* userData, OTF2_AttributeList*, uint32_t receiver,
+                           OTF2_CommRef comm, uint32_t tag, uint64_t length,
+                           uint64_t request)
+{
+  auto cv = get(userData);
+  cv->add(Replay_Isend, {int64_t(length), cv->byte_type_, receiver, tag,
+                         cv->comms_.index(comm), cv->slot(request)});
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onIsendComplete(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                   void* userData, OTF2_AttributeList*, uint64_t request)
+{
+  auto cv = get(userData);
+  cv->completed_.push_back(cv->slot(request));
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onIrecvRequest(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                  void* userData, OTF2_AttributeList*, uint64_t request)
+{
+  //the source, tag and size are only recorded when the receive completes
+  auto cv = get(userData);
+  if (!cv->initialized_){
+    cv->rank_.add(Replay_Init, 0, {});
+    cv->initialized_ = true;
+  }
+  cv->pending_irecvs_[request] = cv->rank_.addPending(Replay_Irecv, cv->takeGap());
+  cv->emitted_ = true;
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onIrecv(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                           void* userData, OTF2_AttributeList*, uint32_t sender,
+                           OTF2_CommRef comm, uint32_t tag, uint64_t length,
+                           uint64_t request)
+{
+  auto cv = get(userData);
+  auto iter = cv->pending_irecvs_.find(request);
+  if (iter == cv->pending_irecvs_.end()){
+    spkt_abort_printf("OTF2 irecv completed request %lu that was never posted", request);
+  }
+  int64_t slot = cv->slot(request);
+  cv->rank_.setArgs(iter->second, {int64_t(length), cv->byte_type_, sender, tag,
+                                   cv->comms_.index(comm), slot});
+  cv->pending_irecvs_.erase(iter);
+  cv->completed_.push_back(slot);
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_CallbackCode
+Otf2RankConverter::onCollectiveEnd(OTF2_LocationRef, OTF2_TimeStamp, uint64_t,
+                                   void* userData, OTF2_AttributeList*,
+                                   OTF2_CollectiveOp op, OTF2_CommRef comm,
+                                   uint32_t root, uint64_t sent, uint64_t recvd)
+{
+  get(userData)->collective(op, comm, root, sent, recvd);
+  return OTF2_CALLBACK_SUCCESS;
+}
+
+OTF2_EvtReaderCallbacks*
+Otf2RankConverter::createCallbacks()
+{
+  OTF2_EvtReaderCallbacks* callbacks = OTF2_EvtReaderCallbacks_New();
+  OTF2_EvtReaderCallbacks_SetEnterCallback(callbacks, onEnter);
+  OTF2_EvtReaderCallbacks_SetLeaveCallback(callbacks, onLeave);
+  OTF2_EvtReaderCallbacks_SetMpiSendCallback(callbacks, onSend);
+  OTF2_EvtReaderCallbacks_SetMpiRecvCallback(callbacks, onRecv);
+  OTF2_EvtReaderCallbacks_SetMpiIsendCallback(callbacks, onIsend);
+  OTF2_EvtReaderCallbacks_SetMpiIsendCompleteCallback(callbacks, onIsendComplete);
+  OTF2_EvtReaderCallbacks_SetMpiIrecvRequestCallback(callbacks, onIrecvRequest);
+  OTF2_EvtReaderCallbacks_SetMpiIrecvCallback(callbacks, onIrecv);
+  OTF2_EvtReaderCallbacks_SetMpiCollectiveEndCallback(callbacks, onCollectiveEnd);
+  return callbacks;
+}
+
+void
+Otf2RankConverter::convert(OTF2_Reader* reader, OTF2_LocationRef loc)
+{
+  //reading the local definitions loads the mappings to global ids
+  OTF2_DefReader* def_reader = OTF2_Reader_GetDefReader(reader, loc);
+  if (def_reader){
+    uint64_t definitions_read = 0;
+    check_status(OTF2_Reader_ReadAllLocalDefinitions(reader, def_reader, &definitions_read),
+                 "OTF2_Reader_ReadAllLocalDefinitions");
+    OTF2_Reader_CloseDefReader(reader, def_reader);
+  }
+
+  OTF2_EvtReader* evt_reader = OTF2_Reader_GetEvtReader(reader, loc);
+  OTF2_EvtReaderCallbacks* callbacks = createCallbacks();
+  check_status(OTF2_Reader_RegisterEvtCallbacks(reader, evt_reader, callbacks, this),
+               "OTF2_Reader_RegisterEvtCallbacks");
+  OTF2_EvtReaderCallbacks_Delete(callbacks);
+
+  uint64_t events_read = 0;
+  check_status(OTF2_Reader_ReadLocalEvents(reader, evt_reader, OTF2_UNDEFINED_UINT64, &events_read),
+               "OTF2_Reader_ReadLocalEvents");
+  check_status(OTF2_Reader_CloseEvtReader(reader, evt_reader), "OTF2_Reader_CloseEvtReader");
+
+  if (!pending_irecvs_.empty()){
+    spkt_abort_printf("OTF2 location %lu has %lu irecvs that never completed",
+                      loc, pending_irecvs_.size());
+  }
+  if (!finalized_){
+    rank_.add(Replay_Finalize, pending_gap_, {});
+  }
+}
+
+void
+convertOtf2(const std::string& anchor, const std::string& output, bool print_progress)
+{
+  const OTF2_GlobalDefs* defs = OTF2_GlobalDefs::get(anchor);
+  int nproc = defs->numberOfLocations;
+  ReplayWriter writer(output, nproc);
+  Otf2CommTable comms(defs, writer);
+
+  OTF2_Reader* reader = OTF2_Reader_Open(anchor.c_str());
+  if (!reader){
+    throw sprockit::IOError("convertOtf2: unable to open \"" + anchor + "\" for reading");
+  }
+  OTF2_Reader_SetSerialCollectiveCallbacks(reader);
+  bool have_def_files = OTF2_Reader_OpenDefFiles(reader) == OTF2_SUCCESS;
+  check_status(OTF2_Reader_OpenEvtFiles(reader), "OTF2_Reader_OpenEvtFiles");
+
+  for (int rank=0; rank < nproc; ++rank){
+    ReplayRankWriter rank_writer;
+    {
+      Otf2RankConverter converter(defs, comms, writer, rank_writer);
+      converter.convert(reader, rank);
+    }
+    writer.writeRank(rank, rank_writer);
+    if (print_progress){
+      std::cout << "converted rank " << rank << ": "
+                << rank_writer.numEvents() << " events" << std::endl;
+    }
+  }
+
+  check_status(OTF2_Reader_CloseEvtFiles(reader), "OTF2_Reader_CloseEvtFiles");
+  if (have_def_files){
+    check_status(OTF2_Reader_CloseDefFiles(reader), "OTF2_Reader_CloseDefFiles");
+  }
+  OTF2_Reader_Close(reader);
+  writer.close();
+}
+
+}
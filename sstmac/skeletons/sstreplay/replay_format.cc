@@ -0,0 +1,342 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/skeletons/sstreplay/replay_format.h>
+#include <sstmac/common/thread_lock.h>
+#include <sprockit/errors.h>
+#include <sprockit/statics.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <cstring>
+#include <map>
+
+namespace sumi {
+
+static void
+append_varint(std::vector<uint8_t>& buf, uint64_t val)
+{
+  while (val >= 0x80){
+    buf.push_back(uint8_t(val) | 0x80);
+    val >>= 7;
+  }
+  buf.push_back(uint8_t(val));
+}
+
+static void
+append_zigzag(std::vector<uint8_t>& buf, int64_t val)
+{
+  append_varint(buf, (uint64_t(val) << 1) ^ uint64_t(val >> 63));
+}
+
+size_t
+ReplayRankWriter::add(ReplayOp op, uint64_t gap_ns, std::vector<int64_t>&& args)
+{
+  buffered_.push_back({op, false, gap_ns, std::move(args)});
+  size_t idx = num_events_++;
+  flush();
+  return idx;
+}
+
+size_t
+ReplayRankWriter::addPending(ReplayOp op, uint64_t gap_ns)
+{
+  buffered_.push_back({op, true, gap_ns, {}});
+  ++num_pending_;
+  return num_events_++;
+}
+
+void
+ReplayRankWriter::setArgs(size_t event, std::vector<int64_t>&& args)
+{
+  if (event < first_index_ || event >= first_index_ + buffered_.size()){
+    spkt_abort_printf("ReplayRankWriter: event %lu was already written", event);
+  }
+  Event& ev = buffered_[event - first_index_];
+  if (!ev.pending){
+    spkt_abort_printf("ReplayRankWriter: event %lu is not pending", event);
+  }
+  ev.args = std::move(args);
+  ev.pending = false;
+  --num_pending_;
+  flush();
+}
+
+void
+ReplayRankWriter::flush()
+{
+  while (!buffered_.empty() && !buffered_.front().pending){
+    Event& ev = buffered_.front();
+    ops_.push_back(ev.op);
+    append_varint(times_, ev.gap);
+    for (int64_t arg : ev.args){
+      append_zigzag(args_, arg);
+    }
+    buffered_.pop_front();
+    ++first_index_;
+  }
+}
+
+void
+ReplayRankWriter::finish()
+{
+  if (num_pending_ != 0){
+    spkt_abort_printf("ReplayRankWriter: %lu events never had their arguments set",
+                      num_pending_);
+  }
+  flush();
+}
+
+ReplayWriter::ReplayWriter(const std::string& fname, int num_ranks) :
+  fname_(fname),
+  offset_(0),
+  ranks_(num_ranks),
+  rank_written_(num_ranks, false)
+{
+  file_ = fopen(fname.c_str(), "wb");
+  if (!file_){
+    spkt_throw_printf(sprockit::IOError, "unable to open replay file %s: %s",
+                      fname.c_str(), ::strerror(errno));
+  }
+  //the header is filled in on close
+  ReplayHeader header;
+  ::memset(&header, 0, sizeof(header));
+  append(&header, sizeof(header));
+  comm_starts_.push_back(0);
+}
+
+ReplayWriter::~ReplayWriter()
+{
+  if (file_) fclose(file_);
+}
+
+void
+ReplayWriter::append(const void* data, size_t size)
+{
+  if (size && fwrite(data, size, 1, file_) != 1){
+    spkt_throw_printf(sprockit::IOError, "failed writing replay file %s: %s",
+                      fname_.c_str(), ::strerror(errno));
+  }
+  offset_ += size;
+}
+
+int
+ReplayWriter::internType(uint32_t size)
+{
+  for (int i=0; i < int(type_sizes_.size()); ++i){
+    if (type_sizes_[i] == size) return i;
+  }
+  type_sizes_.push_back(size);
+  return type_sizes_.size() - 1;
+}
+
+int
+ReplayWriter::addComm(const std::vector<int>& members)
+{
+  comm_members_.insert(comm_members_.end(), members.begin(), members.end());
+  comm_starts_.push_back(comm_members_.size());
+  return replay_first_table_comm + comm_starts_.size() - 2;
+}
+
+void
+ReplayWriter::writeRank(int rank, ReplayRankWriter& rank_writer)
+{
+  if (rank_written_[rank]){
+    spkt_abort_printf("ReplayWriter: rank %d written twice", rank);
+  }
+  rank_writer.finish();
+  ReplayRankIndex& idx = ranks_[rank];
+  idx.num_events = rank_writer.numEvents();
+  idx.ops_offset = offset_;
+  append(rank_writer.ops().data(), rank_writer.ops().size());
+  idx.times_offset = offset_;
+  idx.times_bytes = rank_writer.times().size();
+  append(rank_writer.times().data(), rank_writer.times().size());
+  idx.args_offset = offset_;
+  idx.args_bytes = rank_writer.args().size();
+  append(rank_writer.args().data(), rank_writer.args().size());
+  rank_written_[rank] = true;
+}
+
+void
+ReplayWriter::close()
+{
+  for (int r=0; r < int(ranks_.size()); ++r){
+    if (!rank_written_[r]){
+      spkt_abort_printf("ReplayWriter: rank %d was never written", r);
+    }
+  }
+
+  //keep the tables aligned for direct access from the mapping
+  static const char zeros[8] = {0};
+  append(zeros, (8 - offset_ % 8) % 8);
+
+  ReplayHeader header;
+  ::memset(&header, 0, sizeof(header));
+  ::memcpy(header.magic, replay_magic, sizeof(header.magic));
+  header.version = replay_version;
+  header.num_ranks = ranks_.size();
+  header.num_types = type_sizes_.size();
+  header.num_comms = comm_starts_.size() - 1;
+
+  header.ranks_offset = offset_;
+  append(ranks_.data(), ranks_.size() * sizeof(ReplayRankIndex));
+  header.comms_offset = offset_;
+  append(comm_starts_.data(), comm_starts_.size() * sizeof(uint64_t));
+  append(comm_members_.data(), comm_members_.size() * sizeof(int32_t));
+  append(zeros, (8 - offset_ % 8) % 8);
+  header.types_offset = offset_;
+  append(type_sizes_.data(), type_sizes_.size() * sizeof(uint32_t));
+  header.file_size = offset_;
+
+  if (fseek(file_, 0, SEEK_SET) != 0){
+    spkt_throw_printf(sprockit::IOError, "failed seeking in replay file %s: %s",
+                      fname_.c_str(), ::strerror(errno));
+  }
+  append(&header, sizeof(header));
+  fclose(file_);
+  file_ = nullptr;
+}
+
+static sprockit::NeedDeletestatics<ReplayFile> del_statics;
+
+static sstmac::thread_lock replay_file_lock;
+static std::map<std::string, const ReplayFile*> replay_files;
+
+const ReplayFile*
+ReplayFile::get(const std::string& fname)
+{
+  replay_file_lock.lock();
+  auto iter = replay_files.find(fname);
+  if (iter != replay_files.end()){
+    replay_file_lock.unlock();
+    return iter->second;
+  }
+  const ReplayFile* file = nullptr;
+  try {
+    file = new ReplayFile(fname);
+  } catch (...) {
+    replay_file_lock.unlock();
+    throw;
+  }
+  replay_files[fname] = file;
+  replay_file_lock.unlock();
+  return file;
+}
+
+void
+ReplayFile::deleteStatics()
+{
+  for (auto& pair : replay_files){
+    delete pair.second;
+  }
+  replay_files.clear();
+}
+
+ReplayFile::ReplayFile(const std::string& fname)
+{
+  int fd = ::open(fname.c_str(), O_RDONLY);
+  if (fd < 0){
+    spkt_throw_printf(sprockit::IOError, "unable to open replay file %s: %s",
+                      fname.c_str(), ::strerror(errno));
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(ReplayHeader)){
+    ::close(fd);
+    spkt_throw_printf(sprockit::IOError, "replay file %s is too small", fname.c_str());
+  }
+  size_ = st.st_size;
+  void* mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED){
+    spkt_throw_printf(sprockit::IOError, "unable to map replay file %s: %s",
+                      fname.c_str(), ::strerror(errno));
+  }
+  base_ = (const uint8_t*) mapped;
+  header_ = (const ReplayHeader*) base_;
+  if (::memcmp(header_->magic, replay_magic, sizeof(replay_magic)) != 0
+      || header_->version != replay_version
+      || header_->file_size != size_){
+    ::munmap(mapped, size_);
+    spkt_throw_printf(sprockit::IOError,
+      "%s is not a version %u replay file, rerun sstmac_trace_convert",
+      fname.c_str(), replay_version);
+  }
+  types_ = (const uint32_t*) (base_ + header_->types_offset);
+  comm_starts_ = (const uint64_t*) (base_ + header_->comms_offset);
+  comm_members_ = (const int32_t*) (comm_starts_ + header_->num_comms + 1);
+  ranks_ = (const ReplayRankIndex*) (base_ + header_->ranks_offset);
+  if (header_->ranks_offset + uint64_t(numRanks()) * sizeof(ReplayRankIndex) > size_){
+    ::munmap(mapped, size_);
+    spkt_throw_printf(sprockit::IOError, "replay file %s is truncated", fname.c_str());
+  }
+  for (int r=0; r < numRanks(); ++r){
+    const ReplayRankIndex& idx = ranks_[r];
+    if (idx.ops_offset + idx.num_events > size_
+        || idx.times_offset + idx.times_bytes > size_
+        || idx.args_offset + idx.args_bytes > size_){
+      ::munmap(mapped, size_);
+      spkt_throw_printf(sprockit::IOError,
+        "replay file %s is truncated: rank %d extends past the end of the file",
+        fname.c_str(), r);
+    }
+  }
+}
+
+void
+ReplayCursor::corrupt()
+{
+  spkt_throw_printf(sprockit::IOError,
+    "replay file is corrupt: an event runs past the end of its rank's columns");
+}
+
+ReplayFile::~ReplayFile()
+{
+  ::munmap(const_cast<uint8_t*>(base_), size_);
+}
+
+}
@@ -0,0 +1,381 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_SKELETONS_SSTREPLAY_REPLAY_FORMAT_H_INCLUDED
+#define SSTMAC_SKELETONS_SSTREPLAY_REPLAY_FORMAT_H_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace sumi {
+
+/**
+ * The calls stored in a replay file. The arguments of each call are listed in order.
+ * Counts are in elements of an interned type, comms are the rank's interned comm indices,
+ * and slots are the rank's request indices.
+ */
+enum ReplayOp : uint8_t {
+  Replay_Init,          // (none)
+  Replay_Finalize,      // (none)
+  Replay_Send,          // count, type, dest, tag, comm
+  Replay_Recv,          // count, type, src, tag, comm
+  Replay_Isend,         // count, type, dest, tag, comm, slot
+  Replay_Irecv,         // count, type, src, tag, comm, slot
+  Replay_Wait,          // slot
+  Replay_Waitall,       // n, slot x n
+  Replay_Sendrecv,      // sendcount, sendtype, dest, sendtag, recvcount, recvtype, src, recvtag, comm
+  Replay_Barrier,       // comm
+  Replay_Bcast,         // count, type, root, comm
+  Replay_Reduce,        // count, type, root, comm
+  Replay_Allreduce,     // count, type, comm
+  Replay_Scan,          // count, type, comm
+  Replay_Gather,        // sendcount, sendtype, recvcount, recvtype, root, comm
+  Replay_Scatter,       // sendcount, sendtype, recvcount, recvtype, root, comm
+  Replay_Allgather,     // sendcount, sendtype, recvcount, recvtype, comm
+  Replay_Alltoall,      // sendcount, sendtype, recvcount, recvtype, comm
+  Replay_Allgatherv,    // sendcount, sendtype, n, recvcount x n, recvtype, comm
+  Replay_Alltoallv,     // n, sendcount x n, sendtype, n, recvcount x n, recvtype, comm
+  Replay_ReduceScatter, // n, recvcount x n, type, comm
+  Replay_CommSplit,     // parent, color, key, newcomm
+  Replay_CommDup,       // parent, newcomm
+  Replay_CommFree,      // comm
+  Replay_NumOps
+};
+
+/** Comm indices every rank starts with, comms from the comm table follow */
+static const int replay_comm_world = 0;
+static const int replay_comm_self = 1;
+static const int replay_first_table_comm = 2;
+
+/** MPI_UNDEFINED, MPI_ANY_SOURCE etc. are stored as these values */
+static const int replay_undefined = -1;
+static const int replay_any_source = -2;
+static const int replay_root = -3;
+static const int replay_any_tag = -1;
+
+/**
+ * The file starts with this header. Tables are at the given byte offsets:
+ *  types: uint32_t size[num_types], the byte size of each interned type
+ *  comms: uint64_t start[num_comms+1] into the int32_t world ranks that follow,
+ *         the membership of comms that exist from the start of the run
+ *  ranks: ReplayRankIndex[num_ranks]
+ */
+struct ReplayHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_ranks;
+  uint32_t num_types;
+  uint32_t num_comms;
+  uint64_t types_offset;
+  uint64_t comms_offset;
+  uint64_t ranks_offset;
+  uint64_t file_size;
+};
+
+/**
+ * The event columns of one rank:
+ *  ops: one ReplayOp byte per event
+ *  times: varint nanoseconds of compute between the end of the previous call and the start of this one
+ *  args: zigzag varint arguments of every event back to back
+ */
+struct ReplayRankIndex {
+  uint64_t num_events;
+  uint64_t ops_offset;
+  uint64_t times_offset;
+  uint64_t times_bytes;
+  uint64_t args_offset;
+  uint64_t args_bytes;
+};
+
+static const char replay_magic[8] = {'S','S','T','R','P','L','Y','\0'};
+static const uint32_t replay_version = 1;
+
+/**
+ * Builds the columns of one rank. Events whose arguments are only known later,
+ * e.g. an OTF2 irecv whose source is recorded at completion, can be added as pending.
+ * Events are encoded as soon as no pending event precedes them.
+ */
+class ReplayRankWriter
+{
+ public:
+  ReplayRankWriter() : num_events_(0), num_pending_(0), first_index_(0) {}
+
+  size_t add(ReplayOp op, uint64_t gap_ns, std::initializer_list<int64_t> args){
+    return add(op, gap_ns, std::vector<int64_t>(args));
+  }
+
+  size_t add(ReplayOp op, uint64_t gap_ns, std::vector<int64_t>&& args);
+
+  size_t addPending(ReplayOp op, uint64_t gap_ns);
+
+  void setArgs(size_t event, std::vector<int64_t>&& args);
+
+  uint64_t numEvents() const {
+    return num_events_;
+  }
+
+  /**
+   * @brief finish Encode all events, every pending event must have been set
+   */
+  void finish();
+
+  const std::vector<uint8_t>& ops() const {
+    return ops_;
+  }
+
+  const std::vector<uint8_t>& times() const {
+    return times_;
+  }
+
+  const std::vector<uint8_t>& args() const {
+    return args_;
+  }
+
+ private:
+  struct Event {
+    ReplayOp op;
+    bool pending;
+    uint64_t gap;
+    std::vector<int64_t> args;
+  };
+
+  void flush();
+
+  uint64_t num_events_;
+  uint64_t num_pending_;
+  /** The event index of the front of the buffer */
+  size_t first_index_;
+  std::deque<Event> buffered_;
+
+  std::vector<uint8_t> ops_;
+  std::vector<uint8_t> times_;
+  std::vector<uint8_t> args_;
+};
+
+/**
+ * Writes a replay file. Rank columns are appended as each rank finishes,
+ * so only one rank has to be held in memory.
+ */
+class ReplayWriter
+{
+ public:
+  ReplayWriter(const std::string& fname, int num_ranks);
+
+  ~ReplayWriter();
+
+  /**
+   * @return The index of the type with this size in bytes
+   */
+  int internType(uint32_t size);
+
+  /**
+   * @brief addComm Add a comm that every rank knows from the start
+   * @param members The world ranks in comm rank order
+   * @return The comm index used in events
+   */
+  int addComm(const std::vector<int>& members);
+
+  void writeRank(int rank, ReplayRankWriter& rank_writer);
+
+  /**
+   * @brief close Write the tables and the header
+   */
+  void close();
+
+ private:
+  void append(const void* data, size_t size);
+
+  std::string fname_;
+  FILE* file_;
+  uint64_t offset_;
+  std::vector<uint32_t> type_sizes_;
+  std::vector<uint64_t> comm_starts_;
+  std::vector<int32_t> comm_members_;
+  std::vector<ReplayRankIndex> ranks_;
+  std::vector<bool> rank_written_;
+};
+
+/**
+ * Decodes the events of one rank from a mapped replay file
+ */
+class ReplayCursor
+{
+ public:
+  ReplayCursor(const uint8_t* base, const ReplayRankIndex& idx) :
+    op_(Replay_NumOps), gap_(0),
+    ops_(base + idx.ops_offset),
+    ops_end_(base + idx.ops_offset + idx.num_events),
+    times_(base + idx.times_offset),
+    times_end_(base + idx.times_offset + idx.times_bytes),
+    args_(base + idx.args_offset),
+    args_end_(base + idx.args_offset + idx.args_bytes)
+  {
+  }
+
+  /**
+   * @return Whether there was another event to advance to
+   */
+  bool next(){
+    if (ops_ == ops_end_) return false;
+    op_ = ReplayOp(*ops_++);
+    gap_ = readVarint(times_, times_end_);
+    return true;
+  }
+
+  ReplayOp op() const {
+    return op_;
+  }
+
+  uint64_t gapNs() const {
+    return gap_;
+  }
+
+  /**
+   * @return The next argument of the current event
+   */
+  int64_t arg(){
+    uint64_t z = readVarint(args_, args_end_);
+    return int64_t(z >> 1) ^ -int64_t(z & 1);
+  }
+
+  int intArg(){
+    return int(arg());
+  }
+
+ private:
+  static uint64_t readVarint(const uint8_t*& ptr, const uint8_t* end){
+    uint64_t val = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+      if (ptr == end || shift > 63) corrupt();
+      byte = *ptr++;
+      val |= uint64_t(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    return val;
+  }
+
+  /** A varint ran past the end of its column */
+  [[noreturn]] static void corrupt();
+
+  ReplayOp op_;
+  uint64_t gap_;
+  const uint8_t* ops_;
+  const uint8_t* ops_end_;
+  const uint8_t* times_;
+  const uint8_t* times_end_;
+  const uint8_t* args_;
+  const uint8_t* args_end_;
+};
+
+/**
+ * A replay file mapped read-only into memory. Files are shared by all ranks in the process.
+ */
+class ReplayFile
+{
+ public:
+  /**
+   * @brief get Map the file the first time it is requested
+   */
+  static const ReplayFile* get(const std::string& fname);
+
+  static void deleteStatics();
+
+  int numRanks() const {
+    return header_->num_ranks;
+  }
+
+  int numTypes() const {
+    return header_->num_types;
+  }
+
+  uint32_t typeSize(int type) const {
+    return types_[type];
+  }
+
+  int numComms() const {
+    return header_->num_comms;
+  }
+
+  /**
+   * @brief commMembers
+   * @param comm The index into the comm table, not the comm index used in events
+   * @param size Set to the number of members
+   * @return The world ranks of the comm
+   */
+  const int32_t* commMembers(int comm, int& size) const {
+    size = comm_starts_[comm+1] - comm_starts_[comm];
+    return comm_members_ + comm_starts_[comm];
+  }
+
+  uint64_t numEvents(int rank) const {
+    return ranks_[rank].num_events;
+  }
+
+  ReplayCursor cursor(int rank) const {
+    return ReplayCursor(base_, ranks_[rank]);
+  }
+
+ private:
+  ReplayFile(const std::string& fname);
+
+  ~ReplayFile();
+
+  const uint8_t* base_;
+  size_t size_;
+  const ReplayHeader* header_;
+  const uint32_t* types_;
+  const uint64_t* comm_starts_;
+  const int32_t* comm_members_;
+  const ReplayRankIndex* ranks_;
+};
+
+}
+
+#endif
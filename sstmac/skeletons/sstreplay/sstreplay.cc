@@ -0,0 +1,361 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/skeletons/sstreplay/sstreplay.h>
+#include <sumi-mpi/mpi_api.h>
+#include <sumi-mpi/mpi_types/mpi_type.h>
+#include <sprockit/errors.h>
+#include <sprockit/sim_parameters.h>
+#include <sprockit/keyword_registration.h>
+#include <iostream>
+
+RegisterKeywords(
+{ "replay_file", "the replay file written by sstmac_trace_convert" },
+{ "replay_timescale", "the scale factor for time between MPI calls, < 1 means speedup" },
+{ "replay_print_progress", "whether to print when rank 0 starts and finishes the replay" },
+);
+
+namespace sumi {
+
+/** Table comms and their groups use ids no other comm is given */
+static const int replay_table_id_offset = 0x20000000;
+
+SSTReplay::SSTReplay(SST::Params& params, sstmac::sw::SoftwareId sid,
+                     sstmac::sw::OperatingSystem* os) :
+  App(params, sid, os),
+  mpi_(nullptr),
+  file_(nullptr)
+{
+  fname_ = params.find<std::string>("replay_file");
+  timescale_ = params.find<double>("replay_timescale", 1.0);
+  print_progress_ = params.find<bool>("replay_print_progress", true);
+}
+
+SSTReplay::~SSTReplay() throw()
+{
+}
+
+void
+SSTReplay::createTypes()
+{
+  types_.resize(file_->numTypes());
+  for (int i=0; i < file_->numTypes(); ++i){
+    uint32_t size = file_->typeSize(i);
+    auto iter = MpiType::builtins.find(size);
+    if (iter != MpiType::builtins.end()){
+      types_[i] = iter->second.id;
+    } else {
+      mpi_->typeContiguous(size, MPI_BYTE, &types_[i]);
+      mpi_->typeCommit(&types_[i]);
+    }
+  }
+}
+
+void
+SSTReplay::createTableComms()
+{
+  comms_.assign(replay_first_table_comm + file_->numComms(), MPI_COMM_NULL);
+  comms_[replay_comm_world] = MPI_COMM_WORLD;
+  comms_[replay_comm_self] = MPI_COMM_SELF;
+
+  //every rank gives the table comms the same ids without communicating
+  bool generate = mpi_->generateIds();
+  mpi_->setGenerateIds(false);
+  for (int i=0; i < file_->numComms(); ++i){
+    int size;
+    const int32_t* members = file_->commMembers(i, size);
+    int id = replay_table_id_offset + i;
+    if (mpi_->groupCreateWithId(id, size, members)){
+      mpi_->commCreateWithId(MPI_COMM_WORLD, id, id);
+      comms_[replay_first_table_comm + i] = id;
+    }
+  }
+  mpi_->setGenerateIds(generate);
+}
+
+const int*
+SSTReplay::counts(ReplayCursor& cursor, std::vector<int>& buf)
+{
+  int n = cursor.intArg();
+  buf.resize(n);
+  for (int i=0; i < n; ++i){
+    buf[i] = cursor.intArg();
+  }
+  return buf.data();
+}
+
+static int
+replayPeer(int rank)
+{
+  switch (rank){
+    case replay_any_source: return MPI_ANY_SOURCE;
+    case replay_root: return MPI_ROOT;
+    default: return rank;
+  }
+}
+
+static int
+replayTag(int t)
+{
+  return t == replay_any_tag ? MPI_ANY_TAG : t;
+}
+
+int
+SSTReplay::skeletonMain()
+{
+  int rank = this->tid();
+  mpi_ = getApi<MpiApi>("mpi");
+  file_ = ReplayFile::get(fname_);
+  if (rank >= file_->numRanks()){
+    spkt_abort_printf("rank %d cannot replay %s, which only has %d ranks",
+                      rank, fname_.c_str(), file_->numRanks());
+  }
+
+  if (rank == 0 && print_progress_){
+    std::cout << "Running replay of " << fname_ << std::endl;
+  }
+
+  std::vector<int> send_counts;
+  std::vector<int> recv_counts;
+  std::vector<MPI_Request> wait_reqs;
+  std::vector<int> wait_slots;
+
+  ReplayCursor cursor = file_->cursor(rank);
+  while (cursor.next()){
+    uint64_t gap = cursor.gapNs();
+    if (gap){
+      compute(sstmac::TimeDelta(uint64_t(gap * timescale_), sstmac::TimeDelta::one_nanosecond));
+    }
+
+    switch (cursor.op()){
+      case Replay_Init: {
+        mpi_->init(nullptr, nullptr);
+        createTypes();
+        createTableComms();
+        break;
+      }
+      case Replay_Finalize:
+        mpi_->finalize();
+        break;
+      case Replay_Send: {
+        int count = cursor.intArg();
+        MPI_Datatype type = types_[cursor.intArg()];
+        int dst = replayPeer(cursor.intArg());
+        int t = replayTag(cursor.intArg());
+        mpi_->send(nullptr, count, type, dst, t, comm(cursor.intArg()));
+        break;
+      }
+      case Replay_Recv: {
+        int count = cursor.intArg();
+        MPI_Datatype type = types_[cursor.intArg()];
+        int src = replayPeer(cursor.intArg());
+        int t = replayTag(cursor.intArg());
+        mpi_->recv(nullptr, count, type, src, t, comm(cursor.intArg()), MPI_STATUS_IGNORE);
+        break;
+      }
+      case Replay_Isend: {
+        int count = cursor.intArg();
+        MPI_Datatype type = types_[cursor.intArg()];
+        int dst = replayPeer(cursor.intArg());
+        int t = replayTag(cursor.intArg());
+        MPI_Comm c = comm(cursor.intArg());
+        mpi_->isend(nullptr, count, type, dst, t, c, request(cursor.intArg()));
+        break;
+      }
+      case Replay_Irecv: {
+        int count = cursor.intArg();
+        MPI_Datatype type = types_[cursor.intArg()];
+        int src = replayPeer(cursor.intArg());
+        int t = replayTag(cursor.intArg());
+        MPI_Comm c = comm(cursor.intArg());
+        mpi_->irecv(nullptr, count, type, src, t, c, request(cursor.intArg()));
+        break;
+      }
+      case Replay_Wait:
+        mpi_->wait(request(cursor.intArg()), MPI_STATUS_IGNORE);
+        break;
+      case Replay_Waitall: {
+        counts(cursor, wait_slots);
+        wait_reqs.resize(wait_slots.size());
+        for (size_t i=0; i < wait_slots.size(); ++i){
+          wait_reqs[i] = *request(wait_slots[i]);
+        }
+        mpi_->waitall(wait_reqs.size(), wait_reqs.data(), MPI_STATUSES_IGNORE);
+        for (size_t i=0; i < wait_slots.size(); ++i){
+          *request(wait_slots[i]) = wait_reqs[i];
+        }
+        break;
+      }
+      case Replay_Sendrecv: {
+        int sendcount = cursor.intArg();
+        MPI_Datatype sendtype = types_[cursor.intArg()];
+        int dst = replayPeer(cursor.intArg());
+        int sendtag = replayTag(cursor.intArg());
+        int recvcount = cursor.intArg();
+        MPI_Datatype recvtype = types_[cursor.intArg()];
+        int src = replayPeer(cursor.intArg());
+        int recvtag = replayTag(cursor.intArg());
+        mpi_->sendrecv(nullptr, sendcount, sendtype, dst, sendtag,
+                       nullptr, recvcount, recvtype, src, recvtag,
+                       comm(cursor.intArg()), MPI_STATUS_IGNORE);
+        break;
+      }
+      case Replay_Barrier:
+        mpi_->barrier(comm(cursor.intArg()));
+        break;
+      case Replay_Bcast: {
+        int count = cursor.intArg();
+        MPI_Datatype type = types_[cursor.intArg()];
+        int root = replayPeer(cursor.intArg());
+        mpi_->bcast(count, type, root, comm(cursor.intArg()));
+        break;
+      }
+      case Replay_Reduce: {
+        int count = cursor.intArg();
+        MPI_Datatype type = types_[cursor.intArg()];
+        int root = replayPeer(cursor.intArg());
+        mpi_->reduce(count, type, DUMPI_OP, root, comm(cursor.intArg()));
+        break;
+      }
+      case Replay_Allreduce: {
+        int count = cursor.intArg();
+        MPI_Datatype type = types_[cursor.intArg()];
+        mpi_->allreduce(count, type, DUMPI_OP, comm(cursor.intArg()));
+        break;
+      }
+      case Replay_Scan: {
+        int count = cursor.intArg();
+        MPI_Datatype type = types_[cursor.intArg()];
+        mpi_->scan(count, type, DUMPI_OP, comm(cursor.intArg()));
+        break;
+      }
+      case Replay_Gather:
+      case Replay_Scatter: {
+        int sendcount = cursor.intArg();
+        MPI_Datatype sendtype = types_[cursor.intArg()];
+        int recvcount = cursor.intArg();
+        MPI_Datatype recvtype = types_[cursor.intArg()];
+        int root = replayPeer(cursor.intArg());
+        MPI_Comm c = comm(cursor.intArg());
+        if (cursor.op() == Replay_Gather){
+          mpi_->gather(sendcount, sendtype, recvcount, recvtype, root, c);
+        } else {
+          mpi_->scatter(sendcount, sendtype, recvcount, recvtype, root, c);
+        }
+        break;
+      }
+      case Replay_Allgather:
+      case Replay_Alltoall: {
+        int sendcount = cursor.intArg();
+        MPI_Datatype sendtype = types_[cursor.intArg()];
+        int recvcount = cursor.intArg();
+        MPI_Datatype recvtype = types_[cursor.intArg()];
+        MPI_Comm c = comm(cursor.intArg());
+        if (cursor.op() == Replay_Allgather){
+          mpi_->allgather(sendcount, sendtype, recvcount, recvtype, c);
+        } else {
+          mpi_->alltoall(sendcount, sendtype, recvcount, recvtype, c);
+        }
+        break;
+      }
+      case Replay_Allgatherv: {
+        int sendcount = cursor.intArg();
+        MPI_Datatype sendtype = types_[cursor.intArg()];
+        const int* recvcounts = counts(cursor, recv_counts);
+        MPI_Datatype recvtype = types_[cursor.intArg()];
+        mpi_->allgatherv(sendcount, sendtype, recvcounts, recvtype, comm(cursor.intArg()));
+        break;
+      }
+      case Replay_Alltoallv: {
+        const int* sendcounts = counts(cursor, send_counts);
+        MPI_Datatype sendtype = types_[cursor.intArg()];
+        const int* recvcounts = counts(cursor, recv_counts);
+        MPI_Datatype recvtype = types_[cursor.intArg()];
+        mpi_->alltoallv(sendcounts, sendtype, recvcounts, recvtype, comm(cursor.intArg()));
+        break;
+      }
+      case Replay_ReduceScatter: {
+        counts(cursor, recv_counts);
+        MPI_Datatype type = types_[cursor.intArg()];
+        mpi_->reduceScatter(recv_counts.data(), type, DUMPI_OP, comm(cursor.intArg()));
+        break;
+      }
+      case Replay_CommSplit: {
+        MPI_Comm parent = comm(cursor.intArg());
+        int color = cursor.intArg();
+        if (color == replay_undefined) color = MPI_UNDEFINED;
+        int key = cursor.intArg();
+        MPI_Comm newcomm;
+        mpi_->commSplit(parent, color, key, &newcomm);
+        setComm(cursor.intArg(), newcomm);
+        break;
+      }
+      case Replay_CommDup: {
+        MPI_Comm parent = comm(cursor.intArg());
+        MPI_Comm newcomm;
+        mpi_->commDup(parent, &newcomm);
+        setComm(cursor.intArg(), newcomm);
+        break;
+      }
+      case Replay_CommFree: {
+        int idx = cursor.intArg();
+        MPI_Comm c = comm(idx);
+        if (c != MPI_COMM_NULL) mpi_->commFree(&c);
+        comms_[idx] = MPI_COMM_NULL;
+        break;
+      }
+      default:
+        spkt_abort_printf("replay file %s has unknown op %d on rank %d",
+                          fname_.c_str(), int(cursor.op()), rank);
+    }
+  }
+
+  if (rank == 0 && print_progress_){
+    std::cout << "Replay finalized on rank 0 - " << fname_
+              << " successful!" << std::endl;
+  }
+  return 0;
+}
+
+}
@@ -0,0 +1,123 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_SKELETONS_SSTREPLAY_SSTREPLAY_H_INCLUDED
+#define SSTMAC_SKELETONS_SSTREPLAY_SSTREPLAY_H_INCLUDED
+
+#include <sstmac/software/process/app.h>
+#include <sstmac/skeletons/sstreplay/replay_format.h>
+#include <sumi-mpi/mpi_api_fwd.h>
+#include <sumi-mpi/mpi_integers.h>
+#include <vector>
+
+namespace sumi {
+
+/**
+ * Replays a trace converted by sstmac_trace_convert. The file is mapped once per process
+ * and every rank walks its own columns, so no trace parsing happens during simulation.
+ */
+class SSTReplay : public sstmac::sw::App
+{
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    sstmac::sw::App,
+    SSTReplay,
+    "macro",
+    "sstreplay",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "application for simulating traces converted to the compact replay format")
+
+  SSTReplay(SST::Params& params, sstmac::sw::SoftwareId sid,
+            sstmac::sw::OperatingSystem* os);
+
+  ~SSTReplay() throw () override;
+
+  int skeletonMain() override;
+
+ private:
+  void createTypes();
+
+  void createTableComms();
+
+  MPI_Comm comm(int idx) const {
+    return comms_[idx];
+  }
+
+  void setComm(int idx, MPI_Comm comm){
+    if (idx >= int(comms_.size())) comms_.resize(idx+1, MPI_COMM_NULL);
+    comms_[idx] = comm;
+  }
+
+  MPI_Request* request(int slot){
+    if (slot >= int(requests_.size())) requests_.resize(slot+1, MPI_REQUEST_NULL);
+    return &requests_[slot];
+  }
+
+  /** Read n followed by n counts of the current event */
+  const int* counts(ReplayCursor& cursor, std::vector<int>& buf);
+
+  std::string fname_;
+
+  double timescale_;
+
+  bool print_progress_;
+
+  MpiApi* mpi_;
+
+  const ReplayFile* file_;
+
+  /** The sumi type of each type in the file */
+  std::vector<MPI_Datatype> types_;
+
+  /** Indexed by the comm index used in events */
+  std::vector<MPI_Comm> comms_;
+
+  /** Indexed by the slot used in events */
+  std::vector<MPI_Request> requests_;
+
+};
+
+}
+
+#endif
@@ -84,6 +84,8 @@ ParseDumpi::ParseDumpi(SST::Params& params, SoftwareId sid,
   print_progress_ = params.find<bool>("parsedumpi_print_progress", true);
 
   early_terminate_count_ = params.find<int>("parsedumpi_terminate_count", -1);
+
+  reader_ = sstmac::sw::DumpiReader::get(params);
 }
 
 ParseDumpi::~ParseDumpi() throw()
@@ -49,6 +49,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sumi-mpi/mpi_api_fwd.h>
 #include <sumi-mpi/mpi_comm/mpi_comm_fwd.h>
 #include <sstmac/dumpi_util/dumpi_meta.h>
+#include <sstmac/dumpi_util/dumpi_reader.h>
 #include <sstmac/hardware/topology/topology.h>
 
 namespace sumi {
@@ -91,6 +92,10 @@ class ParseDumpi : public sstmac::sw::App
     return early_terminate_count_;
   }
 
+  sstmac::sw::DumpiReader* reader() const {
+    return reader_;
+  }
+
  private:
   /// The fileroot we plan to parse.
   std::string fileroot_;
@@ -102,6 +107,8 @@ class ParseDumpi : public sstmac::sw::App
 
   MpiApi* mpi_;
 
+  sstmac::sw::DumpiReader* reader_;
+
   bool print_progress_;
 
   std::string metafilename_;
@@ -50,6 +50,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <cstring>
 #include <sumi-mpi/mpi_api.h>
 #include <sumi-mpi/mpi_types.h>
+#include <dumpi/common/io.h>
 
 #define ENABLE_MPI_ALLGATHER    1
 #define ENABLE_MPI_ALLTOALL     1
@@ -160,6 +161,11 @@ ParsedumpiCallbacks::parseStream(
     throw sprockit::IOError(here + ":  Unable to open \"" + fname + "\" for reading.");
   }
   datatype_sizes_ = undumpi_read_datatype_sizes(profile);
+  //hand the stream to the shared reader so this rank does not hold
+  //a descriptor for the whole run while it is blocked in MPI calls
+  long pos = ftell(profile->file);
+  fclose(profile->file);
+  profile->file = parent_->reader()->open(fname, pos);
   int retval = undumpi_read_stream_full(fname.c_str(), profile, cbacks_, this, print_progress);
   if(retval != 1) {
     sprockit::abort(here + ":  Failed reading dumpi stream\n");
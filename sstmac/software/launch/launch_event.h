@@ -119,6 +119,11 @@ class StartAppRequest :
 {
   ImplementSerializable(StartAppRequest)
  public:
+#if SSTMAC_CUSTOM_NEW
+  using sprockit::thread_safe_new<StartAppRequest>::operator new;
+  using sprockit::thread_safe_new<StartAppRequest>::operator delete;
+#endif
+
   StartAppRequest(uint64_t flow_id, AppId aid,
      const std::string& unique_name,
      TaskMapping::ptr mapping,
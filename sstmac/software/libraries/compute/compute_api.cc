@@ -47,6 +47,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/software/process/app.h>
 #include <sstmac/software/process/time.h>
 #include <sstmac/software/libraries/compute/compute_api.h>
+#include <sstmac/software/process/memoize.h>
 #include <sprockit/thread_safe_new.h>
 #include <sstmac/skeleton.h>
 
@@ -154,3 +155,121 @@ sstmac_compute_loop4(uint64_t isize, uint64_t jsize, uint64_t ksize, uint64_t ls
   sstmac::sw::OperatingSystem::currentThread()->parentApp()
     ->computeLoop(num_loops, nflops_per_loop, nintops_per_loop, bytes_per_loop);
 }
+
+extern "C" int
+sstmac_start_memoize(const char* token, const char* model){
+  return sstmac::Memoization::start(token, model);
+}
+
+extern "C" void
+sstmac_finish_memoize0(int thr_tag, const char* token){
+  sstmac::Memoization::finish(thr_tag, token, 0, nullptr);
+}
+
+extern "C" void
+sstmac_finish_memoize1(int thr_tag, const char* token, double p1){
+  double params[] = {p1};
+  sstmac::Memoization::finish(thr_tag, token, 1, params);
+}
+
+extern "C" void
+sstmac_finish_memoize2(int thr_tag, const char* token, double p1, double p2){
+  double params[] = {p1, p2};
+  sstmac::Memoization::finish(thr_tag, token, 2, params);
+}
+
+extern "C" void
+sstmac_finish_memoize3(int thr_tag, const char* token, double p1, double p2,
+                       double p3){
+  double params[] = {p1, p2, p3};
+  sstmac::Memoization::finish(thr_tag, token, 3, params);
+}
+
+extern "C" void
+sstmac_finish_memoize4(int thr_tag, const char* token, double p1, double p2,
+                       double p3, double p4){
+  double params[] = {p1, p2, p3, p4};
+  sstmac::Memoization::finish(thr_tag, token, 4, params);
+}
+
+extern "C" void
+sstmac_finish_memoize5(int thr_tag, const char* token, double p1, double p2,
+                       double p3, double p4, double p5){
+  double params[] = {p1, p2, p3, p4, p5};
+  sstmac::Memoization::finish(thr_tag, token, 5, params);
+}
+
+extern "C" void
+sstmac_compute_memoize0(const char* token){
+  sstmac::Memoization::compute(token, 0, nullptr);
+}
+
+extern "C" void
+sstmac_compute_memoize1(const char* token, double p1){
+  double params[] = {p1};
+  sstmac::Memoization::compute(token, 1, params);
+}
+
+extern "C" void
+sstmac_compute_memoize2(const char* token, double p1, double p2){
+  double params[] = {p1, p2};
+  sstmac::Memoization::compute(token, 2, params);
+}
+
+extern "C" void
+sstmac_compute_memoize3(const char* token, double p1, double p2,
+                        double p3){
+  double params[] = {p1, p2, p3};
+  sstmac::Memoization::compute(token, 3, params);
+}
+
+extern "C" void
+sstmac_compute_memoize4(const char* token, double p1, double p2,
+                        double p3, double p4){
+  double params[] = {p1, p2, p3, p4};
+  sstmac::Memoization::compute(token, 4, params);
+}
+
+extern "C" void
+sstmac_compute_memoize5(const char* token, double p1, double p2,
+                        double p3, double p4, double p5){
+  double params[] = {p1, p2, p3, p4, p5};
+  sstmac::Memoization::compute(token, 5, params);
+}
+
+extern "C" void
+sstmac_set_implicit_memoize_state1(int type0, int state0){
+  sstmac::Memoization::setImplicitState(type0, state0);
+}
+
+extern "C" void
+sstmac_set_implicit_memoize_state2(int type0, int state0, int type1, int state1){
+  sstmac::Memoization::setImplicitState(type0, state0);
+  sstmac::Memoization::setImplicitState(type1, state1);
+}
+
+extern "C" void
+sstmac_set_implicit_memoize_state3(int type0, int state0, int type1, int state1,
+                                   int type2, int state2){
+  sstmac::Memoization::setImplicitState(type0, state0);
+  sstmac::Memoization::setImplicitState(type1, state1);
+  sstmac::Memoization::setImplicitState(type2, state2);
+}
+
+extern "C" void
+sstmac_unset_implicit_memoize_state1(int type0){
+  sstmac::Memoization::unsetImplicitState(type0);
+}
+
+extern "C" void
+sstmac_unset_implicit_memoize_state2(int type0, int type1){
+  sstmac::Memoization::unsetImplicitState(type0);
+  sstmac::Memoization::unsetImplicitState(type1);
+}
+
+extern "C" void
+sstmac_unset_implicit_memoize_state3(int type0, int type1, int type2){
+  sstmac::Memoization::unsetImplicitState(type0);
+  sstmac::Memoization::unsetImplicitState(type1);
+  sstmac::Memoization::unsetImplicitState(type2);
+}
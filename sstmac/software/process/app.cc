@@ -77,6 +77,7 @@ RegisterKeywords(
  { "min_op_cutoff", "the minimum number of operations in a compute before detailed modeling is perfromed" },
  { "notify", "whether the app should send completion notifications to job root" },
  { "globals_size", "the size of the global variable segment to allocate" },
+ { "globals_cow", "whether to map the initial global and TLS segments copy-on-write from a shared image instead of copying them for every rank" },
  { "OMP_NUM_THREADS", "environment variable for configuring openmp" },
  { "exe", "an optional exe .so file to load for this app" },
 );
@@ -134,9 +135,9 @@ static char* get_data_segment(SST::Params& params,
     }
   }
   if (allocSize != 0){
-    char* segment = new char[allocSize];
-    ::memcpy(segment, ctx.globalInit(), ctx.globalsSize());
-    return segment;
+    bool cow = params.find<bool>("globals_cow", false);
+    if (cow) GlobalVariable::initCowReport(params);
+    return ctx.allocateSegment(cow);
   } else {
     return nullptr;
   }
@@ -358,7 +359,7 @@ App::~App()
   /** These get deleted by unregister */
   //sprockit::delete_vals(apis_);
   if (compute_lib_) delete compute_lib_;
-  if (globals_storage_) delete[] globals_storage_;
+  if (globals_storage_) GlobalVariable::glblCtx.freeSegment(globals_storage_, sid());
 }
 
 std::ostream&
@@ -46,6 +46,19 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/software/process/operating_system.h>
 #include <sstmac/software/process/thread.h>
 #include <sstmac/software/process/cppglobal.h>
+#include <sstmac/common/thread_lock.h>
+#include <sstmac/backends/common/parallel_runtime.h>
+#include <sprockit/errors.h>
+#include <sprockit/statics.h>
+#include <sprockit/util.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 extern "C" {
 
@@ -67,6 +80,23 @@ GlobalVariableContext GlobalVariable::glblCtx;
 GlobalVariableContext GlobalVariable::tlsCtx;
 bool GlobalVariable::inited = false;
 
+static sprockit::NeedDeletestatics<GlobalVariable> del_statics;
+
+static thread_lock segment_lock;
+
+namespace {
+struct CowPages {
+  uint64_t globals_pages = 0;
+  uint64_t globals_private = 0;
+  uint64_t tls_pages = 0;
+  uint64_t tls_private = 0;
+};
+}
+
+/** Pages mapped and written in copy-on-write segments, by app and rank */
+static std::map<std::pair<int,int>,CowPages> cow_pages;
+static std::string cow_report_file;
+
 int
 GlobalVariable::init(const int size, const char* name, bool tls)
 {
@@ -83,8 +113,186 @@ void
 GlobalVariableContext::init()
 {
   stackOffset = 0;
-  allocSize_ = 4096;
   globalInits = nullptr;
+  image_version_ = 0;
+  //an app may have sized and mapped its segments before the first variable registers
+  if (allocSize_ == 0){
+    allocSize_ = 4096;
+  }
+  if (image_fd_size_ == 0){
+    image_fd_ = -1;
+    image_fd_version_ = 0;
+  }
+}
+
+static size_t
+pageRound(size_t size)
+{
+  size_t page = sysconf(_SC_PAGESIZE);
+  return (size + page - 1) / page * page;
+}
+
+void
+GlobalVariableContext::syncImage()
+{
+  size_t size = pageRound(allocSize_);
+  if (image_fd_size_ > 0 && image_fd_version_ == image_version_ && image_fd_size_ >= size){
+    return;
+  }
+
+  //the contexts are statics that might be used before init(),
+  //so a nonzero size rather than the descriptor marks that the memfd exists
+  if (image_fd_size_ == 0){
+    image_fd_ = memfd_create("sstmac_globals", MFD_CLOEXEC);
+    if (image_fd_ < 0){
+      spkt_abort_printf("failed creating memfd for copy-on-write globals: %s", ::strerror(errno));
+    }
+  }
+  if (image_fd_size_ < size){
+    if (ftruncate(image_fd_, size) != 0){
+      spkt_abort_printf("failed sizing memfd for copy-on-write globals: %s", ::strerror(errno));
+    }
+    image_fd_size_ = size;
+  }
+  //existing segments received the same updates through initGlobalSpace,
+  //so rewriting the image does not change their unwritten pages
+  ssize_t rc = pwrite(image_fd_, globalInits, stackOffset, 0);
+  if (rc != stackOffset){
+    spkt_abort_printf("failed writing copy-on-write globals image: %s", ::strerror(errno));
+  }
+  image_fd_version_ = image_version_;
+}
+
+char*
+GlobalVariableContext::allocateSegment(bool cow)
+{
+  if (!cow){
+    char* segment = new char[allocSize_];
+    ::memcpy(segment, globalInits, stackOffset);
+    return segment;
+  }
+
+  segment_lock.lock();
+  syncImage();
+  size_t size = pageRound(allocSize_);
+  void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, image_fd_, 0);
+  if (map == MAP_FAILED){
+    spkt_abort_printf("failed mapping copy-on-write globals: %s", ::strerror(errno));
+  }
+  char* segment = (char*) map;
+  cow_segments_[segment] = size;
+  segment_lock.unlock();
+  return segment;
+}
+
+/**
+ * Count the pages of a private file mapping that have been written.
+ * A written page is replaced by an anonymous copy, which pagemap reports
+ * as present (bit 63) without the file-page bit (bit 61).
+ */
+static uint64_t
+countPrivatePages(char* segment, size_t size)
+{
+  static int pagemap_fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+  if (pagemap_fd < 0) return 0;
+
+  size_t page = sysconf(_SC_PAGESIZE);
+  uint64_t first = uintptr_t(segment) / page;
+  uint64_t num_pages = size / page;
+  std::vector<uint64_t> entries(num_pages);
+  ssize_t bytes = entries.size() * sizeof(uint64_t);
+  if (pread(pagemap_fd, entries.data(), bytes, first * sizeof(uint64_t)) != bytes){
+    return 0;
+  }
+  uint64_t num_private = 0;
+  for (uint64_t entry : entries){
+    bool present = entry & (uint64_t(1) << 63);
+    bool file = entry & (uint64_t(1) << 61);
+    if (present && !file) ++num_private;
+  }
+  return num_private;
+}
+
+void
+GlobalVariableContext::freeSegment(char* segment, sw::SoftwareId sid)
+{
+  segment_lock.lock();
+  auto iter = cow_segments_.find(segment);
+  if (iter == cow_segments_.end()){
+    segment_lock.unlock();
+    delete[] segment;
+    return;
+  }
+
+  size_t size = iter->second;
+  uint64_t num_pages = size / sysconf(_SC_PAGESIZE);
+  uint64_t num_private = countPrivatePages(segment, size);
+  CowPages& pages = cow_pages[std::make_pair(int(sid.app_), int(sid.task_))];
+  if (this == &GlobalVariable::tlsCtx){
+    pages.tls_pages += num_pages;
+    pages.tls_private += num_private;
+  } else {
+    pages.globals_pages += num_pages;
+    pages.globals_private += num_private;
+  }
+  munmap(segment, size);
+  cow_segments_.erase(iter);
+  segment_lock.unlock();
+}
+
+void
+GlobalVariable::initCowReport(SST::Params& params)
+{
+  segment_lock.lock();
+  if (cow_report_file.empty()){
+    ParallelRuntime* rt = ParallelRuntime::staticRuntime(params);
+    if (rt && rt->nproc() > 1){
+      cow_report_file = sprockit::sprintf("globals_cow.%d.csv", rt->me());
+    } else {
+      cow_report_file = "globals_cow.csv";
+    }
+  }
+  segment_lock.unlock();
+}
+
+void
+GlobalVariable::deleteStatics()
+{
+  if (cow_pages.empty()) return;
+
+  CowPages total;
+  uint64_t max_private = 0;
+  std::pair<int,int> max_rank;
+  if (cow_report_file.empty()) cow_report_file = "globals_cow.csv";
+  std::ofstream out(cow_report_file.c_str());
+  out << "app,rank,globals_pages,globals_private,tls_pages,tls_private\n";
+  for (auto& pair : cow_pages){
+    const CowPages& pages = pair.second;
+    out << pair.first.first << "," << pair.first.second << ","
+        << pages.globals_pages << "," << pages.globals_private << ","
+        << pages.tls_pages << "," << pages.tls_private << "\n";
+    total.globals_pages += pages.globals_pages;
+    total.globals_private += pages.globals_private;
+    total.tls_pages += pages.tls_pages;
+    total.tls_private += pages.tls_private;
+    uint64_t num_private = pages.globals_private + pages.tls_private;
+    if (num_private >= max_private){
+      max_private = num_private;
+      max_rank = pair.first;
+    }
+  }
+  std::cout << sprockit::sprintf("Copy-on-write globals: %d ranks wrote %llu of %llu global pages "
+                                 "and %llu of %llu TLS pages, at most %llu pages on app %d rank %d\n"
+                                 "Per-rank counts written to %s\n",
+                                 int(cow_pages.size()),
+                                 (unsigned long long) total.globals_private,
+                                 (unsigned long long) total.globals_pages,
+                                 (unsigned long long) total.tls_private,
+                                 (unsigned long long) total.tls_pages,
+                                 (unsigned long long) max_private,
+                                 max_rank.first, max_rank.second,
+                                 cow_report_file.c_str());
+  cow_pages.clear();
 }
 
 void
@@ -128,6 +336,7 @@ GlobalVariableContext::append(const int size, const char*  /*name*/)
   //fflush(stdout);
 
   stackOffset += offsetIncrement;
+  ++image_version_;
 
   return offset;
 }
@@ -169,6 +378,10 @@ GlobalVariableContext::~GlobalVariableContext()
     delete[] globalInits;
     globalInits = nullptr;
   }
+  if (image_fd_size_ > 0){
+    close(image_fd_);
+    image_fd_size_ = 0;
+  }
 }
 
 void
@@ -182,6 +395,7 @@ GlobalVariableContext::initGlobalSpace(void* ptr, int size, int offset)
   //also do the global init for any new threads spawned
   char* dst = ((char*)globalInits) + offset;
   ::memcpy(dst, ptr, size);
+  ++image_version_;
 }
 
 }
@@ -46,6 +46,10 @@ Questions? Contact sst-macro-help@sandia.gov
 #define SSTMAC_SOFTWARE_PROCESS_GLOBAL_H_INCLUDED
 
 #include <sstmac/software/process/tls.h>
+#include <sstmac/software/process/software_id.h>
+#include <sprockit/sim_parameters_fwd.h>
+#include <cstdint>
+#include <cstddef>
 #include <list>
 #include <map>
 #include <functional>
@@ -79,6 +83,20 @@ class GlobalVariableContext {
     return globalInits;
   }
 
+  /**
+   * @brief allocateSegment Allocate a segment of allocSize() bytes holding the initial image
+   * @param cow Map the image copy-on-write from a memfd shared by all segments
+   *            instead of copying it, so pages a rank never writes stay shared
+   */
+  char* allocateSegment(bool cow);
+
+  /**
+   * @brief freeSegment Free a segment from allocateSegment, recording for copy-on-write
+   *        segments how many pages the rank wrote
+   * @param sid The app and rank (task) owning the segment, shared by all threads of the rank
+   */
+  void freeSegment(char* segment, sw::SoftwareId sid);
+
   void addActiveSegment(void* globals){
     activeGlobalMaps_.insert(globals);
   }
@@ -98,9 +116,19 @@ class GlobalVariableContext {
   void registerInitFxn(int offset, std::function<void(void*)>&& fxn);
 
  private:
+  /** Bring the memfd up to date with the initial image, called under the segment lock */
+  void syncImage();
+
   int stackOffset;
   char* globalInits;
   int allocSize_;
+  /** Incremented whenever the initial image changes */
+  uint64_t image_version_;
+  int image_fd_;
+  uint64_t image_fd_version_;
+  size_t image_fd_size_;
+  /** The mapped size of each copy-on-write segment */
+  std::map<char*,size_t> cow_segments_;
   //these should be ordered by the offset in the data segment
   //this ensures as much as possible that global variables
   //are initialized in the same order in SST/macro as they would be in the real app
@@ -118,6 +146,18 @@ class GlobalVariable {
   static GlobalVariableContext glblCtx;
   static GlobalVariableContext tlsCtx;
   static bool inited;
+
+  /**
+   * Choose the file for the copy-on-write report,
+   * globals_cow.<rank>.csv when there are several ranks
+   */
+  static void initCowReport(SST::Params& params);
+
+  /**
+   * Print the pages written by each rank in copy-on-write segments,
+   * called at the end of the run
+   */
+  static void deleteStatics();
 };
 
 static inline void* get_special_at_offset(int offset, int map_offset)
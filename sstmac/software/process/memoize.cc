@@ -0,0 +1,506 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/software/process/memoize.h>
+#include <sstmac/software/process/operating_system.h>
+#include <sstmac/software/process/thread.h>
+#include <sstmac/common/thread_lock.h>
+#include <sstmac/backends/common/parallel_runtime.h>
+#include <sprockit/errors.h>
+#include <sprockit/statics.h>
+#include <sprockit/keyword_registration.h>
+#include <sprockit/sim_parameters.h>
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+RegisterKeywords(
+{ "memoize_file", "the file memoization models are read from and written back to at the end of the run" },
+{ "memoize_degree", "the degree of the polynomial memoization model" },
+);
+
+namespace sstmac {
+
+static sprockit::NeedDeletestatics<Memoization> del_statics;
+
+static thread_lock memoize_lock;
+static bool memoize_inited = false;
+static std::string memoize_file;
+static SST::Params* model_params = nullptr;
+static std::map<std::string, RegressionModel*>* models = nullptr;
+/** Model types declared for each region token */
+static std::map<std::string, std::string>* region_types = nullptr;
+static std::map<sw::Thread*, IntegerImplicitState>* thread_states = nullptr;
+
+/**
+ * A region between sstmac_start_memoize and sstmac_finish_memoize.
+ * The model is chosen once at the start, so finishing does not rebuild the key.
+ */
+struct InFlightRegion {
+  RegressionModel* model;
+  int model_tag;
+};
+static std::vector<InFlightRegion>* in_flight = nullptr;
+static std::vector<int>* free_in_flight = nullptr;
+
+int
+RegressionModel::startCollection()
+{
+  int tag;
+  if (free_tags_.empty()){
+    tag = timers_.size();
+    timers_.emplace_back();
+  } else {
+    tag = free_tags_.back();
+    free_tags_.pop_back();
+  }
+  timers_[tag].start();
+  return tag;
+}
+
+double
+RegressionModel::finishCollection(int tag, int n_params, const double params[], ImplicitState* state)
+{
+  if (tag < 0 || tag >= int(timers_.size())){
+    spkt_abort_printf("invalid memoization tag %d", tag);
+  }
+  double time = timers_[tag].stamp();
+  free_tags_.push_back(tag);
+  addSample(n_params, params, time, state);
+  return time;
+}
+
+PolynomialModel::PolynomialModel(SST::Params& params) :
+  PolynomialModel(params, params.find<int>("memoize_degree", 2))
+{
+}
+
+PolynomialModel::PolynomialModel(SST::Params& params, int degree) :
+  RegressionModel(params),
+  degree_(degree),
+  n_params_(-1),
+  num_samples_(0),
+  dirty_(false)
+{
+  if (degree_ < 1){
+    spkt_abort_printf("memoize_degree=%d must be at least 1", degree_);
+  }
+}
+
+static void
+add_monomials(int param, int degree_left, std::vector<int>& exps,
+              std::vector<std::vector<int>>& all)
+{
+  if (param == int(exps.size())){
+    all.push_back(exps);
+    return;
+  }
+  for (int e=0; e <= degree_left; ++e){
+    exps[param] = e;
+    add_monomials(param+1, degree_left - e, exps, all);
+  }
+  exps[param] = 0;
+}
+
+void
+PolynomialModel::init(int n_params)
+{
+  n_params_ = n_params;
+  std::vector<int> exps(n_params, 0);
+  exponents_.clear();
+  add_monomials(0, degree_, exps, exponents_);
+  int nterms = exponents_.size();
+  xtx_.resize(nterms*nterms, 0.);
+  xty_.resize(nterms, 0.);
+  coeffs_.resize(nterms, 0.);
+}
+
+void
+PolynomialModel::terms(const double params[], std::vector<double>& phi) const
+{
+  phi.resize(exponents_.size());
+  for (int t=0; t < int(exponents_.size()); ++t){
+    double x = 1.;
+    for (int p=0; p < n_params_; ++p){
+      for (int e=0; e < exponents_[t][p]; ++e) x *= params[p];
+    }
+    phi[t] = x;
+  }
+}
+
+void
+PolynomialModel::addSample(int n_params, const double params[], double time, ImplicitState* /*state*/)
+{
+  if (n_params_ < 0){
+    init(n_params);
+  } else if (n_params != n_params_){
+    spkt_abort_printf("memoization model fit with %d inputs got %d inputs", n_params_, n_params);
+  }
+
+  std::vector<double> phi;
+  terms(params, phi);
+  int nterms = phi.size();
+  for (int i=0; i < nterms; ++i){
+    for (int j=0; j < nterms; ++j){
+      xtx_[i*nterms + j] += phi[i]*phi[j];
+    }
+    xty_[i] += phi[i]*time;
+  }
+  ++num_samples_;
+  dirty_ = true;
+}
+
+/**
+ * Solve a*x = b by Gaussian elimination with partial pivoting
+ * @return False if a pivot fell below tol, i.e. the system is singular
+ */
+static bool
+gaussian_solve(int n, std::vector<double> a, std::vector<double> b,
+               std::vector<double>& x, double tol)
+{
+  bool nonsingular = true;
+  for (int col=0; col < n; ++col){
+    int pivot = col;
+    for (int row=col+1; row < n; ++row){
+      if (std::fabs(a[row*n+col]) > std::fabs(a[pivot*n+col])) pivot = row;
+    }
+    if (pivot != col){
+      for (int k=0; k < n; ++k) std::swap(a[col*n+k], a[pivot*n+k]);
+      std::swap(b[col], b[pivot]);
+    }
+    double diag = a[col*n+col];
+    if (std::fabs(diag) <= tol) nonsingular = false;
+    if (diag == 0) continue;
+    for (int row=col+1; row < n; ++row){
+      double factor = a[row*n+col] / diag;
+      if (factor == 0) continue;
+      for (int k=col; k < n; ++k) a[row*n+k] -= factor*a[col*n+k];
+      b[row] -= factor*b[col];
+    }
+  }
+  for (int row=n-1; row >= 0; --row){
+    double sum = b[row];
+    for (int k=row+1; k < n; ++k) sum -= a[row*n+k]*x[k];
+    double diag = a[row*n+row];
+    x[row] = diag == 0 ? 0 : sum / diag;
+  }
+  return nonsingular;
+}
+
+void
+PolynomialModel::solve()
+{
+  int n = xty_.size();
+  double max_diag = 0;
+  for (int i=0; i < n; ++i) max_diag = std::max(max_diag, xtx_[i*n+i]);
+  double ridge = max_diag > 0 ? 1e-12*max_diag : 1e-12;
+
+  //once the samples determine every term the exact solve is the most accurate,
+  //before that a small ridge keeps the system solvable
+  if (!gaussian_solve(n, xtx_, xty_, coeffs_, ridge)){
+    std::vector<double> a(xtx_);
+    for (int i=0; i < n; ++i) a[i*n+i] += ridge;
+    gaussian_solve(n, a, xty_, coeffs_, 0);
+  }
+  dirty_ = false;
+}
+
+double
+PolynomialModel::compute(int n_params, const double params[], ImplicitState* /*state*/)
+{
+  if (n_params != n_params_){
+    spkt_abort_printf("memoization model fit with %d inputs got %d inputs", n_params_, n_params);
+  }
+  if (dirty_) solve();
+
+  std::vector<double> phi;
+  terms(params, phi);
+  double time = 0;
+  for (int t=0; t < int(phi.size()); ++t){
+    time += coeffs_[t]*phi[t];
+  }
+  //extrapolating a fit can go negative
+  return std::max(time, 0.);
+}
+
+void
+PolynomialModel::writeModel(std::ostream& os) const
+{
+  os << degree_ << " " << n_params_ << " " << num_samples_;
+  for (double d : xtx_) os << " " << d;
+  for (double d : xty_) os << " " << d;
+}
+
+void
+PolynomialModel::readModel(std::istream& is)
+{
+  int n_params;
+  is >> degree_ >> n_params >> num_samples_;
+  if (n_params >= 0){
+    init(n_params);
+    for (double& d : xtx_) is >> d;
+    for (double& d : xty_) is >> d;
+  }
+  dirty_ = true;
+}
+
+Memoization::Memoization(const char* name, const char* model)
+{
+  memoize_lock.lock();
+  if (!region_types) region_types = new std::map<std::string, std::string>;
+  (*region_types)[name] = model;
+  memoize_lock.unlock();
+}
+
+void
+Memoization::init()
+{
+  if (memoize_inited) return;
+
+  SST::Params& os_params = sw::OperatingSystem::currentOs()->params();
+  memoize_file = os_params.find<std::string>("memoize_file", "sstmac_memoize.txt");
+  ParallelRuntime* rt = ParallelRuntime::staticRuntime(os_params);
+  if (rt && rt->nproc() > 1){
+    //each rank only fits the regions its own threads ran
+    memoize_file = sprockit::sprintf("%s.%d", memoize_file.c_str(), rt->me());
+  }
+  model_params = new SST::Params(os_params);
+  models = new std::map<std::string, RegressionModel*>;
+  thread_states = new std::map<sw::Thread*, IntegerImplicitState>;
+  in_flight = new std::vector<InFlightRegion>;
+  free_in_flight = new std::vector<int>;
+  if (!region_types) region_types = new std::map<std::string, std::string>;
+  readModels();
+  memoize_inited = true;
+}
+
+void
+Memoization::readModels()
+{
+  std::ifstream in(memoize_file);
+  if (!in.is_open()) return;
+
+  std::string line;
+  while (std::getline(in, line)){
+    if (line.empty() || line[0] == '#') continue;
+    std::stringstream sstr(line);
+    std::string key, type;
+    sstr >> key >> type;
+    RegressionModel* model = getModel(key, type);
+    model->readModel(sstr);
+    if (sstr.fail()){
+      spkt_abort_printf("invalid line for memoization model %s in %s", key.c_str(), memoize_file.c_str());
+    }
+  }
+}
+
+void
+Memoization::writeModels()
+{
+  std::ofstream out(memoize_file);
+  if (!out.is_open()){
+    spkt_abort_printf("could not open memoize_file %s", memoize_file.c_str());
+  }
+  out << "# memoization models: key type fit\n";
+  out.precision(std::numeric_limits<double>::max_digits10);
+  for (auto& pair : *models){
+    out << pair.first << " " << (*region_types)[pair.first] << " ";
+    pair.second->writeModel(out);
+    out << "\n";
+  }
+}
+
+std::string
+Memoization::modelKey(const std::string& token, IntegerImplicitState* state)
+{
+  if (!state || state->states.empty()) return token;
+
+  //each combination of implicit states gets its own fit
+  std::stringstream sstr;
+  sstr << token << "[";
+  bool first = true;
+  for (auto& pair : state->states){
+    if (!first) sstr << ",";
+    sstr << pair.first << "=" << pair.second;
+    first = false;
+  }
+  sstr << "]";
+  return sstr.str();
+}
+
+RegressionModel*
+Memoization::getModel(const std::string& key, const std::string& type)
+{
+  auto iter = models->find(key);
+  if (iter != models->end()) return iter->second;
+
+  RegressionModel* model = sprockit::create<RegressionModel>("macro", type, *model_params);
+  (*models)[key] = model;
+  (*region_types)[key] = type;
+  return model;
+}
+
+static IntegerImplicitState*
+current_state()
+{
+  auto iter = thread_states->find(sw::OperatingSystem::currentThread());
+  return iter == thread_states->end() ? nullptr : &iter->second;
+}
+
+int
+Memoization::start(const char* token, const char* model)
+{
+  memoize_lock.lock();
+  init();
+  std::string type = model ? model : "";
+  if (type.empty()){
+    auto iter = region_types->find(token);
+    type = iter == region_types->end() ? "linear" : iter->second;
+  }
+  RegressionModel* m = getModel(modelKey(token, current_state()), type);
+  int tag;
+  if (free_in_flight->empty()){
+    tag = in_flight->size();
+    in_flight->emplace_back();
+  } else {
+    tag = free_in_flight->back();
+    free_in_flight->pop_back();
+  }
+  InFlightRegion& region = (*in_flight)[tag];
+  region.model = m;
+  region.model_tag = m->startCollection();
+  memoize_lock.unlock();
+  return tag;
+}
+
+void
+Memoization::finish(int tag, const char* token, int n_params, const double params[])
+{
+  memoize_lock.lock();
+  init();
+  if (tag < 0 || tag >= int(in_flight->size()) || !(*in_flight)[tag].model){
+    spkt_abort_printf("memoization region %s finished without being started", token);
+  }
+  InFlightRegion& region = (*in_flight)[tag];
+  double time = region.model->finishCollection(region.model_tag, n_params, params, current_state());
+  region.model = nullptr;
+  free_in_flight->push_back(tag);
+  memoize_lock.unlock();
+
+  //the region really executed - advance simulated time by what it took
+  sw::OperatingSystem::currentOs()->compute(TimeDelta(time));
+}
+
+void
+Memoization::compute(const char* token, int n_params, const double params[])
+{
+  memoize_lock.lock();
+  init();
+  IntegerImplicitState* state = current_state();
+  std::string key = modelKey(token, state);
+  auto iter = models->find(key);
+  if (iter == models->end() || iter->second->numSamples() == 0){
+    spkt_abort_printf("no memoization model for %s in %s - run a memoization pass first",
+                      key.c_str(), memoize_file.c_str());
+  }
+  double time = iter->second->compute(n_params, params, state);
+  memoize_lock.unlock();
+
+  sw::OperatingSystem::currentOs()->compute(TimeDelta(time));
+}
+
+void
+Memoization::setImplicitState(int type, int state)
+{
+  memoize_lock.lock();
+  init();
+  (*thread_states)[sw::OperatingSystem::currentThread()].states[type] = state;
+  memoize_lock.unlock();
+}
+
+void
+Memoization::unsetImplicitState(int type)
+{
+  memoize_lock.lock();
+  init();
+  auto iter = thread_states->find(sw::OperatingSystem::currentThread());
+  if (iter != thread_states->end()){
+    iter->second.states.erase(type);
+    if (iter->second.states.empty()) thread_states->erase(iter);
+  }
+  memoize_lock.unlock();
+}
+
+void
+Memoization::clearThread(sw::Thread* thr)
+{
+  memoize_lock.lock();
+  //the thread object may be reused, so a new thread must not inherit stale states
+  if (thread_states) thread_states->erase(thr);
+  memoize_lock.unlock();
+}
+
+void
+Memoization::deleteStatics()
+{
+  if (memoize_inited){
+    bool fit_any = false;
+    for (auto& pair : *models){
+      fit_any = fit_any || pair.second->numSamples();
+    }
+    if (fit_any) writeModels();
+    for (auto& pair : *models) delete pair.second;
+    free_static_ptr(models);
+    free_static_ptr(thread_states);
+    free_static_ptr(in_flight);
+    free_static_ptr(free_in_flight);
+    free_static_ptr(model_params);
+  }
+  free_static_ptr(region_types);
+  memoize_inited = false;
+}
+
+}
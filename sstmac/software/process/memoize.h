@@ -41,13 +41,198 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 Questions? Contact sst-macro-help@sandia.gov
 */
+
 #ifndef sstmac_sw_process_memoize_h
 #define sstmac_sw_process_memoize_h
 
+#include <sstmac/sst_core/integrated_component.h>
+#include <sstmac/software/process/host_timer.h>
+#include <sstmac/software/process/thread_fwd.h>
+#include <sprockit/factory.h>
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
 namespace sstmac {
 
+/**
+ * Hardware or software state, e.g. a DVFS level or a cold cache, set by the implicit_state
+ * pragma and not captured by the inputs of a memoized region.
+ */
+class ImplicitState {
+ public:
+  virtual ~ImplicitState(){}
+};
+
+/**
+ * The integer type/state pairs passed to sstmac_set_implicit_memoize_stateN
+ */
+class IntegerImplicitState : public ImplicitState {
+ public:
+  std::map<int,int> states;
+};
+
+/**
+ * Performance model for one memoized region, fit online to the host time
+ * measured between sstmac_start_memoize and sstmac_finish_memoizeN.
+ * Models persist their fitting state so that later runs can keep refining them.
+ */
+class RegressionModel {
+ public:
+  SST_ELI_DECLARE_BASE(RegressionModel)
+  SST_ELI_DECLARE_DEFAULT_INFO()
+  SST_ELI_DECLARE_CTOR(SST::Params&)
+
+  virtual ~RegressionModel(){}
+
+  /**
+   * @brief startCollection Start timing one execution of the region
+   * @return A tag identifying the timer for finishCollection
+   */
+  int startCollection();
+
+  /**
+   * @brief finishCollection Stop the timer and add the sample to the fit
+   * @return The measured host time in seconds
+   */
+  double finishCollection(int tag, int n_params, const double params[], ImplicitState* state);
+
+  /**
+   * @return The modeled time in seconds
+   */
+  virtual double compute(int n_params, const double params[], ImplicitState* state) = 0;
+
+  virtual void addSample(int n_params, const double params[], double time, ImplicitState* state) = 0;
+
+  /**
+   * @brief writeModel Write the fitting state on a single line
+   */
+  virtual void writeModel(std::ostream& os) const = 0;
+
+  virtual void readModel(std::istream& is) = 0;
+
+  virtual uint64_t numSamples() const = 0;
+
+ protected:
+  RegressionModel(SST::Params&){}
+
+ private:
+  std::vector<HostTimer> timers_;
+  std::vector<int> free_tags_;
+
+};
+
+/**
+ * Least-squares fit of the time to every monomial of the inputs up to a given degree.
+ * Only the normal equations are accumulated, so memory does not grow with the number of samples.
+ */
+class PolynomialModel : public RegressionModel {
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    RegressionModel,
+    PolynomialModel,
+    "macro",
+    "polynomial",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "least-squares polynomial in the memoization inputs")
+
+  PolynomialModel(SST::Params& params);
+
+  double compute(int n_params, const double params[], ImplicitState* state) override;
+
+  void addSample(int n_params, const double params[], double time, ImplicitState* state) override;
+
+  void writeModel(std::ostream& os) const override;
+
+  void readModel(std::istream& is) override;
+
+  uint64_t numSamples() const override {
+    return num_samples_;
+  }
+
+ protected:
+  PolynomialModel(SST::Params& params, int degree);
+
+ private:
+  void init(int n_params);
+
+  void terms(const double params[], std::vector<double>& phi) const;
+
+  void solve();
+
+  int degree_;
+  int n_params_;
+  uint64_t num_samples_;
+  bool dirty_;
+
+  /** The exponent of each input in each monomial */
+  std::vector<std::vector<int>> exponents_;
+
+  /** Normal equations: row-major sum of phi*phi^T and sum of phi*time */
+  std::vector<double> xtx_;
+  std::vector<double> xty_;
+
+  std::vector<double> coeffs_;
+
+};
+
+class LinearModel : public PolynomialModel {
+ public:
+  SST_ELI_REGISTER_DERIVED(
+    RegressionModel,
+    LinearModel,
+    "macro",
+    "linear",
+    SST_ELI_ELEMENT_VERSION(1,0,0),
+    "least-squares linear function of the memoization inputs")
+
+  LinearModel(SST::Params& params) :
+    PolynomialModel(params, 1)
+  {
+  }
+};
+
+/**
+ * Registry of the memoization models in this process, keyed by region token and implicit state.
+ * Models are read from memoize_file the first time a region is used
+ * and written back to it when the simulation finishes.
+ */
 struct Memoization {
+  /**
+   * @brief Memoization Declare the model type to use for a region
+   */
   Memoization(const char* name, const char* model);
+
+  static int start(const char* token, const char* model);
+
+  static void finish(int tag, const char* token, int n_params, const double params[]);
+
+  static void compute(const char* token, int n_params, const double params[]);
+
+  static void setImplicitState(int type, int state);
+
+  static void unsetImplicitState(int type);
+
+  /**
+   * @brief clearThread Forget the implicit states of a thread that is exiting
+   */
+  static void clearThread(sw::Thread* thr);
+
+  static void deleteStatics();
+
+ private:
+  static void init();
+
+  static std::string modelKey(const std::string& token, IntegerImplicitState* state);
+
+  static RegressionModel* getModel(const std::string& key, const std::string& type);
+
+  static void readModels();
+
+  static void writeModels();
+
 };
 
 }
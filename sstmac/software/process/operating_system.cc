@@ -100,6 +100,8 @@ RegisterNamespaces("callGraph", "ftq");
 RegisterKeywords(
 { "stack_size", "the size of stack to allocate to each user-space thread" },
 { "stack_chunk_size", "the block size to allocate in the memory pool when more stacks are needed" },
+{ "stack_reclaim", "when to return unused stack pages to the OS: none, finish, or park" },
+{ "stack_retain_size", "the bytes at the top of a reclaimed stack to keep resident for reuse" },
 { "ftq", "DEPRECATED: sets the fileroot of the FTQ statistic" },
 { "ftq_epoch", "DEPRECATED: sets the time epoch size for the FTQ statistic" },
 { "callGraph", "DEPRECATED: sets the fileroot of the call graph statistic" },
@@ -466,6 +468,8 @@ OperatingSystem::block()
   os_debug("pausing context on thread %d", active_thread_->threadId());
   blocked_thread_ = active_thread_;
   active_thread_ = nullptr;
+  //before lives on the stack of the blocking thread, marking its current depth
+  StackAlloc::park(old_thread->stack_, &before);
   old_context->pauseContext(des_context_);
 
   while(hold_for_gdb_){
@@ -48,6 +48,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/software/process/thread.h>
 #include <sstmac/software/process/operating_system.h>
 #include <sstmac/software/process/app.h>
+#include <sstmac/software/process/memoize.h>
 #include <sstmac/software/libraries/library.h>
 #include <sstmac/software/libraries/compute/compute_event.h>
 #include <sstmac/software/api/api.h>
@@ -116,6 +117,8 @@ Thread::cleanup()
     //no matter what, I have to delete myself
     os_->scheduleThreadDeletion(this);
   }
+  Memoization::clearThread(this);
+
   // We are done, ask the scheduler to remove this task from the
   state_ = DONE;
 
@@ -307,12 +310,12 @@ Thread::now()
 Thread::~Thread()
 {
   active_cores_.clear();
-  if (stack_) StackAlloc::free(stack_);
+  if (stack_) StackAlloc::free(stack_, aid());
   if (context_) {
     context_->destroyContext();
     delete context_;
   }
-  if (tls_storage_) delete[] tls_storage_;
+  if (tls_storage_) GlobalVariable::tlsCtx.freeSegment(tls_storage_, sid());
   if (host_timer_) delete host_timer_;
 }
 
@@ -48,7 +48,12 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sstmac/common/thread_lock.h>
 #include <sprockit/errors.h>
 #include <sprockit/sim_parameters.h>
+#include <sprockit/statics.h>
+#include <sprockit/util.h>
+#include <iostream>
+#include <map>
 #include <unistd.h>
+#include <sys/mman.h>
 
 namespace sstmac {
 namespace sw {
@@ -57,6 +62,25 @@ StackAlloc::chunk_set StackAlloc::chunks_;
 size_t StackAlloc::suggested_chunk_ = 0;
 size_t StackAlloc::stacksize_ = 0;
 bool StackAlloc::protect_stacks_ = false;
+StackAlloc::reclaim_t StackAlloc::reclaim_ = StackAlloc::reclaim_none;
+size_t StackAlloc::retain_size_ = 0;
+
+static sprockit::NeedDeletestatics<StackAlloc> del_statics;
+
+static thread_lock high_water_lock;
+
+namespace {
+struct HighWater {
+  size_t max = 0;
+  size_t total = 0;
+  int count = 0;
+};
+}
+
+/** The deepest point reached by stacks that blocked, indexed by stack */
+static std::map<void*,size_t> parked_high_water;
+/** The high water of finished stacks, indexed by app */
+static std::map<int,HighWater> app_high_water;
 
 void
 StackAlloc::init(SST::Params& params)
@@ -76,6 +100,78 @@ StackAlloc::init(SST::Params& params)
   stacksize_ = sstmac_global_stacksize;
 
   protect_stacks_ = params.find<bool>("protect_stacks", false);
+
+  std::string reclaim = params.find<std::string>("stack_reclaim", "none");
+  if (reclaim == "none"){
+    reclaim_ = reclaim_none;
+  } else if (reclaim == "finish"){
+    reclaim_ = reclaim_finish;
+  } else if (reclaim == "park"){
+    reclaim_ = reclaim_park;
+  } else {
+    spkt_abort_printf("invalid stack_reclaim %s: must be none, finish, or park", reclaim.c_str());
+  }
+  retain_size_ = params.find<SST::UnitAlgebra>("stack_retain_size", "16KB").getRoundedValue();
+  retain_size_ = std::min(retain_size_, stacksize_);
+}
+
+size_t
+StackAlloc::highWater(void* stack)
+{
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t num_pages = stacksize_ / page;
+  std::vector<unsigned char> resident(num_pages);
+  if (mincore(stack, stacksize_, resident.data()) != 0){
+    return 0;
+  }
+  //the first page holds the thread-local storage, not the stack
+  for (size_t i=1; i < num_pages; ++i){
+    if (resident[i] & 1){
+      return stacksize_ - i*page;
+    }
+  }
+  return 0;
+}
+
+void
+StackAlloc::release(void* stack, char* until)
+{
+  size_t page = sysconf(_SC_PAGESIZE);
+  char* start = (char*) stack + page;
+  until = (char*) (uintptr_t(until) / page * page);
+  if (until > start){
+    madvise(start, until - start, MADV_DONTNEED);
+  }
+}
+
+void
+StackAlloc::parkImpl(void* stack, void* sp)
+{
+  size_t hw = highWater(stack);
+  high_water_lock.lock();
+  size_t& max = parked_high_water[stack];
+  max = std::max(max, hw);
+  high_water_lock.unlock();
+  //leave room below the stack pointer for the frames of the context switch
+  size_t page = sysconf(_SC_PAGESIZE);
+  release(stack, (char*) sp - 2*page);
+}
+
+void
+StackAlloc::deleteStatics()
+{
+  for (auto& pair : app_high_water){
+    const HighWater& hw = pair.second;
+    std::cout << sprockit::sprintf("Stack high water for app %d: max %lu of %lu bytes, mean %lu over %d threads\n",
+                                   pair.first, (unsigned long) hw.max, (unsigned long) stacksize_,
+                                   (unsigned long) (hw.total / hw.count), hw.count);
+    if (hw.max > stacksize_ / 4 * 3){
+      std::cout << sprockit::sprintf("WARNING: app %d used more than 75%% of its stack - consider increasing stack_size\n",
+                                     pair.first);
+    }
+  }
+  app_high_water.clear();
+  parked_high_water.clear();
 }
 
 void
@@ -104,7 +200,7 @@ StackAlloc::alloc()
 
   if(chunks_.available.empty()){
     // grab a new chunk.
-    chunk* new_chunk = new chunk(stacksize_, suggested_chunk_, protect_stacks_);
+    chunk* new_chunk = new chunk(stacksize_, suggested_chunk_, protect_stacks_, reclaim_ != reclaim_none);
     chunks_.allocations.push_back(new_chunk);
     void* buf = new_chunk->getNextStack();
     while (buf != nullptr){
@@ -123,6 +219,30 @@ StackAlloc::alloc()
 //
 void StackAlloc::free(void* buf)
 {
+  free(buf, -1);
+}
+
+void
+StackAlloc::free(void* buf, int aid)
+{
+  if (reclaim_ != reclaim_none){
+    size_t hw = highWater(buf);
+    high_water_lock.lock();
+    auto iter = parked_high_water.find(buf);
+    if (iter != parked_high_water.end()){
+      hw = std::max(hw, iter->second);
+      parked_high_water.erase(iter);
+    }
+    if (aid >= 0){
+      HighWater& app = app_high_water[aid];
+      app.max = std::max(app.max, hw);
+      app.total += hw;
+      ++app.count;
+    }
+    high_water_lock.unlock();
+    release(buf, (char*) buf + stacksize_ - retain_size_);
+  }
+
   static thread_lock lock; 
   lock.lock();
   chunks_.available.push_back(buf);
@@ -60,6 +60,10 @@ namespace sw {
  *
  * This allocator does not return memory to the system until it is
  * deleted, but regions can be allocated and free-d repeatedly.
+ * With stack_reclaim set, stacks are only reserved and the pages
+ * below stack_retain_size from the top are given back to the system
+ * when a thread finishes (finish) or also whenever it blocks (park).
+ * The deepest point reached on each stack is then reported per app.
  */
 class StackAlloc
 {
@@ -82,6 +86,25 @@ class StackAlloc
   /// Optionally added a protected stack between each stack we return
   static bool protect_stacks_;
 
+  enum reclaim_t {
+    reclaim_none,
+    reclaim_finish,
+    reclaim_park
+  };
+  static reclaim_t reclaim_;
+  /// The bytes at the top of a stack kept committed when reclaiming
+  static size_t retain_size_;
+
+  /**
+   * @return The number of bytes from the top of the stack down to the deepest committed page
+   */
+  static size_t highWater(void* stack);
+
+  /**
+   * @brief release Give back the pages between the thread-local storage and until
+   */
+  static void release(void* stack, char* until);
+
  public:
   static size_t stacksize() {
     return stacksize_;
@@ -101,8 +124,28 @@ class StackAlloc
 
   static void free(void*);
 
+  /**
+   * @brief free Return a stack and record its high water for the app
+   */
+  static void free(void* stack, int aid);
+
+  /**
+   * @brief park Release the unused part of a stack while its thread is blocked
+   * @param sp An address at or below the current stack pointer of the thread
+   */
+  static void park(void* stack, void* sp){
+    if (reclaim_ == reclaim_park && stack){
+      parkImpl(stack, sp);
+    }
+  }
+
   static void clear();
 
+  static void deleteStatics();
+
+ private:
+  static void parkImpl(void* stack, void* sp);
+
 };
 
 }
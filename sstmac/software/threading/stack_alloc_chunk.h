@@ -73,8 +73,8 @@ class StackAlloc::chunk
   size_t next_stack_offset_ = 0;
 
  public:
-  /// Make a new chunk.
-  chunk(size_t stacksize, size_t suggested_chunk_size, bool protect);
+  /// Make a new chunk, only reserving rather than committing the memory if noreserve.
+  chunk(size_t stacksize, size_t suggested_chunk_size, bool protect, bool noreserve);
 
   ~chunk();
 
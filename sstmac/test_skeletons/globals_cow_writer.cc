@@ -0,0 +1,95 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#define sstmac_app_name globals_cow_writer
+
+#include <sstmac/skeleton.h>
+#include <sstmac/util.h>
+#include <sstmac/software/process/cppglobal.h>
+#include <sprockit/errors.h>
+#include <unistd.h>
+
+/**
+ * Writes a known number of pages of its global and TLS segments so that
+ * the copy-on-write report can be checked against exact private page counts.
+ * Run with globals_size and tls_size large enough for the page buffers.
+ */
+
+static const int max_pages_written = 4;
+
+struct PageBuffer {
+  //not zeroed on construction, which would make every page private
+  PageBuffer(){}
+  char bytes[(max_pages_written + 1)*4096];
+};
+
+struct globals_tag {};
+struct tls_tag {};
+
+static void
+writePages(char* buffer, int num_pages)
+{
+  uintptr_t page = sysconf(_SC_PAGESIZE);
+  if (num_pages > max_pages_written || (num_pages + 1)*page > sizeof(PageBuffer)){
+    spkt_abort_printf("globals_cow_writer can write at most %d pages of %d bytes",
+                      max_pages_written, int(page));
+  }
+  //the buffer spans num_pages+1 pages, so it holds the start of num_pages whole pages
+  uintptr_t first = (uintptr_t(buffer) + page - 1) / page * page;
+  for (int i=0; i < num_pages; ++i){
+    char* ptr = (char*) (first + i*page);
+    *ptr = 1;
+  }
+}
+
+int USER_MAIN(int  /*argc*/, char**  /*argv*/)
+{
+  //registered on first use so that other apps keep their segment layout
+  static sstmac::CppVarTemplate<globals_tag,PageBuffer,false> globals;
+  static sstmac::CppVarTemplate<tls_tag,PageBuffer,true> tls;
+
+  writePages(globals().bytes, sstmac::getParam<int>("global_pages_written"));
+  writePages(tls().bytes, sstmac::getParam<int>("tls_pages_written"));
+  return 0;
+}
@@ -54,6 +54,10 @@ Questions? Contact sst-macro-help@sandia.gov
 
 #define sstmac_app_name mpi_all_collectives
 
+RegisterKeywords(
+ { "iterations", "the number of times to repeat the collectives" },
+);
+
 int USER_MAIN(int argc, char** argv)
 {
   MPI_Init(&argc, &argv);
@@ -62,8 +66,11 @@ int USER_MAIN(int argc, char** argv)
   MPI_Comm_rank(MPI_COMM_WORLD, &me);
   MPI_Comm_size(MPI_COMM_WORLD, &nproc);
 
-  MPI_Alltoall(nullptr, 100, MPI_INT, nullptr, 100, MPI_INT, MPI_COMM_WORLD);
-  MPI_Allgather(nullptr, 1000, MPI_DOUBLE, nullptr, 1000, MPI_DOUBLE, MPI_COMM_WORLD);
+  int niter = sstmac::getParam<int>("iterations", 1);
+  for (int i=0; i < niter; ++i){
+    MPI_Alltoall(nullptr, 100, MPI_INT, nullptr, 100, MPI_INT, MPI_COMM_WORLD);
+    MPI_Allgather(nullptr, 1000, MPI_DOUBLE, nullptr, 1000, MPI_DOUBLE, MPI_COMM_WORLD);
+  }
   //MPI_Allreduce(nullptr, nullptr, 400, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
 
   MPI_Finalize();
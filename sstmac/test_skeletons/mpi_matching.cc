@@ -0,0 +1,256 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sstmac/util.h>
+#include <sstmac/replacements/mpi/mpi.h>
+#include <sstmac/skeleton.h>
+#include <sprockit/keyword_registration.h>
+#include <chrono>
+#include <vector>
+
+RegisterKeywords(
+ { "num_partners", "the number of ranks on either side to exchange messages with" },
+ { "num_tags", "the number of distinct tags posted per partner in each iteration" },
+ { "num_iterations", "the number of times to repeat each matching phase" },
+);
+
+#define sstmac_app_name mpi_matching
+
+/**
+ * Stresses MPI matching with many posted receives and many unexpected messages.
+ * Each rank posts num_tags receives per partner, then partners send the tags in reverse
+ * so every message matches the newest receive. A second phase sends before the receives
+ * are posted, and a third receives with MPI_ANY_SOURCE. The host time spent in each phase
+ * is reported by rank 0. A final pass mixes exact and wildcard receives and checks
+ * that no message overtook an earlier one from the same source.
+ */
+
+/** Messages each rank sends to each partner in the ordering check, tagged seq % 3 */
+static const int num_ordered = 12;
+static const int tag_any_source = 0;
+static const int tag_exact = 1;
+/** No message is sent with this tag, its receive is cancelled */
+static const int tag_cancelled = 99;
+
+struct OrderedRecv {
+  int source;
+  int tag;
+  int seq;
+};
+
+static bool
+matches(const OrderedRecv& recv, int source, int tag)
+{
+  return (recv.source == MPI_ANY_SOURCE || recv.source == source)
+      && (recv.tag == MPI_ANY_TAG || recv.tag == tag);
+}
+
+static int
+tagOf(int seq)
+{
+  return seq % 3 == 0 ? tag_any_source : tag_exact;
+}
+
+/**
+ * Post exact and MPI_ANY_SOURCE receives first, then MPI_ANY_TAG, then fully wildcard receives.
+ * Older receives always win, so every receive is guaranteed a message.
+ * Half the messages are sent before the receives are posted and half after.
+ * @return The number of receives that got a later message from a source
+ *         while an earlier matching message went to a receive posted after it
+ */
+static int
+checkOrdering(const std::vector<int>& partners)
+{
+  int num_msgs = partners.size() * num_ordered;
+  std::vector<int> send_seqs(num_ordered);
+  std::vector<int> recv_seqs(num_msgs);
+  std::vector<OrderedRecv> recvs;
+  std::vector<MPI_Request> reqs;
+  std::vector<MPI_Request> send_reqs;
+
+  auto send = [&](int first, int last){
+    for (int partner : partners){
+      for (int seq=first; seq < last; ++seq){
+        send_seqs[seq] = seq;
+        send_reqs.emplace_back();
+        MPI_Isend(&send_seqs[seq], 1, MPI_INT, partner, tagOf(seq), MPI_COMM_WORLD, &send_reqs.back());
+      }
+    }
+  };
+  auto recv = [&](int source, int tag){
+    recvs.push_back({source, tag, -1});
+    reqs.emplace_back();
+    MPI_Irecv(&recv_seqs[reqs.size()-1], 1, MPI_INT, source, tag, MPI_COMM_WORLD, &reqs.back());
+  };
+
+  send_reqs.reserve(2*num_msgs);
+  reqs.reserve(num_msgs);
+  send(0, num_ordered/2);
+  //of the 4 any_source and 8 exact tagged messages from each partner,
+  //receive 2 with MPI_ANY_SOURCE and 4 exactly, interleaved
+  for (int i=0; i < 4; ++i){
+    for (int partner : partners){
+      recv(partner, tag_exact);
+      if (i % 2 == 0) recv(MPI_ANY_SOURCE, tag_any_source);
+    }
+  }
+  for (int i=0; i < 3; ++i){
+    for (int partner : partners) recv(partner, MPI_ANY_TAG);
+  }
+
+  MPI_Request cancelled;
+  MPI_Irecv(nullptr, 1, MPI_INT, MPI_ANY_SOURCE, tag_cancelled, MPI_COMM_WORLD, &cancelled);
+  while (int(reqs.size()) < num_msgs) recv(MPI_ANY_SOURCE, MPI_ANY_TAG);
+  MPI_Cancel(&cancelled);
+  MPI_Wait(&cancelled, MPI_STATUS_IGNORE);
+
+  send(num_ordered/2, num_ordered);
+  std::vector<MPI_Status> stats(num_msgs);
+  MPI_Waitall(num_msgs, reqs.data(), stats.data());
+  MPI_Waitall(send_reqs.size(), send_reqs.data(), MPI_STATUSES_IGNORE);
+
+  int violations = 0;
+  for (int i=0; i < num_msgs; ++i){
+    for (int j=i+1; j < num_msgs; ++j){
+      bool same_source = stats[i].MPI_SOURCE == stats[j].MPI_SOURCE;
+      if (same_source && recv_seqs[j] < recv_seqs[i]
+          && matches(recvs[i], stats[j].MPI_SOURCE, stats[j].MPI_TAG)){
+        ++violations;
+      }
+    }
+  }
+  return violations;
+}
+
+int USER_MAIN(int argc, char** argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int me, nproc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &me);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+
+  int num_partners = sstmac::getParam<int>("num_partners", 4);
+  int num_tags = sstmac::getParam<int>("num_tags", 256);
+  int num_iterations = sstmac::getParam<int>("num_iterations", 10);
+  if (2*num_partners >= nproc){
+    num_partners = (nproc - 1) / 2;
+  }
+
+  std::vector<int> partners;
+  for (int p=1; p <= num_partners; ++p){
+    partners.push_back((me + p) % nproc);
+    partners.push_back((me - p + nproc) % nproc);
+  }
+
+  int num_msgs = partners.size() * num_tags;
+  std::vector<MPI_Request> reqs(2*num_msgs);
+
+  using clock = std::chrono::steady_clock;
+  double phase_times[3] = {0, 0, 0};
+  for (int iter=0; iter < num_iterations; ++iter){
+    //phase 0: receives are posted first, sends arrive in reverse tag order
+    auto t_start = clock::now();
+    MPI_Request* reqptr = reqs.data();
+    for (int partner : partners){
+      for (int t=0; t < num_tags; ++t){
+        MPI_Irecv(nullptr, 1, MPI_INT, partner, t, MPI_COMM_WORLD, reqptr++);
+      }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    for (int partner : partners){
+      for (int t=num_tags-1; t >= 0; --t){
+        MPI_Isend(nullptr, 1, MPI_INT, partner, t, MPI_COMM_WORLD, reqptr++);
+      }
+    }
+    MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+    phase_times[0] += std::chrono::duration<double>(clock::now() - t_start).count();
+
+    //phase 1: messages arrive unexpected, receives are posted in reverse tag order
+    t_start = clock::now();
+    reqptr = reqs.data();
+    for (int partner : partners){
+      for (int t=0; t < num_tags; ++t){
+        MPI_Isend(nullptr, 1, MPI_INT, partner, t, MPI_COMM_WORLD, reqptr++);
+      }
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+    for (int partner : partners){
+      for (int t=num_tags-1; t >= 0; --t){
+        MPI_Irecv(nullptr, 1, MPI_INT, partner, t, MPI_COMM_WORLD, reqptr++);
+      }
+    }
+    MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+    phase_times[1] += std::chrono::duration<double>(clock::now() - t_start).count();
+
+    //phase 2: wildcard receives fall back to arrival order
+    t_start = clock::now();
+    reqptr = reqs.data();
+    for (int partner : partners){
+      for (int t=0; t < num_tags; ++t){
+        MPI_Isend(nullptr, 1, MPI_INT, partner, t, MPI_COMM_WORLD, reqptr++);
+      }
+    }
+    for (int i=0; i < num_msgs; ++i){
+      MPI_Irecv(nullptr, 1, MPI_INT, MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, reqptr++);
+    }
+    MPI_Waitall(reqs.size(), reqs.data(), MPI_STATUSES_IGNORE);
+    phase_times[2] += std::chrono::duration<double>(clock::now() - t_start).count();
+  }
+
+  int violations = checkOrdering(partners);
+  int total_violations = 0;
+  MPI_Reduce(&violations, &total_violations, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+
+  if (me == 0){
+    printf("Matching %d messages per iteration over %d iterations\n", num_msgs, num_iterations);
+    printf("  posted first:     %10.4f host ms\n", phase_times[0]*1e3);
+    printf("  unexpected first: %10.4f host ms\n", phase_times[1]*1e3);
+    printf("  wildcard:         %10.4f host ms\n", phase_times[2]*1e3);
+    printf("Mixed wildcard and exact receives: %d ordering violations\n", total_violations);
+  }
+
+  MPI_Finalize();
+  return 0;
+}
@@ -263,6 +263,8 @@ class MpiApi : public sumi::SimTransport
 
   int request_free(MPI_Request* req);
 
+  int cancel(MPI_Request* req);
+
   int start(MPI_Request* req);
 
   int startall(int count, MPI_Request* req);
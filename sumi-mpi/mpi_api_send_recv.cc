@@ -168,6 +168,20 @@ MpiApi::request_free(MPI_Request *req)
   return MPI_SUCCESS;
 }
 
+int
+MpiApi::cancel(MPI_Request *req)
+{
+  mpi_api_debug(sprockit::dbg::mpi | sprockit::dbg::mpi_request | sprockit::dbg::mpi_pt2pt,
+    "MPI_Cancel(REQ=%d)", *req);
+
+  MpiRequest* reqPtr = getRequest(*req);
+  //only receives that have not matched can be withdrawn, sends always complete
+  if (reqPtr && !reqPtr->isComplete() && queue_->cancelRecv(reqPtr)){
+    reqPtr->cancel();
+  }
+  return MPI_SUCCESS;
+}
+
 void
 MpiApi::doStart(MPI_Request req)
 {
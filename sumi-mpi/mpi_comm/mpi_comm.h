@@ -136,6 +136,10 @@ class MpiComm : public Communicator
     return id_;
   }
 
+  int commId() const override {
+    return int(id_);
+  }
+
   void setKeyval(keyval* k, void* val);
 
   void getKeyval(keyval* k, void* val, int* flag);
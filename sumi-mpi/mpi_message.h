@@ -65,6 +65,12 @@ class MpiMessage final :
   ImplementSerializable(MpiMessage)
 
  public:
+#if SSTMAC_CUSTOM_NEW
+  //count MPI messages separately from the flows they derive from
+  using sprockit::thread_safe_new<MpiMessage>::operator new;
+  using sprockit::thread_safe_new<MpiMessage>::operator delete;
+#endif
+
   template <class... Args>
   MpiMessage(int src_rank, int dst_rank,
               MPI_Datatype type, int tag, MPI_Comm commid, int seqnum,
@@ -0,0 +1,232 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#include <sumi-mpi/mpi_queue/mpi_match_engine.h>
+#include <sumi-mpi/mpi_queue/mpi_queue_recv_request.h>
+#include <sprockit/errors.h>
+
+namespace sumi {
+
+void
+MpiMatchEngine::addUnexpected(MpiMessage* msg)
+{
+  UnexpectedQueues& q = unexpected_[msg->comm()];
+  auto it = q.arrivals.insert(q.arrivals.end(), msg);
+  q.buckets[key(msg->srcRank(), msg->tag())].push_back(it);
+  ++num_unexpected_;
+}
+
+MpiMatchEngine::arrival_list::iterator
+MpiMatchEngine::findArrival(UnexpectedQueues& q, int source, int tag)
+{
+  if (source != MPI_ANY_SOURCE && tag != MPI_ANY_TAG){
+    auto iter = q.buckets.find(key(source, tag));
+    return iter == q.buckets.end() ? q.arrivals.end() : iter->second.front();
+  }
+
+  //wildcards fall back to a scan in arrival order
+  for (auto it = q.arrivals.begin(); it != q.arrivals.end(); ++it){
+    MpiMessage* msg = *it;
+    bool src_matches = source == MPI_ANY_SOURCE || source == msg->srcRank();
+    bool tag_matches = tag == MPI_ANY_TAG || tag == msg->tag();
+    if (src_matches && tag_matches) return it;
+  }
+  return q.arrivals.end();
+}
+
+void
+MpiMatchEngine::removeArrival(UnexpectedQueues& q, arrival_list::iterator it)
+{
+  MpiMessage* msg = *it;
+  auto iter = q.buckets.find(key(msg->srcRank(), msg->tag()));
+  //the oldest message matching any receive is also the oldest in its bucket
+  if (iter == q.buckets.end() || iter->second.front() != it){
+    spkt_abort_printf("MPI match engine lost ordering for %s", msg->toString().c_str());
+  }
+  iter->second.pop_front();
+  if (iter->second.empty()) q.buckets.erase(iter);
+  q.arrivals.erase(it);
+  --num_unexpected_;
+}
+
+MpiMessage*
+MpiMatchEngine::matchUnexpected(MpiQueueRecvRequest* req)
+{
+  auto qiter = unexpected_.find(req->comm_);
+  if (qiter == unexpected_.end()) return nullptr;
+
+  UnexpectedQueues& q = qiter->second;
+  auto it = findArrival(q, req->source_, req->tag_);
+  if (it == q.arrivals.end()) return nullptr;
+
+  MpiMessage* msg = *it;
+  //checks that the message fits in the receive buffer
+  req->matches(msg);
+  removeArrival(q, it);
+  if (q.arrivals.empty()) unexpected_.erase(qiter);
+  return msg;
+}
+
+MpiMessage*
+MpiMatchEngine::findUnexpected(MPI_Comm comm, int source, int tag)
+{
+  auto qiter = unexpected_.find(comm);
+  if (qiter == unexpected_.end()) return nullptr;
+
+  UnexpectedQueues& q = qiter->second;
+  auto it = findArrival(q, source, tag);
+  return it == q.arrivals.end() ? nullptr : *it;
+}
+
+void
+MpiMatchEngine::addPosted(MpiQueueRecvRequest* req)
+{
+  PostedQueues& q = posted_[req->comm_];
+  Posted p{q.next_seqnum++, req};
+  if (req->source_ == MPI_ANY_SOURCE && req->tag_ == MPI_ANY_TAG){
+    q.any_source_any_tag.push_back(p);
+  } else if (req->source_ == MPI_ANY_SOURCE){
+    q.any_source[req->tag_].push_back(p);
+  } else if (req->tag_ == MPI_ANY_TAG){
+    q.any_tag[req->source_].push_back(p);
+  } else {
+    q.exact[key(req->source_, req->tag_)].push_back(p);
+  }
+  ++num_posted_;
+}
+
+MpiQueueRecvRequest*
+MpiMatchEngine::matchPosted(MpiMessage* msg)
+{
+  auto qiter = posted_.find(msg->comm());
+  if (qiter == posted_.end()) return nullptr;
+
+  PostedQueues& q = qiter->second;
+  auto exact = q.exact.find(key(msg->srcRank(), msg->tag()));
+  auto any_source = q.any_source.find(msg->tag());
+  auto any_tag = q.any_tag.find(msg->srcRank());
+
+  posted_bucket* candidates[] = {
+    exact == q.exact.end() ? nullptr : &exact->second,
+    any_source == q.any_source.end() ? nullptr : &any_source->second,
+    any_tag == q.any_tag.end() ? nullptr : &any_tag->second,
+    &q.any_source_any_tag
+  };
+
+  //every receive in a candidate bucket matches, so the oldest front wins
+  posted_bucket* oldest = nullptr;
+  for (posted_bucket* bucket : candidates){
+    if (!bucket) continue;
+    if (!bucket->empty() && (!oldest || bucket->front().seqnum < oldest->front().seqnum)){
+      oldest = bucket;
+    }
+  }
+
+  MpiQueueRecvRequest* req = nullptr;
+  if (oldest){
+    req = oldest->front().req;
+    oldest->pop_front();
+    --num_posted_;
+    //checks that the message fits in the receive buffer
+    req->matches(msg);
+  }
+
+  if (exact != q.exact.end() && exact->second.empty()) q.exact.erase(exact);
+  if (any_source != q.any_source.end() && any_source->second.empty()) q.any_source.erase(any_source);
+  if (any_tag != q.any_tag.end() && any_tag->second.empty()) q.any_tag.erase(any_tag);
+  if (q.exact.empty() && q.any_source.empty() && q.any_tag.empty() && q.any_source_any_tag.empty()){
+    posted_.erase(qiter);
+  }
+  return req;
+}
+
+MpiQueueRecvRequest*
+MpiMatchEngine::removePosted(posted_bucket& bucket, MpiRequest* key)
+{
+  for (auto it = bucket.begin(); it != bucket.end(); ++it){
+    MpiQueueRecvRequest* req = it->req;
+    if (req->req() == key){
+      bucket.erase(it);
+      --num_posted_;
+      return req;
+    }
+  }
+  return nullptr;
+}
+
+template <class Map, class Fxn>
+static MpiQueueRecvRequest*
+removeFromBuckets(Map& buckets, Fxn&& remove)
+{
+  for (auto iter = buckets.begin(); iter != buckets.end(); ++iter){
+    MpiQueueRecvRequest* req = remove(iter->second);
+    if (req){
+      if (iter->second.empty()) buckets.erase(iter);
+      return req;
+    }
+  }
+  return nullptr;
+}
+
+MpiQueueRecvRequest*
+MpiMatchEngine::cancelPosted(MpiRequest* key)
+{
+  auto remove = [=](posted_bucket& bucket){ return removePosted(bucket, key); };
+  for (auto qiter = posted_.begin(); qiter != posted_.end(); ++qiter){
+    PostedQueues& q = qiter->second;
+    MpiQueueRecvRequest* req = removeFromBuckets(q.exact, remove);
+    if (!req) req = removeFromBuckets(q.any_source, remove);
+    if (!req) req = removeFromBuckets(q.any_tag, remove);
+    if (!req) req = remove(q.any_source_any_tag);
+    if (req){
+      if (q.exact.empty() && q.any_source.empty() && q.any_tag.empty() && q.any_source_any_tag.empty()){
+        posted_.erase(qiter);
+      }
+      return req;
+    }
+  }
+  return nullptr;
+}
+
+}
@@ -0,0 +1,167 @@
+/**
+Copyright 2009-2022 National Technology and Engineering Solutions of Sandia,
+LLC (NTESS).  Under the terms of Contract DE-NA-0003525, the U.S. Government
+retains certain rights in this software.
+
+Sandia National Laboratories is a multimission laboratory managed and operated
+by National Technology and Engineering Solutions of Sandia, LLC., a wholly
+owned subsidiary of Honeywell International, Inc., for the U.S. Department of
+Energy's National Nuclear Security Administration under contract DE-NA0003525.
+
+Copyright (c) 2009-2022, NTESS
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, 
+are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of the copyright holder nor the names of its
+      contributors may be used to endorse or promote products derived
+      from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+"AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Questions? Contact sst-macro-help@sandia.gov
+*/
+
+#ifndef SSTMAC_SOFTWARE_LIBRARIES_MPI_MPI_QUEUE_MPIMATCHENGINE_H_INCLUDED
+#define SSTMAC_SOFTWARE_LIBRARIES_MPI_MPI_QUEUE_MPIMATCHENGINE_H_INCLUDED
+
+#include <sumi-mpi/mpi_message.h>
+#include <sumi-mpi/mpi_types.h>
+#include <sumi-mpi/mpi_request_fwd.h>
+#include <sumi-mpi/mpi_queue/mpi_queue_recv_request_fwd.h>
+
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+
+namespace sumi {
+
+/**
+ * Matches posted receives against incoming messages without scanning every pending operation.
+ * Unexpected messages are bucketed by (comm,source,tag) and additionally kept in arrival order
+ * per communicator, which is only scanned for wildcard receives and probes.
+ * Posted receives are bucketed by the fields they fix, so a message checks the oldest
+ * receive in at most four buckets. Both sides preserve MPI's non-overtaking order.
+ */
+class MpiMatchEngine
+{
+ public:
+  MpiMatchEngine() : num_unexpected_(0), num_posted_(0) {}
+
+  /**
+   * @brief addUnexpected Hold a message that no posted receive matched
+   */
+  void addUnexpected(MpiMessage* msg);
+
+  /**
+   * @brief matchUnexpected Remove the oldest unexpected message the receive matches
+   * @return The message, null if no unexpected message matches
+   */
+  MpiMessage* matchUnexpected(MpiQueueRecvRequest* req);
+
+  /**
+   * @brief findUnexpected Find the oldest unexpected message matching a probe without removing it
+   * @param source A rank or MPI_ANY_SOURCE
+   * @param tag A tag or MPI_ANY_TAG
+   */
+  MpiMessage* findUnexpected(MPI_Comm comm, int source, int tag);
+
+  /**
+   * @brief addPosted Hold a receive that no unexpected message matched
+   */
+  void addPosted(MpiQueueRecvRequest* req);
+
+  /**
+   * @brief matchPosted Remove the oldest posted receive matching the message
+   * @return The receive, null if no posted receive matches
+   */
+  MpiQueueRecvRequest* matchPosted(MpiMessage* msg);
+
+  /**
+   * @brief cancelPosted Remove the posted receive for a request being cancelled.
+   *        This scans every posted receive, which is fine since cancels are rare.
+   * @return The receive, null if it already matched a message
+   */
+  MpiQueueRecvRequest* cancelPosted(MpiRequest* key);
+
+  uint64_t numUnexpected() const {
+    return num_unexpected_;
+  }
+
+  uint64_t numPosted() const {
+    return num_posted_;
+  }
+
+ private:
+  static uint64_t key(int source, int tag){
+    return (uint64_t(uint32_t(source)) << 32) | uint32_t(tag);
+  }
+
+  typedef std::list<MpiMessage*> arrival_list;
+
+  struct UnexpectedQueues {
+    /** Every unexpected message on the communicator in arrival order */
+    arrival_list arrivals;
+    /** Positions in the arrival list, bucketed by source and tag */
+    std::unordered_map<uint64_t, std::deque<arrival_list::iterator>> buckets;
+  };
+
+  struct Posted {
+    uint64_t seqnum;
+    MpiQueueRecvRequest* req;
+  };
+
+  typedef std::deque<Posted> posted_bucket;
+
+  struct PostedQueues {
+    PostedQueues() : next_seqnum(0) {}
+    uint64_t next_seqnum;
+    /** Keyed on source and tag */
+    std::unordered_map<uint64_t, posted_bucket> exact;
+    /** MPI_ANY_SOURCE, keyed on tag */
+    std::unordered_map<int, posted_bucket> any_source;
+    /** MPI_ANY_TAG, keyed on source */
+    std::unordered_map<int, posted_bucket> any_tag;
+    posted_bucket any_source_any_tag;
+  };
+
+  arrival_list::iterator findArrival(UnexpectedQueues& q, int source, int tag);
+
+  void removeArrival(UnexpectedQueues& q, arrival_list::iterator it);
+
+  MpiQueueRecvRequest* removePosted(posted_bucket& bucket, MpiRequest* key);
+
+  std::unordered_map<MPI_Comm, UnexpectedQueues> unexpected_;
+
+  std::unordered_map<MPI_Comm, PostedQueues> posted_;
+
+  uint64_t num_unexpected_;
+
+  uint64_t num_posted_;
+
+};
+
+}
+
+#endif
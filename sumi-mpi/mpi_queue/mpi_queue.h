@@ -64,6 +64,7 @@ Questions? Contact sst-macro-help@sandia.gov
 
 #include <sumi-mpi/mpi_queue/mpi_queue_recv_request_fwd.h>
 #include <sumi-mpi/mpi_queue/mpi_queue_probe_request_fwd.h>
+#include <sumi-mpi/mpi_queue/mpi_match_engine.h>
 
 #include <sprockit/sim_parameters_fwd.h>
 
@@ -108,6 +109,12 @@ class MpiQueue
 
   bool iprobe(MpiComm* comm, int source, int tag, MPI_Status* stat);
 
+  /**
+   * @brief cancelRecv Withdraw a receive that has not matched a message yet
+   * @return Whether the receive was withdrawn
+   */
+  bool cancelRecv(MpiRequest* key);
+
   MpiApi* api() const {
     return api_;
   }
@@ -191,9 +198,9 @@ class MpiQueue
   /// Hold messages that arrived out of order.
   std::unordered_map<TaskId, hold_list_t> held_;
 
-  /// Inbound messages waiting for a matching receive request.
-  std::list<MpiMessage*> need_recv_match_;
-  std::list<MpiQueueRecvRequest*> need_send_match_;
+  /// Inbound messages waiting for a matching receive request and
+  /// receive requests waiting for a matching inbound message.
+  MpiMatchEngine matcher_;
 
   std::vector<MpiProtocol*> protocols_;
 
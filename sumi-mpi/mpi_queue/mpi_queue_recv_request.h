@@ -61,6 +61,7 @@ class MpiQueueRecvRequest  {
   friend class RendezvousGet;
   friend class Eager1;
   friend class Eager0;
+  friend class MpiMatchEngine;
 
  public:
   MpiQueueRecvRequest(sstmac::Timestamp start, MpiRequest* key, MpiQueue* queue,
@@ -98,6 +98,7 @@ extern "C" int sstmac_irecv(void *buf, int count, MPI_Datatype datatype, int sou
 extern "C" int sstmac_recv_init(void *buf, int count, MPI_Datatype datatype,
       int source, int tag, MPI_Comm comm, MPI_Request *request){ return sumi::sstmac_mpi()->recvInit(buf,count,datatype,source,tag,comm,request); }
 extern "C" int sstmac_request_free(MPI_Request* req){ return sumi::sstmac_mpi()->request_free(req); }
+extern "C" int sstmac_cancel(MPI_Request* req){ return sumi::sstmac_mpi()->cancel(req); }
 extern "C" int sstmac_start(MPI_Request* req){ return sumi::sstmac_mpi()->start(req); }
 extern "C" int sstmac_startall(int count, MPI_Request* req){ return sumi::sstmac_mpi()->startall(count,req); }
 extern "C" int sstmac_wait(MPI_Request *request, MPI_Status *status){ return sumi::sstmac_mpi()->wait(request,status); }
@@ -259,6 +259,80 @@ RingAllgatherActor::initDag()
   }
 }
 
+DagCollectiveActor*
+RecursiveDoublingAllgatherCollective::newActor() const
+{
+  int nproc = comm_->nproc();
+  if (nproc & (nproc - 1)){
+    return new BruckActor(Collective::allgather, engine_, dst_buffer_, src_buffer_,
+                          nelems_, type_size_, tag_, cq_id_, comm_);
+  } else {
+    return new RecursiveDoublingAllgatherActor(engine_, dst_buffer_, src_buffer_, nelems_,
+                                               type_size_, tag_, cq_id_, comm_);
+  }
+}
+
+void
+RecursiveDoublingAllgatherActor::initBuffers()
+{
+  void* dst = result_buffer_;
+  void* src = send_buffer_;
+  //unless in place, my block goes into its final position in the dst buffer
+  if (dst != src){
+    int block_size = nelems_ * type_size_;
+    my_api_->memcopy(Message::offset_ptr(dst, dom_me_*block_size), src, block_size);
+  }
+  send_buffer_ = result_buffer_;
+  recv_buffer_ = result_buffer_;
+}
+
+void
+RecursiveDoublingAllgatherActor::finalizeBuffers()
+{
+}
+
+void
+RecursiveDoublingAllgatherActor::bufferAction(void *dst_buffer, void *msg_buffer, Action *ac)
+{
+  my_api_->memcopy(dst_buffer, msg_buffer, ac->nelems * type_size_);
+}
+
+void
+RecursiveDoublingAllgatherActor::initDag()
+{
+  RecvAction::buf_type_t recv_ty = slicer_->contiguous() ?
+        RecvAction::in_place : RecvAction::unpack_temp_buf;
+
+  Action *prev_send = nullptr, *prev_recv = nullptr;
+  int round = 0;
+  for (int gap=1; gap < dom_nproc_; gap *= 2, ++round){
+    /**
+     * Before each round I hold the gap blocks of my aligned window.
+     * Rank 1 of 4 would exchange the following blocks
+     * send 1, receive 0 from rank 0
+     * send 0-1, receive 2-3 from rank 3
+     */
+    int partner = dom_me_ ^ gap;
+    int my_window = (dom_me_ / gap) * gap;
+    int partner_window = (partner / gap) * gap;
+
+    Action* send_ac = new SendAction(round, partner, SendAction::in_place);
+    send_ac->offset = my_window * nelems_;
+    send_ac->nelems = gap * nelems_;
+    Action* recv_ac = new RecvAction(round, partner, recv_ty);
+    recv_ac->offset = partner_window * nelems_;
+    recv_ac->nelems = gap * nelems_;
+
+    addDependency(prev_send, send_ac);
+    addDependency(prev_send, recv_ac);
+    addDependency(prev_recv, send_ac);
+    addDependency(prev_recv, recv_ac);
+
+    prev_send = send_ac;
+    prev_recv = recv_ac;
+  }
+}
+
 
 
 }
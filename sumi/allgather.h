@@ -204,6 +204,58 @@ class RingAllgatherCollective :
 
 };
 
+class RecursiveDoublingAllgatherActor : public DagCollectiveActor
+{
+ public:
+  RecursiveDoublingAllgatherActor(CollectiveEngine* engine, void* dst, void* src,
+                                  int nelems, int type_size, int tag, int cq_id, Communicator* comm)
+    : DagCollectiveActor(Collective::allgather, engine, dst, src, type_size, tag, cq_id, comm),
+      nelems_(nelems)
+  {
+  }
+
+  std::string toString() const override {
+    return "recursive doubling allgather actor";
+  }
+
+ private:
+  void finalizeBuffers() override;
+  void initBuffers() override;
+  void initDag() override;
+  void bufferAction(void *dst_buffer, void *msg_buffer, Action* ac) override;
+
+  int nelems_;
+};
+
+/**
+ * Exchanges a doubling window of blocks with the partner at distance 1,2,4...
+ * Only valid for a power of two number of ranks, other sizes run the Bruck algorithm.
+ */
+class RecursiveDoublingAllgatherCollective :
+  public AllgatherCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    AllgatherCollective,
+    RecursiveDoublingAllgatherCollective,
+    "macro",
+    "recursive_doubling",
+    "log(N) recursive doubling allgather for power of two communicators")
+
+  RecursiveDoublingAllgatherCollective(CollectiveEngine* engine, void* dst, void* src,
+                          int nelems, int type_size, int tag, int cq_id, Communicator* comm)
+   : AllgatherCollective(engine, dst, src, nelems, type_size, tag, cq_id, comm)
+  {
+  }
+
+  std::string toString() const override {
+    return "recursive doubling allgather";
+  }
+
+  DagCollectiveActor* newActor() const override;
+
+};
+
 }
 
 #endif // ALLGATHER_H
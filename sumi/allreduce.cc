@@ -47,6 +47,8 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sumi/communicator.h>
 #include <sprockit/output.h>
 #include <sprockit/stl_string.h>
+#include <sstmac/null_buffer.h>
+#include <algorithm>
 #include <cstring>
 
 #define divide_by_2_round_up(x) ((x/2) + (x%2))
@@ -246,4 +248,286 @@ WilkeAllreduceActor::bufferAction(void *dst_buffer, void *msg_buffer, Action* ac
   }
 }
 
+void
+AllreduceActor::initBuffers()
+{
+  void* dst = result_buffer_;
+  void* src = send_buffer_;
+  int size = nelems_ * type_size_;
+  //work only with the dst buffer from here on
+  if (src != dst)
+    my_api_->memcopy(dst, src, size);
+  //recvs that reduce land in a temp buffer first
+  recv_buffer_ = my_api_->allocateWorkspace(size, src);
+  send_buffer_ = result_buffer_;
+}
+
+void
+AllreduceActor::finalizeBuffers()
+{
+  long buffer_size = nelems_ * type_size_;
+  my_api_->freeWorkspace(recv_buffer_, buffer_size);
+}
+
+void
+AllreduceActor::bufferAction(void *dst_buffer, void *msg_buffer, Action* ac)
+{
+  if (ac->type == Action::recv && static_cast<RecvAction*>(ac)->buf_type == RecvAction::reduce){
+    (fxn_)(dst_buffer, msg_buffer, ac->nelems);
+  } else {
+    my_api_->memcopy(dst_buffer, msg_buffer, ac->nelems * type_size_);
+  }
+}
+
+void
+FoldedAllreduceActor::initDag()
+{
+  slicer_->fxn = fxn_;
+
+  int log2nproc, midpoint, virtual_nproc;
+  RecursiveDoubling::computeTree(dom_nproc_, log2nproc, midpoint, virtual_nproc);
+  int pow2nproc = dom_nproc_;
+  if (virtual_nproc != dom_nproc_){
+    pow2nproc = midpoint;
+    --log2nproc;
+  }
+  num_folded_ = dom_nproc_ - pow2nproc;
+  int unfold_round = 2*log2nproc + 1;
+
+  debug_printf(sumi_collective,
+    "Rank %s configured allreduce for tag=%d for nproc=%d folded to n=%d over %d rounds",
+    rankStr().c_str(), tag_, dom_nproc_, pow2nproc, unfold_round);
+
+  bool folded = dom_me_ < 2*num_folded_;
+  Action *prev_send = nullptr, *prev_recv = nullptr;
+  if (folded){
+    if (dom_me_ % 2 == 0){
+      //hand my whole vector to my odd neighbor and wait for the result
+      Action* send = new SendAction(0, dom_me_ + 1, SendAction::in_place);
+      send->offset = 0;
+      send->nelems = nelems_;
+      Action* recv = new RecvAction(unfold_round, dom_me_ + 1, RecvAction::in_place);
+      recv->offset = 0;
+      recv->nelems = nelems_;
+      addAction(send);
+      addDependency(send, recv);
+      return;
+    } else {
+      Action* recv = new RecvAction(0, dom_me_ - 1, RecvAction::reduce);
+      recv->offset = 0;
+      recv->nelems = nelems_;
+      addAction(recv);
+      prev_recv = recv;
+    }
+  }
+
+  int me = folded ? dom_me_ / 2 : dom_me_ - num_folded_;
+  initPow2Dag(me, pow2nproc, prev_send, prev_recv);
+
+  if (folded){
+    Action* send = new SendAction(unfold_round, dom_me_ - 1, SendAction::in_place);
+    send->offset = 0;
+    send->nelems = nelems_;
+    addDependency(prev_send, send);
+    addDependency(prev_recv, send);
+  }
+}
+
+void
+RabenseifnerAllreduceActor::initPow2Dag(int me, int pow2nproc,
+                                        Action*& prev_send, Action*& prev_recv)
+{
+  std::vector<Action*> halving_sends;
+  std::vector<Action*> halving_recvs;
+
+  int round = 1;
+  int my_buffer_offset = 0;
+  int round_nelems = nelems_;
+  for (int partner_gap=1; partner_gap < pow2nproc; partner_gap *= 2, ++round){
+    //the lower partner keeps the lower half
+    int partner = unfoldedRank(me ^ partner_gap);
+    int send_nelems, send_offset, recv_offset;
+    if ((me & partner_gap) == 0){
+      send_nelems = divide_by_2_round_down(round_nelems);
+      send_offset = my_buffer_offset + round_nelems - send_nelems;
+      recv_offset = my_buffer_offset;
+    } else {
+      send_nelems = divide_by_2_round_up(round_nelems);
+      send_offset = my_buffer_offset;
+      recv_offset = my_buffer_offset + send_nelems;
+    }
+    int recv_nelems = round_nelems - send_nelems;
+
+    Action* send_ac = new SendAction(round, partner, SendAction::in_place);
+    send_ac->offset = send_offset;
+    send_ac->nelems = send_nelems;
+    Action* recv_ac = new RecvAction(round, partner, RecvAction::reduce);
+    recv_ac->offset = recv_offset;
+    recv_ac->nelems = recv_nelems;
+
+    addDependency(prev_send, send_ac);
+    addDependency(prev_send, recv_ac);
+    addDependency(prev_recv, send_ac);
+    addDependency(prev_recv, recv_ac);
+
+    halving_sends.push_back(send_ac);
+    halving_recvs.push_back(recv_ac);
+    prev_send = send_ac;
+    prev_recv = recv_ac;
+
+    //whatever I recv becomes the subarray for the next round
+    my_buffer_offset = recv_offset;
+    round_nelems = recv_nelems;
+  }
+
+  //as in the Wilke fan-in, non-contiguous types are received packed and forwarded without unpacking
+  RecvAction::buf_type_t fan_in_recv_type = slicer_->contiguous() ?
+        RecvAction::in_place : RecvAction::packed_temp_buf;
+  SendAction::buf_type_t fan_in_send_type = slicer_->contiguous() ?
+        SendAction::in_place : SendAction::prev_recv;
+
+  //retrace the halving rounds in reverse, sending what I reduced and receiving what I gave away
+  int last = int(halving_sends.size()) - 1;
+  for (int i=last; i >= 0; --i, ++round){
+    Action* mirror_send = halving_sends[i];
+    Action* mirror_recv = halving_recvs[i];
+    Action* send_ac = new SendAction(round, mirror_recv->partner,
+                       i == last ? SendAction::in_place : fan_in_send_type);
+    send_ac->offset = mirror_recv->offset;
+    send_ac->nelems = mirror_recv->nelems;
+    Action* recv_ac = new RecvAction(round, mirror_send->partner, fan_in_recv_type);
+    recv_ac->offset = mirror_send->offset;
+    recv_ac->nelems = mirror_send->nelems;
+
+    addDependency(prev_send, send_ac);
+    addDependency(prev_send, recv_ac);
+    addDependency(prev_recv, send_ac);
+    addDependency(prev_recv, recv_ac);
+
+    prev_send = send_ac;
+    prev_recv = recv_ac;
+  }
+}
+
+void
+RecursiveDoublingAllreduceActor::initBuffers()
+{
+  AllreduceActor::initBuffers();
+  //sends go out of a snapshot so that a partner never sees data I have already reduced into
+  send_buffer_ = my_api_->allocateWorkspace(nelems_ * type_size_, result_buffer_);
+}
+
+void
+RecursiveDoublingAllreduceActor::finalizeBuffers()
+{
+  AllreduceActor::finalizeBuffers();
+  my_api_->freeWorkspace(send_buffer_, nelems_ * type_size_);
+}
+
+void
+RecursiveDoublingAllreduceActor::startShuffle(Action * /*ac*/)
+{
+  if (isNonNullBuffer(result_buffer_)){
+    if (slicer_->contiguous()){
+      ::memcpy(send_buffer_, result_buffer_, nelems_ * type_size_);
+    } else {
+      slicer_->packsendBuf(send_buffer_, result_buffer_, 0, nelems_);
+    }
+  }
+}
+
+void
+RecursiveDoublingAllreduceActor::initPow2Dag(int me, int pow2nproc,
+                                             Action*& prev_send, Action*& prev_recv)
+{
+  int round = 1;
+  for (int partner_gap=1; partner_gap < pow2nproc; partner_gap *= 2, ++round){
+    int partner = unfoldedRank(me ^ partner_gap);
+
+    Action* snapshot = new ShuffleAction(round, partner);
+    snapshot->offset = 0;
+    snapshot->nelems = nelems_;
+    Action* send_ac = new SendAction(round, partner, SendAction::temp_send);
+    send_ac->offset = 0;
+    send_ac->nelems = nelems_;
+    Action* recv_ac = new RecvAction(round, partner, RecvAction::reduce);
+    recv_ac->offset = 0;
+    recv_ac->nelems = nelems_;
+
+    addDependency(prev_send, snapshot);
+    addDependency(prev_recv, snapshot);
+    addDependency(snapshot, send_ac);
+    addDependency(snapshot, recv_ac);
+
+    prev_send = send_ac;
+    prev_recv = recv_ac;
+  }
+}
+
+DagCollectiveActor*
+RingAllreduce::newActor() const
+{
+  if (2*(comm_->nproc() - 1) > int(Action::max_round)){
+    return new RabenseifnerAllreduceActor(engine_, dst_buffer_, src_buffer_,
+                                          nelems_, type_size_, tag_, fxn_, cq_id_, comm_);
+  } else {
+    return new RingAllreduceActor(engine_, dst_buffer_, src_buffer_,
+                                  nelems_, type_size_, tag_, fxn_, cq_id_, comm_);
+  }
+}
+
+void
+RingAllreduceActor::initDag()
+{
+  slicer_->fxn = fxn_;
+
+  //block b is the b-th of N nearly equal pieces of the vector
+  int block_nelems = nelems_ / dom_nproc_;
+  int num_big_blocks = nelems_ % dom_nproc_;
+  auto block_offset = [=](int b){ return b*block_nelems + std::min(b, num_big_blocks); };
+  auto block_size = [=](int b){ return block_nelems + (b < num_big_blocks ? 1 : 0); };
+
+  int send_partner = (dom_me_ + 1) % dom_nproc_;
+  int recv_partner = (dom_me_ + dom_nproc_ - 1) % dom_nproc_;
+
+  //after its first step the allgather only forwards the block it just received
+  RecvAction::buf_type_t gather_recv_type = slicer_->contiguous() ?
+        RecvAction::in_place : RecvAction::packed_temp_buf;
+  SendAction::buf_type_t gather_send_type = slicer_->contiguous() ?
+        SendAction::in_place : SendAction::prev_recv;
+
+  Action *prev_send = nullptr, *prev_recv = nullptr;
+  int round = 0;
+  for (int phase=0; phase < 2; ++phase){
+    /**
+     * Reduce-scatter: on step i send block me-i and reduce block me-i-1,
+     * leaving the full sum of block me+1 after N-1 steps.
+     * Allgather: on step i send block me+1-i and receive block me-i.
+     */
+    bool reducing = phase == 0;
+    int send_block = reducing ? dom_me_ : dom_me_ + 1;
+    for (int i=0; i < dom_nproc_ - 1; ++i, ++round){
+      int send_chunk = (send_block - i + 2*dom_nproc_) % dom_nproc_;
+      int recv_chunk = (send_chunk - 1 + dom_nproc_) % dom_nproc_;
+
+      Action* send_ac = new SendAction(round, send_partner,
+                          reducing || i == 0 ? SendAction::in_place : gather_send_type);
+      send_ac->offset = block_offset(send_chunk);
+      send_ac->nelems = block_size(send_chunk);
+      Action* recv_ac = new RecvAction(round, recv_partner,
+                          reducing ? RecvAction::reduce : gather_recv_type);
+      recv_ac->offset = block_offset(recv_chunk);
+      recv_ac->nelems = block_size(recv_chunk);
+
+      addDependency(prev_send, send_ac);
+      addDependency(prev_send, recv_ac);
+      addDependency(prev_recv, send_ac);
+      addDependency(prev_recv, recv_ac);
+
+      prev_send = send_ac;
+      prev_recv = recv_ac;
+    }
+  }
+}
+
 }
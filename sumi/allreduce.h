@@ -49,6 +49,7 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sumi/collective_actor.h>
 #include <sumi/collective_message.h>
 #include <sumi/comm_functions.h>
+#include <sprockit/factory.h>
 
 namespace sumi {
 
@@ -88,15 +89,46 @@ class WilkeAllreduceActor :
 
 };
 
-class WilkeHalvingAllreduce :
+class AllreduceCollective :
   public DagCollective
 {
  public:
+  SPKT_DECLARE_BASE(AllreduceCollective)
+  SPKT_DECLARE_CTOR(CollectiveEngine*, void*, void*, int, int, int,
+                    reduce_fxn, int, Communicator*)
+
+ protected:
+  AllreduceCollective(CollectiveEngine* engine, void* dst, void* src,
+                      int nelems, int type_size, int tag, reduce_fxn fxn,
+                      int cq_id, Communicator* comm)
+    : DagCollective(allreduce, engine, dst, src, type_size, tag, cq_id, comm),
+      fxn_(fxn), nelems_(nelems)
+  {
+  }
+
+  reduce_fxn fxn_;
+  int nelems_;
+};
+
+/**
+ * Reduce-scatter by recursive halving, then allgather by recursive doubling.
+ * Non-power of two sizes are handled by giving some ranks two virtual roles.
+ */
+class WilkeHalvingAllreduce :
+  public AllreduceCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    AllreduceCollective,
+    WilkeHalvingAllreduce,
+    "macro",
+    "wilke",
+    "recursive halving/doubling allreduce with virtual ranks for non-power of two sizes")
+
   WilkeHalvingAllreduce(CollectiveEngine* engine, void* dst, void* src,
                           int nelems, int type_size, int tag, reduce_fxn fxn,
                           int cq_id, Communicator* comm)
-    : DagCollective(allreduce, engine, dst, src, type_size, tag, cq_id, comm),
-      fxn_(fxn), nelems_(nelems)
+    : AllreduceCollective(engine, dst, src, nelems, type_size, tag, fxn, cq_id, comm)
   {
   }
 
@@ -109,9 +141,225 @@ class WilkeHalvingAllreduce :
                                      nelems_, type_size_, tag_, fxn_, cq_id_, comm_);
   }
 
- private:
+};
+
+/**
+ * Reduces into a copy of the src in the dst buffer, receiving into a temp buffer
+ */
+class AllreduceActor :
+  public DagCollectiveActor
+{
+ protected:
+  AllreduceActor(CollectiveEngine* engine, void* dst, void* src,
+                 int nelems, int type_size, int tag, reduce_fxn fxn,
+                 int cq_id, Communicator* comm) :
+    DagCollectiveActor(Collective::allreduce, engine, dst, src, type_size, tag, cq_id, comm, fxn),
+    fxn_(fxn), nelems_(nelems)
+  {
+  }
+
+  void bufferAction(void *dst_buffer, void *msg_buffer, Action* ac) override;
+  void finalizeBuffers() override;
+  void initBuffers() override;
+
   reduce_fxn fxn_;
   int nelems_;
+};
+
+/**
+ * Folds a non-power of two number of ranks onto the largest power of two.
+ * The first 2*r ranks pair up, the even rank of each pair hands its vector to the odd rank
+ * and sits out until the odd rank returns the result.
+ */
+class FoldedAllreduceActor :
+  public AllreduceActor
+{
+ protected:
+  FoldedAllreduceActor(CollectiveEngine* engine, void* dst, void* src,
+                       int nelems, int type_size, int tag, reduce_fxn fxn,
+                       int cq_id, Communicator* comm) :
+    AllreduceActor(engine, dst, src, nelems, type_size, tag, fxn, cq_id, comm),
+    num_folded_(0)
+  {
+  }
+
+  /**
+   * @brief initPow2Dag Add the actions among the ranks left after the fold,
+   *        using rounds 1 through 2*log2(pow2nproc)
+   * @param me My rank among the remaining ranks
+   * @param pow2nproc The number of remaining ranks
+   * @param prev_send In: the last fold action. Out: the last send added.
+   * @param prev_recv In: the last fold action. Out: the last recv added.
+   */
+  virtual void initPow2Dag(int me, int pow2nproc, Action*& prev_send, Action*& prev_recv) = 0;
+
+  /**
+   * @return The rank in the communicator for a rank among the remaining ranks
+   */
+  int unfoldedRank(int pow2_rank) const {
+    return pow2_rank < num_folded_ ? 2*pow2_rank + 1 : pow2_rank + num_folded_;
+  }
+
+ private:
+  void initDag() override;
+
+  int num_folded_;
+};
+
+class RabenseifnerAllreduceActor :
+  public FoldedAllreduceActor
+{
+ public:
+  RabenseifnerAllreduceActor(CollectiveEngine* engine, void* dst, void* src,
+                             int nelems, int type_size, int tag, reduce_fxn fxn,
+                             int cq_id, Communicator* comm) :
+    FoldedAllreduceActor(engine, dst, src, nelems, type_size, tag, fxn, cq_id, comm)
+  {
+  }
+
+  std::string toString() const override {
+    return "rabenseifner allreduce actor";
+  }
+
+ private:
+  void initPow2Dag(int me, int pow2nproc, Action*& prev_send, Action*& prev_recv) override;
+};
+
+/**
+ * Reduce-scatter by recursive halving, then allgather by recursive doubling.
+ * Non-power of two sizes fold the extra ranks onto their neighbors first.
+ */
+class RabenseifnerAllreduce :
+  public AllreduceCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    AllreduceCollective,
+    RabenseifnerAllreduce,
+    "macro",
+    "rabenseifner",
+    "bandwidth-optimal reduce-scatter plus allgather allreduce")
+
+  RabenseifnerAllreduce(CollectiveEngine* engine, void* dst, void* src,
+                        int nelems, int type_size, int tag, reduce_fxn fxn,
+                        int cq_id, Communicator* comm)
+    : AllreduceCollective(engine, dst, src, nelems, type_size, tag, fxn, cq_id, comm)
+  {
+  }
+
+  std::string toString() const override {
+    return "rabenseifner allreduce";
+  }
+
+  DagCollectiveActor* newActor() const override {
+    return new RabenseifnerAllreduceActor(engine_, dst_buffer_, src_buffer_,
+                                          nelems_, type_size_, tag_, fxn_, cq_id_, comm_);
+  }
+
+};
+
+class RecursiveDoublingAllreduceActor :
+  public FoldedAllreduceActor
+{
+ public:
+  RecursiveDoublingAllreduceActor(CollectiveEngine* engine, void* dst, void* src,
+                                  int nelems, int type_size, int tag, reduce_fxn fxn,
+                                  int cq_id, Communicator* comm) :
+    FoldedAllreduceActor(engine, dst, src, nelems, type_size, tag, fxn, cq_id, comm)
+  {
+  }
+
+  std::string toString() const override {
+    return "recursive doubling allreduce actor";
+  }
+
+ private:
+  void finalizeBuffers() override;
+  void initBuffers() override;
+  void startShuffle(Action* ac) override;
+  void initPow2Dag(int me, int pow2nproc, Action*& prev_send, Action*& prev_recv) override;
+};
+
+/**
+ * Exchanges and reduces the whole vector with the partner at distance 1,2,4...
+ * Latency-optimal for small vectors.
+ */
+class RecursiveDoublingAllreduce :
+  public AllreduceCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    AllreduceCollective,
+    RecursiveDoublingAllreduce,
+    "macro",
+    "recursive_doubling",
+    "log(N) allreduce exchanging the full vector each round")
+
+  RecursiveDoublingAllreduce(CollectiveEngine* engine, void* dst, void* src,
+                             int nelems, int type_size, int tag, reduce_fxn fxn,
+                             int cq_id, Communicator* comm)
+    : AllreduceCollective(engine, dst, src, nelems, type_size, tag, fxn, cq_id, comm)
+  {
+  }
+
+  std::string toString() const override {
+    return "recursive doubling allreduce";
+  }
+
+  DagCollectiveActor* newActor() const override {
+    return new RecursiveDoublingAllreduceActor(engine_, dst_buffer_, src_buffer_,
+                                               nelems_, type_size_, tag_, fxn_, cq_id_, comm_);
+  }
+
+};
+
+class RingAllreduceActor :
+  public AllreduceActor
+{
+ public:
+  RingAllreduceActor(CollectiveEngine* engine, void* dst, void* src,
+                     int nelems, int type_size, int tag, reduce_fxn fxn,
+                     int cq_id, Communicator* comm) :
+    AllreduceActor(engine, dst, src, nelems, type_size, tag, fxn, cq_id, comm)
+  {
+  }
+
+  std::string toString() const override {
+    return "ring allreduce actor";
+  }
+
+ private:
+  void initDag() override;
+};
+
+/**
+ * Ring reduce-scatter followed by a ring allgather of N blocks.
+ * Bandwidth-optimal for any number of ranks, but takes 2(N-1) rounds.
+ * Communicators too large to number every round run the Rabenseifner algorithm.
+ */
+class RingAllreduce :
+  public AllreduceCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    AllreduceCollective,
+    RingAllreduce,
+    "macro",
+    "ring",
+    "O(N) ring reduce-scatter plus allgather allreduce")
+
+  RingAllreduce(CollectiveEngine* engine, void* dst, void* src,
+                int nelems, int type_size, int tag, reduce_fxn fxn,
+                int cq_id, Communicator* comm)
+    : AllreduceCollective(engine, dst, src, nelems, type_size, tag, fxn, cq_id, comm)
+  {
+  }
+
+  std::string toString() const override {
+    return "ring allreduce";
+  }
+
+  DagCollectiveActor* newActor() const override;
 
 };
 
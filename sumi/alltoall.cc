@@ -307,5 +307,60 @@ DirectAlltoallActor::finalize()
 {
 }
 
+void
+PairwiseAlltoallActor::initBuffers()
+{
+  //the block I send to myself never goes on the network
+  int block_size = nelems_ * type_size_;
+  void* my_dst = Message::offset_ptr(result_buffer_, dom_me_*block_size);
+  void* my_src = Message::offset_ptr(send_buffer_, dom_me_*block_size);
+  if (my_dst != my_src){
+    my_api_->memcopy(my_dst, my_src, block_size);
+  }
+  recv_buffer_ = result_buffer_;
+}
+
+void
+PairwiseAlltoallActor::finalizeBuffers()
+{
+}
+
+void
+PairwiseAlltoallActor::bufferAction(void *dst_buffer, void *msg_buffer, Action* ac)
+{
+  my_api_->memcopy(dst_buffer, msg_buffer, ac->nelems * type_size_);
+}
+
+void
+PairwiseAlltoallActor::initDag()
+{
+  //every step has a distinct partner, so all steps can share a round
+  int round = 0;
+  RecvAction::buf_type_t recv_ty = slicer_->contiguous() ?
+        RecvAction::in_place : RecvAction::unpack_temp_buf;
+
+  Action *prev_send = nullptr, *prev_recv = nullptr;
+  for (int step=1; step < dom_nproc_; ++step){
+    int send_partner = (dom_me_ + step) % dom_nproc_;
+    int recv_partner = (dom_me_ + dom_nproc_ - step) % dom_nproc_;
+
+    //sends come straight out of the src buffer
+    Action* send_ac = new SendAction(round, send_partner, SendAction::temp_send);
+    send_ac->offset = send_partner * nelems_;
+    send_ac->nelems = nelems_;
+    Action* recv_ac = new RecvAction(round, recv_partner, recv_ty);
+    recv_ac->offset = recv_partner * nelems_;
+    recv_ac->nelems = nelems_;
+
+    addDependency(prev_send, send_ac);
+    addDependency(prev_send, recv_ac);
+    addDependency(prev_recv, send_ac);
+    addDependency(prev_recv, recv_ac);
+
+    prev_send = send_ac;
+    prev_recv = recv_ac;
+  }
+}
+
 
 }
@@ -194,6 +194,62 @@ class DirectAlltoallCollective :
 
 };
 
+class PairwiseAlltoallActor :
+  public DagCollectiveActor
+{
+ public:
+  PairwiseAlltoallActor(CollectiveEngine* engine, void *dst, void *src, int nelems,
+                        int type_size, int tag, int cq_id, Communicator* comm) :
+    DagCollectiveActor(Collective::alltoall, engine, dst, src, type_size, tag, cq_id, comm),
+    nelems_(nelems)
+  {}
+
+  std::string toString() const override {
+    return "pairwise all-to-all actor";
+  }
+
+ protected:
+  void finalizeBuffers() override;
+  void bufferAction(void *dst_buffer, void *msg_buffer, Action* ac) override;
+  void initBuffers() override;
+  void initDag() override;
+
+ private:
+  int nelems_;
+};
+
+/**
+ * N-1 steps, each sending one block to the rank k ahead and receiving one from the rank k behind.
+ * Only one exchange is in flight at a time, which avoids the congestion of the direct algorithm
+ * for large blocks at the cost of N-1 latencies.
+ */
+class PairwiseAlltoallCollective :
+  public AllToAllCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    AllToAllCollective,
+    PairwiseAlltoallCollective,
+    "macro",
+    "pairwise",
+    "pairwise exchange all-to-all collective")
+
+  PairwiseAlltoallCollective(CollectiveEngine* engine, void *dst, void *src, int nelems,
+                             int type_size, int tag, int cq_id, Communicator* comm) :
+    AllToAllCollective(engine, dst, src, nelems, type_size, tag, cq_id, comm)
+  {}
+
+  std::string toString() const override {
+    return "pairwise all-to-all";
+  }
+
+  DagCollectiveActor* newActor() const override {
+    return new PairwiseAlltoallActor(engine_, dst_buffer_, src_buffer_, nelems_,
+                                     type_size_, tag_, cq_id_, comm_);
+  }
+
+};
+
 }
 
 #endif // ALLGATHER_H
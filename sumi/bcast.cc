@@ -46,6 +46,9 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sumi/communicator.h>
 #include <sumi/transport.h>
 
+#include <algorithm>
+#include <cstring>
+
 namespace sumi {
 
 void
@@ -169,5 +172,127 @@ BinaryTreeBcastActor::initBuffers()
   result_buffer_ = send_buffer_;
 }
 
+void
+KnomialTree::computeTree(int me, int nproc, int radix,
+                         int& parent, std::vector<int>& children)
+{
+  parent = -1;
+  int mask = 1;
+  while (mask < nproc){
+    int window = radix*mask;
+    if (me % window){
+      //I am the (me % window)/mask child of my parent at this level
+      parent = (me / window) * window;
+      break;
+    }
+    mask = window;
+  }
+
+  //my subtree is everything below the level I receive on
+  mask /= radix;
+  while (mask > 0){
+    for (int i=1; i < radix; ++i){
+      int child = me + i*mask;
+      if (child < nproc) children.push_back(child);
+    }
+    mask /= radix;
+  }
+}
+
+void
+SegmentedBcastActor::bufferAction(void *dst_buffer, void *msg_buffer, Action *ac)
+{
+  ::memcpy(dst_buffer, msg_buffer, ac->nelems*type_size_);
+}
+
+void
+SegmentedBcastActor::finalizeBuffers()
+{
+}
+
+void
+SegmentedBcastActor::initBuffers()
+{
+  //the buffer is both src and dst, everything happens in place
+  send_buffer_ = result_buffer_;
+  recv_buffer_ = result_buffer_;
+}
+
+void
+SegmentedBcastActor::initDag()
+{
+  int me = (dom_me_ - root_ + dom_nproc_) % dom_nproc_;
+  int parent;
+  std::vector<int> children;
+  computeTree(me, parent, children);
+  int num_children = children.size();
+
+  int segment_nelems = nelems_;
+  if (segment_size_ > 0 && type_size_ > 0){
+    //a segment larger than the buffer is just the whole buffer
+    uint64_t max_nelems = std::max<uint64_t>(1, segment_size_ / type_size_);
+    segment_nelems = int(std::min<uint64_t>(max_nelems, nelems_));
+  }
+  int num_segments = segment_nelems ? (nelems_ + segment_nelems - 1) / segment_nelems : 1;
+  if (num_segments > int(Action::max_round)){
+    //each segment is a round, so use fewer but larger segments
+    segment_nelems = (nelems_ + Action::max_round - 1) / Action::max_round;
+    num_segments = (nelems_ + segment_nelems - 1) / segment_nelems;
+  }
+  //even an empty bcast has to send one message down the tree
+  num_segments = std::max(1, num_segments);
+
+  debug_printf(sprockit::dbg::sumi_collective_init,
+    "Rank %s has parent %d and %d children in bcast with %d segments of %d elements",
+    rankStr().c_str(), parent, num_children, num_segments, segment_nelems);
+
+  RecvAction::buf_type_t recv_ty = slicer_->contiguous() ?
+        RecvAction::in_place : RecvAction::unpack_temp_buf;
+  SendAction::buf_type_t fwd_ty = slicer_->contiguous() ?
+        SendAction::in_place : SendAction::prev_recv;
+
+  Action* prev_recv = nullptr;
+  std::vector<Action*> prev_sends(num_children, nullptr);
+  for (int seg=0; seg < num_segments; ++seg){
+    int offset = seg * segment_nelems;
+    int nelems = std::min(segment_nelems, nelems_ - offset);
+
+    Action* recv = nullptr;
+    if (parent >= 0){
+      recv = new RecvAction(seg, (parent + root_) % dom_nproc_, recv_ty);
+      recv->offset = offset;
+      recv->nelems = nelems;
+      addDependency(prev_recv, recv);
+      prev_recv = recv;
+    }
+
+    for (int c=0; c < num_children; ++c){
+      int partner = (children[c] + root_) % dom_nproc_;
+      Action* send = new SendAction(seg, partner, recv ? fwd_ty : SendAction::in_place);
+      send->offset = offset;
+      send->nelems = nelems;
+      //a segment goes out once it has arrived and the previous segment to this child is done
+      addDependency(recv, send);
+      addDependency(prev_sends[c], send);
+      prev_sends[c] = send;
+    }
+  }
+}
+
+void
+KnomialBcastActor::computeTree(int me, int& parent, std::vector<int>& children)
+{
+  KnomialTree::computeTree(me, dom_nproc_, radix_, parent, children);
+}
+
+void
+ChainBcastActor::computeTree(int me, int& parent, std::vector<int>& children)
+{
+  parent = me - 1;
+  if (me + 1 < dom_nproc_){
+    children.push_back(me + 1);
+  }
+}
+
 
 }
@@ -49,6 +49,9 @@ Questions? Contact sst-macro-help@sandia.gov
 #include <sumi/collective_actor.h>
 #include <sumi/collective_message.h>
 #include <sumi/comm_functions.h>
+#include <sprockit/factory.h>
+
+#include <vector>
 
 namespace sumi {
 
@@ -82,14 +85,50 @@ class BinaryTreeBcastActor :
   int nelems_;
 };
 
-class BinaryTreeBcastCollective :
+class BcastCollective :
   public DagCollective
 {
  public:
+  SPKT_DECLARE_BASE(BcastCollective)
+  SPKT_DECLARE_CTOR(CollectiveEngine*, int, void*,
+                    int, int, int, int, Communicator*)
+
+  /**
+   * @brief setTuning
+   * @param radix The fan-out of k-nomial trees
+   * @param segment_size The bytes per pipelined segment, 0 to send the whole buffer at once
+   */
+  void setTuning(int radix, uint64_t segment_size){
+    radix_ = radix;
+    segment_size_ = segment_size;
+  }
+
+ protected:
+  BcastCollective(CollectiveEngine* engine, int root, void* buf,
+                  int nelems, int type_size, int tag, int cq_id, Communicator* comm)
+    : DagCollective(Collective::bcast, engine, buf, buf, type_size, tag, cq_id, comm),
+      root_(root), nelems_(nelems), radix_(2), segment_size_(0) {}
+
+  int root_;
+  int nelems_;
+  int radix_;
+  uint64_t segment_size_;
+};
+
+class BinaryTreeBcastCollective :
+  public BcastCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    BcastCollective,
+    BinaryTreeBcastCollective,
+    "macro",
+    "binary_tree",
+    "log(N) tree bcast sending the whole buffer at each level")
+
   BinaryTreeBcastCollective(CollectiveEngine* engine, int root, void* buf,
                                int nelems, int type_size, int tag, int cq_id, Communicator* comm)
-    : DagCollective(Collective::bcast, engine, buf, buf, type_size, tag, cq_id, comm),
-      root_(root), nelems_(nelems) {}
+    : BcastCollective(engine, root, buf, nelems, type_size, tag, cq_id, comm) {}
 
   std::string toString() const override {
     return "bcast";
@@ -100,9 +139,175 @@ class BinaryTreeBcastCollective :
                                        type_size_, tag_, cq_id_, comm_);
   }
 
+};
+
+struct KnomialTree
+{
+  /**
+   * @brief computeTree
+   * @param me My rank relative to the root
+   * @param nproc
+   * @param radix Each parent has up to radix-1 children per level, 2 gives a binomial tree
+   * @param parent Set to the parent relative to the root, -1 for the root
+   * @param children The children relative to the root, largest subtree first
+   */
+  static void computeTree(int me, int nproc, int radix,
+                          int& parent, std::vector<int>& children);
+};
+
+/**
+ * Forwards the buffer down a tree in segments, with one round per segment,
+ * so that each level of the tree can start forwarding before the whole buffer has arrived.
+ */
+class SegmentedBcastActor :
+  public DagCollectiveActor
+{
+ public:
+  SegmentedBcastActor(CollectiveEngine* engine, int root, void *buf, int nelems,
+                      int type_size, int tag, int cq_id, Communicator* comm,
+                      uint64_t segment_size)
+    : DagCollectiveActor(Collective::bcast, engine, buf, buf, type_size, tag, cq_id, comm),
+      root_(root), nelems_(nelems), segment_size_(segment_size)
+  {}
+
+ protected:
+  /**
+   * @brief computeTree
+   * @param me My rank relative to the root
+   * @param parent Set to the parent relative to the root, -1 for the root
+   * @param children The children relative to the root in the order they are sent to
+   */
+  virtual void computeTree(int me, int& parent, std::vector<int>& children) = 0;
+
  private:
+  void finalizeBuffers() override;
+  void initBuffers() override;
+  void initDag() override;
+  void bufferAction(void *dst_buffer, void *msg_buffer, Action *ac) override;
+
   int root_;
   int nelems_;
+  uint64_t segment_size_;
+};
+
+class KnomialBcastActor :
+  public SegmentedBcastActor
+{
+ public:
+  KnomialBcastActor(CollectiveEngine* engine, int root, void *buf, int nelems,
+                    int type_size, int tag, int cq_id, Communicator* comm,
+                    int radix, uint64_t segment_size)
+    : SegmentedBcastActor(engine, root, buf, nelems, type_size, tag, cq_id, comm, segment_size),
+      radix_(radix)
+  {}
+
+  std::string toString() const override {
+    return "k-nomial bcast actor";
+  }
+
+ private:
+  void computeTree(int me, int& parent, std::vector<int>& children) override;
+
+  int radix_;
+};
+
+class KnomialBcastCollective :
+  public BcastCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    BcastCollective,
+    KnomialBcastCollective,
+    "macro",
+    "knomial",
+    "log_k(N) k-nomial tree bcast with optional segmentation")
+
+  KnomialBcastCollective(CollectiveEngine* engine, int root, void* buf,
+                         int nelems, int type_size, int tag, int cq_id, Communicator* comm)
+    : BcastCollective(engine, root, buf, nelems, type_size, tag, cq_id, comm) {}
+
+  std::string toString() const override {
+    return "k-nomial bcast";
+  }
+
+  DagCollectiveActor* newActor() const override {
+    return new KnomialBcastActor(engine_, root_, dst_buffer_, nelems_, type_size_,
+                                 tag_, cq_id_, comm_, radix_, segment_size_);
+  }
+
+};
+
+class BinomialBcastCollective :
+  public BcastCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    BcastCollective,
+    BinomialBcastCollective,
+    "macro",
+    "binomial",
+    "log(N) binomial tree bcast with optional segmentation")
+
+  BinomialBcastCollective(CollectiveEngine* engine, int root, void* buf,
+                          int nelems, int type_size, int tag, int cq_id, Communicator* comm)
+    : BcastCollective(engine, root, buf, nelems, type_size, tag, cq_id, comm) {}
+
+  std::string toString() const override {
+    return "binomial bcast";
+  }
+
+  DagCollectiveActor* newActor() const override {
+    return new KnomialBcastActor(engine_, root_, dst_buffer_, nelems_, type_size_,
+                                 tag_, cq_id_, comm_, 2, segment_size_);
+  }
+
+};
+
+class ChainBcastActor :
+  public SegmentedBcastActor
+{
+ public:
+  ChainBcastActor(CollectiveEngine* engine, int root, void *buf, int nelems,
+                  int type_size, int tag, int cq_id, Communicator* comm,
+                  uint64_t segment_size)
+    : SegmentedBcastActor(engine, root, buf, nelems, type_size, tag, cq_id, comm, segment_size)
+  {}
+
+  std::string toString() const override {
+    return "chain bcast actor";
+  }
+
+ private:
+  void computeTree(int me, int& parent, std::vector<int>& children) override;
+};
+
+/**
+ * Each rank forwards segments to the next rank as they arrive.
+ * The time approaches a single transfer of the buffer for large buffers, but grows with N.
+ */
+class ChainBcastCollective :
+  public BcastCollective
+{
+ public:
+  SPKT_REGISTER_DERIVED(
+    BcastCollective,
+    ChainBcastCollective,
+    "macro",
+    "pipeline",
+    "segmented chain bcast")
+
+  ChainBcastCollective(CollectiveEngine* engine, int root, void* buf,
+                       int nelems, int type_size, int tag, int cq_id, Communicator* comm)
+    : BcastCollective(engine, root, buf, nelems, type_size, tag, cq_id, comm) {}
+
+  std::string toString() const override {
+    return "pipelined bcast";
+  }
+
+  DagCollectiveActor* newActor() const override {
+    return new ChainBcastActor(engine_, root_, dst_buffer_, nelems_, type_size_,
+                               tag_, cq_id_, comm_, segment_size_);
+  }
 
 };
 
@@ -147,6 +147,14 @@ Collective::~Collective()
 {
 }
 
+CollectiveDoneMessage*
+AnalyticCollective::recv(int /*target*/, CollectiveWorkMessage* msg)
+{
+  delete msg;
+  engine_->notifyCollectiveDone(dom_me_, type_, tag_);
+  return new CollectiveDoneMessage(tag_, type_, comm_, cq_id_);
+}
+
 DagCollective::~DagCollective()
 {
   actor_map::iterator it, end = my_actors_.end();
@@ -190,6 +190,29 @@ class DoNothingCollective : public Collective
 
 };
 
+/**
+ * Stands in for a collective whose completion time comes from the analytic model.
+ * The only message it receives is the completion delivered at that time.
+ */
+class AnalyticCollective : public Collective
+{
+ public:
+  AnalyticCollective(type_t ty, CollectiveEngine* engine, int tag, int cq_id, Communicator* comm) :
+    Collective(ty, engine, tag, cq_id, comm)
+  {
+    refcounts_[dom_me_] = 1;
+  }
+
+  std::string toString() const override {
+    return "analytic collective";
+  }
+
+  CollectiveDoneMessage* recv(int target, CollectiveWorkMessage* msg) override;
+
+  void start() override {}
+
+};
+
 class DagCollective :
   public Collective
 {
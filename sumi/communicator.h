@@ -81,6 +81,14 @@ class Communicator {
 
   virtual std::set<int> globalRankSetIntersection(const std::set<int>& neighbors) const = 0;
 
+  /**
+   * @return An id that is the same on every rank of the communicator,
+   *         -1 if the communicator has no id
+   */
+  virtual int commId() const {
+    return -1;
+  }
+
   virtual bool supportsSmp() const {
     return false;
   }
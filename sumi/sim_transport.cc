@@ -43,6 +43,8 @@ Questions? Contact sst-macro-help@sandia.gov
 */
 
 #include <cstring>
+#include <set>
+#include <utility>
 #include <sumi/transport.h>
 #include <sumi/allreduce.h>
 #include <sumi/reduce_scatter.h>
@@ -79,8 +81,27 @@ RegisterKeywords(
 { "poll_delay", "the time it takes to poll for an incoming message" },
 { "rdma_pin_latency", "the latency for each RDMA pin information" },
 { "rdma_page_delay", "the per-page delay for RDMA pinning" },
+{ "collective_model", "packet to simulate every collective message or analytic to compute collective completion times" },
+{ "latency", "the LogGP latency of each message in an analytic collective" },
+{ "overhead", "the LogGP send/recv overhead of each message in an analytic collective" },
+{ "bandwidth", "the LogGP bandwidth of an analytic collective" },
+{ "reduce_bandwidth", "the rate at which an analytic collective combines reduced data" },
+{ "calibrate", "whether to scale the analytic model by running the packet-level algorithm once per size bucket" },
+{ "allreduce", "the default algorithm for allreduce collectives" },
+{ "bcast", "the default algorithm for bcast collectives" },
+{ "allgather", "the default algorithm for allgather collectives" },
+{ "alltoall", "the default algorithm for alltoall collectives" },
+{ "allreduce_table", "rules of the form min_nproc:min_bytes:algorithm overriding the default allreduce algorithm" },
+{ "bcast_table", "rules of the form min_nproc:min_bytes:algorithm overriding the default bcast algorithm" },
+{ "allgather_table", "rules of the form min_nproc:min_bytes:algorithm overriding the default allgather algorithm" },
+{ "alltoall_table", "rules of the form min_nproc:min_bytes:algorithm overriding the default alltoall algorithm" },
+{ "bcast_radix", "the fan-out of k-nomial bcast trees" },
+{ "bcast_segment_size", "the size of each pipelined segment in segmented bcasts, 0 to not segment" },
 );
 
+RegisterNamespaces("analytic_collective", "allreduce", "reduce_scatter", "reduce", "scan",
+                   "bcast", "allgather", "alltoall", "gather", "scatter", "barrier");
+
 #include <sstmac/common/sstmac_config.h>
 #if SSTMAC_INTEGRATED_SST_CORE
 #include <sst/core/event.h>
@@ -93,6 +114,10 @@ RegisterKeywords(
 #include <sstmac/hardware/node/node.h>
 #include <sstmac/common/event_callback.h>
 #include <sstmac/common/runtime.h>
+#include <sstmac/common/thread_lock.h>
+#if !SSTMAC_INTEGRATED_SST_CORE
+#include <sstmac/common/event_manager.h>
+#endif
 //#include <sstmac/common/stats/stat_spyplot.h>
 #include <sprockit/output.h>
 
@@ -274,6 +299,7 @@ SimTransport::SimTransport(SST::Params& params, sstmac::sw::App* parent, SST::Co
   std::string subname = sprockit::sprintf("app%d.rank%d", parent->aid(), parent->tid());
   auto* spy = comp->registerMultiStatistic<int,uint64_t>(params, "spy_bytes", subname);
   spy_bytes_ = dynamic_cast<sstmac::StatSpyplot<int,uint64_t>*>(spy);
+  if (spy_bytes_) spy_bytes_->setRow(rank_);
 #endif
 
   if (!engine_) engine_ = new CollectiveEngine(params, this);
@@ -295,6 +321,12 @@ SimTransport::allocateCq(int id, std::function<void(Message*)>&& f)
   }
 }
 
+void
+SimTransport::deliverAt(sstmac::Timestamp t, Message* m)
+{
+  parent_->os()->sendExecutionEvent(t, sstmac::newCallback(this, &SimTransport::incomingMessage, m));
+}
+
 void
 SimTransport::init()
 {
@@ -542,24 +574,193 @@ SimTransport::freeWorkspace(void *buf, uint64_t /*size*/)
   }
 }
 
+namespace {
+
+/** A rank waiting for an analytic collective to complete */
+struct AnalyticWaiter {
+  CollectiveEngine* engine;
+  int comm_rank;
+  int cq_id;
+};
+
+/** One collective call on one communicator, shared by all of its ranks */
+struct AnalyticInstance {
+  enum mode_t {
+    analytic,
+    calibrate,
+    packet
+  } mode;
+  int arrived = 0;
+  int done = 0;
+  int nproc;
+  uint64_t bytes;
+  double scale;
+  sstmac::Timestamp max_start;
+  sstmac::Timestamp max_done;
+  std::vector<AnalyticWaiter> waiting;
+};
+
+/** Collective type, communicator size, and ceil(log2) of the bytes */
+typedef std::tuple<int,int,int> CalibrationBucket;
+
+}
+
+static sstmac::thread_lock analytic_lock;
+static std::map<CollectiveEngine::AnalyticKey, AnalyticInstance> analytic_instances;
+/** The ratio of packet-level time to modeled time in each calibrated bucket */
+static std::map<CalibrationBucket, double> calibration_scales;
+static std::set<CalibrationBucket> calibrating_buckets;
+
+static CalibrationBucket
+calibrationBucket(int ty, int nproc, uint64_t bytes)
+{
+  int log2 = 0;
+  while ((uint64_t(1) << log2) < bytes) ++log2;
+  return CalibrationBucket(ty, nproc, log2);
+}
+
+template <class T>
+static bool
+algorithmRegistered(const std::string& name)
+{
+  auto* lib = T::getBuilderLibrary("macro");
+  return lib && lib->getBuilder(name);
+}
+
+static bool
+algorithmRegistered(Collective::type_t ty, const std::string& name)
+{
+  switch (ty){
+    case Collective::allreduce:
+      return algorithmRegistered<AllreduceCollective>(name);
+    case Collective::bcast:
+      return algorithmRegistered<BcastCollective>(name);
+    case Collective::allgather:
+      return algorithmRegistered<AllgatherCollective>(name);
+    case Collective::alltoall:
+      return algorithmRegistered<AllToAllCollective>(name);
+    default:
+      return false;
+  }
+}
+
+template <class T, class... Args>
+static T*
+createAlgorithm(const std::string& name, Args&&... args)
+{
+  //names are validated when the engine is built
+  auto* builder = T::getBuilderLibrary("macro")->getBuilder(name);
+  return builder->create(std::forward<Args>(args)...);
+}
+
 CollectiveEngine::CollectiveEngine(SST::Params& params, Transport *tport) :
   tport_(tport),
   global_domain_(nullptr),
   eager_cutoff_(512),
   use_put_protocol_(false),
-  system_collective_tag_(-1) //negative tags reserved for special system work
+  system_collective_tag_(-1), //negative tags reserved for special system work
+  analytic_(false),
+  calibrate_(false)
 {
   global_domain_ = new GlobalCommunicator(tport);
   eager_cutoff_ = params.find<int>("eager_cutoff", 512);
   use_put_protocol_ = params.find<bool>("use_put_protocol", false);
-  alltoall_type_ = params.find<std::string>("alltoall", "bruck");
-  allgather_type_ = params.find<std::string>("allgather", "bruck");
+
+  default_algorithms_.resize(Collective::donothing + 1);
+  algorithm_rules_.resize(Collective::donothing + 1);
+  default_algorithms_[Collective::allreduce] = params.find<std::string>("allreduce", "wilke");
+  default_algorithms_[Collective::bcast] = params.find<std::string>("bcast", "binary_tree");
+  default_algorithms_[Collective::allgather] = params.find<std::string>("allgather", "bruck");
+  default_algorithms_[Collective::alltoall] = params.find<std::string>("alltoall", "bruck");
+  for (Collective::type_t ty : {Collective::allreduce, Collective::bcast,
+                                Collective::allgather, Collective::alltoall}){
+    std::string name = Collective::tostr(ty);
+    if (!algorithmRegistered(ty, default_algorithms_[ty])){
+      spkt_abort_printf("invalid %s algorithm requested: %s",
+                        name.c_str(), default_algorithms_[ty].c_str());
+    }
+
+    std::string table = name + "_table";
+    if (!params.contains(table)) continue;
+
+    //like the tuning files of vendor MPIs, each rule applies above a communicator and message size
+    std::vector<std::string> rules;
+    params.find_array(table, rules);
+    for (auto& str : rules){
+      auto first = str.find(':');
+      auto second = first == std::string::npos ? first : str.find(':', first + 1);
+      if (second == std::string::npos){
+        spkt_abort_printf("invalid rule %s in %s: must be min_nproc:min_bytes:algorithm",
+                          str.c_str(), table.c_str());
+      }
+      AlgorithmRule rule;
+      rule.min_nproc = std::stoi(str.substr(0, first));
+      rule.min_bytes = SST::UnitAlgebra(str.substr(first + 1, second - first - 1)).getRoundedValue();
+      rule.name = str.substr(second + 1);
+      if (!algorithmRegistered(ty, rule.name)){
+        spkt_abort_printf("invalid %s algorithm in %s: %s",
+                          name.c_str(), table.c_str(), rule.name.c_str());
+      }
+      algorithm_rules_[ty].push_back(rule);
+    }
+  }
+  bcast_radix_ = params.find<int>("bcast_radix", 2);
+  if (bcast_radix_ < 2){
+    spkt_abort_printf("bcast_radix must be at least 2, got %d", bcast_radix_);
+  }
+  bcast_segment_size_ = params.find<SST::UnitAlgebra>("bcast_segment_size", "0").getRoundedValue();
 
   int default_qos = params.find<int>("default_qos", 0);
   rdma_get_qos_ = params.find<int>("collective_rdma_get_qos", default_qos);
   rdma_header_qos_ = params.find<int>("collective_rdma_header_qos", default_qos);
   ack_qos_ = params.find<int>("collective_ack_qos", default_qos);
   smsg_qos_ = params.find<int>("collective_smsg_qos", default_qos);
+
+  auto model = params.find<std::string>("collective_model", "packet");
+  if (model == "analytic"){
+    analytic_ = true;
+  } else if (model != "packet"){
+    spkt_abort_printf("invalid collective_model %s: must be packet or analytic", model.c_str());
+  }
+
+  if (analytic_){
+#if SSTMAC_INTEGRATED_SST_CORE
+    spkt_abort_printf("analytic collectives are not supported with the integrated SST core");
+#else
+    //ranks on other threads or processes cannot be scheduled directly
+    if (sstmac::EventManager::global && sstmac::EventManager::global->nworker() > 1){
+      spkt_abort_printf("analytic collectives require a serial simulation");
+    }
+#endif
+    auto model_params = params.get_scoped_params("analytic_collective");
+    calibrate_ = model_params.find<bool>("calibrate", false);
+    LogGP dflt;
+    dflt.latency = model_params.find<SST::UnitAlgebra>("latency", "1us").getValue().toDouble();
+    dflt.overhead = model_params.find<SST::UnitAlgebra>("overhead", "0s").getValue().toDouble();
+    dflt.byte_delay = model_params.find<SST::UnitAlgebra>("bandwidth", "10GB/s").getValue().inverse().toDouble();
+    dflt.reduce_byte_delay = model_params.find<SST::UnitAlgebra>("reduce_bandwidth", "10GB/s").getValue().inverse().toDouble();
+    loggp_.resize(Collective::donothing + 1, dflt);
+    for (int ty=0; ty < Collective::donothing; ++ty){
+      std::string name = Collective::tostr(Collective::type_t(ty));
+      if (!model_params->hasNamespace(name)) continue;
+
+      //parameters for a single collective override the defaults
+      auto ty_params = model_params.get_scoped_params(name);
+      LogGP& loggp = loggp_[ty];
+      if (ty_params.contains("latency")){
+        loggp.latency = ty_params.find<SST::UnitAlgebra>("latency").getValue().toDouble();
+      }
+      if (ty_params.contains("overhead")){
+        loggp.overhead = ty_params.find<SST::UnitAlgebra>("overhead").getValue().toDouble();
+      }
+      if (ty_params.contains("bandwidth")){
+        loggp.byte_delay = ty_params.find<SST::UnitAlgebra>("bandwidth").getValue().inverse().toDouble();
+      }
+      if (ty_params.contains("reduce_bandwidth")){
+        loggp.reduce_byte_delay = ty_params.find<SST::UnitAlgebra>("reduce_bandwidth").getValue().inverse().toDouble();
+      }
+    }
+  }
 }
 
 CollectiveEngine::~CollectiveEngine()
@@ -624,13 +825,16 @@ CollectiveEngine::allreduce(void* dst, void *src, int nelems, int type_size, int
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::allreduce, cq_id, comm, dst, src, nelems, type_size, tag)) return nullptr;
 
+  uint64_t bytes = uint64_t(nelems) * type_size;
   Collective* coll = nullptr;
   if (comm->smpComm()){
     //tags are restricted to 28 bits - the front 4 bits are mine for various internal operations
     int intra_reduce_tag = 1<<28 | tag;
-    auto* intra_reduce = new WilkeHalvingAllreduce(this, dst, src, nelems,
-                                   type_size, intra_reduce_tag, fxn, cq_id, comm->smpComm());
+    auto* intra_reduce = createAlgorithm<AllreduceCollective>(
+          algorithm(Collective::allreduce, comm->smpComm()->nproc(), bytes),
+          this, dst, src, nelems, type_size, intra_reduce_tag, fxn, cq_id, comm->smpComm());
 
     int root = comm->smpComm()->commToGlobalRank(0);
     Collective* prev;
@@ -640,8 +844,9 @@ CollectiveEngine::allreduce(void* dst, void *src, int nelems, int type_size, int
       }
       //I am the owner!
       int inter_reduce_tag = 2<<28 | tag;
-      auto* inter_reduce = new WilkeHalvingAllreduce(this, dst, dst, nelems,
-                                     type_size, inter_reduce_tag, fxn, cq_id, comm->ownerComm());
+      auto* inter_reduce = createAlgorithm<AllreduceCollective>(
+            algorithm(Collective::allreduce, comm->ownerComm()->nproc(), bytes),
+            this, dst, dst, nelems, type_size, inter_reduce_tag, fxn, cq_id, comm->ownerComm());
 
 
       intra_reduce->setSubsequent(inter_reduce);
@@ -656,7 +861,8 @@ CollectiveEngine::allreduce(void* dst, void *src, int nelems, int type_size, int
     coll = new DoNothingCollective(this, tag, cq_id, comm);
     intra_bcast->setSubsequent(coll);
   } else {
-    coll = new WilkeHalvingAllreduce(this, dst, src, nelems, type_size, tag, fxn, cq_id, comm);
+    coll = createAlgorithm<AllreduceCollective>(algorithm(Collective::allreduce, comm->nproc(), bytes),
+                                                this, dst, src, nelems, type_size, tag, fxn, cq_id, comm);
   }
 
   return startCollective(coll);
@@ -670,6 +876,7 @@ CollectiveEngine::reduceScatter(void* dst, void *src, int nelems, int type_size,
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::reduce_scatter, cq_id, comm, dst, src, nelems, type_size, tag)) return nullptr;
   DagCollective* coll = new HalvingReduceScatter(this, dst, src, nelems, type_size, tag, fxn, cq_id, comm);
   return startCollective(coll);
 }
@@ -682,6 +889,7 @@ CollectiveEngine::scan(void* dst, void* src, int nelems, int type_size, int tag,
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::scan, cq_id, comm, dst, src, nelems, type_size, tag)) return nullptr;
   DagCollective* coll = new SimultaneousBtreeScan(this, dst, src, nelems, type_size, tag, fxn, cq_id, comm);
   return startCollective(coll);
 }
@@ -695,6 +903,7 @@ CollectiveEngine::reduce(int root, void* dst, void *src, int nelems, int type_si
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::reduce, cq_id, comm, dst, src, nelems, type_size, tag)) return nullptr;
   DagCollective* coll = new WilkeHalvingReduce(this, root, dst, src, nelems, type_size, tag, fxn, cq_id, comm);
   return startCollective(coll);
 }
@@ -707,7 +916,11 @@ CollectiveEngine::bcast(int root, void *buf, int nelems, int type_size, int tag,
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
-  DagCollective* coll = new BinaryTreeBcastCollective(this, root, buf, nelems, type_size, tag, cq_id, comm);
+  if (analytic_ && startAnalytic(Collective::bcast, cq_id, comm, buf, buf, nelems, type_size, tag)) return nullptr;
+  uint64_t bytes = uint64_t(nelems) * type_size;
+  auto* coll = createAlgorithm<BcastCollective>(algorithm(Collective::bcast, comm->nproc(), bytes),
+                                                this, root, buf, nelems, type_size, tag, cq_id, comm);
+  coll->setTuning(bcast_radix_, bcast_segment_size_);
   return startCollective(coll);
 }
 
@@ -733,6 +946,7 @@ CollectiveEngine::gather(int root, void *dst, void *src, int nelems, int type_si
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::gather, cq_id, comm, dst, src, nelems, type_size, tag)) return nullptr;
   DagCollective* coll = new BtreeGather(this, root, dst, src, nelems, type_size, tag, cq_id, comm);
   return startCollective(coll);
 }
@@ -745,6 +959,7 @@ CollectiveEngine::scatter(int root, void *dst, void *src, int nelems, int type_s
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::scatter, cq_id, comm, dst, src, nelems, type_size, tag)) return nullptr;
   DagCollective* coll = new BtreeScatter(this, root, dst, src, nelems, type_size, tag, cq_id, comm);
   return startCollective(coll);
 }
@@ -770,13 +985,9 @@ CollectiveEngine::alltoall(void *dst, void *src, int nelems, int type_size, int
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::alltoall, cq_id, comm, dst, src, nelems, type_size, tag)) return nullptr;
 
-  auto* fact = AllToAllCollective::getBuilderLibrary("macro");
-  auto* builder = fact->getBuilder(alltoall_type_);
-  if (!builder){
-    spkt_abort_printf("invalid alltoall type requested: %s", allgather_type_.c_str());
-  }
-
+  uint64_t bytes = uint64_t(nelems) * type_size;
   if (comm->smpComm() && comm->smpBalanced()){
     int smpSize = comm->smpComm()->nproc();
     void* intraDst = dst ? new char[nelems*type_size*smpSize] : nullptr;
@@ -787,8 +998,9 @@ CollectiveEngine::alltoall(void *dst, void *src, int nelems, int type_size, int
     DagCollective* prev;
     if (comm->ownerComm()){
       int inter_tag = 2<<28 | tag;
-      AllToAllCollective* inter = builder->create(this, dst, intraDst, smpSize*nelems,
-                                                  type_size, inter_tag, cq_id, comm->ownerComm());
+      AllToAllCollective* inter = createAlgorithm<AllToAllCollective>(
+            algorithm(Collective::alltoall, comm->ownerComm()->nproc(), smpSize*bytes),
+            this, dst, intraDst, smpSize*nelems, type_size, inter_tag, cq_id, comm->ownerComm());
       intra->setSubsequent(inter);
       prev = inter;
     } else {
@@ -802,7 +1014,9 @@ CollectiveEngine::alltoall(void *dst, void *src, int nelems, int type_size, int
     bcast->setSubsequent(final);
     return startCollective(intra);
   } else {
-    AllToAllCollective* coll = builder->create(this, dst, src, nelems, type_size, tag, cq_id, comm);
+    AllToAllCollective* coll = createAlgorithm<AllToAllCollective>(
+          algorithm(Collective::alltoall, comm->nproc(), bytes),
+          this, dst, src, nelems, type_size, tag, cq_id, comm);
     return startCollective(coll);
   }
 }
@@ -827,17 +1041,9 @@ CollectiveEngine::allgather(void *dst, void *src, int nelems, int type_size, int
  if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::allgather, cq_id, comm, dst, src, nelems, type_size, tag)) return nullptr;
 
-  auto* fact = AllgatherCollective::getBuilderLibrary("macro");
-  if (!fact){
-    spkt_abort_printf("No allgather collective algorithms registered!");
-  }
-
-  auto* builder = fact->getBuilder(allgather_type_);
-  if (!builder){
-    spkt_abort_printf("invalid allgather type requested: %s", allgather_type_.c_str());
-  }
-
+  uint64_t bytes = uint64_t(nelems) * type_size;
   if (comm->smpComm() && comm->smpBalanced()){
     int smpSize = comm->smpComm()->nproc();
     void* intraDst = dst ? new char[nelems*type_size*smpSize] : nullptr;
@@ -846,15 +1052,17 @@ CollectiveEngine::allgather(void *dst, void *src, int nelems, int type_size, int
 
 
 
-    AllgatherCollective* intra = builder->create(this, intraDst, src, nelems,
-                                                 type_size, intra_tag, cq_id, comm->smpComm());
+    AllgatherCollective* intra = createAlgorithm<AllgatherCollective>(
+          algorithm(Collective::allgather, smpSize, bytes),
+          this, intraDst, src, nelems, type_size, intra_tag, cq_id, comm->smpComm());
 
     DagCollective* prev;
     if (comm->ownerComm()){
       int inter_tag = 2<<28 | tag;
 
-      AllgatherCollective* inter = builder->create(this, dst, intraDst, smpSize*nelems, type_size,
-                                                   inter_tag, cq_id, comm->ownerComm());
+      AllgatherCollective* inter = createAlgorithm<AllgatherCollective>(
+            algorithm(Collective::allgather, comm->ownerComm()->nproc(), smpSize*bytes),
+            this, dst, intraDst, smpSize*nelems, type_size, inter_tag, cq_id, comm->ownerComm());
       intra->setSubsequent(inter);
       prev = inter;
     } else {
@@ -868,7 +1076,9 @@ CollectiveEngine::allgather(void *dst, void *src, int nelems, int type_size, int
     bcast->setSubsequent(final);
     return startCollective(intra);
   } else {
-    AllgatherCollective* coll = builder->create(this, dst, src, nelems, type_size, tag, cq_id, comm);
+    AllgatherCollective* coll = createAlgorithm<AllgatherCollective>(
+          algorithm(Collective::allgather, comm->nproc(), bytes),
+          this, dst, src, nelems, type_size, tag, cq_id, comm);
     return startCollective(coll);
   }
 }
@@ -894,6 +1104,7 @@ CollectiveEngine::barrier(int tag, int cq_id, Communicator* comm)
   if (msg) return msg;
 
   if (!comm) comm = global_domain_;
+  if (analytic_ && startAnalytic(Collective::barrier, cq_id, comm, nullptr, nullptr, 0, 0, tag)) return nullptr;
   DagCollective* coll = new BruckBarrierCollective(this, nullptr, nullptr, tag, cq_id, comm);
   return startCollective(coll);
 }
@@ -939,7 +1150,7 @@ CollectiveEngine::startCollective(Collective* coll)
 {
   if (coll->type() == Collective::donothing){
     todel_.push_back(coll);
-    return new CollectiveDoneMessage(coll->tag(), coll->type(), coll->comm(), coll->cqId());
+    return recordCalibration(new CollectiveDoneMessage(coll->tag(), coll->type(), coll->comm(), coll->cqId()));
   }
 
   coll->initActors();
@@ -965,6 +1176,192 @@ CollectiveEngine::startCollective(Collective* coll)
     dmsg = startCollective(active);
   }
 
+  return recordCalibration(dmsg);
+}
+
+bool
+CollectiveEngine::startAnalytic(Collective::type_t ty, int cq_id, Communicator* comm,
+                                void* dst, void* src, int nelems, int type_size, int tag)
+{
+  //payloads can only be moved by the packet-level algorithm
+  if (isNonNullBuffer(dst) || isNonNullBuffer(src)){
+    return false;
+  }
+
+  uint64_t bytes = uint64_t(nelems) * type_size;
+  int nproc = comm->nproc();
+  AnalyticKey key(tport_->sid().app_, comm->commId(), comm->commToGlobalRank(0), nproc, ty, tag);
+  sstmac::Timestamp now = tport_->now();
+
+  analytic_lock.lock();
+  AnalyticInstance& inst = analytic_instances[key];
+  if (inst.arrived == 0){
+    //the first rank to join decides how every rank runs this collective
+    inst.nproc = nproc;
+    inst.bytes = bytes;
+    inst.scale = 1.0;
+    inst.mode = AnalyticInstance::analytic;
+    if (calibrate_){
+      CalibrationBucket bucket = calibrationBucket(ty, nproc, bytes);
+      auto iter = calibration_scales.find(bucket);
+      if (iter != calibration_scales.end()){
+        inst.scale = iter->second;
+      } else if (calibrating_buckets.insert(bucket).second){
+        inst.mode = AnalyticInstance::calibrate;
+      } else {
+        //another collective is still calibrating this bucket
+        inst.mode = AnalyticInstance::packet;
+      }
+    }
+  }
+  ++inst.arrived;
+  inst.max_start = std::max(inst.max_start, now);
+
+  if (inst.mode != AnalyticInstance::analytic){
+    if (inst.mode == AnalyticInstance::calibrate){
+      calibrating_[std::make_pair(comm, tag)] = key;
+    } else if (inst.arrived == nproc){
+      analytic_instances.erase(key);
+    }
+    analytic_lock.unlock();
+    return false;
+  }
+
+  validateCollective(ty, tag);
+  collectives_[ty][tag] = new AnalyticCollective(ty, this, tag, cq_id, comm);
+  inst.waiting.push_back(AnalyticWaiter{this, comm->myCommRank(), cq_id});
+  if (inst.arrived == nproc){
+    sstmac::Timestamp done = inst.max_start + analyticCost(ty, nproc, bytes) * inst.scale;
+    debug_printf(sprockit::dbg::sumi_collective,
+      "Rank %d completing analytic %s of %llu bytes on %d ranks, tag %d, at %8.4es",
+      tport_->rank(), Collective::tostr(ty), (unsigned long long) bytes, nproc, tag, done.sec());
+    for (AnalyticWaiter& w : inst.waiting){
+      w.engine->deliverAnalytic(done, ty, tag, w.cq_id, w.comm_rank);
+    }
+    analytic_instances.erase(key);
+  }
+  analytic_lock.unlock();
+  return true;
+}
+
+void
+CollectiveEngine::deliverAnalytic(sstmac::Timestamp t, Collective::type_t ty, int tag, int cq_id, int comm_rank)
+{
+  int rank = tport_->rank();
+  //the completion looks like a message to self, so it takes the same path through the CQ
+  auto* msg = new CollectiveWorkMessage(ty, comm_rank, comm_rank, tag, 0, 0, 0,
+                                        nullptr, CollectiveWorkMessage::eager,
+                                        rank, rank, Message::no_ack, cq_id, Message::collective,
+                                        smsg_qos_, tport_->allocateFlowId(), tport_->serverLibname(),
+                                        tport_->sid().app_, tport_->addr(), tport_->addr(),
+                                        0, false, nullptr, Message::smsg{});
+  static_cast<SimTransport*>(tport_)->deliverAt(t, msg);
+}
+
+sstmac::TimeDelta
+CollectiveEngine::analyticCost(Collective::type_t ty, int nproc, uint64_t bytes) const
+{
+  const LogGP& p = loggp_[ty];
+  double alpha = p.latency + 2*p.overhead;
+  double n = bytes;
+  double frac = double(nproc - 1) / nproc;
+  int log2 = 0;
+  while ((1 << log2) < nproc) ++log2;
+
+  double t = 0;
+  switch (ty){
+    case Collective::allreduce:
+      if (algorithm(ty, nproc, bytes) == "recursive_doubling"){
+        t = log2*(alpha + n*(p.byte_delay + p.reduce_byte_delay));
+      } else if (algorithm(ty, nproc, bytes) == "ring"){
+        t = 2*(nproc - 1)*alpha + 2*frac*n*p.byte_delay + frac*n*p.reduce_byte_delay;
+      } else {
+        t = 2*log2*alpha + 2*frac*n*p.byte_delay + frac*n*p.reduce_byte_delay;
+      }
+      break;
+    case Collective::reduce:
+      //recursive halving reduce-scatter, then recursive doubling allgather or gather
+      t = 2*log2*alpha + 2*frac*n*p.byte_delay + frac*n*p.reduce_byte_delay;
+      break;
+    case Collective::reduce_scatter:
+      t = log2*alpha + (nproc - 1)*n*(p.byte_delay + p.reduce_byte_delay);
+      break;
+    case Collective::scan:
+      t = log2*(alpha + n*(p.byte_delay + p.reduce_byte_delay));
+      break;
+    case Collective::bcast:
+      t = log2*(alpha + n*p.byte_delay);
+      break;
+    case Collective::allgather:
+    case Collective::gather:
+    case Collective::scatter:
+      t = log2*alpha + (nproc - 1)*n*p.byte_delay;
+      break;
+    case Collective::alltoall:
+      if (algorithm(ty, nproc, bytes) == "bruck"){
+        t = log2*alpha + ((nproc + 1) / 2)*log2*n*p.byte_delay;
+      } else {
+        t = (nproc - 1)*(alpha + n*p.byte_delay);
+      }
+      break;
+    case Collective::barrier:
+      t = log2*alpha;
+      break;
+    default:
+      spkt_abort_printf("no analytic model for %s collective", Collective::tostr(ty));
+  }
+  return sstmac::TimeDelta(t);
+}
+
+const std::string&
+CollectiveEngine::algorithm(Collective::type_t ty, int nproc, uint64_t bytes) const
+{
+  const AlgorithmRule* match = nullptr;
+  for (const AlgorithmRule& rule : algorithm_rules_[ty]){
+    if (rule.min_nproc > nproc || rule.min_bytes > bytes) continue;
+
+    //the most specific rule wins, later rules break ties
+    if (!match || rule.min_nproc > match->min_nproc
+        || (rule.min_nproc == match->min_nproc && rule.min_bytes >= match->min_bytes)){
+      match = &rule;
+    }
+  }
+  return match ? match->name : default_algorithms_[ty];
+}
+
+CollectiveDoneMessage*
+CollectiveEngine::recordCalibration(CollectiveDoneMessage* dmsg)
+{
+  if (!dmsg || calibrating_.empty()){
+    return dmsg;
+  }
+
+  auto iter = calibrating_.find(std::make_pair(dmsg->dom(), dmsg->tag()));
+  if (iter == calibrating_.end()){
+    return dmsg;
+  }
+
+  analytic_lock.lock();
+  auto inst_iter = analytic_instances.find(iter->second);
+  AnalyticInstance& inst = inst_iter->second;
+  inst.max_done = std::max(inst.max_done, tport_->now());
+  ++inst.done;
+  if (inst.done == inst.nproc){
+    Collective::type_t ty = Collective::type_t(std::get<4>(iter->second));
+    sstmac::TimeDelta measured = inst.max_done - inst.max_start;
+    sstmac::TimeDelta modeled = analyticCost(ty, inst.nproc, inst.bytes);
+    double scale = modeled.ticks() ? measured.sec() / modeled.sec() : 1.0;
+    CalibrationBucket bucket = calibrationBucket(ty, inst.nproc, inst.bytes);
+    calibration_scales[bucket] = scale;
+    calibrating_buckets.erase(bucket);
+    debug_printf(sprockit::dbg::sumi_collective,
+      "Calibrated analytic %s of %llu bytes on %d ranks: packet-level %8.4es, model %8.4es",
+      Collective::tostr(ty), (unsigned long long) inst.bytes, inst.nproc,
+      measured.sec(), modeled.sec());
+    analytic_instances.erase(inst_iter);
+  }
+  analytic_lock.unlock();
+  calibrating_.erase(iter);
   return dmsg;
 }
 
@@ -1039,7 +1436,7 @@ CollectiveEngine::incoming(Message* msg)
       coll = coll->popSubsequent();
       dmsg = startCollective(coll);
     }
-    return dmsg;
+    return recordCalibration(dmsg);
   }
 }
 
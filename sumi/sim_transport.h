@@ -264,6 +264,12 @@ class SimTransport : public Transport, public sstmac::sw::API {
 
   void allocateCq(int id, std::function<void(Message*)>&& f);
 
+  /**
+   * @brief deliverAt Hand a message to its completion queue at a given time
+   *        without sending it through the network
+   */
+  void deliverAt(sstmac::Timestamp t, Message* m);
+
  private:      
   void send(Message* m) override;
 
@@ -62,6 +62,9 @@ Questions? Contact sst-macro-help@sandia.gov
 
 #include <unordered_map>
 #include <queue>
+#include <map>
+#include <tuple>
+#include <vector>
 
 DeclareDebugSlot(sumi);
 
@@ -330,6 +333,14 @@ class CollectiveEngine
 
   void initSmp(const std::set<int>& neighbors);
 
+  /**
+   * @return Whether collectives without payloads skip the network and
+   *         complete at a time computed from the analytic model
+   */
+  bool analytic() const {
+    return analytic_;
+  }
+
   int allocateGlobalCollectiveTag(){
     system_collective_tag_--;
     if (system_collective_tag_ >= 0)
@@ -532,6 +543,42 @@ class CollectiveEngine
 
   CollectiveDoneMessage* deliverPending(Collective* coll, int tag, Collective::type_t ty);
 
+  /**
+   * @brief startAnalytic Join a collective that completes from the analytic model
+   * @return Whether the collective is analytic, false if it must run the packet-level algorithm
+   */
+  bool startAnalytic(Collective::type_t ty, int cq_id, Communicator* comm,
+                     void* dst, void* src, int nelems, int type_size, int tag);
+
+  /**
+   * @brief deliverAnalytic Schedule the completion of an analytic collective on this rank
+   */
+  void deliverAnalytic(sstmac::Timestamp t, Collective::type_t ty, int tag, int cq_id, int comm_rank);
+
+  /**
+   * @return The modeled time of a collective from the moment the last rank joins
+   */
+  sstmac::TimeDelta analyticCost(Collective::type_t ty, int nproc, uint64_t bytes) const;
+
+  /**
+   * @brief recordCalibration If the collective is run to calibrate the analytic model,
+   *        record the time this rank finished it
+   * @return The done message, unchanged
+   */
+  CollectiveDoneMessage* recordCalibration(CollectiveDoneMessage* dmsg);
+
+  /**
+   * @brief algorithm Look up the algorithm for a collective in the selection table
+   * @param bytes The bytes contributed by each rank
+   * @return The algorithm of the matching rule with the largest communicator size,
+   *         then the largest message size, or the default algorithm if no rule matches
+   */
+  const std::string& algorithm(Collective::type_t ty, int nproc, uint64_t bytes) const;
+
+ public:
+  /** app, communicator id, first global rank, size, collective type, tag */
+  typedef std::tuple<int,int,int,int,int,int> AnalyticKey;
+
  private:
   Transport* tport_;
 
@@ -556,14 +603,43 @@ class CollectiveEngine
 
   int system_collective_tag_;
 
-  std::string alltoall_type_;
-  std::string allgather_type_;
+  /** Use an algorithm for communicators of at least min_nproc ranks and messages of at least min_bytes */
+  struct AlgorithmRule {
+    int min_nproc;
+    uint64_t min_bytes;
+    std::string name;
+  };
+
+  /** Indexed by collective type */
+  std::vector<std::string> default_algorithms_;
+  std::vector<std::vector<AlgorithmRule>> algorithm_rules_;
+
+  int bcast_radix_;
+  uint64_t bcast_segment_size_;
 
   int rdma_header_qos_;
   int rdma_get_qos_;
   int smsg_qos_;
   int ack_qos_;
 
+  /** LogGP parameters of the analytic model in seconds and seconds per byte */
+  struct LogGP {
+    double latency;
+    double overhead;
+    double byte_delay;
+    double reduce_byte_delay;
+  };
+
+  bool analytic_;
+
+  bool calibrate_;
+
+  /** Indexed by collective type */
+  std::vector<LogGP> loggp_;
+
+  /** Collectives this rank runs at packet level to calibrate the model */
+  std::map<std::pair<Communicator*,int>, AnalyticKey> calibrating_;
+
 };
 
 }
@@ -43,7 +43,17 @@ Questions? Contact sst-macro-help@sandia.gov
 */
 
 #include <sstmac/common/rng.h>
+#include <sstmac/software/process/memoize.h>
+#include <sprockit/sim_parameters.h>
+#include <sprockit/slab_allocator.h>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
 
 void test_random_numbers()
 {
@@ -63,7 +73,125 @@ void test_random_numbers()
 }
 
 
+static void check_fit(const char* name, sstmac::RegressionModel* model,
+                      const double params[], double expected)
+{
+    double time = model->compute(2, params, nullptr);
+    if (std::fabs(time - expected) < 1e-9*expected)
+        printf("SUCCESS on %s memoization fit\n", name);
+    else
+        printf("FAILURE on %s memoization fit: got %g, expected %g\n", name, time, expected);
+}
+
+void test_memoization_models()
+{
+    SST::Params params;
+    params.insert("memoize_degree", "2");
+    sstmac::LinearModel linear(params);
+    sstmac::PolynomialModel poly(params);
+
+    //exact data, so least squares must recover the functions
+    for (int x=1; x <= 4; ++x){
+        for (int y=1; y <= 4; ++y){
+            double in[] = { double(x), double(y) };
+            linear.addSample(2, in, 1e-6 + 2e-6*x + 3e-7*y, nullptr);
+            poly.addSample(2, in, 1e-6 + 1e-7*x*y + 5e-8*x*x, nullptr);
+        }
+    }
+
+    double extrapolate[] = { 10., 7. };
+    check_fit("linear", &linear, extrapolate, 1e-6 + 2e-5 + 2.1e-6);
+    check_fit("polynomial", &poly, extrapolate, 1e-6 + 7e-6 + 5e-6);
+
+    //a model read back from its written state must give the same fit
+    std::stringstream sstr;
+    poly.writeModel(sstr);
+    sstmac::PolynomialModel reread(params);
+    reread.readModel(sstr);
+    if (reread.numSamples() == poly.numSamples())
+        printf("SUCCESS on memoization model samples\n");
+    else
+        printf("FAILURE on memoization model samples\n");
+    check_fit("reread polynomial", &reread, extrapolate, 1e-6 + 7e-6 + 5e-6);
+}
+
+struct SlabBarrier {
+    std::mutex mtx;
+    std::condition_variable cv;
+    int count = 0;
+    int generation = 0;
+    int nthread;
+
+    void wait(){
+        std::unique_lock<std::mutex> lk(mtx);
+        int gen = generation;
+        if (++count == nthread){
+            count = 0;
+            ++generation;
+            cv.notify_all();
+        } else {
+            cv.wait(lk, [&]{ return gen != generation; });
+        }
+    }
+};
+
+void test_slab_allocator()
+{
+    using sprockit::SlabAllocator;
+    static const int nthread = 4;
+    static const int nobjs = 20000;
+    int64_t slabs_before = SlabAllocator::slabsMapped();
+
+    //every object is allocated on one thread and freed on the next
+    std::vector<std::vector<std::pair<char*,size_t>>> handoff(nthread);
+    SlabBarrier barrier;
+    barrier.nthread = nthread;
+    std::vector<int> errors(nthread, 0);
+    std::vector<std::thread> threads;
+    for (int t=0; t < nthread; ++t){
+        threads.emplace_back([&,t]{
+            auto& mine = handoff[(t+1) % nthread];
+            for (int round=0; round < 3; ++round){
+                for (int i=0; i < nobjs; ++i){
+                    size_t size = 8 + (i*37 + t*11) % SlabAllocator::max_size;
+                    char* ptr = (char*) SlabAllocator::allocate(size);
+                    memset(ptr, t, size);
+                    mine.emplace_back(ptr, size);
+                }
+                barrier.wait();
+                int from = (t + nthread - 1) % nthread;
+                for (auto& pair : handoff[t]){
+                    if (pair.first[0] != from || pair.first[pair.second-1] != from) ++errors[t];
+                    SlabAllocator::deallocate(pair.first, pair.second);
+                }
+                handoff[t].clear();
+                barrier.wait();
+                //owners collect what the other threads freed
+                SlabAllocator::trim();
+                barrier.wait();
+            }
+        });
+    }
+    for (auto& thr : threads) thr.join();
+
+    int total_errors = 0;
+    for (int e : errors) total_errors += e;
+    if (total_errors == 0)
+        printf("SUCCESS on cross-thread slab allocation\n");
+    else
+        printf("FAILURE on cross-thread slab allocation: %d corrupted objects\n", total_errors);
+
+    if (SlabAllocator::slabsMapped() == slabs_before)
+        printf("SUCCESS on returning slabs after trim\n");
+    else
+        printf("FAILURE on returning slabs after trim: %ld slabs still mapped\n",
+               long(SlabAllocator::slabsMapped() - slabs_before));
+}
+
+
 int main(int argc, char** argv)
 {
     test_random_numbers();
+    test_memoization_models();
+    test_slab_allocator();
 }